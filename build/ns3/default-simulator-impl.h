@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef DEFAULT_SIMULATOR_IMPL_H
+#define DEFAULT_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "traced-callback.h"
+#include "timer-wheel.h"
+#include "event-profiler.h"
+
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <string>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::DefaultSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * The default single process simulator implementation.
+ *
+ * When the \c EventProfile attribute is set, the wall-clock time of the
+ * events is attributed by an EventProfiler to their callback, TypeId
+ * and context, and reported at Simulator::Destroy.  For example:
+ * \code
+ *   ./waf --run "first --ns3::DefaultSimulatorImpl::EventProfile=true
+ *                      --ns3::DefaultSimulatorImpl::EventProfileCollapsedStacks=first.folded"
+ *   flamegraph.pl first.folded > first.svg
+ * \endcode
+ */
+class DefaultSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DefaultSimulatorImpl ();
+  /** Destructor. */
+  ~DefaultSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual EventId ScheduleTimer (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * TracedCallback signature for the events received from other threads.
+   *
+   * \param [in] count The number of events moved to the event queue
+   *                   by one call to ProcessEventsWithContext.
+   */
+  typedef void (* DrainTracedCallback)(uint32_t count);
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * Set the duration of a tick of the timer wheel.
+   *
+   * \param [in] resolution The duration of a tick, or zero to disable
+   *             the timer wheel.
+   */
+  void SetTimerWheelResolution (Time resolution);
+  /** \returns The duration of a tick of the timer wheel. */
+  Time GetTimerWheelResolution (void) const;
+  /** Move the timers which may run before the next event to the event queue. */
+  void AdvanceTimers (void);
+  /** Report the event profile, and forget it. */
+  void WriteEventProfile (void);
+  /** Process the next event. */
+  void ProcessOneEvent (void);
+  /** Move events from a different context into the main event queue. */
+  void ProcessEventsWithContext (void);
+
+  /**
+   * Wrap an event with its execution context.
+   *
+   * This is also a node of the queue of events from other threads.
+   */
+  struct EventWithContext
+  {
+    /** The event context. */
+    uint32_t context;
+    /** Event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+    /** The next (more recent) node of the queue. */
+    std::atomic<struct EventWithContext *> next;
+  };
+  /**
+   * Append a node to the queue of events from other threads.
+   *
+   * This is wait-free and can be called concurrently by any thread.
+   *
+   * \param [in] node The node to append.
+   */
+  void PushEventWithContext (struct EventWithContext *node);
+  /**
+   * Remove the oldest node of the queue of events from other threads.
+   *
+   * This can only be called by the main thread.
+   *
+   * \returns The oldest node, or 0 if the queue is empty or if the
+   *          next node is still being appended by another thread.
+   */
+  struct EventWithContext * PopEventWithContext (void);
+
+  /**
+   * The queue of events from other threads is an intrusive
+   * multiple-producer single-consumer linked list: producers exchange
+   * the head and link the previous head to their node, the main thread
+   * consumes from the tail.  The stub node keeps the list non-empty.
+   */
+  std::atomic<struct EventWithContext *> m_eventsWithContextHead;
+  /** The oldest node of the queue, only accessed by the main thread. */
+  struct EventWithContext *m_eventsWithContextTail;
+  /** The stub node of the queue. */
+  struct EventWithContext m_eventsWithContextStub;
+  /** Trace of the number of events received in each batch. */
+  TracedCallback<uint32_t> m_eventsWithContextDrained;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** The event priority queue. */
+  Ptr<Scheduler> m_events;
+  /** The events scheduled with ScheduleTimer, until they are due. */
+  TimerWheel m_timers;
+
+  /** Next event unique id. */
+  uint64_t m_uid;
+  /** Unique id of the current event. */
+  uint64_t m_currentUid;
+  /** Timestamp of the current event. */
+  uint64_t m_currentTs;
+  /** Execution context of the current event. */
+  uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
+  /**
+   * Number of events that have been inserted but not yet scheduled,
+   *  not counting the Destroy events; this is used for validation
+   */
+  int m_unscheduledEvents;
+
+  /** Whether to profile the events. */
+  bool m_profile;
+  /** The event profile. */
+  EventProfiler m_profiler;
+  /** The file to write the event profile report to. */
+  std::string m_profileReport;
+  /** The file to write the event profile collapsed stacks to. */
+  std::string m_profileCollapsedStacks;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* DEFAULT_SIMULATOR_IMPL_H */
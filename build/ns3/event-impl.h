@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef EVENT_IMPL_H
+#define EVENT_IMPL_H
+
+#include <stdint.h>
+#include <cstddef>
+#include "simple-ref-count.h"
+#include "size-class-allocator.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventImpl declarations.
+ */
+
+namespace ns3 {
+
+class ObjectBase;
+
+/**
+ * \ingroup events
+ * \brief A simulation event.
+ *
+ * Each subclass of this base class represents a simulation event. The
+ * Invoke() method will be called by the simulation engine
+ * when it reaches the time associated to this event. Most subclasses
+ * are usually created by one of the many Simulator::Schedule
+ * methods.
+ *
+ * The memory of the events, which includes the arguments bound by
+ * MakeEvent(), is recycled through per-thread free lists, one for each
+ * size class of 16 bytes up to 256 bytes, so that scheduling an event
+ * does not usually reach malloc.  The free lists can be disabled, for
+ * example to let AddressSanitizer or valgrind check the events, with
+ * the "EventImplPool" GlobalValue or the NS_GLOBAL_VALUE environment
+ * variable:
+ * \code
+ *   NS_GLOBAL_VALUE="EventImplPool=false" ./waf --run ...
+ * \endcode
+ */
+class EventImpl : public SimpleRefCount<EventImpl>
+{
+public:
+  /** Statistics of the EventImpl free lists of a thread. */
+  typedef SizeClassAllocatorStats PoolStats;
+
+  /**
+   * Allocate an event, from the free list of its size class if possible.
+   *
+   * \param [in] size The size of the event.
+   * \returns The event memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release an event to the free list of its size class.
+   *
+   * \param [in] p The event memory.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \returns The allocation statistics of the calling thread.
+   */
+  static PoolStats GetPoolStats (void);
+  /** Reset the allocation statistics of the calling thread. */
+  static void ResetPoolStats (void);
+
+  /** Default constructor. */
+  EventImpl ();
+  /** Destructor. */
+  virtual ~EventImpl () = 0;
+  /**
+   * Called by the simulation engine to notify the event that it is time
+   * to execute.
+   */
+  void Invoke (void);
+  /**
+   * Marks the event as 'canceled'. The event is not removed from
+   * the event list but the simulation engine will check its canceled status
+   * before calling Invoke().
+   */
+  void Cancel (void);
+  /**
+   * \returns true if the event has been canceled.
+   *
+   * Checked by the simulation engine before calling Invoke().
+   */
+  bool IsCancelled (void);
+  /**
+   * \returns The object whose method is invoked by this event, if it is
+   *          an ObjectBase, or 0.
+   *
+   * This is used to attribute the events to the TypeId of their object,
+   * for example by the event profiler of DefaultSimulatorImpl.
+   */
+  virtual const ObjectBase * PeekObject (void) const;
+
+protected:
+  /**
+   * Implementation for Invoke().
+   *
+   * This typically calls a method or function pointer with the
+   * arguments bound by a call to one of the MakeEvent() functions.
+   */
+  virtual void Notify (void) = 0;
+
+private:
+  friend class TimerWheel;
+
+  bool m_cancel;  /**< Has this event been cancelled. */
+  /** The index of the event in its TimerWheel slot, if it is a timer. */
+  uint32_t m_timerIndex;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_IMPL_H */
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "type-id.h"
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Attribute the wall-clock time of the events to what they run.
+ *
+ * The time spent in each event is attributed to the type of the
+ * callback invoked by the event, to the TypeId of the object whose
+ * method the event invokes, if any, and to the context of the event,
+ * that is, usually, its node.  The profile is reported as sorted tables,
+ * and as collapsed stacks, one line per context, TypeId and callback:
+ * \verbatim
+   context 3;ns3::TcpSocketBase;void (ns3::TcpSocketBase::*)() 1234567
+   \endverbatim
+ * which can be rendered as a flame graph, for example with
+ * \c flamegraph.pl from https://github.com/brendangregg/FlameGraph
+ *
+ * This is used by DefaultSimulatorImpl when its \c EventProfile
+ * attribute is set.
+ */
+class EventProfiler
+{
+public:
+  /** The profile of a callback, in a context and for a TypeId. */
+  struct Record
+  {
+    /** The context of the events. */
+    uint32_t context;
+    /** The name of the TypeId of the events object, or "-". */
+    std::string tid;
+    /** The type of the callback invoked by the events. */
+    std::string callback;
+    /** Number of events. */
+    uint64_t count;
+    /** Wall-clock time spent in the events, in nanoseconds. */
+    uint64_t nanoseconds;
+  };
+
+  /**
+   * Invoke an event, and attribute its wall-clock time.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   */
+  void Invoke (EventImpl *event, uint32_t context);
+  /**
+   * \returns The profile of each context, TypeId and callback, by
+   *          decreasing time.
+   */
+  std::vector<Record> GetRecords (void) const;
+  /**
+   * Print the time and number of events of each callback, TypeId and
+   * context, by decreasing time.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void Report (std::ostream &os) const;
+  /**
+   * Print the profile as collapsed stacks.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void WriteCollapsedStacks (std::ostream &os) const;
+  /** Forget the events profiled so far. */
+  void Clear (void);
+
+private:
+  /** The attribution of an event. */
+  struct Key
+  {
+    /** The dynamic type of the event. */
+    std::type_index type;
+    /** The TypeId of the event object. */
+    TypeId tid;
+    /** The context of the event. */
+    uint32_t context;
+    /**
+     * Ordering of the keys.
+     * \param [in] other The other key.
+     * \returns \c true if this key is before \c other.
+     */
+    bool operator < (const Key &other) const;
+  };
+  /** Event count and time. */
+  struct Stats
+  {
+    /** Number of events. */
+    uint64_t count;
+    /** Wall-clock time, in nanoseconds. */
+    uint64_t nanoseconds;
+  };
+
+  /**
+   * Print a table of the profile aggregated by one field.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] title The field name.
+   * \param [in] records The records, with the field as their callback.
+   * \param [in] total The total time, in nanoseconds.
+   */
+  static void PrintTable (std::ostream &os, const std::string &title,
+                          const std::vector<Record> &records, uint64_t total);
+  /**
+   * \param [in] context An event context.
+   * \returns The name of the context.
+   */
+  static std::string GetContextName (uint32_t context);
+
+  /** The profile. */
+  std::map<Key, Stats> m_stats;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_SHARED_ROUTING_HELPER_H
+#define IPV4_SHARED_ROUTING_HELPER_H
+
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-shared-routing-graph.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that adds ns3::Ipv4SharedRouting objects
+ *
+ * All the protocols which a helper and its copies create share the same
+ * Ipv4SharedRoutingGraph, and form a routing domain.  No call is needed
+ * once the addresses are assigned: the routes are computed on demand.
+ */
+class Ipv4SharedRoutingHelper : public Ipv4RoutingHelper
+{
+public:
+  /**
+   * \brief Construct an Ipv4SharedRoutingHelper, with a new graph.
+   */
+  Ipv4SharedRoutingHelper ();
+
+  /**
+   * \brief Construct an Ipv4SharedRoutingHelper from another previously
+   * initialized instance (Copy Constructor), which shares its graph.
+   */
+  Ipv4SharedRoutingHelper (const Ipv4SharedRoutingHelper &);
+
+  /**
+   * \returns pointer to clone of this Ipv4SharedRoutingHelper
+   *
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv4SharedRoutingHelper* Copy (void) const;
+
+  /**
+   * \param node the node on which the routing protocol will run
+   * \returns a newly-created routing protocol
+   *
+   * This method will be called by ns3::InternetStackHelper::Install
+   */
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \returns The graph which the protocols created by this helper share,
+   * for instance to set its attributes.
+   */
+  Ptr<Ipv4SharedRoutingGraph> GetGraph (void) const;
+
+private:
+  /**
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return Nothing useful.
+   */
+  Ipv4SharedRoutingHelper &operator = (const Ipv4SharedRoutingHelper &);
+
+  Ptr<Ipv4SharedRoutingGraph> m_graph; //!< The graph of the domain
+};
+
+} // namespace ns3
+
+#endif /* IPV4_SHARED_ROUTING_HELPER_H */
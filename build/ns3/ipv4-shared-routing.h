@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_SHARED_ROUTING_H
+#define IPV4_SHARED_ROUTING_H
+
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-shared-routing-graph.h"
+
+namespace ns3 {
+
+class Packet;
+class NetDevice;
+class Ipv4Header;
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Routing protocol for IPv4 stacks which computes its routes on
+ * demand from a graph shared with the other nodes of its domain.
+ *
+ * This protocol is meant for large and regular topologies, such as
+ * fat-trees and Clos networks, where Ipv4GlobalRouting would store a route
+ * to every destination in every node.  An Ipv4SharedRouting stores no
+ * route: it asks the Ipv4SharedRoutingGraph of its domain for the next hop
+ * to the prefix which matches the destination of each packet.  The routes
+ * are shortest paths over the metrics of the interfaces, as with global
+ * routing, and follow the changes of the interfaces and addresses of the
+ * nodes without any further call.
+ *
+ * The Ipv4SharedRoutingHelper creates the protocols of a domain with a
+ * shared graph.
+ *
+ * This class deals with Ipv4 unicast routes only.
+ *
+ * \see Ipv4SharedRoutingGraph
+ */
+class Ipv4SharedRouting : public Ipv4RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4SharedRouting ();
+  virtual ~Ipv4SharedRouting ();
+
+  // These methods inherited from base class
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+  virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                            LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+
+  /**
+   * \brief Set the graph from which the routes are computed.
+   *
+   * \param graph The graph of the domain of the node.
+   */
+  void SetGraph (Ptr<Ipv4SharedRoutingGraph> graph);
+  /**
+   * \returns The graph from which the routes are computed.
+   */
+  Ptr<Ipv4SharedRoutingGraph> GetGraph (void) const;
+
+protected:
+  void DoDispose (void);
+
+private:
+  /**
+   * \brief Look up a route to a destination in the graph.
+   * \param dest The destination address.
+   * \param oif The output device, if the route must use one.
+   * \returns The route, or 0 if none was found.
+   */
+  Ptr<Ipv4Route> LookupShared (Ipv4Address dest, Ptr<NetDevice> oif = 0) const;
+
+  Ptr<Ipv4> m_ipv4;                      //!< The Ipv4 of the node
+  Ptr<Ipv4SharedRoutingGraph> m_graph;   //!< The graph of the domain
+  uint32_t m_node;                       //!< The index of the node in the graph
+};
+
+} // namespace ns3
+
+#endif /* IPV4_SHARED_ROUTING_H */
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * Events are kept in three tiers:
+ * - the Top, an unsorted array of the events in the far future;
+ * - the Ladder, made of up to eight rungs of buckets.  When the Bottom
+ *   is empty, the events of the Top are spread over the buckets of the
+ *   first rung, and each bucket of the last rung is either sorted into
+ *   the Bottom, or, if it holds more than \c Threshold events, spread
+ *   over the buckets of a new, finer, rung;
+ * - the Bottom, a small array sorted in decreasing time stamp order,
+ *   from which events are dequeued.
+ *
+ * Events are only sorted once they reach the Bottom, so both insertion
+ * and removal of the next event take amortized constant time,
+ * independently of the distribution of the time stamps.  Unlike
+ * CalendarScheduler, the buckets are contiguous arrays whose storage
+ * is reused, and the queue never needs to be resized.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket type: a contiguous array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** The buckets; only the first \c nBuckets are in use. */
+    std::vector<Bucket> buckets;
+    /** Number of buckets in use. */
+    uint32_t nBuckets;
+    /** Index of the first bucket not yet dequeued. */
+    uint32_t current;
+    /** Time stamp at the start of the first bucket. */
+    uint64_t start;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t width;
+  };
+
+  /** Maximum number of rungs of the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /**
+   * Initialize a new rung after the last one in use.
+   *
+   * \param [in] start The time stamp at the start of the rung.
+   * \param [in] end The time stamp at the end (excluded) of the rung.
+   * \param [in] n The number of events to spread over the rung.
+   * \returns The new rung.
+   */
+  Rung & AddRung (uint64_t start, uint64_t end, uint32_t n);
+  /**
+   * Insert an event in the rung which covers its time stamp.
+   *
+   * \param [in] ev The event.
+   * \returns \c false if no rung covers the event time stamp.
+   */
+  bool InsertInLadder (const Scheduler::Event &ev);
+  /**
+   * Insert an event in the sorted Bottom.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /** Move events down to the Bottom until it is not empty. */
+  void Refill (void);
+  /** Spread the Top over a new first rung. */
+  void TransferTop (void);
+  /**
+   * \returns The time stamp at the start of the first bucket not
+   *          yet dequeued of the last rung.
+   */
+  uint64_t GetLadderLimit (void) const;
+
+  /** The events in the far future, unsorted. */
+  Bucket m_top;
+  /** Smallest time stamp in the Top. */
+  uint64_t m_topMin;
+  /** Largest time stamp in the Top. */
+  uint64_t m_topMax;
+  /** The smallest time stamp stored in the Top. */
+  uint64_t m_topStart;
+  /** The rungs of the ladder. */
+  std::vector<Rung> m_rungs;
+  /** The number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The next events, in decreasing time stamp order. */
+  Bucket m_bottom;
+  /** Number of events in the queue. */
+  uint32_t m_size;
+  /** Bucket size above which a new rung is created. */
+  uint32_t m_threshold;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
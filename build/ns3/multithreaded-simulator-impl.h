@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "system-mutex.h"
+
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A shared-memory parallel simulator implementation.
+ *
+ * Events are partitioned by their execution context (the node id)
+ * into ThreadCount partitions, each with its own event list, and every
+ * partition is processed by its own thread.  The partitions advance in
+ * lock step through time windows of length equal to the lookahead, the
+ * smallest delay of any link which joins two partitions: an event
+ * executed in a window can only schedule events in another partition
+ * at or beyond the end of that window, so all the partitions can safely
+ * execute the events of a window concurrently (conservative,
+ * barrier-synchronized parallel simulation).
+ *
+ * Events scheduled into another partition are buffered in the sender
+ * and handed to the receiver at the next window boundary, without any
+ * serialization: a Ptr<Packet> bound to the event is simply passed along.
+ * The events buffered for a partition are inserted in the order of the
+ * sending partition index, which makes the execution order of all events
+ * a function of the seed and of the thread count only.
+ *
+ * Events without context (Simulator::NO_CONTEXT), such as those scheduled
+ * from the main program with Simulator::Schedule, are "global" events:
+ * they are run by the main thread between two windows while all the
+ * partitions are paused, so they can safely touch any node.  At equal
+ * timestamps, global events run before partition events.
+ *
+ * The partition of every node and the lookahead are usually configured
+ * by MultithreadedSimulatorHelper::Partition, which derives them from the
+ * channels (PointToPointChannel, CsmaChannel, ...) installed in the
+ * topology.  Running with more than one thread requires ns-3 to be
+ * configured with --enable-mtp, which makes the reference counts and the
+ * packet data structures safe to share between threads.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \returns The number of partitions, which is also the number of
+   *          threads used by Run.
+   */
+  uint32_t GetPartitionCount (void) const;
+  /**
+   * Assign an execution context to a partition.
+   *
+   * Contexts which have not been assigned explicitly are mapped to
+   * partition \c context modulo GetPartitionCount().  This method
+   * can only be called from the main thread while the simulation is
+   * not running.
+   *
+   * \param [in] context The context (node id).
+   * \param [in] partition The partition index.
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context The context (node id).
+   * \returns The index of the partition which executes the events
+   *          of this context.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * Set the lookahead, that is, the smallest delay between an event
+   * executed in a partition and any event it schedules in another
+   * partition.
+   *
+   * \param [in] lookahead The lookahead.
+   */
+  void SetLookahead (const Time &lookahead);
+  /** \returns The lookahead. */
+  Time GetLookahead (void) const;
+  /**
+   * \returns The number of time windows executed so far.
+   */
+  uint64_t GetWindowCount (void) const;
+
+  /**
+   * Allocate an identifier, for example a packet uid, from the sequence
+   * of the partition which runs the calling thread.  The partition index
+   * plus one is stored above the low UID_BITS bits, so the sequences of
+   * the partitions are disjoint, and each of them only depends on the
+   * events of its partition, not on the interleaving of the threads.
+   *
+   * \returns The identifier, or 0 if the calling thread is not running
+   *          an event of a partition.
+   */
+  static uint64_t AllocateUid (void);
+
+  /** The number of bits of the identifiers of a partition sequence. */
+  static const uint32_t UID_BITS = 40;
+
+private:
+  virtual void DoDispose (void);
+
+  /** Wrap an event with its execution context. */
+  struct EventWithContext
+  {
+    /** The event context. */
+    uint32_t context;
+    /** Event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+  /** Container type for the events from a different context. */
+  typedef std::vector<struct EventWithContext> EventsWithContext;
+
+  /** The state of a partition, accessed only by its thread while running. */
+  struct Partition
+  {
+    /** The partition index. */
+    uint32_t index;
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /** Next event unique id, unique across the partitions. */
+    uint64_t uid;
+    /** Unique id of the current event. */
+    uint64_t currentUid;
+    /** Next identifier allocated by AllocateUid, without the partition bits. */
+    uint64_t objectUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** The event count. */
+    uint64_t eventCount;
+    /** Number of events inserted but not yet executed. */
+    int unscheduledEvents;
+    /** Set by Stop when called by an event of this partition. */
+    bool stop;
+    /** Smallest timestamp sent to another partition during this window. */
+    uint64_t minSent;
+    /**
+     * Events sent to the other partitions, indexed by the window parity
+     * and the destination partition (the global partition is last).
+     */
+    std::vector<EventsWithContext> outbox[2];
+  };
+
+  /**
+   * Entry point of the worker threads.
+   * \param [in] self The simulator.
+   * \param [in] index The index of the partition run by the thread.
+   */
+  static void RunWorker (MultithreadedSimulatorImpl *self, uint32_t index);
+  /**
+   * Wait until all threads have reached this point.
+   */
+  void Synchronize (void);
+  /**
+   * Receive the events sent during the previous window, then process
+   * all events of the partition which are before the end of the window.
+   * \param [in] partition The partition to process.
+   */
+  void ProcessPartition (Partition *partition);
+  /**
+   * Process the next event of a partition.
+   * \param [in] partition The partition to process.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Collect the results of the window which just ended.
+   */
+  void EndWindow (void);
+  /** Move events from a different thread into the event queues. */
+  void ProcessEventsWithContext (void);
+  /**
+   * \returns The partition of the calling thread, the global partition
+   *          for the main thread when no window is running.
+   */
+  Partition * GetCurrentPartition (void) const;
+  /**
+   * \param [in] context The event context.
+   * \returns The partition which executes the events of this context.
+   */
+  Partition * GetPartitionOf (uint32_t context) const;
+  /**
+   * Insert an event in a partition event list.
+   * \param [in] partition The partition.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \returns The scheduler event key.
+   */
+  Scheduler::EventKey Insert (Partition *partition, uint64_t ts,
+                              uint32_t context, EventImpl *event);
+  /**
+   * \returns The smallest timestamp of any pending partition event.
+   */
+  uint64_t GetNextPartitionTs (void) const;
+
+  /** The partitions which run in the worker threads. */
+  std::vector<Partition *> m_partitions;
+  /** The partition of the global events, run by the main thread. */
+  Partition *m_global;
+  /** The number of threads. */
+  uint32_t m_threadCount;
+  /** The explicit context to partition assignment. */
+  std::vector<uint32_t> m_partitionOf;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookahead;
+  /** The start of the current window, before which all events have run. */
+  uint64_t m_windowStart;
+  /** The end (excluded) of the current window. */
+  uint64_t m_windowEnd;
+  /** The parity of the current window, selects the outboxes. */
+  uint32_t m_parity;
+  /** Smallest timestamp of the events not yet received by a partition. */
+  uint64_t m_pendingTs;
+  /** The number of windows executed. */
+  uint64_t m_windowCount;
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** Flag calling for the worker threads to exit. */
+  bool m_exit;
+  /** The worker threads. */
+  std::vector<Ptr<SystemThread> > m_threads;
+  /** The number of threads which reached the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** The number of times the barrier was crossed. */
+  std::atomic<uint32_t> m_barrierGeneration;
+
+  /** The container of events from a different thread. */
+  EventsWithContext m_eventsWithContext;
+  /**
+   * Flag \c true if all events with context have been moved to the
+   * primary event queue.
+   */
+  bool m_eventsWithContextEmpty;
+  /** Mutex to control access to the list of events with context. */
+  SystemMutex m_eventsWithContextMutex;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** The factory of the partition schedulers. */
+  ObjectFactory m_schedulerFactory;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+
+  /** The partition processed by the calling thread, if any. */
+  static thread_local Partition *g_currentPartition;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_LIFECYCLE_TRACKER_H
+#define PACKET_LIFECYCLE_TRACKER_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketLifecycleTracker declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Record the lifecycle events of the packets, by uid, in a
+ * columnar table.
+ *
+ * The tracker connects itself to the trace sources of the net devices
+ * and of their transmit queues, so that the simulation scripts do not
+ * have to hook each of them with Config::Connect and a string context.
+ * Each event appends a row to a table of columns: the uid of the packet,
+ * the time in nanoseconds, the node id, the interface index of the
+ * device, the event and the size of the packet.  The columns are
+ * allocated once for a chunk of rows, and never hold more, so that
+ * recording an event does not allocate memory.
+ *
+ * When a file is opened, each full chunk is appended to it, column by
+ * column, and the table is reused for the next chunk:
+ * \code
+ *   PacketLifecycleTracker tracker;
+ *   tracker.Open ("lifecycle.bin");
+ *   tracker.InstallAll ();
+ *   Simulator::Run ();
+ *   tracker.Close ();
+ * \endcode
+ * Otherwise the table keeps the last chunk of rows in memory: once it
+ * is full, each event overwrites the oldest row.  Read loads a file back
+ * into a table.
+ *
+ * The file starts with a header of two 32-bit words, the magic number
+ * and the version.  Each chunk then holds the number of rows as a 32-bit
+ * word, followed by the columns uid (64 bits), time (64 bits), node (32
+ * bits), interface (32 bits), size (32 bits) and event (8 bits).  The
+ * words are in the byte order of the host which wrote the file.
+ *
+ * Other events, for example those of a QueueDisc, can be added with
+ * Record.  The tracker is not thread safe: with the multithreaded
+ * simulator, use a tracker for each partition.  It must outlive the
+ * simulation, as the trace sources keep a pointer to it.
+ */
+class PacketLifecycleTracker
+{
+public:
+  /** The events of the lifecycle of a packet. */
+  enum Event
+  {
+    ENQUEUE = 0,     //!< Enqueued in the transmit queue of a device
+    DEQUEUE = 1,     //!< Dequeued from the transmit queue of a device
+    QUEUE_DROP = 2,  //!< Dropped by the transmit queue of a device
+    TX = 3,          //!< Passed to the device for transmission (MacTx)
+    RX = 4,          //!< Received by the device and passed up (MacRx)
+    TX_DROP = 5,     //!< Dropped by the device before transmission
+    RX_DROP = 6      //!< Dropped by the device on reception
+  };
+
+  /** A table of events, by column. */
+  struct Columns
+  {
+    std::vector<uint64_t> uid;        //!< The uids of the packets
+    std::vector<int64_t> time;        //!< The times in nanoseconds
+    std::vector<uint32_t> node;       //!< The node ids
+    std::vector<uint32_t> interface;  //!< The interface indices of the devices
+    std::vector<uint32_t> size;       //!< The sizes of the packets
+    std::vector<uint8_t> event;       //!< The events
+
+    /** \returns the number of rows. */
+    std::size_t GetN (void) const;
+    /**
+     * Reserve room for a number of rows in each column.
+     *
+     * \param [in] n The number of rows.
+     */
+    void Reserve (std::size_t n);
+    /** Remove all the rows, and keep the memory of the columns. */
+    void Clear (void);
+  };
+
+  PacketLifecycleTracker ();
+  /** Destructor; writes the last rows to the file, if any. */
+  ~PacketLifecycleTracker ();
+
+  /**
+   * Set the number of rows of a chunk.  The default is 65536.  Without a
+   * file, the oldest rows beyond the new size are discarded.
+   *
+   * \param [in] rows The number of rows.
+   */
+  void SetChunkSize (uint32_t rows);
+  /**
+   * Write the chunks to a binary file.  The rows still in memory are
+   * written with the first chunk.
+   *
+   * \param [in] filename The name of the file.
+   * \returns \c true if the file could be created.
+   */
+  bool Open (std::string filename);
+  /** Write the last rows and close the file, if any. */
+  void Close (void);
+  /** Write the rows recorded so far to the file, if any. */
+  void Flush (void);
+
+  /**
+   * Connect the tracker to the trace sources of a device and of its
+   * transmit queue.  The trace sources which the device does not have
+   * are ignored.
+   *
+   * \param [in] device The device.
+   */
+  void Install (Ptr<NetDevice> device);
+  /**
+   * \param [in] devices The devices.
+   */
+  void Install (NetDeviceContainer devices);
+  /**
+   * Connect the tracker to the devices of some nodes.
+   *
+   * \param [in] nodes The nodes.
+   */
+  void Install (NodeContainer nodes);
+  /** Connect the tracker to the devices of all the nodes. */
+  void InstallAll (void);
+
+  /**
+   * Record an event at the current simulation time.
+   *
+   * \param [in] packet The packet.
+   * \param [in] node The node id.
+   * \param [in] interface The interface index of the device.
+   * \param [in] event The event.
+   */
+  void Record (Ptr<const Packet> packet, uint32_t node, uint32_t interface, Event event);
+
+  /**
+   * \returns The rows not written to the file yet, or the last chunk of
+   * rows without a file, from the oldest to the newest.
+   */
+  const Columns & GetColumns (void);
+  /**
+   * \returns The number of rows recorded since the creation of the
+   * tracker, including those written to the file.
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * Read a file written by a tracker.
+   *
+   * \param [in] filename The name of the file.
+   * \param [out] columns The rows of all the chunks of the file.
+   * \returns \c false if the file could not be read.
+   */
+  static bool Read (std::string filename, Columns &columns);
+
+private:
+  /** Write the rows of the table as a chunk, and clear the table. */
+  void WriteChunk (void);
+  /** Rotate the columns so that the oldest row is the first one. */
+  void Unwrap (void);
+
+  Columns m_columns;       //!< The rows of the current chunk
+  uint32_t m_oldest;       //!< The index of the oldest row, once the table is full
+  uint32_t m_chunkSize;    //!< The number of rows of a chunk
+  uint64_t m_nRecords;     //!< The number of rows recorded
+  std::ofstream m_file;    //!< The file of the chunks
+};
+
+} // namespace ns3
+
+#endif /* PACKET_LIFECYCLE_TRACKER_H */
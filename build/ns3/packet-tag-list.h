@@ -0,0 +1,370 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef PACKET_TAG_LIST_H
+#define PACKET_TAG_LIST_H
+
+/**
+\file   packet-tag-list.h
+\brief  Defines a list of Packet tags stored in a shared array, including copy-on-write semantics.
+*/
+
+#include <stdint.h>
+#include <ostream>
+#include <cstring>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+#include "ns3/type-id.h"
+
+namespace ns3 {
+
+class Tag;
+
+/**
+ * \ingroup packet
+ *
+ * \brief List of the packet tags stored in a packet.
+ *
+ * This class is mostly private to the Packet implementation and users
+ * should never have to access it directly.
+ *
+ * \internal
+ *
+ * A packet usually carries a handful of small tags, which are copied
+ * with the packet at every hop and looked up by type.  The tags are
+ * therefore stored in serialized form, one after the other, in a single
+ * array rather than in a node each.  The first INLINE_SIZE bytes of tags
+ * are stored in the PacketTagList itself, and copied with it.  When more
+ * tags are added, they are all moved to a TagBlock, which is shared by
+ * the copies of the list:
+ *
+ * \verbatim
+ *   PacketTagList A: m_data, m_used = 3 tags ----.
+ *   PacketTagList B: m_data, m_used = 4 tags ---------.
+ *                                                |    |
+ *   TagBlock: count = 2 | T1 | T2 | T3 | T4 |****|
+ *                                           ^ dirty
+ * \endverbatim
+ *
+ *   - Each TagData entry holds the TypeId and the size of a tag,
+ *     followed by its serialized data, padded to the alignment of
+ *     the entries.
+ *
+ *   - Each PacketTagList uses the first \c m_used bytes of the block
+ *     which it points to.  \c count is the number of PacketTagLists
+ *     which point to the block, and \c dirty is the largest \c m_used
+ *     among them.
+ *
+ * \par <b> Copy-on-write </b> of a TagBlock is implemented as follows,
+ * in the same way as the ByteTagList:
+ *
+ *   - Copy constructor (PacketTagList(const PacketTagList & o))
+ *     and assignment (#operator=(const PacketTagList & o))
+ *     share the block of \c o, incrementing its \c count, or copy
+ *     the inline tags of \c o.
+ *
+ *   - #Add appends the new tag in place if the block is not shared or
+ *     if no other PacketTagList uses the bytes after \c m_used (that is,
+ *     if \c m_used is \c dirty), and the block is large enough.
+ *     Otherwise, the tags are copied to a new block first, which grows
+ *     geometrically.  #Add does not affect any other PacketTagList,
+ *     hence this is a \c const function.
+ *
+ *   - #Remove of the last tag only decrements \c m_used.  #Remove of
+ *     another tag, and #Replace, modify the block in place if it is not
+ *     shared, and otherwise copy it first.
+ *
+ * The blocks are allocated from the PacketPool, so that the packets
+ * with more tags do not usually reach malloc either.
+ */
+class PacketTagList 
+{
+public:
+  /**
+   * Serialized tag, stored in the array of a TagBlock.
+   *
+   * See PacketTagList for a discussion of the data structure.
+   *
+   * \internal
+   * Unfortunately this has to be public, because
+   * PacketTagIterator::Item::GetTag() needs the data and size values.
+   * The Item nested class can't be forward declared, so friending isn't
+   * possible.
+   */
+  struct TagData
+  {
+    TypeId tid;                 /**< Type of the tag serialized into #data */
+    uint32_t size;              /**< Size of the \c data buffer */
+    uint8_t data[1];            /**< Serialization buffer */
+  };  /* struct TagData */
+
+  /**
+   * Create a new PacketTagList.
+   */
+  inline PacketTagList ();
+  /**
+   * Copy constructor
+   *
+   * \param [in] o The PacketTagList to copy.
+   *
+   * This makes a light-weight copy, sharing the tags of \pname{o}.
+   */
+  inline PacketTagList (PacketTagList const &o);
+  /**
+   * Assignment
+   *
+   * \param [in] o The PacketTagList to copy.
+   * \returns the copied object
+   *
+   * This makes a light-weight copy by #RemoveAll, then
+   * sharing the tags of \pname{o}.
+   */
+  inline PacketTagList &operator = (PacketTagList const &o);
+  /**
+   * Destructor
+   *
+   * #RemoveAll's the tags.
+   */
+  inline ~PacketTagList ();
+
+  /**
+   * Add a tag at the end of this list.
+   *
+   * \param [in] tag The tag to add
+   */
+  void Add (Tag const&tag) const;
+  /**
+   * Remove (the first instance of) tag from the list.
+   *
+   * \param [in,out] tag The tag type to remove.  If found,
+   *          \pname{tag} is set to the value of the tag found.
+   * \returns True if \pname{tag} is found, false otherwise.
+   */
+  bool Remove (Tag &tag);
+  /**
+   * Replace the value of a tag.
+   *
+   * \param [in] tag The tag type to replace.  To get the old
+   *        value of the tag, use #Peek first.
+   * \returns True if \pname{tag} is found, false otherwise.
+   *        If \pname{tag} wasn't found, Add is performed instead (so
+   *        the list is guaranteed to have the new tag value either way).
+   */
+  bool Replace (Tag &tag);
+  /**
+   * Find a tag and return its value.
+   *
+   * \param [in,out] tag The tag type to find.  If found,
+   *          \pname{tag} is set to the value of the tag found.
+   * \returns True if \pname{tag} is found, false otherwise.
+   */
+  bool Peek (Tag &tag) const;
+  /**
+   * Remove all tags from this list.
+   */
+  inline void RemoveAll (void);
+  /**
+   * \returns pointer to the first tag of the list, or 0 if it is empty.
+   */
+  const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns pointer past the last tag of the list, or 0 if it is empty.
+   */
+  const struct PacketTagList::TagData *End (void) const;
+  /**
+   * \param [in] cur A tag of a list.
+   * \returns pointer to the tag which follows \pname{cur} in its list.
+   */
+  static const struct PacketTagList::TagData *Next (const struct PacketTagList::TagData *cur);
+
+private:
+  /**
+   * Shared array of serialized tags.
+   */
+  struct TagBlock
+  {
+    uint32_t size;               /**< Size of the \c data array */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; /**< Number of PacketTagLists using the block */
+#else
+    uint32_t count;              /**< Number of PacketTagLists using the block */
+#endif
+    uint32_t dirty;              /**< Number of bytes used by the longest list */
+    uint8_t data[4];             /**< The TagData entries */
+  };  /* struct TagBlock */
+
+  /** The size of the tags stored in the list itself. */
+  static const uint32_t INLINE_SIZE = 48;
+
+  /**
+   * \param [in] size The serialized size of a tag.
+   * \returns The size of the TagData entry which holds it.
+   */
+  static uint32_t GetEntrySize (uint32_t size);
+  /**
+   * Allocate a TagBlock from the PacketPool.
+   *
+   * \param [in] size The minimum size of its array.
+   * \returns The TagBlock, which uses the whole PacketPool block.
+   */
+  static struct TagBlock *Allocate (uint32_t size);
+  /**
+   * Release a reference to a TagBlock, and its memory if it was the
+   * last one.
+   *
+   * \param [in] data The TagBlock, or 0.
+   */
+  static void Deallocate (struct TagBlock *data);
+  /**
+   * \returns The array of the tags, in the TagBlock or inline.
+   */
+  inline uint8_t *GetBuffer (void) const;
+  /**
+   * Copy the inline tags of another list, which has no TagBlock.
+   *
+   * \param [in] o The other list.
+   */
+  inline void CopyInline (PacketTagList const &o);
+  /**
+   * Find a tag in this list.
+   *
+   * \param [in] tid The type of the tag.
+   * \returns The offset of its entry in the block, or m_used if
+   *          it is not found.
+   */
+  uint32_t Find (TypeId tid) const;
+  /**
+   * Remove a tag from this list.
+   *
+   * \param [in] offset The offset of its entry in the block.
+   */
+  void RemoveEntry (uint32_t offset);
+  /**
+   * Copy the tags of this list to a new block of its own, from its
+   * shared block or from its inline array.
+   *
+   * \param [in] size The minimum size of the new block.
+   */
+  void Unshare (uint32_t size);
+
+  /**
+   * The array of the tags, or 0 if they are stored in #m_inline.
+   */
+  struct TagBlock *m_data;
+  /**
+   * The number of bytes of the array used by this list.
+   */
+  uint32_t m_used;
+  /**
+   * The array of the tags when they fit in it, aligned as a TagData.
+   */
+  uint32_t m_inline[INLINE_SIZE / 4];
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of inline methods for performance
+ ****************************************************/
+
+namespace ns3 {
+
+PacketTagList::PacketTagList ()
+  : m_data (0),
+    m_used (0)
+{
+}
+
+PacketTagList::PacketTagList (PacketTagList const &o)
+  : m_data (o.m_data),
+    m_used (o.m_used)
+{
+  if (m_data != 0)
+    {
+      m_data->count++;
+    }
+  else
+    {
+      CopyInline (o);
+    }
+}
+
+PacketTagList &
+PacketTagList::operator = (PacketTagList const &o)
+{
+  if (this == &o)
+    {
+      return *this;
+    }
+  // assignment of a list sharing the same block
+  if (m_data != 0 && m_data == o.m_data)
+    {
+      m_used = o.m_used;
+      return *this;
+    }
+  RemoveAll ();
+  m_data = o.m_data;
+  m_used = o.m_used;
+  if (m_data != 0) 
+    {
+      m_data->count++;
+    }
+  else
+    {
+      CopyInline (o);
+    }
+  return *this;
+}
+
+PacketTagList::~PacketTagList ()
+{
+  RemoveAll ();
+}
+
+uint8_t *
+PacketTagList::GetBuffer (void) const
+{
+  if (m_data != 0)
+    {
+      return m_data->data;
+    }
+  return reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (m_inline));
+}
+
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  if (m_used != 0)
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
+}
+
+void
+PacketTagList::RemoveAll (void)
+{
+  Deallocate (m_data);
+  m_data = 0;
+  m_used = 0;
+}
+
+} // namespace ns3
+
+#endif /* PACKET_TAG_LIST_H */
@@ -0,0 +1,452 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup internet
+ * ns3::PrefixTrie declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief An index of the routes of a routing table by destination prefix.
+ *
+ * The values are stored in a path-compressed binary trie of the prefixes
+ * of N bytes (4 for IPv4, 16 for IPv6) in network byte order.  Match
+ * returns the values of all the prefixes which match an address, in the
+ * order in which they were inserted, so that a routing table which scans
+ * a list of routes in order can scan the matching routes only, with the
+ * same result, in a time which depends on the length of the addresses
+ * rather than on the number of routes.
+ *
+ * A prefix whose mask is not contiguous cannot be stored in the trie;
+ * it is kept in a list which Match scans.
+ *
+ * The trie does not support the removal of a value: the routing tables
+ * Clear it and insert their routes again when one is removed.
+ *
+ * \tparam T \explicit The type of the values.
+ * \tparam N \explicit The number of bytes of the addresses.
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * Insert a value for a prefix.
+   *
+   * \param [in] address The address of the prefix.
+   * \param [in] mask The mask of the prefix.
+   * \param [in] value The value.
+   */
+  void Insert (const uint8_t address[N], const uint8_t mask[N], const T &value);
+
+  /**
+   * Find the values of the prefixes which match an address.
+   *
+   * The values are merged from the nodes of the path of the address,
+   * which are each in the order of insertion, so that the routing tables
+   * can pass the same vector for each lookup without allocating memory.
+   *
+   * \param [in] address The address.
+   * \param [out] values The values, in the order of their insertion.
+   */
+  void Match (const uint8_t address[N], std::vector<T> &values) const;
+
+  /**
+   * Find the value of the longest prefix which matches an address.  The
+   * length of a mask which is not contiguous is the index of the bit
+   * after its last one, as with Ipv4Mask::GetPrefixLength.
+   *
+   * \param [in] address The address.
+   * \param [out] value The first value inserted for the longest prefix.
+   * \returns \c false if no prefix matches the address.
+   */
+  bool MatchLongest (const uint8_t address[N], T &value) const;
+
+  /** Remove all the values. */
+  void Clear (void);
+
+  /** \returns The number of values. */
+  uint32_t GetN (void) const;
+
+private:
+  /** A value and its rank of insertion. */
+  struct Item
+  {
+    uint32_t rank;  //!< The rank of insertion
+    T value;        //!< The value
+  };
+
+  /** A node of the trie: a prefix, its values and its children. */
+  struct Node
+  {
+    uint8_t prefix[N];           //!< The prefix, with zeros after its length
+    uint32_t length;             //!< The length of the prefix in bits
+    std::vector<Item> items;     //!< The values of the prefix
+    Node *children[2];           //!< The children, by the bit after the prefix
+  };
+
+  /** A prefix with a mask which is not contiguous. */
+  struct Irregular
+  {
+    uint8_t address[N];  //!< The address, masked
+    uint8_t mask[N];     //!< The mask
+    uint32_t length;     //!< The index of the bit after the last one of the mask
+    Item item;           //!< The value
+  };
+
+  /**
+   * \param [in] key The key.
+   * \param [in] i The index of a bit.
+   * \returns The bit of the key, from the most significant.
+   */
+  static uint32_t GetBit (const uint8_t key[N], uint32_t i);
+  /**
+   * \param [in] a A key.
+   * \param [in] b Another key.
+   * \param [in] length The maximum length in bits.
+   * \returns The length of the common prefix of the keys, up to a length.
+   */
+  static uint32_t GetCommonLength (const uint8_t a[N], const uint8_t b[N], uint32_t length);
+  /**
+   * Keep the prefix of a key.
+   *
+   * \param [in] key The key.
+   * \param [in] length The length of the prefix in bits.
+   * \param [out] prefix The prefix, with zeros after its length.
+   */
+  static void GetPrefix (const uint8_t key[N], uint32_t length, uint8_t prefix[N]);
+  /**
+   * \param [in] key The key.
+   * \param [in] length The length of the prefix of the key in bits.
+   * \returns A new node for the prefix of a key.
+   */
+  static Node * CreateNode (const uint8_t key[N], uint32_t length);
+  /**
+   * Delete a node and its descendants.
+   *
+   * \param [in] node The node.
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * \param [in] address An address.
+   * \param [in] i The index of an irregular prefix.
+   * \returns The index of the first irregular prefix from \pname{i} which
+   *          matches the address, or the number of irregular prefixes.
+   */
+  uint32_t NextIrregular (const uint8_t address[N], uint32_t i) const;
+
+  Node *m_root;                         //!< The root of the trie
+  std::vector<Irregular> m_irregular;   //!< The prefixes with irregular masks
+  uint32_t m_rank;                      //!< The rank of the next insertion
+};
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+  : m_root (0),
+    m_rank (0)
+{
+}
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  Clear ();
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetBit (const uint8_t key[N], uint32_t i)
+{
+  return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t a[N], const uint8_t b[N], uint32_t length)
+{
+  uint32_t common = 0;
+  for (uint32_t i = 0; i < N && common < length; i++, common += 8)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              common++;
+            }
+          break;
+        }
+    }
+  return std::min (common, length);
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::GetPrefix (const uint8_t key[N], uint32_t length, uint8_t prefix[N])
+{
+  for (uint32_t i = 0; i < N; i++)
+    {
+      uint32_t bits = std::min<uint32_t> (8, length > 8 * i ? length - 8 * i : 0);
+      prefix[i] = key[i] & (0xff00 >> bits);
+    }
+}
+
+template <typename T, uint32_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t key[N], uint32_t length)
+{
+  Node *node = new Node;
+  GetPrefix (key, length, node->prefix);
+  node->length = length;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  return node;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->children[0]);
+      DeleteNode (node->children[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::NextIrregular (const uint8_t address[N], uint32_t i) const
+{
+  for (; i < m_irregular.size (); i++)
+    {
+      bool match = true;
+      for (uint32_t j = 0; j < N && match; j++)
+        {
+          match = (address[j] & m_irregular[i].mask[j]) == m_irregular[i].address[j];
+        }
+      if (match)
+        {
+          break;
+        }
+    }
+  return i;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t address[N], const uint8_t mask[N], const T &value)
+{
+  Item item;
+  item.rank = m_rank++;
+  item.value = value;
+
+  uint8_t ones[N];
+  memset (ones, 0xff, N);
+  uint32_t length = GetCommonLength (mask, ones, 8 * N);
+  uint8_t contiguous[N];
+  GetPrefix (ones, length, contiguous);
+  if (memcmp (contiguous, mask, N) != 0)
+    {
+      Irregular irregular;
+      irregular.length = 0;
+      for (uint32_t i = 0; i < N; i++)
+        {
+          irregular.address[i] = address[i] & mask[i];
+          irregular.mask[i] = mask[i];
+          for (uint32_t bit = 0; bit < 8; bit++)
+            {
+              if (GetBit (mask, 8 * i + bit))
+                {
+                  irregular.length = 8 * i + bit + 1;
+                }
+            }
+        }
+      irregular.item = item;
+      m_irregular.push_back (irregular);
+      return;
+    }
+
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = CreateNode (address, length);
+          node->items.push_back (item);
+          *link = node;
+          return;
+        }
+      uint32_t common = GetCommonLength (node->prefix, address, std::min (node->length, length));
+      if (common == node->length && common == length)
+        {
+          node->items.push_back (item);
+          return;
+        }
+      if (common == node->length)
+        {
+          link = &node->children[GetBit (address, common)];
+          continue;
+        }
+      // the prefix of the node is longer, or diverges: insert a node
+      // above it
+      Node *parent = CreateNode (address, common);
+      parent->children[GetBit (node->prefix, common)] = node;
+      *link = parent;
+      if (common == length)
+        {
+          parent->items.push_back (item);
+        }
+      else
+        {
+          Node *leaf = CreateNode (address, length);
+          leaf->items.push_back (item);
+          parent->children[GetBit (address, common)] = leaf;
+        }
+      return;
+    }
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Match (const uint8_t address[N], std::vector<T> &values) const
+{
+  // the items of the nodes of the path, from the shortest prefix to the
+  // longest one, and the irregular prefixes are each in the order of
+  // insertion: merge them by rank
+  const Item *next[8 * N + 1];
+  const Item *end[8 * N + 1];
+  uint32_t n = 0;
+  Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->prefix, address, node->length) == node->length)
+    {
+      if (!node->items.empty ())
+        {
+          next[n] = &node->items.front ();
+          end[n] = next[n] + node->items.size ();
+          n++;
+        }
+      node = node->length < 8 * N ? node->children[GetBit (address, node->length)] : 0;
+    }
+  uint32_t irregular = NextIrregular (address, 0);
+  values.clear ();
+  while (true)
+    {
+      const Item *first = 0;
+      uint32_t from = n;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          if (next[i] != end[i] && (first == 0 || next[i]->rank < first->rank))
+            {
+              first = next[i];
+              from = i;
+            }
+        }
+      if (irregular < m_irregular.size ()
+          && (first == 0 || m_irregular[irregular].item.rank < first->rank))
+        {
+          first = &m_irregular[irregular].item;
+          from = n;
+        }
+      if (first == 0)
+        {
+          return;
+        }
+      values.push_back (first->value);
+      if (from < n)
+        {
+          next[from]++;
+        }
+      else
+        {
+          irregular = NextIrregular (address, irregular + 1);
+        }
+    }
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::MatchLongest (const uint8_t address[N], T &value) const
+{
+  const Item *best = 0;
+  uint32_t length = 0;
+  Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->prefix, address, node->length) == node->length)
+    {
+      if (!node->items.empty ())
+        {
+          best = &node->items.front ();
+          length = node->length;
+        }
+      node = node->length < 8 * N ? node->children[GetBit (address, node->length)] : 0;
+    }
+  for (uint32_t i = NextIrregular (address, 0); i < m_irregular.size (); i = NextIrregular (address, i + 1))
+    {
+      const Irregular &irregular = m_irregular[i];
+      if (best == 0 || irregular.length > length
+          || (irregular.length == length && irregular.item.rank < best->rank))
+        {
+          best = &irregular.item;
+          length = irregular.length;
+        }
+    }
+  if (best == 0)
+    {
+      return false;
+    }
+  value = best->value;
+  return true;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteNode (m_root);
+  m_root = 0;
+  m_irregular.clear ();
+  m_rank = 0;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetN (void) const
+{
+  return m_rank;
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIZE_CLASS_ALLOCATOR_H
+#define SIZE_CLASS_ALLOCATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SizeClassAllocator template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * Statistics of the free lists of a SizeClassAllocator in a thread.
+ */
+struct SizeClassAllocatorStats
+{
+  /** Number of blocks allocated. */
+  uint64_t allocations;
+  /** Number of blocks allocated from the free lists. */
+  uint64_t hits;
+  /** Number of blocks deallocated. */
+  uint64_t deallocations;
+  /** Number of blocks currently kept in the free lists. */
+  uint64_t cached;
+};
+
+/**
+ * \ingroup core
+ * \brief Per-thread free lists of small blocks, by size class.
+ *
+ * The blocks are rounded up to a multiple of GRANULARITY bytes, and the
+ * free blocks of each size class are kept in a free list of the calling
+ * thread.  A block released by another thread than the one which
+ * allocated it goes to the free list of the releasing thread.  Blocks
+ * larger than the largest size class are not pooled.
+ *
+ * The \pname{Traits} class configures an instance of the allocator:
+ * \code
+ *   struct Traits
+ *   {
+ *     // number of size classes
+ *     static const std::size_t CLASSES = 16;
+ *     // maximum number of free blocks kept in each size class
+ *     static const uint32_t MAX_CACHED = 16384;
+ *     // read once by each thread; false bypasses the free lists
+ *     static bool IsEnabled (void);
+ *   };
+ * \endcode
+ * Each \pname{Traits} class has its own free lists, so it should be
+ * private to the translation unit of its user.
+ *
+ * \tparam Traits \explicit The configuration of the allocator.
+ */
+template <typename Traits>
+class SizeClassAllocator
+{
+public:
+  /** Size granularity of the size classes. */
+  static const std::size_t GRANULARITY = 16;
+
+  /**
+   * Allocate a block, from the free list of its size class if possible.
+   *
+   * \param [in] size The size of the block.
+   * \returns The block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release a block to the free list of its size class.
+   *
+   * \param [in] p The block.
+   * \param [in] size The size of the block, as passed to Allocate.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the usable size of the blocks allocated for a given size.
+   *
+   * \param [in] size The requested size.
+   * \returns The size of the block which Allocate returns for \pname{size}.
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+  /**
+   * \returns The allocation statistics of the calling thread.
+   */
+  static SizeClassAllocatorStats GetStats (void);
+  /** Reset the allocation statistics of the calling thread. */
+  static void ResetStats (void);
+
+private:
+  /** A free block. */
+  struct Block
+  {
+    /** The next free block of the size class. */
+    Block *next;
+  };
+
+  /** The free lists of a thread. */
+  class FreeLists
+  {
+  public:
+    /** Constructor. */
+    FreeLists ();
+    /** Destructor, releases the free blocks. */
+    ~FreeLists ();
+    /** \returns \c true if the free lists are enabled. */
+    bool IsEnabled (void);
+
+    /** The free blocks of each size class. */
+    Block *m_free[Traits::CLASSES];
+    /** The number of free blocks of each size class. */
+    uint32_t m_nFree[Traits::CLASSES];
+    /** The statistics. */
+    SizeClassAllocatorStats m_stats;
+    /** Whether Traits::IsEnabled was called. */
+    bool m_initialized;
+    /** The value returned by Traits::IsEnabled. */
+    bool m_enabled;
+  };
+
+  /** The free lists of the calling thread. */
+  static thread_local FreeLists g_freeLists;
+  /**
+   * Set when the free lists of the calling thread are destroyed, at the
+   * thread exit.  Being trivially destructible, it can still be read by
+   * the blocks released later, for example by the destructor of a static
+   * object, which then go back to operator delete.
+   */
+  static thread_local bool g_destroyed;
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename Traits>
+thread_local typename SizeClassAllocator<Traits>::FreeLists SizeClassAllocator<Traits>::g_freeLists;
+
+template <typename Traits>
+thread_local bool SizeClassAllocator<Traits>::g_destroyed = false;
+
+template <typename Traits>
+SizeClassAllocator<Traits>::FreeLists::FreeLists ()
+  : m_initialized (false),
+    m_enabled (false)
+{
+  m_stats.allocations = 0;
+  m_stats.hits = 0;
+  m_stats.deallocations = 0;
+  m_stats.cached = 0;
+  for (std::size_t i = 0; i < Traits::CLASSES; ++i)
+    {
+      m_free[i] = 0;
+      m_nFree[i] = 0;
+    }
+}
+
+template <typename Traits>
+SizeClassAllocator<Traits>::FreeLists::~FreeLists ()
+{
+  g_destroyed = true;
+  for (std::size_t i = 0; i < Traits::CLASSES; ++i)
+    {
+      while (m_free[i] != 0)
+        {
+          Block *block = m_free[i];
+          m_free[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+}
+
+template <typename Traits>
+bool
+SizeClassAllocator<Traits>::FreeLists::IsEnabled (void)
+{
+  if (!m_initialized)
+    {
+      m_enabled = Traits::IsEnabled ();
+      m_initialized = true;
+    }
+  return m_enabled;
+}
+
+template <typename Traits>
+void *
+SizeClassAllocator<Traits>::Allocate (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (g_destroyed)
+    {
+      return ::operator new (sizeClass < Traits::CLASSES ? (sizeClass + 1) * GRANULARITY : size);
+    }
+  FreeLists &lists = g_freeLists;
+  lists.m_stats.allocations++;
+  if (sizeClass < Traits::CLASSES && lists.IsEnabled ())
+    {
+      Block *block = lists.m_free[sizeClass];
+      if (block != 0)
+        {
+          lists.m_free[sizeClass] = block->next;
+          lists.m_nFree[sizeClass]--;
+          lists.m_stats.cached--;
+          lists.m_stats.hits++;
+          return block;
+        }
+    }
+  if (sizeClass < Traits::CLASSES)
+    {
+      // blocks are allocated with the largest size of their class, even
+      // if the free lists are disabled, so any block can be put in a free list.
+      return ::operator new ((sizeClass + 1) * GRANULARITY);
+    }
+  return ::operator new (size);
+}
+
+template <typename Traits>
+void
+SizeClassAllocator<Traits>::Deallocate (void *p, std::size_t size)
+{
+  if (g_destroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeLists &lists = g_freeLists;
+  lists.m_stats.deallocations++;
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  // the block may have been allocated by another thread
+  if (sizeClass < Traits::CLASSES && lists.IsEnabled ()
+      && lists.m_nFree[sizeClass] < Traits::MAX_CACHED)
+    {
+      Block *block = static_cast<Block *> (p);
+      block->next = lists.m_free[sizeClass];
+      lists.m_free[sizeClass] = block;
+      lists.m_nFree[sizeClass]++;
+      lists.m_stats.cached++;
+      return;
+    }
+  ::operator delete (p);
+}
+
+template <typename Traits>
+std::size_t
+SizeClassAllocator<Traits>::GetBlockSize (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (sizeClass < Traits::CLASSES)
+    {
+      return (sizeClass + 1) * GRANULARITY;
+    }
+  return size;
+}
+
+template <typename Traits>
+SizeClassAllocatorStats
+SizeClassAllocator<Traits>::GetStats (void)
+{
+  if (g_destroyed)
+    {
+      return SizeClassAllocatorStats ();
+    }
+  return g_freeLists.m_stats;
+}
+
+template <typename Traits>
+void
+SizeClassAllocator<Traits>::ResetStats (void)
+{
+  if (g_destroyed)
+    {
+      return;
+    }
+  SizeClassAllocatorStats &stats = g_freeLists.m_stats;
+  stats.allocations = 0;
+  stats.hits = 0;
+  stats.deallocations = 0;
+}
+
+} // namespace ns3
+
+#endif /* SIZE_CLASS_ALLOCATOR_H */
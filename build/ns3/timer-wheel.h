@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "scheduler.h"
+#include "ptr.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup timer
+ * \brief A hierarchical timer wheel holding the timers of a simulator.
+ *
+ * Protocol timers (retransmission, delayed acknowledgment, ...) are
+ * mostly cancelled before they expire.  The simulator keeps the events
+ * scheduled with Simulator::ScheduleTimer in this wheel rather than in
+ * its Scheduler, until the time comes to run them: a cancelled timer is
+ * then removed from its slot in constant time, as its EventImpl records
+ * its index in the slot, and never reaches the Scheduler.
+ *
+ * Time is divided in ticks of the wheel resolution.  The wheel has six
+ * levels of 64 slots: the slots of level \c l span 64^l ticks, and a
+ * timer is kept at the lowest level whose slots separate it from the
+ * current tick.  When the current tick reaches a slot of a higher level,
+ * its timers are spread over the lower levels.  The timers of the
+ * current tick are moved, with their original EventKey, to the
+ * Scheduler, so they run at the exact same time and in the same order
+ * as if they had been inserted in the Scheduler when they were
+ * scheduled.
+ */
+class TimerWheel
+{
+public:
+  /** Constructor. */
+  TimerWheel ();
+  /** Destructor. */
+  ~TimerWheel ();
+
+  /**
+   * Set the duration of a tick.  This can only be called while
+   * the wheel is empty.
+   *
+   * \param [in] resolution The duration of a tick, in time steps,
+   *             or 0 to disable the wheel.
+   */
+  void SetResolution (uint64_t resolution);
+  /** \returns The duration of a tick, in time steps. */
+  uint64_t GetResolution (void) const;
+  /** \returns \c true if the wheel holds no timer. */
+  bool IsEmpty (void) const;
+  /**
+   * Insert a timer.
+   *
+   * \param [in] ev The timer event.
+   * \param [in] now The current time.
+   * \returns \c false if the timer expires during the current tick, in
+   *          which case it must be inserted in the Scheduler instead.
+   */
+  bool Insert (const Scheduler::Event &ev, uint64_t now);
+  /**
+   * Remove a timer.
+   *
+   * \param [in] ev The timer event.
+   * \returns \c false if the event is not in the wheel.
+   */
+  bool Remove (const Scheduler::Event &ev);
+  /**
+   * \returns The time at which the wheel must be advanced: the
+   *          Scheduler can run all the events before this time.
+   */
+  uint64_t GetNextTs (void) const;
+  /**
+   * Advance the current tick to the next one holding timers, and move
+   * the timers of this tick to the Scheduler.
+   *
+   * \param [in] scheduler The Scheduler to move the timers to.
+   */
+  void Advance (Ptr<Scheduler> scheduler);
+
+private:
+  /** Slot type: a contiguous array of Events. */
+  typedef std::vector<Scheduler::Event> Slot;
+
+  /**
+   * Append a timer to a slot.
+   *
+   * \param [in] slot The slot.
+   * \param [in] ev The timer event.
+   */
+  static void Append (Slot &slot, const Scheduler::Event &ev);
+
+  /** Number of bits of the index of a slot in a level. */
+  static const uint32_t BITS = 6;
+  /** Number of slots of a level. */
+  static const uint32_t SLOTS = 1 << BITS;
+  /** Number of levels. */
+  static const uint32_t LEVELS = 6;
+
+  /**
+   * Find the slot of a timer.
+   *
+   * \param [in] tick The timer tick, after the current tick.
+   * \param [out] level The level of the slot, or LEVELS if the timer
+   *              is too far in the future and belongs to the overflow.
+   * \returns The index of the slot in the level.
+   */
+  uint32_t Locate (uint64_t tick, uint32_t &level) const;
+  /**
+   * Insert a timer in its slot.
+   *
+   * \param [in] ev The timer event.
+   * \param [in] tick The timer tick, after the current tick.
+   */
+  void Place (const Scheduler::Event &ev, uint64_t tick);
+  /** \returns The next tick at which the wheel must be advanced. */
+  uint64_t GetNextTick (void) const;
+
+  /** The slots of each level. */
+  Slot m_slots[LEVELS][SLOTS];
+  /** The non-empty slots of each level. */
+  uint64_t m_bitmap[LEVELS];
+  /** The timers beyond the last level. */
+  Slot m_overflow;
+  /** Smallest tick of the timers in the overflow. */
+  uint64_t m_overflowMin;
+  /** The current tick: all the timers up to this tick have been moved. */
+  uint64_t m_cursor;
+  /** The duration of a tick. */
+  uint64_t m_resolution;
+  /** Number of timers in the wheel. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -9,6 +9,7 @@
 # See test.py for more information.
 cpp_examples = [
     ("star", "True", "True"),
+    ("tcp-checkpoint-sweep", "True", "False"),
     ("tcp-large-transfer", "True", "True"),
     ("tcp-nsc-lfn", "NSC_ENABLED == True", "False"),
     ("tcp-nsc-zoo", "NSC_ENABLED == True", "False"),
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+//       n0 ----------- n1
+//            1 Mbps
+//             5 ms
+//
+// - Flow from n0 to n1 using BulkSendApplication.
+// - After a warm-up, the simulation is forked with Checkpoint::Fork into
+//   one branch per point of a sweep of the link data rate, and each
+//   branch reports the throughput after the warm-up.
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/network-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpCheckpointSweepExample");
+
+/// The sink application.
+static Ptr<PacketSink> g_sink;
+/// The bytes received during the warm-up.
+static uint64_t g_warmupRx = 0;
+
+/**
+ * Fork one branch per data rate, and set the data rate of the branch.
+ *
+ * \param [in] branches The number of branches.
+ * \param [in] step The data rate increment between the branches.
+ */
+static void
+Sweep (uint32_t branches, DataRate step)
+{
+  g_warmupRx = g_sink->GetTotalRx ();
+  uint32_t branch = Checkpoint::Fork (branches);
+  DataRate rate (step.GetBitRate () * (branch + 1));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/DataRate",
+               DataRateValue (rate));
+  NS_LOG_INFO ("branch " << branch << " continues at " << rate);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t branches = 4;
+  Time warmup = Seconds (5);
+  Time duration = Seconds (10);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("branches", "Number of points of the sweep", branches);
+  cmd.AddValue ("warmup", "Duration of the warm-up", warmup);
+  cmd.AddValue ("duration", "Duration of the simulation after the warm-up", duration);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("1Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer devices = pointToPoint.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (i.GetAddress (1), port));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (0.0));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (1));
+  sinkApps.Start (Seconds (0.0));
+  g_sink = DynamicCast<PacketSink> (sinkApps.Get (0));
+
+  Simulator::Schedule (warmup, &Sweep, branches, DataRate ("1Mbps"));
+  Simulator::Stop (warmup + duration);
+  Simulator::Run ();
+
+  uint64_t rx = g_sink->GetTotalRx () - g_warmupRx;
+  std::cout << "Branch " << Checkpoint::GetBranch () << ": "
+            << rx * 8 / duration.GetSeconds () / 1e6 << " Mbps" << std::endl;
+  g_sink = 0;
+  Simulator::Destroy ();
+
+  if (Checkpoint::GetBranch () != 0)
+    {
+      return 0;
+    }
+  return Checkpoint::Wait () == 0 ? 0 : 1;
+}
@@ -187,7 +187,7 @@ CalendarScheduler::PeekNext (void) const
   Scheduler::Event minEvent;
   minEvent.impl = 0;
   minEvent.key.m_ts = UINT64_MAX;
-  minEvent.key.m_uid = UINT32_MAX;
+  minEvent.key.m_uid = UINT64_MAX;
   minEvent.key.m_context = 0;
   do
     {
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "abort.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace {
+
+/** \ingroup simulator The branch of this process. */
+uint32_t g_branch = 0;
+/** \ingroup simulator The processes of the branches forked by this process. */
+std::vector<pid_t> g_children;
+
+}  // unnamed namespace
+
+uint32_t
+Checkpoint::Fork (uint32_t branches)
+{
+  NS_LOG_FUNCTION (branches);
+  NS_ABORT_MSG_IF (g_branch != 0, "Only the original process can fork");
+  NS_ABORT_MSG_IF (branches == 0, "No branch");
+
+  // do not let the branches flush the buffered output again
+  std::cout.flush ();
+  std::clog.flush ();
+  std::fflush (NULL);
+
+  for (uint32_t i = 1; i < branches; ++i)
+    {
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "fork() failed: " << std::strerror (errno));
+      if (pid == 0)
+        {
+          g_branch = i;
+          g_children.clear ();
+          NS_LOG_LOGIC ("branch " << i << " in process " << getpid ());
+          return i;
+        }
+      g_children.push_back (pid);
+    }
+  return 0;
+}
+
+uint32_t
+Checkpoint::GetBranch (void)
+{
+  return g_branch;
+}
+
+uint32_t
+Checkpoint::Wait (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t failures = 0;
+  for (std::vector<pid_t>::const_iterator i = g_children.begin (); i != g_children.end (); ++i)
+    {
+      int status;
+      pid_t pid;
+      do
+        {
+          pid = waitpid (*i, &status, 0);
+        }
+      while (pid < 0 && errno == EINTR);
+      if (pid < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_LOGIC ("process " << *i << " failed");
+          failures++;
+        }
+    }
+  g_children.clear ();
+  return failures;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Fork a warm simulation into several branches.
+ *
+ * A parameter sweep often repeats the same warm-up for every point of
+ * the sweep.  Fork() checkpoints the whole simulation at the end of the
+ * warm-up, that is, the pending events, the nodes, devices and sockets,
+ * and the position of every random variable stream, and restores it in
+ * as many processes as there are points in the sweep.  Each branch then
+ * changes its parameters and continues the simulation on its own:
+ *
+ * \code
+ *   void
+ *   Sweep (void)
+ *   {
+ *     uint32_t branch = Checkpoint::Fork (4);
+ *     Config::Set ("/NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/DataRate",
+ *                  DataRateValue (DataRate ((branch + 1) * 1000000)));
+ *   }
+ *
+ *   Simulator::Schedule (warmup, &Sweep);
+ *   Simulator::Run ();
+ *   // report the results of this branch
+ *   Simulator::Destroy ();
+ *   if (Checkpoint::GetBranch () != 0)
+ *     {
+ *       return 0;
+ *     }
+ *   Checkpoint::Wait ();
+ * \endcode
+ *
+ * The checkpoint is the memory image of the process: it is taken with
+ * fork(2), so it costs only the pages which the branches later modify,
+ * and it captures the state of all the modules without requiring them
+ * to be serializable.  The simulation must run in a single thread,
+ * as the other threads are not copied into the branches.  The files
+ * opened before the checkpoint, including the trace files, are shared
+ * by the branches, which should write their results to their own files.
+ */
+class Checkpoint
+{
+public:
+  /**
+   * Fork the simulation into several branches.
+   *
+   * This can be called before Simulator::Run, or by an event.  Only the
+   * original process can fork.
+   *
+   * \param [in] branches The number of branches, including the original
+   *             process.
+   * \returns The index of the branch of the calling process: 0 in the
+   *          original process, and from 1 to \c branches - 1 in the new
+   *          processes.
+   */
+  static uint32_t Fork (uint32_t branches);
+  /**
+   * \returns The index of the branch of this process, 0 in the original
+   *          process.
+   */
+  static uint32_t GetBranch (void);
+  /**
+   * Wait for the end of the branches forked by this process.
+   *
+   * \returns The number of branches which did not exit successfully.
+   */
+  static uint32_t Wait (void);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -19,6 +19,7 @@
  */
 #include "config.h"
 #include "singleton.h"
+#include "ensemble-runner.h"
 #include "object.h"
 #include "global-value.h"
 #include "object-ptr-container.h"
@@ -617,6 +618,15 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
 class ConfigImpl : public Singleton<ConfigImpl>
 {
 public:
+  /**
+   * Get the Config of the calling thread: the threads which run the
+   * replications of an EnsembleRunner each have their own root
+   * namespace objects.
+   *
+   * \returns The ConfigImpl instance.
+   */
+  static ConfigImpl * Get (void);
+
   // Keep Set and SetFailSafe since their errors are triggered
   // by the underlying ObjecBase functions.
   /** \copydoc Config::Set() */
@@ -662,6 +672,17 @@ private:
 
 };  // class ConfigImpl
 
+ConfigImpl *
+ConfigImpl::Get (void)
+{
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      static thread_local ConfigImpl replicationConfig;
+      return &replicationConfig;
+    }
+  return Singleton<ConfigImpl>::Get ();
+}
+
 void
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
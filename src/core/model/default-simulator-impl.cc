@@ -27,8 +27,15 @@
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "abort.h"
+#include "trace-source-accessor.h"
+#include "nstime.h"
+#include "boolean.h"
+#include "string.h"
 
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -53,6 +60,37 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddTraceSource ("EventsWithContextDrained",
+                     "The number of events scheduled by other threads "
+                     "moved at once to the event queue.",
+                     MakeTraceSourceAccessor (&DefaultSimulatorImpl::m_eventsWithContextDrained),
+                     "ns3::DefaultSimulatorImpl::DrainTracedCallback")
+    .AddAttribute ("TimerWheelResolution",
+                   "The duration of a tick of the wheel holding the events "
+                   "scheduled with Simulator::ScheduleTimer, or zero to keep "
+                   "them in the event queue.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&DefaultSimulatorImpl::SetTimerWheelResolution,
+                                     &DefaultSimulatorImpl::GetTimerWheelResolution),
+                   MakeTimeChecker (TimeStep (0)))
+    .AddAttribute ("EventProfile",
+                   "Measure the wall-clock time spent in each callback, "
+                   "TypeId and context, and report it at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EventProfileReport",
+                   "The file to write the event profile report to, "
+                   "or empty to write it to the standard error.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileReport),
+                   MakeStringChecker ())
+    .AddAttribute ("EventProfileCollapsedStacks",
+                   "The file to write the event profile to, as collapsed "
+                   "stacks for a flame graph, or empty for none.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileCollapsedStacks),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -72,7 +110,10 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
+  m_profile = false;
+  m_eventsWithContextStub.next.store (0, std::memory_order_relaxed);
+  m_eventsWithContextHead.store (&m_eventsWithContextStub, std::memory_order_relaxed);
+  m_eventsWithContextTail = &m_eventsWithContextStub;
   m_main = SystemThread::Self ();
 }
 
@@ -87,6 +128,10 @@ DefaultSimulatorImpl::DoDispose (void)
   NS_LOG_FUNCTION (this);
   ProcessEventsWithContext ();
 
+  while (!m_timers.IsEmpty ())
+    {
+      m_timers.Advance (m_events);
+    }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -109,6 +154,33 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profile)
+    {
+      WriteEventProfile ();
+    }
+}
+
+void
+DefaultSimulatorImpl::WriteEventProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_profileReport.empty ())
+    {
+      m_profiler.Report (std::clog);
+    }
+  else
+    {
+      std::ofstream os (m_profileReport.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << m_profileReport);
+      m_profiler.Report (os);
+    }
+  if (!m_profileCollapsedStacks.empty ())
+    {
+      std::ofstream os (m_profileCollapsedStacks.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << m_profileCollapsedStacks);
+      m_profiler.WriteCollapsedStacks (os);
+    }
+  m_profiler.Clear ();
 }
 
 void
@@ -135,9 +207,35 @@ DefaultSimulatorImpl::GetSystemId (void) const
   return 0;
 }
 
+void
+DefaultSimulatorImpl::SetTimerWheelResolution (Time resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  m_timers.SetResolution (resolution.GetTimeStep ());
+}
+
+Time
+DefaultSimulatorImpl::GetTimerWheelResolution (void) const
+{
+  return TimeStep (m_timers.GetResolution ());
+}
+
+void
+DefaultSimulatorImpl::AdvanceTimers (void)
+{
+  // move the timers to the event queue before any later event runs
+  while (!m_timers.IsEmpty ()
+         && (m_events->IsEmpty ()
+             || m_timers.GetNextTs () <= m_events->PeekNext ().key.m_ts))
+    {
+      m_timers.Advance (m_events);
+    }
+}
+
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
+  AdvanceTimers ();
   Scheduler::Event next = m_events->RemoveNext ();
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
@@ -148,7 +246,14 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profile)
+    {
+      m_profiler.Invoke (next.impl, next.key.m_context);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -157,36 +262,78 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 bool
 DefaultSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  return (m_events->IsEmpty () && m_timers.IsEmpty ()) || m_stop;
 }
 
 void
-DefaultSimulatorImpl::ProcessEventsWithContext (void)
+DefaultSimulatorImpl::PushEventWithContext (struct EventWithContext *node)
+{
+  node->next.store (0, std::memory_order_relaxed);
+  struct EventWithContext *previous =
+    m_eventsWithContextHead.exchange (node, std::memory_order_acq_rel);
+  // Between the exchange and this store the consumer cannot see the
+  // new node yet, and stops at the previous one.
+  previous->next.store (node, std::memory_order_release);
+}
+
+struct DefaultSimulatorImpl::EventWithContext *
+DefaultSimulatorImpl::PopEventWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  struct EventWithContext *tail = m_eventsWithContextTail;
+  struct EventWithContext *next = tail->next.load (std::memory_order_acquire);
+  if (tail == &m_eventsWithContextStub)
     {
-      return;
+      if (next == 0)
+        {
+          return 0;
+        }
+      // skip the stub
+      m_eventsWithContextTail = next;
+      tail = next;
+      next = next->next.load (std::memory_order_acquire);
+    }
+  if (next != 0)
+    {
+      m_eventsWithContextTail = next;
+      return tail;
     }
+  if (tail != m_eventsWithContextHead.load (std::memory_order_acquire))
+    {
+      // a producer is linking a new node after tail: retry later.
+      return 0;
+    }
+  // tail is the last node: put the stub back behind it to release it.
+  PushEventWithContext (&m_eventsWithContextStub);
+  next = tail->next.load (std::memory_order_acquire);
+  if (next != 0)
+    {
+      m_eventsWithContextTail = next;
+      return tail;
+    }
+  return 0;
+}
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap (eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+void
+DefaultSimulatorImpl::ProcessEventsWithContext (void)
+{
+  uint32_t count = 0;
+  struct EventWithContext *event;
+  while ((event = PopEventWithContext ()) != 0)
     {
-      EventWithContext event = eventsWithContext.front ();
-      eventsWithContext.pop_front ();
       Scheduler::Event ev;
-      ev.impl = event.event;
-      ev.key.m_ts = m_currentTs + event.timestamp;
-      ev.key.m_context = event.context;
+      ev.impl = event->event;
+      ev.key.m_ts = m_currentTs + event->timestamp;
+      ev.key.m_context = event->context;
       ev.key.m_uid = m_uid;
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      delete event;
+      count++;
+    }
+  if (count > 0)
+    {
+      m_eventsWithContextDrained (count);
     }
 }
 
@@ -199,14 +346,14 @@ DefaultSimulatorImpl::Run (void)
   ProcessEventsWithContext ();
   m_stop = false;
 
-  while (!m_events->IsEmpty () && !m_stop)
+  while ((!m_events->IsEmpty () || !m_timers.IsEmpty ()) && !m_stop)
     {
       ProcessOneEvent ();
     }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!m_events->IsEmpty () || !m_timers.IsEmpty () || m_unscheduledEvents == 0);
 }
 
 void
@@ -246,6 +393,29 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
+EventId
+DefaultSimulatorImpl::ScheduleTimer (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleTimer Thread-unsafe invocation!");
+
+  NS_ASSERT_MSG (delay.IsPositive (), "DefaultSimulatorImpl::ScheduleTimer(): Negative delay");
+  Time tAbsolute = delay + TimeStep (m_currentTs);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = GetContext ();
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  if (!m_timers.Insert (ev, m_currentTs))
+    {
+      m_events->Insert (ev);
+    }
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
 void
 DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
 {
@@ -265,16 +435,12 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      struct EventWithContext *ev = new EventWithContext;
+      ev->context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back (ev);
-        m_eventsWithContextEmpty = false;
-      }
+      ev->timestamp = delay.GetTimeStep ();
+      ev->event = event;
+      PushEventWithContext (ev);
     }
 }
 
@@ -350,7 +516,10 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_ts = id.GetTs ();
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
-  m_events->Remove (event);
+  if (!m_timers.Remove (event))
+    {
+      m_events->Remove (event);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -364,6 +533,17 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+      // a cancelled timer does not need to reach the event queue
+      if (m_timers.Remove (event))
+        {
+          event.impl->Unref ();
+          m_unscheduledEvents--;
+        }
     }
 }
 
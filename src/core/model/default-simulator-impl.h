@@ -25,11 +25,15 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "system-mutex.h"
+#include "traced-callback.h"
+#include "timer-wheel.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -43,6 +47,15 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the \c EventProfile attribute is set, the wall-clock time of the
+ * events is attributed by an EventProfiler to their callback, TypeId
+ * and context, and reported at Simulator::Destroy.  For example:
+ * \code
+ *   ./waf --run "first --ns3::DefaultSimulatorImpl::EventProfile=true
+ *                      --ns3::DefaultSimulatorImpl::EventProfileCollapsedStacks=first.folded"
+ *   flamegraph.pl first.folded > first.svg
+ * \endcode
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -64,6 +77,7 @@ public:
   virtual void Stop (void);
   virtual void Stop (const Time &delay);
   virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual EventId ScheduleTimer (const Time &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
@@ -79,15 +93,40 @@ public:
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
 
+  /**
+   * TracedCallback signature for the events received from other threads.
+   *
+   * \param [in] count The number of events moved to the event queue
+   *                   by one call to ProcessEventsWithContext.
+   */
+  typedef void (* DrainTracedCallback)(uint32_t count);
+
 private:
   virtual void DoDispose (void);
 
+  /**
+   * Set the duration of a tick of the timer wheel.
+   *
+   * \param [in] resolution The duration of a tick, or zero to disable
+   *             the timer wheel.
+   */
+  void SetTimerWheelResolution (Time resolution);
+  /** \returns The duration of a tick of the timer wheel. */
+  Time GetTimerWheelResolution (void) const;
+  /** Move the timers which may run before the next event to the event queue. */
+  void AdvanceTimers (void);
+  /** Report the event profile, and forget it. */
+  void WriteEventProfile (void);
   /** Process the next event. */
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
 
-  /** Wrap an event with its execution context. */
+  /**
+   * Wrap an event with its execution context.
+   *
+   * This is also a node of the queue of events from other threads.
+   */
   struct EventWithContext
   {
     /** The event context. */
@@ -96,18 +135,40 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The next (more recent) node of the queue. */
+    std::atomic<struct EventWithContext *> next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * Append a node to the queue of events from other threads.
+   *
+   * This is wait-free and can be called concurrently by any thread.
+   *
+   * \param [in] node The node to append.
+   */
+  void PushEventWithContext (struct EventWithContext *node);
+  /**
+   * Remove the oldest node of the queue of events from other threads.
+   *
+   * This can only be called by the main thread.
+   *
+   * \returns The oldest node, or 0 if the queue is empty or if the
+   *          next node is still being appended by another thread.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  struct EventWithContext * PopEventWithContext (void);
+
+  /**
+   * The queue of events from other threads is an intrusive
+   * multiple-producer single-consumer linked list: producers exchange
+   * the head and link the previous head to their node, the main thread
+   * consumes from the tail.  The stub node keeps the list non-empty.
+   */
+  std::atomic<struct EventWithContext *> m_eventsWithContextHead;
+  /** The oldest node of the queue, only accessed by the main thread. */
+  struct EventWithContext *m_eventsWithContextTail;
+  /** The stub node of the queue. */
+  struct EventWithContext m_eventsWithContextStub;
+  /** Trace of the number of events received in each batch. */
+  TracedCallback<uint32_t> m_eventsWithContextDrained;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -117,11 +178,13 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The events scheduled with ScheduleTimer, until they are due. */
+  TimerWheel m_timers;
 
   /** Next event unique id. */
-  uint32_t m_uid;
+  uint64_t m_uid;
   /** Unique id of the current event. */
-  uint32_t m_currentUid;
+  uint64_t m_currentUid;
   /** Timestamp of the current event. */
   uint64_t m_currentTs;
   /** Execution context of the current event. */
@@ -134,6 +197,15 @@ private:
    */
   int m_unscheduledEvents;
 
+  /** Whether to profile the events. */
+  bool m_profile;
+  /** The event profile. */
+  EventProfiler m_profiler;
+  /** The file to write the event profile report to. */
+  std::string m_profileReport;
+  /** The file to write the event profile collapsed stacks to. */
+  std::string m_profileCollapsedStacks;
+
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
 };
@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ensemble-runner.h"
+#include "simulator.h"
+#include "rng-seed-manager.h"
+#include "names.h"
+#include "assert.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "system-thread.h"
+#include "ptr.h"
+#include <thread>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EnsembleRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EnsembleRunner");
+
+thread_local bool EnsembleRunner::g_replicationThread = false;
+
+EnsembleRunner::EnsembleRunner ()
+  : m_threadCount (0),
+    m_hasFirstRun (false),
+    m_firstRun (0),
+    m_next (0),
+    m_seed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EnsembleRunner::SetThreadCount (uint32_t threads)
+{
+  NS_LOG_FUNCTION (this << threads);
+  m_threadCount = threads;
+}
+
+uint32_t
+EnsembleRunner::GetThreadCount (void) const
+{
+  NS_LOG_FUNCTION (this);
+#if defined (HAVE_PTHREAD_H) && (defined (NS3_MTP) || defined (NS3_ENSEMBLE))
+  if (m_threadCount != 0)
+    {
+      return m_threadCount;
+    }
+  return std::max (1U, std::thread::hardware_concurrency ());
+#else
+  return 1;
+#endif
+}
+
+void
+EnsembleRunner::SetFirstRun (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+  m_hasFirstRun = true;
+  m_firstRun = run;
+}
+
+void
+EnsembleRunner::Run (Replication replication, uint32_t count)
+{
+  NS_LOG_FUNCTION (this << count);
+  NS_ASSERT_MSG (!g_replicationThread, "EnsembleRunner::Run called by a replication");
+
+  m_replication = replication;
+  m_seed = RngSeedManager::GetSeed ();
+  if (!m_hasFirstRun)
+    {
+      m_firstRun = RngSeedManager::GetRun ();
+    }
+  m_results.clear ();
+  m_results.resize (count);
+  m_next = 0;
+
+#ifdef HAVE_PTHREAD_H
+  uint32_t threads = std::min (GetThreadCount (), count);
+  NS_LOG_LOGIC ("running " << count << " replications in " << threads << " threads");
+  std::vector<Ptr<SystemThread> > pool;
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&EnsembleRunner::RunWorker, this));
+      thread->Start ();
+      pool.push_back (thread);
+    }
+  for (std::vector<Ptr<SystemThread> >::iterator i = pool.begin (); i != pool.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+#else
+  RunWorker (this);
+#endif
+  m_replication = Replication ();
+}
+
+void
+EnsembleRunner::RunWorker (EnsembleRunner *self)
+{
+  NS_LOG_FUNCTION (self);
+  for (uint32_t i = self->m_next++; i < self->m_results.size (); i = self->m_next++)
+    {
+#ifdef HAVE_PTHREAD_H
+      // Every replication starts in a new thread, with fresh thread_local
+      // free lists and counters, as if it were the first simulation of
+      // the program.
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&EnsembleRunner::RunReplication, self, i));
+      thread->Start ();
+      thread->Join ();
+#else
+      RunReplication (self, i);
+#endif
+    }
+}
+
+void
+EnsembleRunner::RunReplication (EnsembleRunner *self, uint32_t i)
+{
+  NS_LOG_FUNCTION (self << i);
+  bool wasReplicationThread = g_replicationThread;
+  g_replicationThread = true;
+  self->DoRunReplication (i);
+  g_replicationThread = wasReplicationThread;
+}
+
+void
+EnsembleRunner::DoRunReplication (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  RngSeedManager::SetSeed (m_seed);
+  RngSeedManager::SetRun (GetRun (i));
+  RngSeedManager::ResetNextStreamIndex ();
+
+  m_results[i] = m_replication (GetRun (i));
+
+  // Leave the singletons of this thread clean for its next replication.
+  Simulator::Destroy ();
+  Names::Clear ();
+}
+
+uint32_t
+EnsembleRunner::GetN (void) const
+{
+  return m_results.size ();
+}
+
+uint64_t
+EnsembleRunner::GetRun (uint32_t i) const
+{
+  return m_firstRun + i;
+}
+
+const EnsembleRunner::Results &
+EnsembleRunner::GetResults (uint32_t i) const
+{
+  NS_ASSERT (i < m_results.size ());
+  return m_results[i];
+}
+
+EnsembleRunner::Summary
+EnsembleRunner::GetSummary (std::string metric) const
+{
+  NS_LOG_FUNCTION (this << metric);
+  Summary summary;
+  summary.count = 0;
+  summary.mean = 0;
+  summary.stddev = 0;
+  summary.min = 0;
+  summary.max = 0;
+  // Welford's algorithm, in the order of the replications, so that
+  // the summary does not depend on the order of completion.
+  double m2 = 0;
+  for (std::vector<Results>::const_iterator i = m_results.begin (); i != m_results.end (); ++i)
+    {
+      Results::const_iterator j = i->find (metric);
+      if (j == i->end ())
+        {
+          continue;
+        }
+      double value = j->second;
+      summary.count++;
+      if (summary.count == 1)
+        {
+          summary.min = value;
+          summary.max = value;
+        }
+      summary.min = std::min (summary.min, value);
+      summary.max = std::max (summary.max, value);
+      double delta = value - summary.mean;
+      summary.mean += delta / summary.count;
+      m2 += delta * (value - summary.mean);
+    }
+  if (summary.count > 1)
+    {
+      summary.stddev = std::sqrt (m2 / (summary.count - 1));
+    }
+  return summary;
+}
+
+void
+EnsembleRunner::PrintSummary (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  std::set<std::string> metrics;
+  for (std::vector<Results>::const_iterator i = m_results.begin (); i != m_results.end (); ++i)
+    {
+      for (Results::const_iterator j = i->begin (); j != i->end (); ++j)
+        {
+          metrics.insert (j->first);
+        }
+    }
+  for (std::set<std::string>::const_iterator i = metrics.begin (); i != metrics.end (); ++i)
+    {
+      Summary summary = GetSummary (*i);
+      os << *i
+         << " count=" << summary.count
+         << " mean=" << summary.mean
+         << " stddev=" << summary.stddev
+         << " min=" << summary.min
+         << " max=" << summary.max
+         << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ENSEMBLE_RUNNER_H
+#define ENSEMBLE_RUNNER_H
+
+#include "callback.h"
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EnsembleRunner declaration.
+ */
+
+/**
+ * \ingroup simulator
+ * Storage class of the static variables which are only a cache or a
+ * scratch area of the calling thread, such as a reused ObjectFactory.
+ * With --enable-ensemble or --enable-mtp, the simulations of the
+ * replications of an EnsembleRunner, or the partitions of a simulation,
+ * run concurrently in several threads, and these variables are
+ * thread_local.
+ */
+#if defined (NS3_ENSEMBLE) || defined (NS3_MTP)
+#define NS_ENSEMBLE_THREAD_LOCAL thread_local
+#else
+#define NS_ENSEMBLE_THREAD_LOCAL
+#endif
+
+/**
+ * \ingroup simulator
+ * Type of the static variables which hold the state of one simulation
+ * rather than of the process, such as the counters used to allocate
+ * addresses and identifiers.  With --enable-ensemble, the replications
+ * of an EnsembleRunner run concurrently in their own threads, and these
+ * variables are thread_local.  With --enable-mtp, the partitions of a
+ * simulation, which run concurrently, share them, and they are
+ * std::atomic.
+ *
+ * \param [in] type The type of the variable.
+ */
+#ifdef NS3_MTP
+#define NS_ENSEMBLE_ATOMIC(type) std::atomic<type>
+#elif defined (NS3_ENSEMBLE)
+#define NS_ENSEMBLE_ATOMIC(type) thread_local type
+#else
+#define NS_ENSEMBLE_ATOMIC(type) type
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Run many independent replications of a simulation in one process.
+ *
+ * Running each replication as its own program pays again for loading
+ * the modules and registering the TypeIds.  The EnsembleRunner instead
+ * runs the replications in a pool of threads of the same process.  Each
+ * replication is a function which builds the topology, runs the
+ * simulation, and returns its results as named metrics:
+ *
+ * \code
+ *   EnsembleRunner::Results
+ *   Replication (uint64_t run)
+ *   {
+ *     NodeContainer nodes;
+ *     nodes.Create (2);
+ *     // ...
+ *     Simulator::Run ();
+ *     EnsembleRunner::Results results;
+ *     results["rxBytes"] = sink->GetTotalRx ();
+ *     Simulator::Destroy ();
+ *     return results;
+ *   }
+ *
+ *   EnsembleRunner runner;
+ *   runner.SetThreadCount (8);
+ *   runner.Run (MakeCallback (&Replication), 100);
+ *   runner.PrintSummary (std::cout);
+ * \endcode
+ *
+ * Replication \c i runs with RngSeedManager::GetRun() equal to the first
+ * run number (RngRun by default) plus \c i, so the results of every
+ * replication only depend on its run number, and not on the thread
+ * count or on the order of execution.
+ *
+ * Each replication thread has its own instance of the Simulator, of the
+ * random number stream assignment (RngSeedManager), of the Names, of
+ * the Config root namespace objects, and of the instances of
+ * SimulationSingleton, NodeList and ChannelList.  The TypeIds and the
+ * attribute defaults remain shared by all the threads, so Config::SetDefault
+ * and Config::SetGlobal must be called before Run, and not by the
+ * replications.  The simulator implementation of the replications must
+ * run in the calling thread, as the DefaultSimulatorImpl does.
+ *
+ * The free lists of Buffer and PacketMetadata, the packet uids, and the
+ * counters which allocate the MAC addresses and router ids are only safe
+ * to use from several threads when ns-3 is configured with
+ * --enable-ensemble or --enable-mtp.  Without either option, the
+ * replications run one after the other.  With --enable-ensemble, these
+ * counters are thread_local (NS_ENSEMBLE_ATOMIC), and every replication
+ * runs in a new thread, so that its packet uids and addresses are the
+ * same as in the first simulation of a program, whatever the other
+ * replications.  With --enable-mtp, the free lists are disabled and the
+ * counters are std::atomic and shared by all the threads, so that the
+ * uids and addresses of the concurrent replications are unique but
+ * depend on the interleaving of their threads.
+ */
+class EnsembleRunner
+{
+public:
+  /** The named metrics reported by a replication. */
+  typedef std::map<std::string, double> Results;
+  /**
+   * A replication: takes the run number, returns the metrics.
+   * The replication should call Simulator::Destroy before returning;
+   * otherwise the runner does.
+   */
+  typedef Callback<Results, uint64_t> Replication;
+
+  /** The statistics of one metric over all the replications. */
+  struct Summary
+  {
+    uint32_t count;   //!< Number of replications which reported the metric.
+    double mean;      //!< Mean value.
+    double stddev;    //!< Sample standard deviation.
+    double min;       //!< Minimum value.
+    double max;       //!< Maximum value.
+  };
+
+  /** Constructor. */
+  EnsembleRunner ();
+
+  /**
+   * Set the number of threads of the pool.
+   *
+   * \param [in] threads The number of threads, or 0 for the number of
+   *             processors (the default).
+   */
+  void SetThreadCount (uint32_t threads);
+  /**
+   * \returns The number of threads which Run will use.
+   */
+  uint32_t GetThreadCount (void) const;
+  /**
+   * Set the run number of the first replication.
+   *
+   * \param [in] run The run number; the default is RngSeedManager::GetRun()
+   *             at the time of the call to Run.
+   */
+  void SetFirstRun (uint64_t run);
+
+  /**
+   * Run the replications, and wait for all of them to complete.
+   *
+   * This must be called from the main thread, while no simulation is
+   * running, and replaces the results of a previous call.
+   *
+   * \param [in] replication The function which runs a replication.
+   * \param [in] count The number of replications.
+   */
+  void Run (Replication replication, uint32_t count);
+
+  /**
+   * \returns The number of replications of the last Run.
+   */
+  uint32_t GetN (void) const;
+  /**
+   * \param [in] i The index of the replication.
+   * \returns The run number of replication \pname{i}.
+   */
+  uint64_t GetRun (uint32_t i) const;
+  /**
+   * \param [in] i The index of the replication.
+   * \returns The metrics reported by replication \pname{i}.
+   */
+  const Results & GetResults (uint32_t i) const;
+  /**
+   * \param [in] metric The name of the metric.
+   * \returns The statistics of \pname{metric} over the replications.
+   */
+  Summary GetSummary (std::string metric) const;
+  /**
+   * Print the statistics of every metric, one per line.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void PrintSummary (std::ostream &os) const;
+
+  /**
+   * \returns \c true if the calling thread runs a replication, that is,
+   *          if it uses its own instance of the simulation singletons.
+   *
+   * This is inline, as every Simulator call checks it.
+   */
+  static bool IsReplicationThread (void);
+
+private:
+  /**
+   * Entry point of the threads of the pool, which start the
+   * replications one after the other.
+   *
+   * \param [in] self The runner.
+   */
+  static void RunWorker (EnsembleRunner *self);
+  /**
+   * Entry point of the thread of a replication.
+   *
+   * \param [in] self The runner.
+   * \param [in] i The index of the replication.
+   */
+  static void RunReplication (EnsembleRunner *self, uint32_t i);
+  /**
+   * Run one replication in the calling thread.
+   *
+   * \param [in] i The index of the replication.
+   */
+  void DoRunReplication (uint32_t i);
+
+  /** The number of threads, 0 for the number of processors. */
+  uint32_t m_threadCount;
+  /** Whether SetFirstRun was called. */
+  bool m_hasFirstRun;
+  /** The run number of the first replication. */
+  uint64_t m_firstRun;
+  /** The replication of the current Run. */
+  Replication m_replication;
+  /** The index of the next replication to start. */
+  std::atomic<uint32_t> m_next;
+  /** The seed of all the replications. */
+  uint32_t m_seed;
+  /** The metrics of each replication. */
+  std::vector<Results> m_results;
+
+  /** Whether the calling thread runs a replication. */
+  static thread_local bool g_replicationThread;
+};
+
+inline bool
+EnsembleRunner::IsReplicationThread (void)
+{
+  return g_replicationThread;
+}
+
+} // namespace ns3
+
+#endif /* ENSEMBLE_RUNNER_H */
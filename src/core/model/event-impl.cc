@@ -19,6 +19,8 @@
  */
 
 #include "event-impl.h"
+#include "global-value.h"
+#include "boolean.h"
 #include "log.h"
 
 /**
@@ -31,13 +33,75 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/**
+ * \relates EventImpl
+ * \anchor GlobalValueEventImplPool
+ * Recycle the memory of the events through per-thread free lists.
+ */
+static GlobalValue g_eventImplPool = GlobalValue ("EventImplPool",
+                                                  "Recycle the memory of the events through per-thread free lists.  "
+                                                  "Disable to debug with AddressSanitizer or valgrind.",
+                                                  BooleanValue (true),
+                                                  MakeBooleanChecker ());
+
+namespace {
+
+/**
+ * \ingroup events
+ * Configuration of the free lists of the events.
+ */
+struct EventImplPoolTraits
+{
+  /** Number of size classes; larger events are not pooled. */
+  static const std::size_t CLASSES = 16;
+  /** Maximum number of free blocks kept in each size class. */
+  static const uint32_t MAX_CACHED = 16384;
+  /** \returns The value of the EventImplPool GlobalValue. */
+  static bool IsEnabled (void)
+  {
+    BooleanValue value;
+    g_eventImplPool.GetValue (value);
+    return value.Get ();
+  }
+};
+
+/** The free lists of the events. */
+typedef SizeClassAllocator<EventImplPoolTraits> EventImplPool;
+
+}  // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return EventImplPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  EventImplPool::Deallocate (p, size);
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  return EventImplPool::GetStats ();
+}
+
+void
+EventImpl::ResetPoolStats (void)
+{
+  EventImplPool::ResetStats ();
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_timerIndex (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +130,10 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const ObjectBase *
+EventImpl::PeekObject (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -21,7 +21,9 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
+#include "size-class-allocator.h"
 
 /**
  * \file
@@ -31,6 +33,8 @@
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup events
  * \brief A simulation event.
@@ -40,10 +44,45 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the events, which includes the arguments bound by
+ * MakeEvent(), is recycled through per-thread free lists, one for each
+ * size class of 16 bytes up to 256 bytes, so that scheduling an event
+ * does not usually reach malloc.  The free lists can be disabled, for
+ * example to let AddressSanitizer or valgrind check the events, with
+ * the "EventImplPool" GlobalValue or the NS_GLOBAL_VALUE environment
+ * variable:
+ * \code
+ *   NS_GLOBAL_VALUE="EventImplPool=false" ./waf --run ...
+ * \endcode
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
+  /** Statistics of the EventImpl free lists of a thread. */
+  typedef SizeClassAllocatorStats PoolStats;
+
+  /**
+   * Allocate an event, from the free list of its size class if possible.
+   *
+   * \param [in] size The size of the event.
+   * \returns The event memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release an event to the free list of its size class.
+   *
+   * \param [in] p The event memory.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \returns The allocation statistics of the calling thread.
+   */
+  static PoolStats GetPoolStats (void);
+  /** Reset the allocation statistics of the calling thread. */
+  static void ResetPoolStats (void);
+
   /** Default constructor. */
   EventImpl ();
   /** Destructor. */
@@ -65,6 +104,14 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * \returns The object whose method is invoked by this event, if it is
+   *          an ObjectBase, or 0.
+   *
+   * This is used to attribute the events to the TypeId of their object,
+   * for example by the event profiler of DefaultSimulatorImpl.
+   */
+  virtual const ObjectBase * PeekObject (void) const;
 
 protected:
   /**
@@ -76,7 +123,11 @@ protected:
   virtual void Notify (void) = 0;
 
 private:
+  friend class TimerWheel;
+
   bool m_cancel;  /**< Has this event been cancelled. */
+  /** The index of the event in its TimerWheel slot, if it is a timer. */
+  uint32_t m_timerIndex;
 };
 
 } // namespace ns3
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "object-base.h"
+#include "simulator.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup simulator
+ * Get a readable name for the dynamic type of an event.
+ *
+ * The events created by MakeEvent() are named after the method or
+ * function they invoke, that is, the type of the first parameter of
+ * MakeEvent().
+ *
+ * \param [in] type The type of the event.
+ * \returns The name of the type.
+ */
+std::string
+GetEventTypeName (std::type_index type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  std::string::size_type makeEvent = name.find ("MakeEvent<");
+  if (makeEvent == std::string::npos)
+    {
+      return name;
+    }
+  // skip the template arguments, and return the first parameter
+  std::string::size_type start = std::string::npos;
+  int depth = 0;
+  for (std::string::size_type i = makeEvent + 9; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (depth == 0 && c == '(' && start == std::string::npos)
+        {
+          start = i + 1;
+        }
+      else if (depth == 1 && start != std::string::npos
+               && (c == ',' || c == ')'))
+        {
+          return name.substr (start, i - start);
+        }
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')')
+        {
+          depth--;
+        }
+    }
+  return name;
+}
+
+/**
+ * \ingroup simulator
+ * Ordering of the records by decreasing time.
+ *
+ * \param [in] a The first record.
+ * \param [in] b The second record.
+ * \returns \c true if \c a took more time than \c b.
+ */
+bool
+MoreTime (const EventProfiler::Record &a, const EventProfiler::Record &b)
+{
+  return a.nanoseconds > b.nanoseconds;
+}
+
+}  // unnamed namespace
+
+bool
+EventProfiler::Key::operator < (const Key &other) const
+{
+  if (context != other.context)
+    {
+      return context < other.context;
+    }
+  if (tid != other.tid)
+    {
+      return tid < other.tid;
+    }
+  return type < other.type;
+}
+
+void
+EventProfiler::Invoke (EventImpl *event, uint32_t context)
+{
+  const ObjectBase *object = event->PeekObject ();
+  Key key = { std::type_index (typeid (*event)), TypeId (), context };
+  if (object != 0)
+    {
+      key.tid = object->GetInstanceTypeId ();
+    }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  event->Invoke ();
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+
+  std::map<Key, Stats>::iterator i = m_stats.find (key);
+  if (i == m_stats.end ())
+    {
+      Stats stats = { 0, 0 };
+      i = m_stats.insert (std::make_pair (key, stats)).first;
+    }
+  i->second.count++;
+  i->second.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ();
+}
+
+std::vector<EventProfiler::Record>
+EventProfiler::GetRecords (void) const
+{
+  std::vector<Record> records;
+  for (std::map<Key, Stats>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      Record record;
+      record.context = i->first.context;
+      record.tid = i->first.tid.GetUid () == 0 ? "-" : i->first.tid.GetName ();
+      record.callback = GetEventTypeName (i->first.type);
+      record.count = i->second.count;
+      record.nanoseconds = i->second.nanoseconds;
+      records.push_back (record);
+    }
+  std::stable_sort (records.begin (), records.end (), MoreTime);
+  return records;
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "context " << context;
+  return oss.str ();
+}
+
+void
+EventProfiler::PrintTable (std::ostream &os, const std::string &title,
+                           const std::vector<Record> &records, uint64_t total)
+{
+  // aggregate the records with the same name
+  std::map<std::string, Record> byName;
+  for (std::vector<Record>::const_iterator i = records.begin (); i != records.end (); ++i)
+    {
+      std::map<std::string, Record>::iterator j = byName.find (i->callback);
+      if (j == byName.end ())
+        {
+          byName[i->callback] = *i;
+        }
+      else
+        {
+          j->second.count += i->count;
+          j->second.nanoseconds += i->nanoseconds;
+        }
+    }
+  std::vector<Record> sorted;
+  for (std::map<std::string, Record>::const_iterator i = byName.begin (); i != byName.end (); ++i)
+    {
+      sorted.push_back (i->second);
+    }
+  std::stable_sort (sorted.begin (), sorted.end (), MoreTime);
+
+  os << std::endl
+     << std::setw (12) << "time (s)" << std::setw (8) << "%"
+     << std::setw (12) << "events" << "  " << title << std::endl;
+  for (std::vector<Record>::const_iterator i = sorted.begin (); i != sorted.end (); ++i)
+    {
+      os << std::fixed
+         << std::setw (12) << std::setprecision (6) << i->nanoseconds / 1e9
+         << std::setw (8) << std::setprecision (2) << (total > 0 ? 100.0 * i->nanoseconds / total : 0.0)
+         << std::setw (12) << i->count
+         << "  " << i->callback << std::endl;
+    }
+}
+
+void
+EventProfiler::Report (std::ostream &os) const
+{
+  std::vector<Record> records = GetRecords ();
+  uint64_t total = 0;
+  uint64_t count = 0;
+  for (std::vector<Record>::const_iterator i = records.begin (); i != records.end (); ++i)
+    {
+      total += i->nanoseconds;
+      count += i->count;
+    }
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "Event profile: " << count << " events, "
+     << std::fixed << std::setprecision (6) << total / 1e9 << " s" << std::endl;
+
+  PrintTable (os, "callback", records, total);
+  std::vector<Record> byField = records;
+  for (std::vector<Record>::iterator i = byField.begin (); i != byField.end (); ++i)
+    {
+      i->callback = i->tid;
+    }
+  PrintTable (os, "TypeId", byField, total);
+  byField = records;
+  for (std::vector<Record>::iterator i = byField.begin (); i != byField.end (); ++i)
+    {
+      i->callback = GetContextName (i->context);
+    }
+  PrintTable (os, "context", byField, total);
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::WriteCollapsedStacks (std::ostream &os) const
+{
+  std::vector<Record> records = GetRecords ();
+  for (std::vector<Record>::const_iterator i = records.begin (); i != records.end (); ++i)
+    {
+      os << GetContextName (i->context) << ";" << i->tid << ";" << i->callback
+         << " " << i->nanoseconds << std::endl;
+    }
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stats.clear ();
+}
+
+} // namespace ns3
@@ -22,6 +22,9 @@
 
 #include <iostream>
 #include <list>
+#ifdef NS3_MTP
+#include <mutex>
+#endif
 
 #include <cstdlib>
 #include <cstdio>
@@ -73,10 +76,36 @@ namespace {
 std::list<std::ostream*> ** PeekStreamList (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  // the streams of a simulation: those of the replication of the calling
+  // thread with --enable-ensemble, those of all the partitions with
+  // --enable-mtp
+#ifdef NS3_ENSEMBLE
+  static thread_local std::list<std::ostream*> *streams = 0;
+#else
   static std::list<std::ostream*> *streams = 0;
+#endif
   return &streams;
 }
 
+#ifdef NS3_MTP
+/**
+ * \ingroup fatalimpl
+ * \brief The mutex of the stream list, which the threads of the
+ * partitions of a simulation share.
+ *
+ * It is recursive, as the SIGSEGV handler of FlushStreams flushes the
+ * streams again, and never deleted, so that the streams can be
+ * unregistered by static destructors.
+ *
+ * \returns The mutex.
+ */
+std::recursive_mutex & GetStreamListMutex (void)
+{
+  static std::recursive_mutex *mutex = new std::recursive_mutex ();
+  return *mutex;
+}
+#endif
+
 /**
  * \ingroup fatalimpl
  * \brief Get the stream list, initializing it if necessary.
@@ -100,6 +129,9 @@ void
 RegisterStream (std::ostream* stream)
 {
   NS_LOG_FUNCTION (stream);
+#ifdef NS3_MTP
+  std::lock_guard<std::recursive_mutex> lock (GetStreamListMutex ());
+#endif
   GetStreamList ()->push_back (stream);
 }
 
@@ -107,6 +139,9 @@ void
 UnregisterStream (std::ostream* stream)
 {
   NS_LOG_FUNCTION (stream);
+#ifdef NS3_MTP
+  std::lock_guard<std::recursive_mutex> lock (GetStreamListMutex ());
+#endif
   std::list<std::ostream*> **pl = PeekStreamList ();
   if (*pl == 0)
     {
@@ -149,13 +184,15 @@ void
 FlushStreams (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+#ifdef NS3_MTP
+  std::lock_guard<std::recursive_mutex> lock (GetStreamListMutex ());
+#endif
   std::list<std::ostream*> **pl = PeekStreamList ();
   if (*pl == 0)
     {
       return;
     }
 
-
   /* Override default SIGSEGV handler - will flush subsequent
    * streams even if one of the stream pointers is bad.
    * The SIGSEGV override should only be active for the
@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Ordering of the Bottom: the next event is last.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a is after \c b.
+ */
+bool
+Later (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+}  // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("Threshold",
+                   "The number of events in a bucket above which the bucket "
+                   "is spread over a new rung instead of being sorted.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderScheduler::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_size (0),
+    m_threshold (50)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::Rung &
+LadderScheduler::AddRung (uint64_t start, uint64_t end, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << start << end << n);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (end > start);
+  uint64_t span = end - start;
+  // about two events per bucket, and no bucket narrower than a time step
+  uint64_t nBuckets = n / 2 + 1;
+  uint64_t width = (span + nBuckets - 1) / nBuckets;
+  nBuckets = (span + width - 1) / width;
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  rung.nBuckets = nBuckets;
+  rung.current = 0;
+  rung.start = start;
+  rung.width = width;
+  return rung;
+}
+
+uint64_t
+LadderScheduler::GetLadderLimit (void) const
+{
+  if (m_nRungs == 0)
+    {
+      return m_topStart;
+    }
+  const Rung &rung = m_rungs[m_nRungs - 1];
+  return rung.start + rung.current * rung.width;
+}
+
+bool
+LadderScheduler::InsertInLadder (const Scheduler::Event &ev)
+{
+  // each rung covers the time of a bucket of the previous rung
+  // which has already been dequeued.
+  for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+      Rung &rung = m_rungs[i];
+      if (ev.key.m_ts >= rung.start + rung.current * rung.width)
+        {
+          uint64_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.nBuckets);
+          rung.buckets[bucket].push_back (ev);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, Later);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () > m_threshold
+      && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts > m_bottom.back ().key.m_ts)
+    {
+      // too many events were inserted below the ladder: spread them
+      // over a new rung rather than paying for the sorted insertion.
+      Rung &rung = AddRung (m_bottom.back ().key.m_ts, GetLadderLimit (), m_bottom.size ());
+      for (Bucket::const_iterator j = m_bottom.begin (); j != m_bottom.end (); ++j)
+        {
+          rung.buckets[(j->key.m_ts - rung.start) / rung.width].push_back (*j);
+        }
+      m_bottom.clear ();
+    }
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_nRungs == 0);
+  NS_ASSERT (!m_top.empty ());
+  Rung &rung = AddRung (m_topMin, m_topMax + 1, m_top.size ());
+  m_topStart = rung.start + rung.nBuckets * rung.width;
+  for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - rung.start) / rung.width].push_back (*i);
+    }
+  m_top.clear ();
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty () && m_size > 0)
+    {
+      if (m_nRungs == 0)
+        {
+          TransferTop ();
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets
+             && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t start = rung.start + rung.current * rung.width;
+      rung.current++;
+      if (bucket.size () > m_threshold
+          && rung.width > 1
+          && m_nRungs < MAX_RUNGS)
+        {
+          Rung &child = AddRung (start, start + rung.width, bucket.size ());
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              child.buckets[(i->key.m_ts - child.start) / child.width].push_back (*i);
+            }
+          bucket.clear ();
+        }
+      else
+        {
+          // the bucket takes over the empty storage of the bottom
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), Later);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  if (ev.key.m_ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ev.key.m_ts;
+          m_topMax = ev.key.m_ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ev.key.m_ts);
+          m_topMax = std::max (m_topMax, ev.key.m_ts);
+        }
+      m_top.push_back (ev);
+    }
+  else if (!InsertInLadder (ev))
+    {
+      InsertInBottom (ev);
+    }
+  Refill ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  Refill ();
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  Bucket *bucket = &m_bottom;
+  if (ev.key.m_ts >= m_topStart)
+    {
+      // m_topMin and m_topMax are left as bounds of the Top
+      bucket = &m_top;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; ++i)
+        {
+          Rung &rung = m_rungs[i];
+          if (ev.key.m_ts >= rung.start + rung.current * rung.width)
+            {
+              bucket = &rung.buckets[(ev.key.m_ts - rung.start) / rung.width];
+              break;
+            }
+        }
+    }
+  Bucket::iterator i = std::find (bucket->begin (), bucket->end (), ev);
+  NS_ASSERT (i != bucket->end ());
+  if (bucket == &m_bottom)
+    {
+      m_bottom.erase (i);
+    }
+  else
+    {
+      *i = bucket->back ();
+      bucket->pop_back ();
+    }
+  m_size--;
+  Refill ();
+}
+
+} // namespace ns3
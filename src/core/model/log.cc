@@ -26,6 +26,7 @@
 #include <stdexcept>
 #include "ns3/core-config.h"
 #include "fatal-error.h"
+#include "ensemble-runner.h"
 
 #include <cstdlib>    // getenv
 #include <cstring>    // strlen
@@ -50,6 +51,15 @@ static TimePrinter g_logTimePrinter = 0;
  * The Log NodePrinter.
  */
 static NodePrinter g_logNodePrinter = 0;
+/**
+ * \ingroup logging
+ * The Log TimePrinter and NodePrinter of the replication run by the
+ * calling thread of an EnsembleRunner.  They print the time and node of
+ * the simulation of this thread, and are reset with it.
+ */
+static thread_local TimePrinter g_replicationTimePrinter = 0;
+/** \copydoc g_replicationTimePrinter */
+static thread_local NodePrinter g_replicationNodePrinter = 0;
 
 /**
  * \ingroup logging
@@ -619,6 +629,11 @@ static void CheckEnvironmentVariables (void)
 }
 void LogSetTimePrinter (TimePrinter printer)
 {
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      g_replicationTimePrinter = printer;
+      return;
+    }
   g_logTimePrinter = printer;
   /** \internal
    *  This is the only place where we are more or less sure that all log variables
@@ -628,15 +643,28 @@ void LogSetTimePrinter (TimePrinter printer)
 }
 TimePrinter LogGetTimePrinter (void)
 {
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return g_replicationTimePrinter;
+    }
   return g_logTimePrinter;
 }
 
 void LogSetNodePrinter (NodePrinter printer)
 {
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      g_replicationNodePrinter = printer;
+      return;
+    }
   g_logNodePrinter = printer;
 }
 NodePrinter LogGetNodePrinter (void)
 {
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return g_replicationNodePrinter;
+    }
   return g_logNodePrinter;
 }
 
@@ -0,0 +1,826 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator.h"
+#include "multithreaded-simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+
+#include "ptr.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "abort.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "unused.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** Timestamp used to mark the absence of an event. */
+static const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_currentPartition = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of partitions, each processed by its own thread.",
+                   TypeId::ATTR_GET | TypeId::ATTR_CONSTRUCT,
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Lookahead",
+                   "The smallest delay of an event scheduled from one partition "
+                   "into another one, which is also the length of the time "
+                   "windows processed in parallel.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::SetLookahead,
+                                     &MultithreadedSimulatorImpl::GetLookahead),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_global = 0;
+  m_threadCount = 1;
+  m_lookahead = 0;
+  m_windowStart = 0;
+  m_windowEnd = 0;
+  m_parity = 0;
+  m_pendingTs = NO_EVENT;
+  m_windowCount = 0;
+  m_stop = false;
+  m_exit = false;
+  m_barrierCount = 0;
+  m_barrierGeneration = 0;
+  m_eventsWithContextEmpty = true;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
+
+  std::vector<Partition *> partitions = m_partitions;
+  if (m_global != 0)
+    {
+      partitions.push_back (m_global);
+    }
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (uint32_t parity = 0; parity < 2; ++parity)
+        {
+          for (uint32_t j = 0; j < partition->outbox[parity].size (); ++j)
+            {
+              EventsWithContext &outbox = partition->outbox[parity][j];
+              for (EventsWithContext::iterator k = outbox.begin (); k != outbox.end (); ++k)
+                {
+                  k->event->Unref ();
+                }
+            }
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  if (m_global == 0)
+    {
+      for (uint32_t i = 0; i <= m_threadCount; ++i)
+        {
+          Partition *partition = new Partition ();
+          partition->index = i;
+          // uids are allocated from 4.
+          // uid 0 is "invalid" events
+          // uid 1 is "now" events
+          // uid 2 is "destroy" events
+          // Each partition allocates every (m_threadCount + 1)th uid, so
+          // that the uids of the events moved by SetPartition remain unique.
+          partition->uid = 4 + i;
+          partition->currentUid = 0;
+          partition->objectUid = 0;
+          partition->currentTs = 0;
+          partition->currentContext = Simulator::NO_CONTEXT;
+          partition->eventCount = 0;
+          partition->unscheduledEvents = 0;
+          partition->stop = false;
+          partition->minSent = NO_EVENT;
+          partition->outbox[0].resize (m_threadCount + 1);
+          partition->outbox[1].resize (m_threadCount + 1);
+          if (i < m_threadCount)
+            {
+              m_partitions.push_back (partition);
+            }
+          else
+            {
+              m_global = partition;
+            }
+        }
+    }
+
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              Scheduler::Event next = (*i)->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (SystemThread::Equals (m_main) && g_currentPartition == 0,
+                 "MultithreadedSimulatorImpl::SetPartition can only be called before Simulator::Run");
+  NS_ASSERT (context != Simulator::NO_CONTEXT);
+  NS_ABORT_MSG_UNLESS (partition < m_partitions.size (),
+                       "Invalid partition " << partition << ", there are only " << m_partitions.size ());
+  Partition *old = GetPartitionOf (context);
+  if (context >= m_partitionOf.size ())
+    {
+      uint32_t first = m_partitionOf.size ();
+      m_partitionOf.resize (context + 1);
+      for (uint32_t i = first; i < m_partitionOf.size (); ++i)
+        {
+          m_partitionOf[i] = i % m_partitions.size ();
+        }
+    }
+  m_partitionOf[context] = partition;
+
+  // move the already scheduled events of this context to their new
+  // partition, with their keys, so that their EventIds remain valid
+  Partition *target = m_partitions[partition];
+  if (old != target && !old->events->IsEmpty ())
+    {
+      Ptr<Scheduler> events = m_schedulerFactory.Create<Scheduler> ();
+      while (!old->events->IsEmpty ())
+        {
+          Scheduler::Event next = old->events->RemoveNext ();
+          if (next.key.m_context == context)
+            {
+              old->unscheduledEvents--;
+              target->unscheduledEvents++;
+              target->events->Insert (next);
+            }
+          else
+            {
+              events->Insert (next);
+            }
+        }
+      old->events = events;
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  return GetPartitionOf (context)->index;
+}
+
+void
+MultithreadedSimulatorImpl::SetLookahead (const Time &lookahead)
+{
+  NS_LOG_FUNCTION (this << lookahead);
+  m_lookahead = lookahead.GetTimeStep ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return TimeStep (m_lookahead);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount (void) const
+{
+  return m_windowCount;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::AllocateUid (void)
+{
+  Partition *partition = g_currentPartition;
+  if (partition == 0)
+    {
+      return 0;
+    }
+  NS_ASSERT (partition->objectUid < (static_cast<uint64_t> (1) << UID_BITS));
+  return (static_cast<uint64_t> (partition->index + 1) << UID_BITS) | partition->objectUid++;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  if (g_currentPartition != 0)
+    {
+      return g_currentPartition;
+    }
+  return m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_global;
+    }
+  if (context < m_partitionOf.size ())
+    {
+      return m_partitions[m_partitionOf[context]];
+    }
+  return m_partitions[context % m_partitions.size ()];
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts,
+                                    uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid += m_partitions.size () + 1;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::Synchronize (void)
+{
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == m_partitions.size ())
+    {
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+    }
+  else
+    {
+      while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (MultithreadedSimulatorImpl *self, uint32_t index)
+{
+  Partition *partition = self->m_partitions[index];
+  while (true)
+    {
+      self->Synchronize ();
+      if (self->m_exit)
+        {
+          break;
+        }
+      self->ProcessPartition (partition);
+      self->Synchronize ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+  partition->eventCount++;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessPartition (Partition *partition)
+{
+  g_currentPartition = partition;
+
+  // receive, in sender order, the events sent during the previous window
+  uint32_t previous = m_parity ^ 1;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      EventsWithContext &inbox = (*i)->outbox[previous][partition->index];
+      for (EventsWithContext::const_iterator j = inbox.begin (); j != inbox.end (); ++j)
+        {
+          Insert (partition, j->timestamp, j->context, j->event);
+        }
+      inbox.clear ();
+    }
+
+  partition->minSent = NO_EVENT;
+  while (!partition->events->IsEmpty ()
+         && !partition->stop
+         && partition->events->PeekNext ().key.m_ts < m_windowEnd)
+    {
+      ProcessOneEvent (partition);
+      if (m_partitions.size () == 1)
+        {
+          // the main thread owns all the partitions: receive the events
+          // from other threads as soon as DefaultSimulatorImpl would.
+          ProcessEventsWithContext ();
+        }
+    }
+
+  g_currentPartition = 0;
+}
+
+void
+MultithreadedSimulatorImpl::EndWindow (void)
+{
+  m_windowCount++;
+  m_pendingTs = NO_EVENT;
+  uint32_t global = m_partitions.size ();
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      if (partition->stop)
+        {
+          partition->stop = false;
+          m_stop = true;
+        }
+      m_pendingTs = std::min (m_pendingTs, partition->minSent);
+      EventsWithContext &outbox = partition->outbox[m_parity][global];
+      for (EventsWithContext::const_iterator j = outbox.begin (); j != outbox.end (); ++j)
+        {
+          Insert (m_global, j->timestamp, j->context, j->event);
+        }
+      outbox.clear ();
+    }
+  m_parity ^= 1;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNextPartitionTs (void) const
+{
+  uint64_t next = m_pendingTs;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          next = std::min (next, (*i)->events->PeekNext ().key.m_ts);
+        }
+    }
+  return next;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  return (GetNextPartitionTs () == NO_EVENT && m_global->events->IsEmpty ()) || m_stop;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContextEmpty)
+    {
+      return;
+    }
+
+  // swap queues
+  EventsWithContext eventsWithContext;
+  {
+    CriticalSection cs (m_eventsWithContextMutex);
+    m_eventsWithContext.swap (eventsWithContext);
+    m_eventsWithContextEmpty = true;
+  }
+  for (EventsWithContext::const_iterator i = eventsWithContext.begin (); i != eventsWithContext.end (); ++i)
+    {
+      Partition *partition = GetPartitionOf (i->context);
+      uint64_t now = std::max (m_global->currentTs, partition->currentTs);
+      Insert (partition, now + i->timestamp, i->context, i->event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifndef NS3_MTP
+  NS_ABORT_MSG_IF (m_partitions.size () > 1,
+                   "MultithreadedSimulatorImpl needs ns-3 to be configured with --enable-mtp to use more than one thread");
+#endif
+  uint64_t lookahead = m_lookahead;
+  if (lookahead == 0)
+    {
+      NS_ABORT_MSG_IF (m_partitions.size () > 1,
+                       "MultithreadedSimulatorImpl: the lookahead is not set, "
+                       "see MultithreadedSimulatorHelper::Partition");
+      lookahead = NO_EVENT;
+    }
+
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_stop = false;
+  m_exit = false;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::RunWorker, this, i));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+
+  ProcessEventsWithContext ();
+  while (!m_stop)
+    {
+      uint64_t next = GetNextPartitionTs ();
+      if (!m_global->events->IsEmpty ()
+          && m_global->events->PeekNext ().key.m_ts <= next)
+        {
+          // the partitions are paused: run the global event alone.
+          g_currentPartition = m_global;
+          ProcessOneEvent (m_global);
+          g_currentPartition = 0;
+          ProcessEventsWithContext ();
+          continue;
+        }
+      if (next == NO_EVENT)
+        {
+          break;
+        }
+
+      m_windowStart = next;
+      m_windowEnd = next + std::min (lookahead, NO_EVENT - next);
+      if (!m_global->events->IsEmpty ())
+        {
+          m_windowEnd = std::min (m_windowEnd, m_global->events->PeekNext ().key.m_ts);
+        }
+      Synchronize ();
+      ProcessPartition (m_partitions[0]);
+      Synchronize ();
+      EndWindow ();
+      ProcessEventsWithContext ();
+    }
+
+  m_exit = true;
+  Synchronize ();
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+
+  int unscheduledEvents = m_global->unscheduledEvents;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, (*i)->currentTs);
+      unscheduledEvents += (*i)->unscheduledEvents;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!IsFinished () || m_stop || unscheduledEvents == 0);
+  NS_UNUSED (unscheduledEvents);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *partition = GetCurrentPartition ();
+  if (partition == m_global)
+    {
+      m_stop = true;
+    }
+  else
+    {
+      // the other partitions complete the current window
+      partition->stop = true;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (g_currentPartition != 0 || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *partition = GetCurrentPartition ();
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+  Scheduler::EventKey key = Insert (partition, (uint64_t) tAbsolute.GetTimeStep (),
+                                    partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  Partition *current = g_currentPartition;
+  if (current == 0 && !SystemThread::Equals (m_main))
+    {
+      EventWithContext ev;
+      ev.context = context;
+      // Current time added in ProcessEventsWithContext()
+      ev.timestamp = delay.GetTimeStep ();
+      ev.event = event;
+      {
+        CriticalSection cs (m_eventsWithContextMutex);
+        m_eventsWithContext.push_back (ev);
+        m_eventsWithContextEmpty = false;
+      }
+      return;
+    }
+
+  current = GetCurrentPartition ();
+  Partition *target = GetPartitionOf (context);
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  if (current == m_global || current == target)
+    {
+      // either all the partitions are paused or the target is ours
+      Insert (target, ts, context, event);
+    }
+  else
+    {
+      NS_ABORT_MSG_IF (ts < m_windowEnd,
+                       "Event scheduled from context " << current->currentContext
+                       << " to context " << context << " with a delay of "
+                       << delay.GetTimeStep () << " is below the lookahead ("
+                       << m_lookahead << ")");
+      EventWithContext ev;
+      ev.context = context;
+      ev.timestamp = ts;
+      ev.event = event;
+      current->outbox[m_parity][target->index].push_back (ev);
+      if (target != m_global)
+        {
+          current->minSent = std::min (current->minSent, ts);
+        }
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_ASSERT_MSG (g_currentPartition != 0 || SystemThread::Equals (m_main),
+                 "Simulator::ScheduleNow Thread-unsafe invocation!");
+
+  Partition *partition = GetCurrentPartition ();
+  Scheduler::EventKey key = Insert (partition, partition->currentTs,
+                                    partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (g_currentPartition == 0 && SystemThread::Equals (m_main),
+                 "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_global->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartitionOf (id.GetContext ());
+  NS_ASSERT_MSG (g_currentPartition == 0 || g_currentPartition == m_global
+                 || g_currentPartition == partition,
+                 "Simulator::Remove of an event which belongs to another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *partition = GetPartitionOf (id.GetContext ());
+  if (partition != m_global && g_currentPartition != 0
+      && g_currentPartition != m_global && g_currentPartition != partition)
+    {
+      // The event belongs to a partition which runs concurrently with the
+      // caller: only the events before the current window are known to
+      // have been executed.
+      return id.PeekEventImpl () == 0
+             || id.GetTs () < m_windowStart
+             || id.PeekEventImpl ()->IsCancelled ();
+    }
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < partition->currentTs
+      || (id.GetTs () == partition->currentTs && id.GetUid () <= partition->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t eventCount = m_global->eventCount;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      eventCount += (*i)->eventCount;
+    }
+  return eventCount;
+}
+
+} // namespace ns3
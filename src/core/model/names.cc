@@ -23,6 +23,7 @@
 #include "abort.h"
 #include "names.h"
 #include "singleton.h"
+#include "ensemble-runner.h"
 
 /**
  * \file
@@ -124,6 +125,14 @@ public:
   /** Destructor. */
   ~NamesPriv ();
 
+  /**
+   * Get the names of the calling thread: the threads which run the
+   * replications of an EnsembleRunner each have their own.
+   *
+   * \returns The NamesPriv instance.
+   */
+  static NamesPriv * Get (void);
+
   // Doxygen \copydoc bug: won't copy these docs, so we repeat them.
 
   /**
@@ -289,6 +298,17 @@ NamesPriv::~NamesPriv ()
   m_root.m_name = "";
 }
 
+NamesPriv *
+NamesPriv::Get (void)
+{
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      static thread_local NamesPriv replicationNames;
+      return &replicationNames;
+    }
+  return Singleton<NamesPriv>::Get ();
+}
+
 void
 NamesPriv::Clear (void)
 {
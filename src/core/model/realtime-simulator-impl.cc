@@ -31,8 +31,13 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "ns3/core-config.h"
 
+#ifdef HAVE_SYS_TIMERFD_H
+#include "timerfd-synchronizer.h"
+#endif
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -51,6 +56,53 @@ NS_LOG_COMPONENT_DEFINE ("RealtimeSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (RealtimeSimulatorImpl);
 
+/** Number of buckets of the lateness histogram: 16 per power of two. */
+static const uint32_t LATENESS_BUCKETS = 61 * 16;
+
+/**
+ * \ingroup realtime
+ * Get the bucket of the lateness histogram which counts a value.
+ *
+ * Values below 16 have their own bucket; above, each power of two is
+ * split into 16 buckets of equal width.
+ *
+ * \param [in] value The lateness.
+ * \returns The index of the bucket.
+ */
+static uint32_t
+GetLatenessBucket (uint64_t value)
+{
+  if (value < 16)
+    {
+      return static_cast<uint32_t> (value);
+    }
+  uint32_t msb = 4;
+  while ((value >> (msb + 1)) != 0)
+    {
+      msb++;
+    }
+  return (msb - 3) * 16 + static_cast<uint32_t> ((value >> (msb - 4)) & 15);
+}
+
+/**
+ * \ingroup realtime
+ * Get the value represented by a bucket of the lateness histogram.
+ *
+ * \param [in] bucket The index of the bucket.
+ * \returns The middle of the values counted by the bucket.
+ */
+static uint64_t
+GetLatenessBucketValue (uint32_t bucket)
+{
+  if (bucket < 16)
+    {
+      return bucket;
+    }
+  uint32_t msb = bucket / 16 + 3;
+  uint64_t lower = static_cast<uint64_t> (16 + bucket % 16) << (msb - 4);
+  return lower + ((static_cast<uint64_t> (1) << (msb - 4)) - 1) / 2;
+}
+
 TypeId
 RealtimeSimulatorImpl::GetTypeId (void)
 {
@@ -63,12 +115,31 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    EnumValue (SYNC_BEST_EFFORT),
                    MakeEnumAccessor (&RealtimeSimulatorImpl::SetSynchronizationMode),
                    MakeEnumChecker (SYNC_BEST_EFFORT, "BestEffort",
-                                    SYNC_HARD_LIMIT, "HardLimit"))
+                                    SYNC_HARD_LIMIT, "HardLimit",
+                                    SYNC_ADAPTIVE, "Adaptive"))
     .AddAttribute ("HardLimit",
                    "Maximum acceptable real-time jitter (used in conjunction with SynchronizationMode=HardLimit)",
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("JitterWindow",
+                   "Events due within this window after a wakeup run at once "
+                   "(used in conjunction with SynchronizationMode=Adaptive)",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&RealtimeSimulatorImpl::SetJitterWindow,
+                                     &RealtimeSimulatorImpl::GetJitterWindow),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("LatenessInterval",
+                   "Real time between two reports of the Lateness trace source",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RealtimeSimulatorImpl::m_latenessInterval),
+                   MakeTimeChecker (Time (1)))
+    .AddTraceSource ("Lateness",
+                     "The median, 99th percentile and largest lateness "
+                     "of the events run in the last LatenessInterval, "
+                     "in SynchronizationMode=Adaptive",
+                     MakeTraceSourceAccessor (&RealtimeSimulatorImpl::m_latenessTrace),
+                     "ns3::RealtimeSimulatorImpl::LatenessTracedCallback")
   ;
   return tid;
 }
@@ -91,6 +162,11 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
+  m_synchronizationMode = SYNC_BEST_EFFORT;
+  m_nextLatenessReport = 0;
+  m_latenessBuckets.resize (LATENESS_BUCKETS, 0);
+  m_latenessCount = 0;
+  m_latenessMax = 0;
 
   m_main = SystemThread::Self ();
 
@@ -395,6 +471,132 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   event->Unref ();
 }
 
+void
+RealtimeSimulatorImpl::ProcessEventBatch (void)
+{
+  //
+  // This is ProcessOneEvent with a jitter window.  We wait as above, but
+  // an event due within the window is treated as already due, so events
+  // closer together than the window share one wakeup, and run back to
+  // back without a wait between them.
+  //
+  uint64_t tsWindow = m_jitterWindow.GetTimeStep ();
+  for (;;)
+    {
+      uint64_t tsNow;
+      uint64_t tsDelay;
+      {
+        CriticalSection cs (m_mutex);
+        tsNow = m_synchronizer->GetCurrentRealtime ();
+        uint64_t tsNext = NextTs ();
+        if (tsNext <= tsNow + tsWindow)
+          {
+            break;
+          }
+        tsDelay = tsNext - tsNow;
+        m_synchronizer->SetCondition (false);
+      }
+      if (m_synchronizer->Synchronize (tsNow, tsDelay))
+        {
+          break;
+        }
+    }
+
+  //
+  // Now run the batch: every event due within the window of the current
+  // real time, including the events scheduled by the batch itself.
+  //
+  while (!m_stop)
+    {
+      Scheduler::Event next;
+      {
+        CriticalSection cs (m_mutex);
+        if (m_events->IsEmpty ())
+          {
+            break;
+          }
+        uint64_t tsNow = m_synchronizer->GetCurrentRealtime ();
+        if (NextTs () > tsNow + tsWindow)
+          {
+            break;
+          }
+        next = m_events->RemoveNext ();
+        m_unscheduledEvents--;
+        m_eventCount++;
+
+        NS_ASSERT_MSG (next.key.m_ts >= m_currentTs,
+                       "RealtimeSimulatorImpl::ProcessEventBatch(): "
+                       "next.GetTs() earlier than m_currentTs (list order error)");
+        m_currentTs = next.key.m_ts;
+        m_currentContext = next.key.m_context;
+        m_currentUid = next.key.m_uid;
+        RecordLateness (tsNow > m_currentTs ? tsNow - m_currentTs : 0);
+      }
+
+      EventImpl *event = next.impl;
+      m_synchronizer->EventStart ();
+      event->Invoke ();
+      m_synchronizer->EventEnd ();
+      event->Unref ();
+    }
+
+  if (m_synchronizer->GetCurrentRealtime () >= m_nextLatenessReport)
+    {
+      ReportLateness ();
+    }
+}
+
+uint64_t
+RealtimeSimulatorImpl::GetRealtimeTs (void) const
+{
+  return std::max (m_synchronizer->GetCurrentRealtime (), m_currentTs);
+}
+
+void
+RealtimeSimulatorImpl::RecordLateness (uint64_t lateness)
+{
+  m_latenessBuckets[GetLatenessBucket (lateness)]++;
+  m_latenessCount++;
+  m_latenessMax = std::max (m_latenessMax, lateness);
+}
+
+uint64_t
+RealtimeSimulatorImpl::GetLatenessPercentile (double percentile) const
+{
+  if (m_latenessCount == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = static_cast<uint64_t> (std::ceil (percentile / 100 * m_latenessCount));
+  rank = std::max<uint64_t> (rank, 1);
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < LATENESS_BUCKETS; ++i)
+    {
+      count += m_latenessBuckets[i];
+      if (count >= rank)
+        {
+          return std::min (GetLatenessBucketValue (i), m_latenessMax);
+        }
+    }
+  return m_latenessMax;
+}
+
+void
+RealtimeSimulatorImpl::ReportLateness (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_latenessCount != 0)
+    {
+      m_latenessTrace (TimeStep (GetLatenessPercentile (50)),
+                       TimeStep (GetLatenessPercentile (99)),
+                       TimeStep (m_latenessMax));
+      std::fill (m_latenessBuckets.begin (), m_latenessBuckets.end (), 0);
+      m_latenessCount = 0;
+      m_latenessMax = 0;
+    }
+  m_nextLatenessReport = m_synchronizer->GetCurrentRealtime () + m_latenessInterval.GetTimeStep ();
+}
+
 bool
 RealtimeSimulatorImpl::IsFinished (void) const
 {
@@ -433,6 +635,7 @@ RealtimeSimulatorImpl::Run (void)
   m_stop = false;
   m_running = true;
   m_synchronizer->SetOrigin (m_currentTs);
+  m_nextLatenessReport = m_latenessInterval.GetTimeStep ();
 
   // Sleep until signalled
   uint64_t tsNow = 0;
@@ -464,7 +667,19 @@ RealtimeSimulatorImpl::Run (void)
           continue;
         }
 
-      ProcessOneEvent ();
+      if (m_synchronizationMode == SYNC_ADAPTIVE)
+        {
+          ProcessEventBatch ();
+        }
+      else
+        {
+          ProcessOneEvent ();
+        }
+    }
+
+  if (m_synchronizationMode == SYNC_ADAPTIVE)
+    {
+      ReportLateness ();
     }
 
   //
@@ -558,7 +773,7 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
         // If the simulator is running, we're pacing and have a meaningful
         // realtime clock.  If we're not, then m_currentTs is where we stopped.
         //
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+        ts = m_running ? GetRealtimeTs () : m_currentTs;
         ts += delay.GetTimeStep ();
       }
 
@@ -613,7 +828,7 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
   {
     CriticalSection cs (m_mutex);
 
-    uint64_t ts = m_synchronizer->GetCurrentRealtime () + time.GetTimeStep ();
+    uint64_t ts = GetRealtimeTs () + time.GetTimeStep ();
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
     ev.impl = impl;
@@ -644,7 +859,7 @@ RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventIm
     // If the simulator is running, we're pacing and have a meaningful
     // realtime clock.  If we're not, then m_currentTs is were we stopped.
     //
-    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+    uint64_t ts = m_running ? GetRealtimeTs () : m_currentTs;
     NS_ASSERT_MSG (ts >= m_currentTs,
                    "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -829,6 +1044,20 @@ void
 RealtimeSimulatorImpl::SetSynchronizationMode (enum SynchronizationMode mode)
 {
   NS_LOG_FUNCTION (this << mode);
+  NS_ASSERT_MSG (!m_running, "RealtimeSimulatorImpl::SetSynchronizationMode(): Simulator running");
+#ifdef HAVE_SYS_TIMERFD_H
+  if ((mode == SYNC_ADAPTIVE) != (m_synchronizationMode == SYNC_ADAPTIVE))
+    {
+      if (mode == SYNC_ADAPTIVE)
+        {
+          m_synchronizer = CreateObject<TimerFdSynchronizer> ();
+        }
+      else
+        {
+          m_synchronizer = CreateObject<WallClockSynchronizer> ();
+        }
+    }
+#endif
   m_synchronizationMode = mode;
 }
 
@@ -853,4 +1082,18 @@ RealtimeSimulatorImpl::GetHardLimit (void) const
   return m_hardLimit;
 }
 
+void
+RealtimeSimulatorImpl::SetJitterWindow (Time window)
+{
+  NS_LOG_FUNCTION (this << window);
+  m_jitterWindow = window;
+}
+
+Time
+RealtimeSimulatorImpl::GetJitterWindow (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_jitterWindow;
+}
+
 } // namespace ns3
@@ -30,8 +30,11 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "nstime.h"
+#include "traced-callback.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -82,8 +85,30 @@ public:
      * \see SetHardLimit
      */
     SYNC_HARD_LIMIT,
+    /**
+     * Trade some precision for fewer wakeups.
+     *
+     * After each wait, run every event due within the jitter window
+     * configured with SetJitterWindow, so that events closer together
+     * than the window share a single wakeup, and events may run up to
+     * the window ahead of real time.  Where timerfd is available, wait
+     * on a TimerFdSynchronizer instead of spinning.  The lateness of the
+     * events is reported by the Lateness trace source.
+     * \see SetJitterWindow
+     */
+    SYNC_ADAPTIVE,
   };
 
+  /**
+   * TracedCallback signature for the lateness statistics of the
+   * events run in SynchronizationMode SYNC_ADAPTIVE.
+   *
+   * \param [in] p50 The median lateness over the last interval.
+   * \param [in] p99 The 99th percentile of the lateness over the last interval.
+   * \param [in] max The largest lateness over the last interval.
+   */
+  typedef void (* LatenessTracedCallback)(Time p50, Time p99, Time max);
+
   /** Constructor. */
   RealtimeSimulatorImpl ();
   /** Destructor. */
@@ -156,6 +181,20 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Set the jitter window of SynchronizationMode SYNC_ADAPTIVE.
+   *
+   * \param [in] window The amount of time ahead of real time an event
+   *     may run in order to share the wakeup of an earlier event.
+   */
+  void SetJitterWindow (Time window);
+  /**
+   * Get the jitter window of SynchronizationMode SYNC_ADAPTIVE.
+   *
+   * \returns The jitter window.
+   */
+  Time GetJitterWindow (void) const;
+
 private:
   /**
    * Is the simulator running?
@@ -174,6 +213,41 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Wait for the next event, then process every event due within the
+   * jitter window, in SynchronizationMode SYNC_ADAPTIVE.
+   */
+  void ProcessEventBatch (void);
+  /**
+   * Get the real time at which to schedule an event from another thread.
+   *
+   * In SynchronizationMode SYNC_ADAPTIVE the simulation time may be ahead
+   * of real time by up to the jitter window; the event must not be
+   * scheduled in the past.  Should be called with the critical section
+   * locked.
+   *
+   * \returns The larger of the current real time and the current
+   *          simulation time.
+   */
+  uint64_t GetRealtimeTs (void) const;
+  /**
+   * Add the lateness of an event to the statistics of the current interval.
+   *
+   * \param [in] lateness The lateness of the event, in time steps.
+   */
+  void RecordLateness (uint64_t lateness);
+  /**
+   * Get a percentile of the lateness over the current interval.
+   *
+   * \param [in] percentile The percentile, between 0 and 100.
+   * \returns The lateness, in time steps.
+   */
+  uint64_t GetLatenessPercentile (double percentile) const;
+  /**
+   * Fire the Lateness trace with the statistics of the current interval,
+   * and start a new interval.
+   */
+  void ReportLateness (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -197,9 +271,9 @@ private:
   /**< Number of events in the event list. */
   int m_unscheduledEvents;
   /**< Unique id for the next event to be scheduled. */
-  uint32_t m_uid;
+  uint64_t m_uid;
   /**< Unique id of the current event. */
-  uint32_t m_currentUid;
+  uint64_t m_currentUid;
   /**< Timestep of the current event. */
   uint64_t m_currentTs;
   /**< Execution context. */
@@ -220,6 +294,24 @@ private:
   /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
   Time m_hardLimit;
 
+  /** The jitter window of SYNC_ADAPTIVE mode. */
+  Time m_jitterWindow;
+  /** The real time between two reports of the lateness statistics. */
+  Time m_latenessInterval;
+  /** The real time of the next report of the lateness statistics. */
+  uint64_t m_nextLatenessReport;
+  /**
+   * Log-linear histogram of the lateness of the events of the current
+   * interval: 16 buckets per power of two, within about 3% of the value.
+   */
+  std::vector<uint32_t> m_latenessBuckets;
+  /** The number of events of the current interval. */
+  uint64_t m_latenessCount;
+  /** The largest lateness of the current interval. */
+  uint64_t m_latenessMax;
+  /** Lateness statistics of SYNC_ADAPTIVE mode. */
+  TracedCallback<Time, Time, Time> m_latenessTrace;
+
   /** Main SystemThread. */
   SystemThread::ThreadId m_main;
 };
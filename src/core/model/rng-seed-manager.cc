@@ -23,6 +23,7 @@
 #include "uinteger.h"
 #include "config.h"
 #include "log.h"
+#include "ensemble-runner.h"
 
 /**
  * \file
@@ -40,6 +41,18 @@ NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
  * for automatic assignment.
  */
 static uint64_t g_nextStreamIndex = 0;
+/**
+ * \relates RngSeedManager
+ * The seed, run and next stream index of the replication run by the
+ * calling thread of an EnsembleRunner, which replace RngSeed, RngRun
+ * and g_nextStreamIndex in this thread.
+ */
+static thread_local struct
+{
+  uint32_t seed;            //!< The seed of the replication.
+  uint64_t run;             //!< The run of the replication.
+  uint64_t nextStreamIndex; //!< The next stream index of the replication.
+} g_replication = { 1, 1, 0 };
 /**
  * \relates RngSeedManager
  * \anchor GlobalValueRngSeed
@@ -73,6 +86,10 @@ static ns3::GlobalValue g_rngRun ("RngRun",
 uint32_t RngSeedManager::GetSeed (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return g_replication.seed;
+    }
   UintegerValue seedValue;
   g_rngSeed.GetValue (seedValue);
   return static_cast<uint32_t> (seedValue.Get ());
@@ -81,18 +98,32 @@ void
 RngSeedManager::SetSeed (uint32_t seed)
 {
   NS_LOG_FUNCTION (seed);
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      g_replication.seed = seed;
+      return;
+    }
   Config::SetGlobal ("RngSeed", UintegerValue (seed));
 }
 
 void RngSeedManager::SetRun (uint64_t run)
 {
   NS_LOG_FUNCTION (run);
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      g_replication.run = run;
+      return;
+    }
   Config::SetGlobal ("RngRun", UintegerValue (run));
 }
 
 uint64_t RngSeedManager::GetRun ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return g_replication.run;
+    }
   UintegerValue value;
   g_rngRun.GetValue (value);
   uint64_t run = value.Get ();
@@ -102,9 +133,25 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return g_replication.nextStreamIndex++;
+    }
   uint64_t next = g_nextStreamIndex;
   g_nextStreamIndex++;
   return next;
 }
 
+void
+RngSeedManager::ResetNextStreamIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      g_replication.nextStreamIndex = 0;
+      return;
+    }
+  g_nextStreamIndex = 0;
+}
+
 } // namespace ns3
@@ -105,6 +105,15 @@ public:
    */
   static uint64_t GetNextStreamIndex (void);
 
+  /**
+   * Restart the automatic assignment of stream indices from 0.
+   *
+   * This is used to start a new replication in the same thread, so that
+   * its streams are the same as if it were the first simulation of the
+   * program.
+   */
+  static void ResetNextStreamIndex (void);
+
 };
 
 /** Alias for compatibility. */
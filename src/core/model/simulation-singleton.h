@@ -99,6 +99,7 @@ private:
  ********************************************************************/
 
 #include "simulator.h"
+#include "ensemble-runner.h"
 
 namespace ns3 {
 
@@ -115,12 +116,15 @@ T **
 SimulationSingleton<T>::GetObject (void)
 {
   static T *pobject = 0;
-  if (pobject == 0)
+  // The threads of an EnsembleRunner each run their own simulation.
+  static thread_local T *replicationObject = 0;
+  T **ppobject = EnsembleRunner::IsReplicationThread () ? &replicationObject : &pobject;
+  if (*ppobject == 0)
     {
-      pobject = new T ();
+      *ppobject = new T ();
       Simulator::ScheduleDestroy (&SimulationSingleton<T>::DeleteObject);
     }
-  return &pobject;
+  return ppobject;
 }
 
 template <typename T>
@@ -42,4 +42,10 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+EventId
+SimulatorImpl::ScheduleTimer (const Time &delay, EventImpl *event)
+{
+  return Schedule (delay, event);
+}
+
 } // namespace ns3
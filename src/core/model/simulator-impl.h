@@ -65,6 +65,14 @@ public:
   virtual void Stop (const Time &delay) = 0;
   /** \copydoc Simulator::Schedule(const Time&,const Ptr<EventImpl>&) */
   virtual EventId Schedule (const Time &delay, EventImpl *event) = 0;
+  /**
+   * Schedule a timer, which is likely to be cancelled before it expires.
+   *
+   * The default implementation calls Schedule().
+   *
+   * \copydetails Simulator::Schedule(const Time&,const Ptr<EventImpl>&)
+   */
+  virtual EventId ScheduleTimer (const Time &delay, EventImpl *event);
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
@@ -24,6 +24,7 @@
 #include "map-scheduler.h"
 #include "event-impl.h"
 #include "des-metrics.h"
+#include "ensemble-runner.h"
 
 #include "ptr.h"
 #include "string.h"
@@ -83,9 +84,15 @@ static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
  * \brief Get the static SimulatorImpl instance.
  * \return The SimulatorImpl instance pointer.
  */
-static SimulatorImpl ** PeekImpl (void)
+static inline SimulatorImpl ** PeekImpl (void)
 {
   static SimulatorImpl *impl = 0;
+  // The threads of an EnsembleRunner each run their own simulation.
+  static thread_local SimulatorImpl *replicationImpl = 0;
+  if (EnsembleRunner::IsReplicationThread ())
+    {
+      return &replicationImpl;
+    }
   return &impl;
 }
 
@@ -240,6 +247,14 @@ Simulator::DoSchedule (Time const &time, EventImpl *impl)
   return GetImpl ()->Schedule (time, impl);
 }
 EventId
+Simulator::DoScheduleTimer (Time const &time, EventImpl *impl)
+{
+#ifdef ENABLE_DES_METRICS
+  DesMetrics::Get ()->Trace (Now (), time);
+#endif
+  return GetImpl ()->ScheduleTimer (time, impl);
+}
+EventId
 Simulator::DoScheduleNow (EventImpl *impl)
 {
 #ifdef ENABLE_DES_METRICS
@@ -1293,6 +1293,24 @@ public:
    */
   static EventId Schedule (const Time &delay, const Ptr<EventImpl> &event);
 
+  /**
+   * Schedule a timer: an event which is likely to be cancelled before
+   * it expires, such as a protocol retransmission timeout.
+   *
+   * The timer runs exactly as if it had been scheduled with Schedule(),
+   * but the simulator implementation may keep it apart from the other
+   * events, where cancelling it is cheap: DefaultSimulatorImpl keeps
+   * the timers in a TimerWheel until they are due.
+   *
+   * @tparam Ts @deduced The types of the arguments of MakeEvent().
+   * @param [in] delay Delay until the timer expires.
+   * @param [in] args The method or function to invoke, with its
+   *             arguments, as for MakeEvent().
+   * @returns A unique identifier for the newly-scheduled timer.
+   */
+  template <typename... Ts>
+  static EventId ScheduleTimer (const Time &delay, Ts... args);
+
   /**
    * Schedule a future event execution (in a different context).
    * This method is thread-safe: it can be called from any thread.
@@ -1343,6 +1361,13 @@ private:
    * @return The EventId.
    */
   static EventId DoSchedule (Time const &delay, EventImpl *event);
+  /**
+   * Implementation of the ScheduleTimer methods.
+   * @param [in] delay Delay until the timer should expire.
+   * @param [in] event The event to execute.
+   * @return The EventId.
+   */
+  static EventId DoScheduleTimer (Time const &delay, EventImpl *event);
   /**
    * Implementation of the various ScheduleNow methods.
    * @param [in] event The event to execute.
@@ -1479,6 +1504,12 @@ EventId Simulator::Schedule (Time const &time, void (*f)(U1,U2,U3,U4,U5,U6), T1
   return DoSchedule (time, MakeEvent (f, a1, a2, a3, a4, a5, a6));
 }
 
+template <typename... Ts>
+EventId Simulator::ScheduleTimer (Time const &delay, Ts... args)
+{
+  return DoScheduleTimer (delay, MakeEvent (args...));
+}
+
 
 template <typename MEM, typename OBJ>
 void Simulator::ScheduleWithContext (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj)
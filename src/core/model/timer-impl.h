@@ -270,7 +270,7 @@ MakeTimerImpl (IntToType<0>, FN fn)
     {}
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn);
+      return Simulator::ScheduleTimer (delay, m_fn);
     }
     virtual void Invoke (void)
     {
@@ -304,7 +304,7 @@ MakeTimerImpl (IntToType<1>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1);
     }
     virtual void Invoke (void)
     {
@@ -343,7 +343,7 @@ MakeTimerImpl (IntToType<2>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1, m_a2);
     }
     virtual void Invoke (void)
     {
@@ -387,7 +387,7 @@ MakeTimerImpl (IntToType<3>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1, m_a2, m_a3);
     }
     virtual void Invoke (void)
     {
@@ -436,7 +436,7 @@ MakeTimerImpl (IntToType<4>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1, m_a2, m_a3, m_a4);
     }
     virtual void Invoke (void)
     {
@@ -490,7 +490,7 @@ MakeTimerImpl (IntToType<5>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
     virtual void Invoke (void)
     {
@@ -549,7 +549,7 @@ MakeTimerImpl (IntToType<6>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+      return Simulator::ScheduleTimer (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
     virtual void Invoke (void)
     {
@@ -638,7 +638,7 @@ MakeTimerImpl (IntToType<0>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {}
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr);
     }
     virtual void Invoke (void)
     {
@@ -674,7 +674,7 @@ MakeTimerImpl (IntToType<1>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1);
     }
     virtual void Invoke (void)
     {
@@ -715,7 +715,7 @@ MakeTimerImpl (IntToType<2>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1, m_a2);
     }
     virtual void Invoke (void)
     {
@@ -761,7 +761,7 @@ MakeTimerImpl (IntToType<3>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
     }
     virtual void Invoke (void)
     {
@@ -812,7 +812,7 @@ MakeTimerImpl (IntToType<4>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
     }
     virtual void Invoke (void)
     {
@@ -868,7 +868,7 @@ MakeTimerImpl (IntToType<5>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
     virtual void Invoke (void)
     {
@@ -929,7 +929,7 @@ MakeTimerImpl (IntToType<6>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+      return Simulator::ScheduleTimer (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
     virtual void Invoke (void)
     {
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "timer-wheel.h"
+#include "assert.h"
+#include "log.h"
+#include "event-impl.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+TimerWheel::TimerWheel ()
+  : m_overflowMin (std::numeric_limits<uint64_t>::max ()),
+    m_cursor (0),
+    m_resolution (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t l = 0; l < LEVELS; ++l)
+    {
+      m_bitmap[l] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_size == 0);
+}
+
+void
+TimerWheel::SetResolution (uint64_t resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  NS_ASSERT_MSG (m_size == 0, "Cannot change the resolution of a TimerWheel in use");
+  m_resolution = resolution;
+  m_cursor = 0;
+}
+
+uint64_t
+TimerWheel::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+bool
+TimerWheel::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+uint32_t
+TimerWheel::Locate (uint64_t tick, uint32_t &level) const
+{
+  NS_ASSERT (tick > m_cursor);
+  // the lowest level whose slots separate the timer from the cursor
+  for (level = 0; level < LEVELS; ++level)
+    {
+      uint32_t shift = BITS * (level + 1);
+      if ((tick >> shift) == (m_cursor >> shift))
+        {
+          return (tick >> (BITS * level)) & (SLOTS - 1);
+        }
+    }
+  return 0;
+}
+
+void
+TimerWheel::Append (Slot &slot, const Scheduler::Event &ev)
+{
+  ev.impl->m_timerIndex = slot.size ();
+  slot.push_back (ev);
+}
+
+void
+TimerWheel::Place (const Scheduler::Event &ev, uint64_t tick)
+{
+  uint32_t level;
+  uint32_t slot = Locate (tick, level);
+  if (level == LEVELS)
+    {
+      Append (m_overflow, ev);
+      m_overflowMin = std::min (m_overflowMin, tick);
+      return;
+    }
+  Append (m_slots[level][slot], ev);
+  m_bitmap[level] |= (uint64_t) 1 << slot;
+}
+
+bool
+TimerWheel::Insert (const Scheduler::Event &ev, uint64_t now)
+{
+  if (m_resolution == 0)
+    {
+      return false;
+    }
+  if (m_size == 0)
+    {
+      // nothing depends on the cursor: move it to the present
+      m_cursor = std::max (m_cursor, now / m_resolution);
+    }
+  uint64_t tick = ev.key.m_ts / m_resolution;
+  if (tick <= m_cursor)
+    {
+      return false;
+    }
+  Place (ev, tick);
+  m_size++;
+  return true;
+}
+
+bool
+TimerWheel::Remove (const Scheduler::Event &ev)
+{
+  if (m_size == 0)
+    {
+      return false;
+    }
+  uint64_t tick = ev.key.m_ts / m_resolution;
+  if (tick <= m_cursor)
+    {
+      return false;
+    }
+  uint32_t level;
+  uint32_t index = Locate (tick, level);
+  Slot &slot = (level == LEVELS) ? m_overflow : m_slots[level][index];
+  // the event may be in the Scheduler, with a stale index
+  uint32_t i = ev.impl->m_timerIndex;
+  if (i >= slot.size () || slot[i].impl != ev.impl)
+    {
+      return false;
+    }
+  slot[i] = slot.back ();
+  slot[i].impl->m_timerIndex = i;
+  slot.pop_back ();
+  if (slot.empty ())
+    {
+      if (level < LEVELS)
+        {
+          m_bitmap[level] &= ~((uint64_t) 1 << index);
+        }
+      else
+        {
+          m_overflowMin = std::numeric_limits<uint64_t>::max ();
+        }
+    }
+  // otherwise, m_overflowMin is left as a lower bound of the overflow
+  m_size--;
+  return true;
+}
+
+uint64_t
+TimerWheel::GetNextTick (void) const
+{
+  NS_ASSERT (m_size > 0);
+  uint64_t next = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+      uint32_t shift = BITS * level;
+      uint32_t current = (m_cursor >> shift) & (SLOTS - 1);
+      // the slots after the current one
+      uint64_t later = (current == SLOTS - 1) ? 0 : (m_bitmap[level] & (~(uint64_t) 0 << (current + 1)));
+      if (later != 0)
+        {
+          uint64_t slot = __builtin_ctzll (later);
+          uint64_t block = (m_cursor >> (shift + BITS)) << (shift + BITS);
+          // the slots of a lower level always come first
+          next = block | (slot << shift);
+          break;
+        }
+    }
+  if (!m_overflow.empty ())
+    {
+      uint64_t shift = BITS * LEVELS;
+      uint64_t block = (m_overflowMin >> shift) << shift;
+      next = std::min (next, std::max (block, m_cursor + 1));
+    }
+  return next;
+}
+
+uint64_t
+TimerWheel::GetNextTs (void) const
+{
+  return GetNextTick () * m_resolution;
+}
+
+void
+TimerWheel::Advance (Ptr<Scheduler> scheduler)
+{
+  NS_LOG_FUNCTION (this);
+  m_cursor = GetNextTick ();
+  Slot cascade;
+  if (!m_overflow.empty ()
+      && (m_overflowMin >> (BITS * LEVELS)) == (m_cursor >> (BITS * LEVELS)))
+    {
+      m_overflowMin = std::numeric_limits<uint64_t>::max ();
+      cascade.swap (m_overflow);
+    }
+  // spread the slots the cursor entered over the lower levels, from the
+  // top level down, and move the timers of the current tick
+  for (uint32_t level = LEVELS; level-- > 0; )
+    {
+      uint32_t index = (m_cursor >> (BITS * level)) & (SLOTS - 1);
+      if (m_bitmap[level] & ((uint64_t) 1 << index))
+        {
+          Slot &slot = m_slots[level][index];
+          cascade.insert (cascade.end (), slot.begin (), slot.end ());
+          slot.clear ();
+          m_bitmap[level] &= ~((uint64_t) 1 << index);
+        }
+      for (Slot::const_iterator i = cascade.begin (); i != cascade.end (); ++i)
+        {
+          uint64_t tick = i->key.m_ts / m_resolution;
+          if (tick == m_cursor)
+            {
+              scheduler->Insert (*i);
+              m_size--;
+            }
+          else
+            {
+              Place (*i, tick);
+            }
+        }
+      cascade.clear ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ctime>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "log.h"
+#include "fatal-error.h"
+
+#include "timerfd-synchronizer.h"
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::TimerFdSynchronizer implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerFdSynchronizer");
+
+NS_OBJECT_ENSURE_REGISTERED (TimerFdSynchronizer);
+
+/** Conversion constant between ns and s. */
+static const uint64_t NS_PER_SEC = 1000000000;
+
+TypeId
+TimerFdSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerFdSynchronizer")
+    .SetParent<Synchronizer> ()
+    .SetGroupName ("Core")
+  ;
+  return tid;
+}
+
+TimerFdSynchronizer::TimerFdSynchronizer ()
+  : m_nsEventStart (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (m_timerFd == -1)
+    {
+      NS_FATAL_ERROR ("TimerFdSynchronizer::TimerFdSynchronizer(): timerfd_create() failed: " << std::strerror (errno));
+    }
+  m_eventFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_eventFd == -1)
+    {
+      NS_FATAL_ERROR ("TimerFdSynchronizer::TimerFdSynchronizer(): eventfd() failed: " << std::strerror (errno));
+    }
+}
+
+TimerFdSynchronizer::~TimerFdSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+  close (m_timerFd);
+  close (m_eventFd);
+}
+
+bool
+TimerFdSynchronizer::DoRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+uint64_t
+TimerFdSynchronizer::DoGetCurrentRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime ();
+}
+
+void
+TimerFdSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  // As in the WallClockSynchronizer, the normalized real time counts
+  // from the start of the simulation.
+  m_realtimeOriginNano = GetRealtime ();
+  NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+}
+
+int64_t
+TimerFdSynchronizer::DoGetDrift (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow > ns)
+    {
+      return (int64_t)(nsNow - ns);
+    }
+  else
+    {
+      return -(int64_t)(ns - nsNow);
+    }
+}
+
+bool
+TimerFdSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  //
+  // The deadline is absolute, so there is no drift to correct: if we
+  // are already late, the timer expires at once.
+  //
+  uint64_t deadline = m_realtimeOriginNano + nsCurrent + nsDelay;
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = 0;
+  spec.it_interval.tv_nsec = 0;
+  spec.it_value.tv_sec = static_cast<time_t> (deadline / NS_PER_SEC);
+  spec.it_value.tv_nsec = static_cast<long> (deadline % NS_PER_SEC);
+  if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+    {
+      // An all-zero value would disarm the timer.
+      spec.it_value.tv_nsec = 1;
+    }
+  if (timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &spec, 0) == -1)
+    {
+      NS_FATAL_ERROR ("TimerFdSynchronizer::DoSynchronize(): timerfd_settime() failed: " << std::strerror (errno));
+    }
+
+  struct pollfd fds[2];
+  fds[0].fd = m_eventFd;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_timerFd;
+  fds[1].events = POLLIN;
+  for (;;)
+    {
+      fds[0].revents = 0;
+      fds[1].revents = 0;
+      if (poll (fds, 2, -1) == -1)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("TimerFdSynchronizer::DoSynchronize(): poll() failed: " << std::strerror (errno));
+        }
+      //
+      // A Signal wins over the timer: the simulator must re-evaluate the
+      // head of the event list, which may have changed.  The eventfd is
+      // left set until the next SetCondition (false).
+      //
+      if (fds[0].revents & POLLIN)
+        {
+          NS_LOG_INFO ("Wait interrupted");
+          return false;
+        }
+      if (fds[1].revents & POLLIN)
+        {
+          uint64_t expirations;
+          if (read (m_timerFd, &expirations, sizeof (expirations)) == -1 && errno != EAGAIN)
+            {
+              NS_FATAL_ERROR ("TimerFdSynchronizer::DoSynchronize(): read() failed: " << std::strerror (errno));
+            }
+          return true;
+        }
+    }
+}
+
+void
+TimerFdSynchronizer::DoSignal (void)
+{
+  NS_LOG_FUNCTION (this);
+  DoSetCondition (true);
+}
+
+void
+TimerFdSynchronizer::DoSetCondition (bool cond)
+{
+  NS_LOG_FUNCTION (this << cond);
+  uint64_t value = 1;
+  if (cond)
+    {
+      if (write (m_eventFd, &value, sizeof (value)) == -1 && errno != EAGAIN)
+        {
+          NS_FATAL_ERROR ("TimerFdSynchronizer::DoSetCondition(): write() failed: " << std::strerror (errno));
+        }
+    }
+  else
+    {
+      // Reading resets the counter; EAGAIN means it was already clear.
+      if (read (m_eventFd, &value, sizeof (value)) == -1 && errno != EAGAIN)
+        {
+          NS_FATAL_ERROR ("TimerFdSynchronizer::DoSetCondition(): read() failed: " << std::strerror (errno));
+        }
+    }
+}
+
+void
+TimerFdSynchronizer::DoEventStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nsEventStart = GetNormalizedRealtime ();
+}
+
+uint64_t
+TimerFdSynchronizer::DoEventEnd (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime () - m_nsEventStart;
+}
+
+uint64_t
+TimerFdSynchronizer::GetRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t> (ts.tv_sec) * NS_PER_SEC + ts.tv_nsec;
+}
+
+uint64_t
+TimerFdSynchronizer::GetNormalizedRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetRealtime () - m_realtimeOriginNano;
+}
+
+} // namespace ns3
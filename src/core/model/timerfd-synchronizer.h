@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMERFD_SYNCHRONIZER_H
+#define TIMERFD_SYNCHRONIZER_H
+
+#include "synchronizer.h"
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::TimerFdSynchronizer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup realtime
+ * @brief Class used for synchronizing the simulation events to the
+ * monotonic clock, sleeping on a Linux @c timerfd.
+ *
+ * The WallClockSynchronizer sleeps on a condition variable for whole
+ * jiffies, and then busy-waits for the rest of the delay, which burns
+ * a processor whenever the events are close together.  This synchronizer
+ * instead arms a single @c timerfd, created once, with the absolute
+ * deadline of the next event, and sleeps in @c poll() until either the
+ * timer expires or an @c eventfd is written by Signal().  It never
+ * busy-waits, so each wait costs one system call, at the price of the
+ * timer slack of the kernel (typically 50 &mu;s).
+ *
+ * The RealtimeSimulatorImpl uses this synchronizer in its
+ * SynchronizationMode Adaptive, which also runs all the events due within
+ * a jitter window after a single wakeup.
+ */
+class TimerFdSynchronizer : public Synchronizer
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  TimerFdSynchronizer ();
+  /** Destructor. */
+  virtual ~TimerFdSynchronizer ();
+
+protected:
+  // Inherited from Synchronizer
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual bool DoRealtime (void);
+  virtual uint64_t DoGetCurrentRealtime (void);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual void DoSignal (void);
+  virtual void DoSetCondition (bool cond);
+  virtual int64_t DoGetDrift (uint64_t ns);
+  virtual void DoEventStart (void);
+  virtual uint64_t DoEventEnd (void);
+
+private:
+  /**
+   * @brief Get the current absolute time of the monotonic clock, in ns.
+   *
+   * @returns The current monotonic time, in ns.
+   */
+  uint64_t GetRealtime (void);
+  /**
+   * @brief Get the current normalized real time, in ns.
+   *
+   * @returns The current normalized real time, in ns.
+   */
+  uint64_t GetNormalizedRealtime (void);
+
+  /** The timer armed with the deadline of each wait. */
+  int m_timerFd;
+  /** The event counter written by Signal to interrupt a wait. */
+  int m_eventFd;
+  /** Time recorded by DoEventStart. */
+  uint64_t m_nsEventStart;
+};
+
+} // namespace ns3
+
+#endif /* TIMERFD_SYNCHRONIZER_H */
@@ -206,6 +206,13 @@ public:
   {
     m_cb.Disconnect (cb, path);
   }
+  /**
+   * \returns \c true if no Callback is connected.
+   */
+  bool IsEmpty (void) const
+  {
+    return m_cb.IsEmpty ();
+  }
   /**
    * Set the value of the underlying variable.
    *
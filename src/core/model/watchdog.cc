@@ -56,7 +56,7 @@ Watchdog::Ping (Time delay)
     {
       return;
     }
-  m_event = Simulator::Schedule (m_end - Now (), &Watchdog::Expire, this);
+  m_event = Simulator::ScheduleTimer (m_end - Now (), &Watchdog::Expire, this);
 }
 
 void
@@ -69,7 +69,7 @@ Watchdog::Expire (void)
     }
   else
     {
-      m_event = Simulator::Schedule (m_end - Now (), &Watchdog::Expire, this);
+      m_event = Simulator::ScheduleTimer (m_end - Now (), &Watchdog::Expire, this);
     }
 }
 
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/checkpoint.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+/// Number of branches of the test
+static const uint32_t N_BRANCHES = 3;
+
+class CheckpointForkTestCase : public TestCase
+{
+public:
+  CheckpointForkTestCase ();
+  virtual void DoRun (void);
+  void Step (void);
+  void Sweep (void);
+  void RunSimulation (bool fork);
+
+  Ptr<UniformRandomVariable> m_random;
+  /// Values drawn by the steps, scaled by the branch parameter
+  std::vector<double> m_values;
+  /// Number of steps before the fork
+  uint32_t m_forkStep;
+  double m_scale;
+  uint32_t m_branch;
+};
+
+CheckpointForkTestCase::CheckpointForkTestCase ()
+  : TestCase ("Check that the branches continue from the checkpoint")
+{}
+void
+CheckpointForkTestCase::Step (void)
+{
+  m_values.push_back (m_scale * m_random->GetValue ());
+  if (Simulator::Now () < Seconds (10))
+    {
+      Simulator::Schedule (MilliSeconds (100), &CheckpointForkTestCase::Step, this);
+    }
+}
+void
+CheckpointForkTestCase::Sweep (void)
+{
+  m_forkStep = m_values.size ();
+  m_branch = Checkpoint::Fork (N_BRANCHES);
+  m_scale = m_branch + 1;
+}
+void
+CheckpointForkTestCase::RunSimulation (bool fork)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_values.clear ();
+  m_scale = 1;
+  m_branch = 0;
+  Simulator::Schedule (Seconds (0), &CheckpointForkTestCase::Step, this);
+  if (fork)
+    {
+      Simulator::Schedule (Seconds (5) + MilliSeconds (50), &CheckpointForkTestCase::Sweep, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_random = 0;
+}
+void
+CheckpointForkTestCase::DoRun (void)
+{
+  RunSimulation (false);
+  std::vector<double> reference = m_values;
+
+  RunSimulation (true);
+  bool ok = m_values.size () == reference.size ();
+  for (uint32_t i = 0; ok && i < reference.size (); ++i)
+    {
+      double expected = reference[i] * (i < m_forkStep ? 1 : m_branch + 1);
+      ok = m_values[i] == expected;
+    }
+  if (m_branch != 0)
+    {
+      // do not return to the test runner
+      _exit (ok ? 0 : 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::GetBranch (), 0, "Wrong branch");
+  NS_TEST_EXPECT_MSG_EQ (m_forkStep, 51, "Wrong checkpoint time");
+  NS_TEST_EXPECT_MSG_EQ (ok, true, "Wrong values in the original process");
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), 0, "Wrong values in a branch");
+}
+
+class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ()
+    : TestSuite ("checkpoint")
+  {
+    AddTestCase (new CheckpointForkTestCase (), TestCase::QUICK);
+  }
+} g_checkpointTestSuite;
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/ensemble-runner.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/names.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+
+#include <cmath>
+
+using namespace ns3;
+
+/// Number of replications of the tests
+static const uint32_t N_REPLICATIONS = 6;
+
+/// A simulation-wide counter, to check that SimulationSingleton is per replication
+struct EnsembleCounter
+{
+  EnsembleCounter () : value (0) {}
+  uint32_t value; ///< The number of steps of the simulation
+};
+
+/**
+ * A small simulation: steps at random intervals, each drawing a random
+ * value, with a named object and a SimulationSingleton counter.
+ */
+class EnsembleSimulation
+{
+public:
+  EnsembleSimulation ();
+  /// Draw a value and schedule the next step
+  void Step (void);
+  /**
+   * Run the simulation.
+   * \param run The run number.
+   * \returns The results of the simulation.
+   */
+  EnsembleRunner::Results Run (uint64_t run);
+
+  Ptr<ExponentialRandomVariable> m_interval; ///< Interval between the steps
+  Ptr<UniformRandomVariable> m_value;        ///< Value drawn by the steps
+  double m_sum;                              ///< Sum of the values
+  bool m_namesOk;                            ///< Whether the names were private
+};
+
+EnsembleSimulation::EnsembleSimulation ()
+  : m_sum (0),
+    m_namesOk (true)
+{}
+void
+EnsembleSimulation::Step (void)
+{
+  m_sum += m_value->GetValue ();
+  SimulationSingleton<EnsembleCounter>::Get ()->value++;
+  if (Names::Find<UniformRandomVariable> ("value") != m_value)
+    {
+      m_namesOk = false;
+    }
+  if (Simulator::Now () < Seconds (10))
+    {
+      Simulator::Schedule (Seconds (m_interval->GetValue ()), &EnsembleSimulation::Step, this);
+    }
+}
+EnsembleRunner::Results
+EnsembleSimulation::Run (uint64_t run)
+{
+  m_interval = CreateObject<ExponentialRandomVariable> ();
+  m_interval->SetAttribute ("Mean", DoubleValue (0.01));
+  m_value = CreateObject<UniformRandomVariable> ();
+  Names::Add ("value", m_value);
+  Simulator::Schedule (Seconds (0), &EnsembleSimulation::Step, this);
+  Simulator::Run ();
+  EnsembleRunner::Results results;
+  results["run"] = RngSeedManager::GetRun ();
+  results["sum"] = m_sum;
+  results["steps"] = SimulationSingleton<EnsembleCounter>::Get ()->value;
+  results["end"] = Simulator::Now ().GetSeconds ();
+  results["names"] = m_namesOk;
+  Simulator::Destroy ();
+  return results;
+}
+
+/**
+ * Run a replication.
+ * \param run The run number.
+ * \returns The results of the replication.
+ */
+static EnsembleRunner::Results
+RunReplication (uint64_t run)
+{
+  EnsembleSimulation simulation;
+  return simulation.Run (run);
+}
+
+class EnsembleRunnerSequentialTestCase : public TestCase
+{
+public:
+  EnsembleRunnerSequentialTestCase ();
+  virtual void DoRun (void);
+};
+
+EnsembleRunnerSequentialTestCase::EnsembleRunnerSequentialTestCase ()
+  : TestCase ("Check that the replications match sequential runs")
+{}
+void
+EnsembleRunnerSequentialTestCase::DoRun (void)
+{
+  uint64_t savedRun = RngSeedManager::GetRun ();
+
+  EnsembleRunner runner;
+  runner.SetFirstRun (10);
+  runner.Run (MakeCallback (&RunReplication), N_REPLICATIONS);
+  NS_TEST_ASSERT_MSG_EQ (runner.GetN (), N_REPLICATIONS, "wrong number of replications");
+
+  for (uint32_t i = 0; i < N_REPLICATIONS; ++i)
+    {
+      RngSeedManager::SetRun (10 + i);
+      RngSeedManager::ResetNextStreamIndex ();
+      EnsembleRunner::Results expected = RunReplication (10 + i);
+      Names::Clear ();
+      const EnsembleRunner::Results &results = runner.GetResults (i);
+      NS_TEST_ASSERT_MSG_EQ (runner.GetRun (i), 10 + i, "wrong run number");
+      NS_TEST_ASSERT_MSG_EQ (results.find ("run")->second, 10 + i, "the replication saw the wrong run");
+      NS_TEST_ASSERT_MSG_EQ (results.find ("names")->second, 1, "the replications shared their names");
+      NS_TEST_ASSERT_MSG_EQ ((results == expected), true,
+                             "replication " << i << " differs from a sequential run");
+    }
+  NS_TEST_ASSERT_MSG_NE (runner.GetResults (0).find ("sum")->second,
+                         runner.GetResults (1).find ("sum")->second,
+                         "the replications used the same streams");
+
+  RngSeedManager::SetRun (savedRun);
+  NS_TEST_ASSERT_MSG_EQ (EnsembleRunner::IsReplicationThread (), false,
+                         "the main thread was left as a replication thread");
+}
+
+class EnsembleRunnerThreadsTestCase : public TestCase
+{
+public:
+  EnsembleRunnerThreadsTestCase ();
+  virtual void DoRun (void);
+};
+
+EnsembleRunnerThreadsTestCase::EnsembleRunnerThreadsTestCase ()
+  : TestCase ("Check that the results do not depend on the thread count")
+{}
+void
+EnsembleRunnerThreadsTestCase::DoRun (void)
+{
+  EnsembleRunner single;
+  single.SetThreadCount (1);
+  single.SetFirstRun (3);
+  single.Run (MakeCallback (&RunReplication), N_REPLICATIONS);
+
+  EnsembleRunner pool;
+  pool.SetThreadCount (4);
+  pool.SetFirstRun (3);
+  pool.Run (MakeCallback (&RunReplication), N_REPLICATIONS);
+
+  for (uint32_t i = 0; i < N_REPLICATIONS; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((single.GetResults (i) == pool.GetResults (i)), true,
+                             "replication " << i << " depends on the thread count");
+    }
+}
+
+class EnsembleRunnerSummaryTestCase : public TestCase
+{
+public:
+  EnsembleRunnerSummaryTestCase ();
+  virtual void DoRun (void);
+  /**
+   * A replication which reports its run number.
+   * \param run The run number.
+   * \returns The results of the replication.
+   */
+  static EnsembleRunner::Results Report (uint64_t run);
+};
+
+EnsembleRunnerSummaryTestCase::EnsembleRunnerSummaryTestCase ()
+  : TestCase ("Check the statistics of the metrics")
+{}
+EnsembleRunner::Results
+EnsembleRunnerSummaryTestCase::Report (uint64_t run)
+{
+  EnsembleRunner::Results results;
+  results["run"] = run;
+  if (run % 2 == 0)
+    {
+      results["even"] = run;
+    }
+  return results;
+}
+void
+EnsembleRunnerSummaryTestCase::DoRun (void)
+{
+  EnsembleRunner runner;
+  runner.SetFirstRun (1);
+  runner.Run (MakeCallback (&EnsembleRunnerSummaryTestCase::Report), 5);
+
+  EnsembleRunner::Summary summary = runner.GetSummary ("run");
+  NS_TEST_ASSERT_MSG_EQ (summary.count, 5, "wrong count");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.mean, 3, 1e-12, "wrong mean");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.stddev, std::sqrt (2.5), 1e-12, "wrong standard deviation");
+  NS_TEST_ASSERT_MSG_EQ (summary.min, 1, "wrong minimum");
+  NS_TEST_ASSERT_MSG_EQ (summary.max, 5, "wrong maximum");
+
+  summary = runner.GetSummary ("even");
+  NS_TEST_ASSERT_MSG_EQ (summary.count, 2, "wrong count of a partial metric");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.mean, 3, 1e-12, "wrong mean of a partial metric");
+
+  summary = runner.GetSummary ("missing");
+  NS_TEST_ASSERT_MSG_EQ (summary.count, 0, "wrong count of a missing metric");
+}
+
+class EnsembleRunnerTestSuite : public TestSuite
+{
+public:
+  EnsembleRunnerTestSuite ()
+    : TestSuite ("ensemble-runner")
+  {
+    AddTestCase (new EnsembleRunnerSequentialTestCase (), TestCase::QUICK);
+    AddTestCase (new EnsembleRunnerThreadsTestCase (), TestCase::QUICK);
+    AddTestCase (new EnsembleRunnerSummaryTestCase (), TestCase::QUICK);
+  }
+} g_ensembleRunnerTestSuite;
@@ -0,0 +1,319 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/// Number of contexts of the test topology
+static const uint32_t N_CONTEXTS = 8;
+
+class MultithreadedSimulatorEventsTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorEventsTestCase (uint32_t threads);
+  virtual void DoRun (void);
+  void Hop (uint32_t hops);
+  void Local (void);
+  void CheckWindow (void);
+  void RunTopology (Ptr<SimulatorImpl> impl);
+
+  uint32_t m_threads;
+  /// Events executed in each context, in order, as timestamp * 100 + hops
+  std::vector<std::vector<uint64_t> > m_trace;
+  /// Whether a global event observed a partition event in its future
+  bool m_windowError;
+  /// Identifiers allocated by the Hop events of each context, in order
+  std::vector<std::vector<uint64_t> > m_uids;
+};
+
+MultithreadedSimulatorEventsTestCase::MultithreadedSimulatorEventsTestCase (uint32_t threads)
+  : TestCase ("Check events across partitions with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{}
+
+void
+MultithreadedSimulatorEventsTestCase::Hop (uint32_t hops)
+{
+  uint32_t context = Simulator::GetContext ();
+  m_trace[context].push_back (Simulator::Now ().GetTimeStep () * 100 + hops);
+  m_uids[context].push_back (MultithreadedSimulatorImpl::AllocateUid ());
+  Simulator::Schedule (MicroSeconds (300), &MultithreadedSimulatorEventsTestCase::Local, this);
+  if (hops > 0)
+    {
+      Simulator::ScheduleWithContext ((context + 1) % N_CONTEXTS,
+                                      MilliSeconds (1) + MicroSeconds (context),
+                                      &MultithreadedSimulatorEventsTestCase::Hop, this, hops - 1);
+      Simulator::ScheduleWithContext ((context + 3) % N_CONTEXTS,
+                                      MilliSeconds (2),
+                                      &MultithreadedSimulatorEventsTestCase::Hop, this, hops / 2);
+    }
+}
+
+void
+MultithreadedSimulatorEventsTestCase::Local (void)
+{
+  m_trace[Simulator::GetContext ()].push_back (Simulator::Now ().GetTimeStep () * 100 + 99);
+}
+
+void
+MultithreadedSimulatorEventsTestCase::CheckWindow (void)
+{
+  // global events run while the partitions are paused, never ahead of them
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      for (std::vector<uint64_t>::const_iterator j = m_trace[i].begin (); j != m_trace[i].end (); ++j)
+        {
+          if (*j / 100 >= now)
+            {
+              m_windowError = true;
+            }
+        }
+    }
+}
+
+void
+MultithreadedSimulatorEventsTestCase::RunTopology (Ptr<SimulatorImpl> impl)
+{
+  m_trace.assign (N_CONTEXTS, std::vector<uint64_t> ());
+  m_uids.assign (N_CONTEXTS, std::vector<uint64_t> ());
+  m_windowError = false;
+  Simulator::SetImplementation (impl);
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (10 * i),
+                                      &MultithreadedSimulatorEventsTestCase::Hop, this, 6);
+    }
+  Simulator::Schedule (MicroSeconds (3500), &MultithreadedSimulatorEventsTestCase::CheckWindow, this);
+  Simulator::Schedule (MicroSeconds (7250), &MultithreadedSimulatorEventsTestCase::CheckWindow, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorEventsTestCase::DoRun (void)
+{
+  RunTopology (CreateObject<DefaultSimulatorImpl> ());
+  std::vector<std::vector<uint64_t> > expected = m_trace;
+
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("Lookahead", TimeValue (MilliSeconds (1)));
+  RunTopology (factory.Create<SimulatorImpl> ());
+  NS_TEST_EXPECT_MSG_EQ (m_windowError, false, "Global event ran ahead of a partition");
+  std::vector<std::vector<uint64_t> > first = m_trace;
+  std::vector<std::vector<uint64_t> > firstUids = m_uids;
+
+  // the order of the events of a context, including among the events of
+  // equal timestamps, is the same in every run with the same thread count
+  RunTopology (factory.Create<SimulatorImpl> ());
+  NS_TEST_EXPECT_MSG_EQ (m_windowError, false, "Global event ran ahead of a partition");
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_trace[i] == first[i]), true, "Nondeterministic event order in context " << i);
+      NS_TEST_EXPECT_MSG_EQ ((m_uids[i] == firstUids[i]), true, "Nondeterministic identifiers in context " << i);
+    }
+
+  // each partition allocates distinct identifiers, marked with its index
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      for (std::vector<uint64_t>::const_iterator j = m_uids[i].begin (); j != m_uids[i].end (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ ((*j >> MultithreadedSimulatorImpl::UID_BITS), i % m_threads + 1,
+                                 "Wrong partition of an identifier of context " << i);
+          uids.push_back (*j);
+        }
+    }
+  std::sort (uids.begin (), uids.end ());
+  NS_TEST_EXPECT_MSG_EQ ((std::adjacent_find (uids.begin (), uids.end ()) == uids.end ()), true,
+                         "Identifiers allocated twice");
+
+  // the events of equal timestamps may be ordered differently than with
+  // DefaultSimulatorImpl, but the same events are run at the same times
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      std::sort (m_trace[i].begin (), m_trace[i].end ());
+      std::sort (expected[i].begin (), expected[i].end ());
+      NS_TEST_EXPECT_MSG_EQ (m_trace[i].size (), expected[i].size (), "Wrong number of events in context " << i);
+      NS_TEST_EXPECT_MSG_EQ ((m_trace[i] == expected[i]), true, "Wrong event times in context " << i);
+    }
+}
+
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase (uint32_t threads);
+  virtual void DoRun (void);
+  void Tick (void);
+
+  uint32_t m_threads;
+  /// Number of ticks per context
+  std::vector<uint32_t> m_ticks;
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase (uint32_t threads)
+  : TestCase ("Check Stop and Now across partitions with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{}
+
+void
+MultithreadedSimulatorStopTestCase::Tick (void)
+{
+  m_ticks[Simulator::GetContext ()]++;
+  Simulator::Schedule (MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Tick, this);
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("Lookahead", TimeValue (MicroSeconds (100)));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+  NS_TEST_ASSERT_MSG_EQ (impl->GetPartitionCount (), m_threads, "Wrong number of partitions");
+
+  m_ticks.assign (N_CONTEXTS, 0);
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      impl->SetPartition (i, (N_CONTEXTS - 1 - i) % m_threads);
+      Simulator::ScheduleWithContext (i, Seconds (0), &MultithreadedSimulatorStopTestCase::Tick, this);
+    }
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (0), (N_CONTEXTS - 1) % m_threads, "Wrong partition");
+  Simulator::Stop (MicroSeconds (10500));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MicroSeconds (10500), "Wrong stop time");
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_ticks[i], 11, "Wrong number of ticks in context " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 8 * 11 + 1, "Wrong event count");
+  NS_TEST_EXPECT_MSG_GT (impl->GetWindowCount (), 0, "No window was run");
+  Simulator::Destroy ();
+}
+
+class MultithreadedSimulatorRepartitionTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorRepartitionTestCase (uint32_t threads);
+  virtual void DoRun (void);
+  void Start (void);
+  void Fire (void);
+
+  uint32_t m_threads;
+  /// The event scheduled by Start in each context
+  std::vector<EventId> m_ids;
+  /// Whether the event of each context was run
+  std::vector<bool> m_fired;
+};
+
+MultithreadedSimulatorRepartitionTestCase::MultithreadedSimulatorRepartitionTestCase (uint32_t threads)
+  : TestCase ("Check the EventIds of events moved by SetPartition with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{}
+
+void
+MultithreadedSimulatorRepartitionTestCase::Start (void)
+{
+  m_ids[Simulator::GetContext ()] = Simulator::Schedule (MilliSeconds (10), &MultithreadedSimulatorRepartitionTestCase::Fire, this);
+}
+
+void
+MultithreadedSimulatorRepartitionTestCase::Fire (void)
+{
+  m_fired[Simulator::GetContext ()] = true;
+}
+
+void
+MultithreadedSimulatorRepartitionTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("Lookahead", TimeValue (MicroSeconds (100)));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  m_ids.assign (N_CONTEXTS, EventId ());
+  m_fired.assign (N_CONTEXTS, false);
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MilliSeconds (i), &MultithreadedSimulatorRepartitionTestCase::Start, this);
+    }
+  Simulator::Stop (MilliSeconds (N_CONTEXTS));
+  Simulator::Run ();
+
+  // move every context, with its pending event, to another partition
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      impl->SetPartition (i, (impl->GetPartition (i) + 1) % m_threads);
+    }
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (m_ids[i]), false, "Moved event of context " << i << " expired");
+      NS_TEST_EXPECT_MSG_EQ (Simulator::GetDelayLeft (m_ids[i]), MilliSeconds (i + 10) - Simulator::Now (),
+                             "Wrong delay of the moved event of context " << i);
+    }
+  Simulator::Cancel (m_ids[0]);
+  Simulator::Remove (m_ids[1]);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (m_ids[0]), true, "Cancelled event not expired");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (m_ids[1]), true, "Removed event not expired");
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_fired[i], (i > 1), "Wrong execution of the moved event of context " << i);
+      NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (m_ids[i]), true, "Event of context " << i << " not expired");
+    }
+  Simulator::Destroy ();
+}
+
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    uint32_t threadcounts[] = {
+      1,
+#ifdef NS3_MTP
+      2,
+      3,
+      8
+#endif
+    };
+    for (unsigned int i = 0; i < (sizeof(threadcounts) / sizeof(threadcounts[0])); ++i)
+      {
+        AddTestCase (new MultithreadedSimulatorEventsTestCase (threadcounts[i]), TestCase::QUICK);
+        AddTestCase (new MultithreadedSimulatorStopTestCase (threadcounts[i]), TestCase::QUICK);
+        AddTestCase (new MultithreadedSimulatorRepartitionTestCase (threadcounts[i]), TestCase::QUICK);
+      }
+  }
+} g_multithreadedSimulatorTestSuite;
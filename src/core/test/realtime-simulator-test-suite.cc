@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+
+#include <chrono>  // milliseconds
+#include <thread>  // sleep_for
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ * \ingroup tests
+ *
+ * \brief Check that SynchronizationMode Adaptive runs every event at its
+ * time, at most the jitter window ahead of real time, and reports the
+ * lateness statistics.
+ */
+class RealtimeAdaptiveTestCase : public TestCase
+{
+public:
+  RealtimeAdaptiveTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Check an event.
+   * \param [in] expected The expected simulation time of the event.
+   */
+  void Event (Time expected);
+  /**
+   * Sink of the Lateness trace source.
+   * \param [in] p50 The median lateness.
+   * \param [in] p99 The 99th percentile of the lateness.
+   * \param [in] max The largest lateness.
+   */
+  void Lateness (Time p50, Time p99, Time max);
+
+  Ptr<RealtimeSimulatorImpl> m_impl; ///< The simulator
+  uint32_t m_events;                 ///< Number of events run
+  bool m_onTime;                     ///< Whether each event ran at its time
+  bool m_early;                      ///< Whether an event ran too far ahead
+  uint32_t m_reports;                ///< Number of lateness reports
+  bool m_ordered;                    ///< Whether p50 <= p99 <= max
+};
+
+/** The jitter window of the test. */
+static const Time JITTER_WINDOW = MilliSeconds (2);
+
+RealtimeAdaptiveTestCase::RealtimeAdaptiveTestCase ()
+  : TestCase ("Check SynchronizationMode Adaptive")
+{}
+void
+RealtimeAdaptiveTestCase::Event (Time expected)
+{
+  m_events++;
+  if (Simulator::Now () != expected)
+    {
+      m_onTime = false;
+    }
+  if (Simulator::Now () > m_impl->RealtimeNow () + JITTER_WINDOW)
+    {
+      m_early = true;
+    }
+}
+void
+RealtimeAdaptiveTestCase::Lateness (Time p50, Time p99, Time max)
+{
+  m_reports++;
+  if (p50 > p99 || p99 > max)
+    {
+      m_ordered = false;
+    }
+}
+void
+RealtimeAdaptiveTestCase::DoRun (void)
+{
+  m_events = 0;
+  m_onTime = true;
+  m_early = false;
+  m_reports = 0;
+  m_ordered = true;
+  m_impl = CreateObject<RealtimeSimulatorImpl> ();
+  m_impl->SetAttribute ("SynchronizationMode", EnumValue (RealtimeSimulatorImpl::SYNC_ADAPTIVE));
+  m_impl->SetAttribute ("JitterWindow", TimeValue (JITTER_WINDOW));
+  m_impl->SetAttribute ("LatenessInterval", TimeValue (MilliSeconds (20)));
+  m_impl->TraceConnectWithoutContext ("Lateness", MakeCallback (&RealtimeAdaptiveTestCase::Lateness, this));
+  Simulator::SetImplementation (m_impl);
+
+  // Bursts of events 100 us apart, separated by gaps longer than the window
+  for (uint32_t burst = 0; burst < 10; ++burst)
+    {
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          Time t = MilliSeconds (10 * burst) + MicroSeconds (100 * i);
+          Simulator::Schedule (t, &RealtimeAdaptiveTestCase::Event, this, t);
+        }
+    }
+  // The realtime simulator waits for events from other threads until stopped
+  Simulator::Stop (MilliSeconds (95));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+  m_impl = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (m_events, 100, "Lost events");
+  NS_TEST_ASSERT_MSG_EQ (m_onTime, true, "An event ran at the wrong simulation time");
+  NS_TEST_ASSERT_MSG_EQ (m_early, false, "An event ran more than the jitter window ahead of real time");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (elapsed, 88, "The simulation did not wait for real time");
+  NS_TEST_ASSERT_MSG_GT (m_reports, 0, "No lateness report");
+  NS_TEST_ASSERT_MSG_EQ (m_ordered, true, "Lateness percentiles out of order");
+}
+
+/**
+ * \ingroup core-tests
+ * \ingroup tests
+ *
+ * \brief Check that an event scheduled by another thread interrupts the
+ * wait of SynchronizationMode Adaptive.
+ */
+class RealtimeAdaptiveSignalTestCase : public TestCase
+{
+public:
+  RealtimeAdaptiveSignalTestCase ();
+  virtual void DoRun (void);
+  /** Schedule a stop from another thread. */
+  void SchedulingThread (void);
+};
+
+RealtimeAdaptiveSignalTestCase::RealtimeAdaptiveSignalTestCase ()
+  : TestCase ("Check that SynchronizationMode Adaptive wakes up for events of other threads")
+{}
+void
+RealtimeAdaptiveSignalTestCase::SchedulingThread (void)
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  Simulator::ScheduleWithContext (0, Seconds (0), &Simulator::Stop);
+}
+void
+RealtimeAdaptiveSignalTestCase::DoRun (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = CreateObject<RealtimeSimulatorImpl> ();
+  impl->SetAttribute ("SynchronizationMode", EnumValue (RealtimeSimulatorImpl::SYNC_ADAPTIVE));
+  Simulator::SetImplementation (impl);
+
+  // The simulator sleeps until this event, unless interrupted.
+  Simulator::Schedule (Seconds (30), &Simulator::Stop);
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&RealtimeAdaptiveSignalTestCase::SchedulingThread, this));
+  SystemWallClockMs clock;
+  clock.Start ();
+  thread->Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  thread->Join ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_LT (elapsed, 10000, "The wait was not interrupted");
+}
+
+/**
+ * \ingroup core-tests
+ * \ingroup tests
+ *
+ * \brief RealtimeSimulatorImpl TestSuite
+ */
+class RealtimeSimulatorTestSuite : public TestSuite
+{
+public:
+  RealtimeSimulatorTestSuite ()
+    : TestSuite ("realtime-simulator")
+  {
+    AddTestCase (new RealtimeAdaptiveTestCase (), TestCase::QUICK);
+    AddTestCase (new RealtimeAdaptiveSignalTestCase (), TestCase::QUICK);
+  }
+};
+
+static RealtimeSimulatorTestSuite g_realtimeSimulatorTestSuite; //!< Static variable for test initialization
@@ -24,6 +24,18 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/object.h"
+
+#include <fstream>
+#include <map>
+#include <vector>
+#include <utility>
 
 using namespace ns3;
 
@@ -465,6 +477,361 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  uint32_t Random (uint32_t max);
+  void Insert (uint64_t ts);
+  void Check (Scheduler::Event a, Scheduler::Event b);
+  ObjectFactory m_schedulerFactory;
+  Ptr<Scheduler> m_scheduler;
+  Ptr<Scheduler> m_reference;
+  std::map<uint64_t, Scheduler::Event> m_pending;
+  uint64_t m_uid;
+  uint32_t m_random;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of many events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{}
+uint32_t
+SchedulerOrderTestCase::Random (uint32_t max)
+{
+  // deterministic linear congruential generator
+  m_random = m_random * 1103515245 + 12345;
+  return (m_random >> 8) % max;
+}
+void
+SchedulerOrderTestCase::Insert (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  m_scheduler->Insert (ev);
+  m_reference->Insert (ev);
+  m_pending[ev.key.m_uid] = ev;
+}
+void
+SchedulerOrderTestCase::Check (Scheduler::Event a, Scheduler::Event b)
+{
+  NS_TEST_ASSERT_MSG_EQ (a.key.m_ts, b.key.m_ts, "Wrong event time stamp");
+  NS_TEST_ASSERT_MSG_EQ (a.key.m_uid, b.key.m_uid, "Wrong event order");
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_scheduler = m_schedulerFactory.Create<Scheduler> ();
+  m_reference = CreateObject<MapScheduler> ();
+  m_uid = 4;
+  m_random = 1;
+  uint64_t now = 0;
+  // a hold model with bursts of simultaneous events, far future
+  // events and removals
+  for (uint32_t i = 0; i < 3000; ++i)
+    {
+      Insert (now + Random (1000));
+    }
+  for (uint32_t i = 0; i < 100000; ++i)
+    {
+      uint32_t op = Random (100);
+      if (op < 40)
+        {
+          Insert (now + Random (1000));
+        }
+      else if (op < 41)
+        {
+          uint64_t ts = now + Random (10);
+          for (uint32_t j = Random (100); j > 0; --j)
+            {
+              Insert (ts);
+            }
+        }
+      else if (op < 42)
+        {
+          Insert (now + 1000000 + Random (1000000));
+        }
+      else if (op < 46)
+        {
+          std::map<uint64_t, Scheduler::Event>::iterator j = m_pending.lower_bound (4 + Random (m_uid - 4));
+          if (j != m_pending.end ())
+            {
+              m_scheduler->Remove (j->second);
+              m_reference->Remove (j->second);
+              m_pending.erase (j);
+            }
+        }
+      else if (!m_reference->IsEmpty ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), false, "Scheduler is empty");
+          Check (m_scheduler->PeekNext (), m_reference->PeekNext ());
+          Scheduler::Event ev = m_scheduler->RemoveNext ();
+          Check (ev, m_reference->RemoveNext ());
+          now = ev.key.m_ts;
+          m_pending.erase (ev.key.m_uid);
+        }
+    }
+  while (!m_reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), false, "Scheduler is empty");
+      Check (m_scheduler->RemoveNext (), m_reference->RemoveNext ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), true, "Scheduler is not empty");
+  m_scheduler = 0;
+  m_reference = 0;
+  m_pending.clear ();
+}
+
+class EventImplPoolTestCase : public TestCase
+{
+public:
+  EventImplPoolTestCase ();
+  virtual void DoRun (void);
+  void Chain (uint32_t left, uint64_t a, uint64_t b);
+};
+
+EventImplPoolTestCase::EventImplPoolTestCase ()
+  : TestCase ("Check that the memory of the events is recycled")
+{}
+void
+EventImplPoolTestCase::Chain (uint32_t left, uint64_t a, uint64_t b)
+{
+  if (left > 0)
+    {
+      Simulator::Schedule (NanoSeconds (1), &EventImplPoolTestCase::Chain, this, left - 1, a, b);
+    }
+}
+void
+EventImplPoolTestCase::DoRun (void)
+{
+  BooleanValue enabled;
+  GlobalValue::GetValueByName ("EventImplPool", enabled);
+
+  EventImpl::ResetPoolStats ();
+  Simulator::Schedule (NanoSeconds (1), &EventImplPoolTestCase::Chain, this, 1000, 1, 2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats stats = EventImpl::GetPoolStats ();
+
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.allocations, 1001, "Events not counted");
+  NS_TEST_EXPECT_MSG_EQ (stats.deallocations, stats.allocations, "Events not released");
+  if (enabled.Get ())
+    {
+      // an event is released after it schedules the next one, so only
+      // the first two events of the chain can miss
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.hits, 999, "Events not recycled");
+      NS_TEST_EXPECT_MSG_GT (stats.cached, 0, "No free block");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (stats.hits, 0, "Events recycled while disabled");
+    }
+}
+
+class TimerWheelTestCase : public TestCase
+{
+public:
+  TimerWheelTestCase ();
+  virtual void DoRun (void);
+  uint32_t Random (uint32_t max);
+  Time RandomDelay (void);
+  void Step (uint32_t left);
+  void Expire (uint32_t label);
+  void RunSimulation (Time resolution);
+
+  /// Labels of the events run, with their time
+  std::vector<std::pair<uint64_t, uint32_t> > m_trace;
+  std::vector<EventId> m_timers;
+  /// Number of events processed by the last simulation
+  uint64_t m_events;
+  uint32_t m_label;
+  uint32_t m_random;
+};
+
+TimerWheelTestCase::TimerWheelTestCase ()
+  : TestCase ("Check that the timer wheel preserves the order of the events")
+{}
+uint32_t
+TimerWheelTestCase::Random (uint32_t max)
+{
+  // deterministic linear congruential generator
+  m_random = m_random * 1103515245 + 12345;
+  return (m_random >> 8) % max;
+}
+Time
+TimerWheelTestCase::RandomDelay (void)
+{
+  // delays spread over all the levels of the wheel, and beyond
+  switch (Random (5))
+    {
+    case 0:
+      return NanoSeconds (Random (2000000));
+    case 1:
+      return MicroSeconds (Random (64000));
+    case 2:
+      return MilliSeconds (Random (5000));
+    case 3:
+      return Seconds (Random (300));
+    default:
+      return Seconds (70000 + Random (100000));
+    }
+}
+void
+TimerWheelTestCase::Expire (uint32_t label)
+{
+  m_trace.push_back (std::make_pair (Simulator::Now ().GetTimeStep (), label));
+}
+void
+TimerWheelTestCase::Step (uint32_t left)
+{
+  Expire (m_label++);
+  for (uint32_t i = Random (4); i > 0; --i)
+    {
+      m_timers.push_back (Simulator::ScheduleTimer (RandomDelay (), &TimerWheelTestCase::Expire, this, m_label++));
+    }
+  Simulator::Schedule (RandomDelay (), &TimerWheelTestCase::Expire, this, m_label++);
+  if (Random (2) == 0)
+    {
+      // the same timestamp as an earlier timer
+      EventId id = m_timers[Random (m_timers.size ())];
+      if (!id.IsExpired ())
+        {
+          Simulator::Schedule (Simulator::GetDelayLeft (id), &TimerWheelTestCase::Expire, this, m_label++);
+        }
+    }
+  for (uint32_t i = Random (3); i > 0; --i)
+    {
+      m_timers[Random (m_timers.size ())].Cancel ();
+    }
+  Simulator::Remove (m_timers[Random (m_timers.size ())]);
+  if (left > 0)
+    {
+      Simulator::ScheduleTimer (MicroSeconds (Random (20000)), &TimerWheelTestCase::Step, this, left - 1);
+    }
+}
+void
+TimerWheelTestCase::RunSimulation (Time resolution)
+{
+  m_trace.clear ();
+  m_timers.clear ();
+  m_label = 0;
+  m_random = 1;
+  ObjectFactory factory;
+  factory.SetTypeId (DefaultSimulatorImpl::GetTypeId ());
+  factory.Set ("TimerWheelResolution", TimeValue (resolution));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  Simulator::Schedule (Seconds (0), &TimerWheelTestCase::Step, this, 5000);
+  Simulator::Run ();
+  m_events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+}
+void
+TimerWheelTestCase::DoRun (void)
+{
+  RunSimulation (Seconds (0));
+  std::vector<std::pair<uint64_t, uint32_t> > expected = m_trace;
+  uint64_t expectedEvents = m_events;
+
+  Time resolutions[] = { NanoSeconds (1), MicroSeconds (1), MilliSeconds (1), Seconds (1) };
+  for (uint32_t i = 0; i < sizeof (resolutions) / sizeof (resolutions[0]); ++i)
+    {
+      RunSimulation (resolutions[i]);
+      NS_TEST_ASSERT_MSG_EQ (m_trace.size (), expected.size (), "Wrong number of events with resolution " << resolutions[i]);
+      NS_TEST_EXPECT_MSG_EQ ((m_trace == expected), true, "Wrong order of events with resolution " << resolutions[i]);
+      // cancelled timers are not processed
+      NS_TEST_EXPECT_MSG_LT (m_events, expectedEvents, "Cancelled timers were processed");
+    }
+}
+
+class EventProfilerTestObject : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  void Method (void);
+};
+
+TypeId
+EventProfilerTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EventProfilerTestObject")
+    .SetParent<Object> ()
+    .HideFromDocumentation ()
+    .AddConstructor<EventProfilerTestObject> ()
+  ;
+  return tid;
+}
+void
+EventProfilerTestObject::Method (void)
+{}
+
+static void
+EventProfilerTestFunction (uint32_t a)
+{}
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the event profile of DefaultSimulatorImpl")
+{}
+void
+EventProfilerTestCase::DoRun (void)
+{
+  std::string report = CreateTempDirFilename ("event-profile.txt");
+  std::string stacks = CreateTempDirFilename ("event-profile.folded");
+  ObjectFactory factory;
+  factory.SetTypeId (DefaultSimulatorImpl::GetTypeId ());
+  factory.Set ("EventProfile", BooleanValue (true));
+  factory.Set ("EventProfileReport", StringValue (report));
+  factory.Set ("EventProfileCollapsedStacks", StringValue (stacks));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+
+  Ptr<EventProfilerTestObject> object = CreateObject<EventProfilerTestObject> ();
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::ScheduleWithContext (7, Seconds (i), &EventProfilerTestObject::Method, object);
+    }
+  Simulator::Schedule (Seconds (1), &EventProfilerTestFunction, 1);
+  Simulator::Schedule (Seconds (2), &EventProfilerTestFunction, 2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (stacks.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "No collapsed stacks");
+  std::string line;
+  uint32_t lines = 0;
+  bool method = false;
+  bool function = false;
+  while (std::getline (is, line))
+    {
+      lines++;
+      if (line.find ("context 7;ns3::EventProfilerTestObject;void (EventProfilerTestObject::*)() ") == 0)
+        {
+          method = true;
+        }
+      if (line.find ("no context;-;void (*)(unsigned int) ") == 0)
+        {
+          function = true;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (lines, 2, "Wrong number of stacks");
+  NS_TEST_EXPECT_MSG_EQ (method, true, "Method events not attributed to their TypeId and context");
+  NS_TEST_EXPECT_MSG_EQ (function, true, "Function events not attributed");
+
+  std::ifstream reportStream (report.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (std::getline (reportStream, line).good (), true, "No report");
+  NS_TEST_EXPECT_MSG_EQ (line.find ("Event profile: 5 events"), 0, "Wrong event count in the report");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -483,5 +850,11 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventImplPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerWheelTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -26,6 +26,7 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/default-simulator-impl.h"
 
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
@@ -225,6 +226,81 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorDrainTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorDrainTestCase ();
+  static void SchedulingThread (ThreadedSimulatorDrainTestCase *me);
+  void Drained (uint32_t count);
+  void Count (void);
+  uint32_t m_drained;
+  uint32_t m_batches;
+  uint32_t m_count;
+
+private:
+  virtual void DoRun (void);
+};
+
+/// Number of scheduling threads of ThreadedSimulatorDrainTestCase
+static const unsigned int DRAIN_THREADS = 4;
+/// Number of events scheduled by each thread of ThreadedSimulatorDrainTestCase
+static const unsigned int DRAIN_EVENTS = 1000;
+
+ThreadedSimulatorDrainTestCase::ThreadedSimulatorDrainTestCase ()
+  : TestCase ("Check the batched drain of events scheduled from other threads")
+{}
+
+void
+ThreadedSimulatorDrainTestCase::SchedulingThread (ThreadedSimulatorDrainTestCase *me)
+{
+  for (unsigned int i = 0; i < DRAIN_EVENTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i),
+                                      &ThreadedSimulatorDrainTestCase::Count, me);
+    }
+}
+void
+ThreadedSimulatorDrainTestCase::Drained (uint32_t count)
+{
+  m_drained += count;
+  m_batches++;
+}
+void
+ThreadedSimulatorDrainTestCase::Count (void)
+{
+  m_count++;
+}
+void
+ThreadedSimulatorDrainTestCase::DoRun (void)
+{
+  m_drained = 0;
+  m_batches = 0;
+  m_count = 0;
+  Ptr<DefaultSimulatorImpl> impl = CreateObject<DefaultSimulatorImpl> ();
+  impl->TraceConnectWithoutContext ("EventsWithContextDrained",
+                                    MakeCallback (&ThreadedSimulatorDrainTestCase::Drained, this));
+  Simulator::SetImplementation (impl);
+
+  std::list<Ptr<SystemThread> > threads;
+  for (unsigned int i = 0; i < DRAIN_THREADS; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&ThreadedSimulatorDrainTestCase::SchedulingThread, this));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, DRAIN_THREADS * DRAIN_EVENTS, "Lost events");
+  NS_TEST_EXPECT_MSG_EQ (m_drained, DRAIN_THREADS * DRAIN_EVENTS, "Wrong drained count");
+  NS_TEST_EXPECT_MSG_EQ (m_batches, 1, "Events not drained in a single batch");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -235,13 +311,15 @@ public:
 #ifdef HAVE_RT
       "ns3::RealtimeSimulatorImpl",
 #endif
-      "ns3::DefaultSimulatorImpl"
+      "ns3::DefaultSimulatorImpl",
+      "ns3::MultithreadedSimulatorImpl"
     };
     std::string schedulerTypes[] = {
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +340,6 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorDrainTestCase (), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -84,6 +84,19 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes that were previously installed in a prior call
+   * to PopulateRoutingTables(), RecomputeRoutingTables() or
+   * UpdateRoutingTables(), after a change of the topology such as an
+   * interface which was set down or up.
+   *
+   * The routing database is rebuilt, and only the nodes whose routes may
+   * depend on the Link State Advertisements which changed compute their
+   * routes again; the other nodes keep their routes.  Ipv4GlobalRouting
+   * calls this method upon interface events when its
+   * RespondToInterfaceEvents attribute is set.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
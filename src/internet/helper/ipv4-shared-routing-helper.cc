@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-shared-routing-helper.h"
+#include "ns3/ipv4-shared-routing.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4SharedRoutingHelper");
+
+Ipv4SharedRoutingHelper::Ipv4SharedRoutingHelper ()
+{
+  m_graph = CreateObject<Ipv4SharedRoutingGraph> ();
+}
+
+Ipv4SharedRoutingHelper::Ipv4SharedRoutingHelper (const Ipv4SharedRoutingHelper &o)
+  : m_graph (o.m_graph)
+{
+}
+
+Ipv4SharedRoutingHelper*
+Ipv4SharedRoutingHelper::Copy (void) const
+{
+  return new Ipv4SharedRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+Ipv4SharedRoutingHelper::Create (Ptr<Node> node) const
+{
+  NS_LOG_LOGIC ("Adding SharedRouting Protocol to node " << node->GetId ());
+  Ptr<Ipv4SharedRouting> routing = CreateObject<Ipv4SharedRouting> ();
+  routing->SetGraph (m_graph);
+  return routing;
+}
+
+Ptr<Ipv4SharedRoutingGraph>
+Ipv4SharedRoutingHelper::GetGraph (void) const
+{
+  return m_graph;
+}
+
+} // namespace ns3
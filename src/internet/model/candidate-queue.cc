@@ -49,24 +49,27 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  typedef CandidateQueue::CandidateHeap_t Heap_t;
+  typedef Heap_t::const_iterator CIter_t;
+  Heap_t heap = q.m_candidates;
+  std::sort (heap.begin (), heap.end (), &CandidateQueue::CompareCandidate);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (CIter_t iter = heap.begin (); iter != heap.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_positions (),
+    m_rank (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -87,6 +90,7 @@ CandidateQueue::Clear (void)
       delete p;
       p = 0;
     }
+  m_rank = 0;
 }
 
 void
@@ -94,11 +98,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.rank = m_rank++;
+  m_candidates.push_back (c);
+  uint32_t i = m_candidates.size () - 1;
+  m_positions.insert (std::make_pair (vNew->GetVertexId (), i));
+  SiftUp (i);
 }
 
 SPFVertex *
@@ -110,8 +116,12 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  uint32_t last = m_candidates.size () - 1;
+  Swap (0, last);
+  m_positions.erase (FindPosition (last));
+  m_candidates.pop_back ();
+  SiftDown (0);
   return v;
 }
 
@@ -124,7 +134,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +155,21 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
+  std::pair<PositionMap_t::const_iterator, PositionMap_t::const_iterator> range =
+    m_positions.equal_range (addr);
 
-  for (; i != m_candidates.end (); i++)
+  // the first vertex with this ID to be popped, if several were pushed
+  const Candidate *found = 0;
+  for (PositionMap_t::const_iterator i = range.first; i != range.second; i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      const Candidate &c = m_candidates[i->second];
+      if (found == 0 || CompareCandidate (c, *found))
         {
-          return v;
+          found = &c;
         }
     }
 
-  return 0;
+  return found != 0 ? found->vertex : 0;
 }
 
 void
@@ -164,11 +177,119 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::pair<PositionMap_t::iterator, PositionMap_t::iterator> range =
+    m_positions.equal_range (v->GetVertexId ());
+  for (PositionMap_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (m_candidates[i->second].vertex == v)
+        {
+          uint32_t position = i->second;
+          m_candidates[position].rank = m_rank++;
+          SiftUp (position);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "CandidateQueue::Reorder (): vertex not in the queue");
+}
+
+bool
+CandidateQueue::CompareCandidate (const Candidate& c1, const Candidate& c2)
+{
+  if (CompareSPFVertex (c1.vertex, c2.vertex))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (c2.vertex, c1.vertex))
+    {
+      return false;
+    }
+  return c1.rank < c2.rank;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!CompareCandidate (m_candidates[i], m_candidates[parent]))
+        {
+          break;
+        }
+      Swap (i, parent);
+      i = parent;
+    }
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  uint32_t n = m_candidates.size ();
+  while (true)
+    {
+      uint32_t first = i;
+      uint32_t left = 2 * i + 1;
+      uint32_t right = left + 1;
+      if (left < n && CompareCandidate (m_candidates[left], m_candidates[first]))
+        {
+          first = left;
+        }
+      if (right < n && CompareCandidate (m_candidates[right], m_candidates[first]))
+        {
+          first = right;
+        }
+      if (first == i)
+        {
+          break;
+        }
+      Swap (i, first);
+      i = first;
+    }
+}
+
+void
+CandidateQueue::Swap (uint32_t i, uint32_t j)
+{
+  if (i == j)
+    {
+      return;
+    }
+  PositionMap_t::iterator pi = FindPosition (i);
+  PositionMap_t::iterator pj = FindPosition (j);
+  pi->second = j;
+  pj->second = i;
+  std::swap (m_candidates[i], m_candidates[j]);
+}
+
+CandidateQueue::PositionMap_t::iterator
+CandidateQueue::FindPosition (uint32_t i)
+{
+  std::pair<PositionMap_t::iterator, PositionMap_t::iterator> range =
+    m_positions.equal_range (m_candidates[i].vertex->GetVertexId ());
+  for (PositionMap_t::iterator p = range.first; p != range.second; p++)
+    {
+      if (p->second == i)
+        {
+          return p;
+        }
+    }
+  NS_ASSERT_MSG (false, "CandidateQueue: candidate missing from the index");
+  return m_positions.end ();
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The vertices are kept in a binary heap, with an index of their positions
+ * by vertex ID, so that Push, Pop and Reorder of a vertex take a time
+ * logarithmic in the size of the queue and Find a constant time.  The
+ * vertices which are tied are popped in the order in which they were
+ * pushed, or in which their distance was last lowered.
  */
 class CandidateQueue
 {
@@ -154,6 +161,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Moves a vertex of the Candidate Queue after its m_distanceFromRoot
+ * was lowered.
+ *
+ * The vertex is placed after the vertices which have the same priority,
+ * as if it had just been pushed.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance was lowered.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +203,60 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /**
+   * \brief A vertex of the queue and the rank of its insertion.
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< The vertex
+    uint32_t rank;      //!< The rank of the insertion of the vertex
+  };
+
+  /// positions of the candidates in the heap, by vertex ID
+  typedef std::unordered_multimap<Ipv4Address, uint32_t, Ipv4AddressHash> PositionMap_t;
+
+/**
+ * \brief return true if c1 should be popped before c2
+ *
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool CompareCandidate (const Candidate& c1, const Candidate& c2);
+
+/**
+ * \brief Move a candidate towards the top of the heap.
+ *
+ * \param i The position of the candidate.
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move a candidate towards the bottom of the heap.
+ *
+ * \param i The position of the candidate.
+ */
+  void SiftDown (uint32_t i);
+
+/**
+ * \brief Swap two candidates of the heap and their positions in the index.
+ *
+ * \param i The position of a candidate.
+ * \param j The position of another candidate.
+ */
+  void Swap (uint32_t i, uint32_t j);
+
+/**
+ * \param i The position of a candidate in the heap.
+ * \returns The entry of the index for the candidate.
+ */
+  PositionMap_t::iterator FindPosition (uint32_t i);
+
+  typedef std::vector<Candidate> CandidateHeap_t; //!< binary heap of candidates
+  CandidateHeap_t m_candidates;  //!< SPFVertex candidates
+
+  PositionMap_t m_positions;  //!< positions of the candidates
+  uint32_t m_rank;            //!< rank of the next insertion
 
   /**
    * \brief Stream insertion operator.
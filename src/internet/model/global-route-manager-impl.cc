@@ -26,10 +26,14 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -38,11 +42,311 @@
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <thread>
+#endif
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * \anchor GlobalValueGlobalRoutingThreads
+ * The number of threads which run the SPF calculations of the routers.
+ */
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "The number of threads which compute the global routes "
+                                                         "of the routers, 0 for one per processor.",
+                                                         UintegerValue (1),
+                                                         MakeUintegerChecker<uint32_t> ());
+
+namespace {
+
+/**
+ * \ingroup globalrouting
+ * \param a a Link State Advertisement
+ * \param b another Link State Advertisement
+ * \returns true if the two LSAs advertise the same links
+ */
+bool
+IsSameLSA (const GlobalRoutingLSA *a, const GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \ingroup globalrouting
+ * The transit vertices of a Link State Database and the edges between them,
+ * as the SPF calculation walks them, to find the routers whose routes
+ * depend on a change of the database.
+ */
+class LsdbGraph
+{
+public:
+  /** An edge between two vertices, by the indexes of the vertices. */
+  struct Edge
+  {
+    uint32_t vertex;  //!< The vertex at the other end of the edge
+    uint32_t cost;    //!< The cost of the edge
+  };
+  /** The edges leaving a vertex, by link state ID of their target. */
+  typedef std::vector<std::pair<Ipv4Address, uint32_t> > Targets_t;
+
+  /**
+   * Constructor.
+   *
+   * \param lsdb The database.
+   */
+  LsdbGraph (const GlobalRouteManagerLSDB &lsdb);
+
+  /**
+   * \param id The link state ID of an LSA.
+   * \returns The index of the vertex of the LSA, or -1 if the LSA is not
+   * in the database.
+   */
+  int32_t GetIndex (Ipv4Address id) const;
+
+  /**
+   * \param id The link state ID of an LSA.
+   * \returns The edges which leave the vertex of the LSA, sorted.
+   */
+  const Targets_t & GetTargets (Ipv4Address id) const;
+
+  /**
+   * Find the distance of each vertex to a vertex.
+   *
+   * \param target The index of the vertex.
+   * \param [out] distances The distances, SPF_INFINITY if there is no path.
+   */
+  void GetDistancesTo (uint32_t target, std::vector<uint32_t> &distances) const;
+
+  /**
+   * Find the vertices which have a path to any of some vertices.
+   *
+   * \param targets The indexes of the vertices.
+   * \param [out] reaching Whether each vertex has a path to a target.
+   */
+  void GetReaching (const std::vector<uint32_t> &targets, std::vector<bool> &reaching) const;
+
+private:
+  std::map<Ipv4Address, uint32_t> m_indexes;   //!< The indexes of the vertices, by link state ID
+  std::vector<Targets_t> m_targets;            //!< The edges which leave each vertex
+  std::vector<std::vector<Edge> > m_in;        //!< The edges which enter each vertex
+};
+
+LsdbGraph::LsdbGraph (const GlobalRouteManagerLSDB &lsdb)
+{
+  std::vector<GlobalRoutingLSA*> lsas;
+  lsdb.GetLSAs (lsas);
+  for (uint32_t i = 0; i < lsas.size (); i++)
+    {
+      m_indexes[lsas[i]->GetLinkStateId ()] = i;
+    }
+  m_targets.resize (lsas.size ());
+  m_in.resize (lsas.size ());
+  for (uint32_t i = 0; i < lsas.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = lsas[i];
+      Targets_t &targets = m_targets[i];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork
+                  && lsdb.GetLSA (l->GetLinkId ()) != 0)
+                {
+                  targets.push_back (std::make_pair (l->GetLinkId (), l->GetMetric ()));
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA *w = lsdb.GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              if (w != 0)
+                {
+                  targets.push_back (std::make_pair (w->GetLinkStateId (), 0));
+                }
+            }
+        }
+      std::sort (targets.begin (), targets.end ());
+      for (Targets_t::const_iterator j = targets.begin (); j != targets.end (); j++)
+        {
+          Edge edge;
+          edge.vertex = i;
+          edge.cost = j->second;
+          m_in[GetIndex (j->first)].push_back (edge);
+        }
+    }
+}
+
+int32_t
+LsdbGraph::GetIndex (Ipv4Address id) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_indexes.find (id);
+  return i != m_indexes.end () ? i->second : -1;
+}
+
+const LsdbGraph::Targets_t &
+LsdbGraph::GetTargets (Ipv4Address id) const
+{
+  return m_targets[GetIndex (id)];
+}
+
+void
+LsdbGraph::GetDistancesTo (uint32_t target, std::vector<uint32_t> &distances) const
+{
+  typedef std::pair<uint32_t, uint32_t> Item_t;
+  distances.assign (m_in.size (), SPF_INFINITY);
+  std::priority_queue<Item_t, std::vector<Item_t>, std::greater<Item_t> > queue;
+  distances[target] = 0;
+  queue.push (std::make_pair (0, target));
+  while (!queue.empty ())
+    {
+      Item_t item = queue.top ();
+      queue.pop ();
+      if (item.first != distances[item.second])
+        {
+          continue;
+        }
+      const std::vector<Edge> &in = m_in[item.second];
+      for (std::vector<Edge>::const_iterator i = in.begin (); i != in.end (); i++)
+        {
+          uint64_t distance = uint64_t (item.first) + i->cost;
+          if (distance < distances[i->vertex])
+            {
+              distances[i->vertex] = distance;
+              queue.push (std::make_pair (distance, i->vertex));
+            }
+        }
+    }
+}
+
+void
+LsdbGraph::GetReaching (const std::vector<uint32_t> &targets, std::vector<bool> &reaching) const
+{
+  reaching.assign (m_in.size (), false);
+  std::vector<uint32_t> stack;
+  for (std::vector<uint32_t>::const_iterator i = targets.begin (); i != targets.end (); i++)
+    {
+      if (!reaching[*i])
+        {
+          reaching[*i] = true;
+          stack.push_back (*i);
+        }
+    }
+  while (!stack.empty ())
+    {
+      uint32_t v = stack.back ();
+      stack.pop_back ();
+      for (std::vector<Edge>::const_iterator i = m_in[v].begin (); i != m_in[v].end (); i++)
+        {
+          if (!reaching[i->vertex])
+            {
+              reaching[i->vertex] = true;
+              stack.push_back (i->vertex);
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup globalrouting
+ * Get the addresses which the SPF calculation turns into the destinations
+ * of routes: the local addresses of the point-to-point links and the stub
+ * networks of a router, or the address and mask of a network.
+ *
+ * \param lsa a Link State Advertisement
+ * \param [out] content the type of each destination and its two addresses
+ */
+void
+GetDestinations (const GlobalRoutingLSA *lsa, std::vector<uint32_t> &content)
+{
+  content.clear ();
+  content.push_back (lsa->GetLSType ());
+  if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      content.push_back (lsa->GetLinkStateId ().Get ());
+      content.push_back (lsa->GetNetworkLSANetworkMask ().Get ());
+      return;
+    }
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          content.push_back (l->GetLinkType ());
+          content.push_back (l->GetLinkData ().Get ());
+          content.push_back (0);
+        }
+      else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+        {
+          content.push_back (l->GetLinkType ());
+          content.push_back (l->GetLinkId ().Get ());
+          content.push_back (l->GetLinkData ().Get ());
+        }
+    }
+}
+
+/**
+ * \ingroup globalrouting
+ * Get the link records of a router, by link ID; the next hops of a root
+ * towards the router, or towards a network, are the link data of the
+ * records whose link ID is the root or the network.
+ *
+ * \param lsa a Link State Advertisement
+ * \param [out] records the type and link data of the records, by link ID
+ */
+void
+GetRecordsByLinkId (const GlobalRoutingLSA *lsa, std::map<Ipv4Address, std::vector<uint32_t> > &records)
+{
+  records.clear ();
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+      std::vector<uint32_t> &r = records[l->GetLinkId ()];
+      r.push_back (l->GetLinkType ());
+      r.push_back (l->GetLinkData ().Get ());
+      r.push_back (l->GetMetric ());
+    }
+}
+
+} // anonymous namespace
+
 /**
  * \brief Stream insertion operator.
  *
@@ -469,7 +773,29 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      std::pair<LSDBMap_t::iterator, bool> inserted = m_database.insert (LSDBPair_t (addr, lsa));
+      if (!inserted.second)
+        {
+          return;
+        }
+//
+// Index the LSA by the link data of its TransitNetwork link records, keeping
+// the LSA with the lowest address as a scan of the database would.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<LinkDataMap_t::iterator, bool> indexed =
+            m_linkData.insert (std::make_pair (lr->GetLinkData (), inserted.first));
+          if (!indexed.second && addr < indexed.first->second->first)
+            {
+              indexed.first->second = inserted.first;
+            }
+        }
     }
 }
 
@@ -494,13 +820,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -510,24 +833,62 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LinkDataMap_t::const_iterator i = m_linkData.find (addr);
+  if (i != m_linkData.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      return i->second->second;
+    }
+  return 0;
+}
+
+void
+GlobalRouteManagerLSDB::GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const
+{
+  NS_LOG_FUNCTION (this);
+  lsas.clear ();
+  lsas.reserve (m_database.size ());
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+}
+
+void
+GlobalRouteManagerLSDB::Copy (const GlobalRouteManagerLSDB &lsdb)
+{
+  NS_LOG_FUNCTION (this << &lsdb);
+  for (LSDBMap_t::const_iterator i = lsdb.m_database.begin (); i != lsdb.m_database.end (); i++)
+    {
+      GlobalRoutingLSA *lsa = new GlobalRoutingLSA ();
+      *lsa = *i->second;
+      Insert (i->first, lsa);
+    }
+  for (uint32_t j = 0; j < lsdb.m_extdatabase.size (); j++)
+    {
+      GlobalRoutingLSA *lsa = new GlobalRoutingLSA ();
+      *lsa = *lsdb.m_extdatabase[j];
+      Insert (lsa->GetLinkStateId (), lsa);
+    }
+}
+
+bool
+GlobalRouteManagerLSDB::IsSameExternal (const GlobalRouteManagerLSDB &lsdb) const
+{
+  NS_LOG_FUNCTION (this << &lsdb);
+  if (m_extdatabase.size () != lsdb.m_extdatabase.size ())
+    {
+      return false;
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      if (!IsSameLSA (m_extdatabase[j], lsdb.m_extdatabase[j]))
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
+          return false;
         }
     }
-  return 0;
+  return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -538,7 +899,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_roots (0),
+    m_nextRoot (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -564,6 +927,30 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -571,25 +958,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (*i);
     }
   if (m_lsdb)
     {
@@ -695,38 +1064,432 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("About to start SPF calculation");
+  FindRouters ();
+  std::vector<Ipv4Address> roots;
+  GetRoots (roots);
+  CalculateRoutes (roots);
+  m_routers.clear ();
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::FindRouters (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routers.clear ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr)
+        {
+          // the first node with a router ID is the one whose routes are set
+          m_routers.insert (std::make_pair (rtr->GetRouterId (), node));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::GetRoots (std::vector<Ipv4Address> &roots) const
+{
+  NS_LOG_FUNCTION (this);
+//
+// Walk the list of nodes in the system.
+//
+  roots.clear ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+//
+// Look for the GlobalRouter interface that indicates that the node is
+// participating in routing.
+//
+      Ptr<GlobalRouter> rtr = 
+        node->GetObject<GlobalRouter> ();
+
+      uint32_t systemId = Simulator::GetSystemId ();
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () != systemId) 
+        {
+          continue;
+        }
+
+//
+// if the node has a global router interface, then run the global routing
+// algorithms.
+//
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          roots.push_back (rtr->GetRouterId ());
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::CalculateRoutes (const std::vector<Ipv4Address> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+#ifdef HAVE_PTHREAD_H
+  UintegerValue value;
+  g_globalRoutingThreads.GetValue (value);
+  uint32_t threads = value.Get ();
+  if (threads == 0)
+    {
+      threads = std::max (1U, std::thread::hardware_concurrency ());
+    }
+  threads = std::min<uint32_t> (threads, roots.size ());
+  if (threads > 1)
+    {
+      NS_LOG_LOGIC ("computing the routes of " << roots.size () << " routers in " << threads << " threads");
+//
+// The SPF calculation marks the LSAs of the database and each root writes
+// to its own routing table only, so each thread works on a copy of the
+// database and the routes do not depend on the number of threads.
+//
+      m_roots = &roots;
+      m_nextRoot = 0;
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > pool;
+      for (uint32_t i = 0; i < threads; ++i)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          worker->m_lsdb->Copy (*m_lsdb);
+          worker->m_routers = m_routers;
+          workers.push_back (worker);
+        }
+      for (uint32_t i = 0; i < threads; ++i)
+        {
+          Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&GlobalRouteManagerImpl::RunWorker, this, workers[i]));
+          thread->Start ();
+          pool.push_back (thread);
+        }
+      for (uint32_t i = 0; i < threads; ++i)
+        {
+          pool[i]->Join ();
+          delete workers[i];
+        }
+      m_roots = 0;
+      return;
+    }
+#endif
+  for (std::vector<Ipv4Address>::const_iterator i = roots.begin (); i != roots.end (); i++)
+    {
+      SPFCalculate (*i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::RunWorker (GlobalRouteManagerImpl *self, GlobalRouteManagerImpl *worker)
+{
+  NS_LOG_FUNCTION (self << worker);
+  for (uint32_t i = self->m_nextRoot++; i < self->m_roots->size (); i = self->m_nextRoot++)
+    {
+      worker->SPFCalculate ((*self->m_roots)[i]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<GlobalRoutingLSA*> lsas;
+  m_lsdb->GetLSAs (lsas);
+  if (lsas.empty () && m_lsdb->GetNumExtLSAs () == 0)
+    {
+      NS_LOG_LOGIC ("No routing database, computing all the routes");
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+
+  FindRouters ();
+  std::vector<Ipv4Address> roots;
+  GetRoots (roots);
+  std::set<Ipv4Address> affected;
+  GetAffectedRoots (*oldLsdb, roots, affected);
+  delete oldLsdb;
+
+//
+// Delete the routes of the routers which are computed again, and of those
+// which no longer have LSAs.
+//
+  std::set<Ipv4Address> rootSet (roots.begin (), roots.end ());
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && (affected.count (rtr->GetRouterId ()) || !rootSet.count (rtr->GetRouterId ())))
+        {
+          DeleteRoutes (*i);
+        }
+    }
+
+  std::vector<Ipv4Address> updated;
+  for (std::vector<Ipv4Address>::const_iterator i = roots.begin (); i != roots.end (); i++)
+    {
+      if (affected.count (*i))
+        {
+          updated.push_back (*i);
+        }
+    }
+  NS_LOG_INFO ("Computing the routes of " << updated.size () << " of " << roots.size () << " routers");
+  CalculateRoutes (updated);
+  m_routers.clear ();
+}
+
+void
+GlobalRouteManagerImpl::GetAffectedRoots (const GlobalRouteManagerLSDB &oldLsdb,
+                                          const std::vector<Ipv4Address> &roots,
+                                          std::set<Ipv4Address> &affected) const
+{
+  NS_LOG_FUNCTION (this << &oldLsdb << roots.size ());
+  affected.clear ();
+  if (!m_lsdb->IsSameExternal (oldLsdb))
+    {
+      NS_LOG_LOGIC ("External LSAs changed, all the routes are computed again");
+      affected.insert (roots.begin (), roots.end ());
+      return;
+    }
+
+  const GlobalRouteManagerLSDB *lsdbs[2] = { &oldLsdb, m_lsdb };
+  LsdbGraph oldGraph (oldLsdb);
+  LsdbGraph newGraph (*m_lsdb);
+  const LsdbGraph *graphs[2] = { &oldGraph, &newGraph };
+
+//
+// Compare the LSAs of the two databases.  Those whose destinations changed
+// change the routes of every router which reaches them; a change of their
+// link records towards a router or a network changes the next hops of that
+// router, or of the routers of that network, towards them.
+//
+  std::vector<GlobalRoutingLSA*> lsas[2];
+  oldLsdb.GetLSAs (lsas[0]);
+  m_lsdb->GetLSAs (lsas[1]);
+  std::set<Ipv4Address> ids;
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      for (uint32_t i = 0; i < lsas[k].size (); i++)
+        {
+          ids.insert (lsas[k][i]->GetLinkStateId ());
+        }
+    }
+  std::set<Ipv4Address> changed;
+  std::vector<uint32_t> destinations[2];
+  std::vector<std::pair<Ipv4Address, LsdbGraph::Targets_t::value_type> > edges[2];
+  for (std::set<Ipv4Address>::const_iterator i = ids.begin (); i != ids.end (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = oldLsdb.GetLSA (*i);
+      GlobalRoutingLSA *newLsa = m_lsdb->GetLSA (*i);
+//
+// The edges of the graph which appeared or disappeared, including those
+// from a network to the routers attached to it, which depend on the link
+// records of the routers.
+//
+      static const LsdbGraph::Targets_t none;
+      const LsdbGraph::Targets_t &oldTargets = oldLsa ? oldGraph.GetTargets (*i) : none;
+      const LsdbGraph::Targets_t &newTargets = newLsa ? newGraph.GetTargets (*i) : none;
+      if (oldTargets != newTargets)
+        {
+          LsdbGraph::Targets_t removed;
+          LsdbGraph::Targets_t added;
+          std::set_difference (oldTargets.begin (), oldTargets.end (), newTargets.begin (), newTargets.end (),
+                               std::back_inserter (removed));
+          std::set_difference (newTargets.begin (), newTargets.end (), oldTargets.begin (), oldTargets.end (),
+                               std::back_inserter (added));
+          for (LsdbGraph::Targets_t::const_iterator j = removed.begin (); j != removed.end (); j++)
+            {
+              edges[0].push_back (std::make_pair (*i, *j));
+            }
+          for (LsdbGraph::Targets_t::const_iterator j = added.begin (); j != added.end (); j++)
+            {
+              edges[1].push_back (std::make_pair (*i, *j));
+            }
+        }
+      if (oldLsa && newLsa && IsSameLSA (oldLsa, newLsa))
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("LSA " << *i << " changed");
+//
+// A router whose own LSA changed computes all of its routes again.
+//
+      affected.insert (*i);
+      if (oldLsa == 0 || newLsa == 0)
+        {
+          changed.insert (*i);
+        }
+      else
+        {
+          GetDestinations (oldLsa, destinations[0]);
+          GetDestinations (newLsa, destinations[1]);
+          if (destinations[0] != destinations[1])
+            {
+              changed.insert (*i);
+            }
+        }
+      std::map<Ipv4Address, std::vector<uint32_t> > records[2];
+      if (oldLsa)
+        {
+          GetRecordsByLinkId (oldLsa, records[0]);
+        }
+      if (newLsa)
+        {
+          GetRecordsByLinkId (newLsa, records[1]);
+        }
+      std::set<Ipv4Address> linkIds;
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          for (std::map<Ipv4Address, std::vector<uint32_t> >::const_iterator j = records[k].begin (); j != records[k].end (); j++)
+            {
+              linkIds.insert (j->first);
+            }
+        }
+      for (std::set<Ipv4Address>::const_iterator j = linkIds.begin (); j != linkIds.end (); j++)
+        {
+          if (records[0][*j] == records[1][*j])
+            {
+              continue;
+            }
+          affected.insert (*j);
+          for (uint32_t k = 0; k < 2; k++)
+            {
+              GlobalRoutingLSA *network = lsdbs[k]->GetLSA (*j);
+              if (network == 0 || network->GetLSType () != GlobalRoutingLSA::NetworkLSA)
+                {
+                  continue;
+                }
+              for (uint32_t n = 0; n < network->GetNAttachedRouters (); n++)
+                {
+                  GlobalRoutingLSA *router = lsdbs[k]->GetLSAByLinkData (network->GetAttachedRouter (n));
+                  if (router != 0)
+                    {
+                      affected.insert (router->GetLinkStateId ());
+                    }
+                }
+            }
+        }
+    }
+
 //
-// Walk the list of nodes in the system.
+// A router which is a stub only has a default route towards its neighbor,
+// which the comparison of the link records above already checked.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+  std::vector<Ipv4Address> candidates;
+  for (std::vector<Ipv4Address>::const_iterator i = roots.begin (); i != roots.end (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// Look for the GlobalRouter interface that indicates that the node is
-// participating in routing.
-//
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      uint32_t systemId = Simulator::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      if (!affected.count (*i) && !IsStubNode (*m_lsdb, *i))
         {
-          continue;
+          candidates.push_back (*i);
         }
+    }
 
 //
-// if the node has a global router interface, then run the global routing
-// algorithms.
+// The other routers are affected if they reach an LSA whose destinations
+// changed, or if a link which appeared or disappeared is on one of their
+// shortest paths, in the graph which holds it.
 //
-      if (rtr && rtr->GetNumLSAs () )
+  for (uint32_t k = 0; k < 2 && !candidates.empty (); k++)
+    {
+      const LsdbGraph &graph = *graphs[k];
+      std::vector<uint32_t> targets;
+      for (std::set<Ipv4Address>::const_iterator i = changed.begin (); i != changed.end (); i++)
+        {
+          int32_t index = graph.GetIndex (*i);
+          if (index >= 0)
+            {
+              targets.push_back (index);
+            }
+        }
+      std::vector<bool> reaching;
+      graph.GetReaching (targets, reaching);
+      std::map<uint32_t, std::vector<uint32_t> > distances;
+      std::vector<Ipv4Address> remaining;
+      for (std::vector<Ipv4Address>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          int32_t root = graph.GetIndex (*i);
+          bool isAffected = root >= 0 && reaching[root];
+          for (uint32_t j = 0; j < edges[k].size () && root >= 0 && !isAffected; j++)
+            {
+              uint32_t from = graph.GetIndex (edges[k][j].first);
+              uint32_t to = graph.GetIndex (edges[k][j].second.first);
+              for (uint32_t end = 0; end < 2; end++)
+                {
+                  uint32_t vertex = end == 0 ? from : to;
+                  if (distances.find (vertex) == distances.end ())
+                    {
+                      graph.GetDistancesTo (vertex, distances[vertex]);
+                    }
+                }
+              uint64_t toFrom = distances[from][root];
+              uint64_t toTo = distances[to][root];
+              isAffected = toFrom != SPF_INFINITY && toFrom + edges[k][j].second.second == toTo;
+            }
+          if (isAffected)
+            {
+              affected.insert (*i);
+            }
+          else
+            {
+              remaining.push_back (*i);
+            }
         }
+      candidates.swap (remaining);
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  NS_LOG_LOGIC (affected.size () << " routers affected by " << changed.size () << " changed destinations and "
+                << edges[0].size () + edges[1].size () << " changed links");
+}
+
+bool
+GlobalRouteManagerImpl::IsStubNode (const GlobalRouteManagerLSDB &lsdb, Ipv4Address root)
+{
+  GlobalRoutingLSA *rlsa = lsdb.GetLSA (root);
+  if (rlsa == 0)
+    {
+      return false;
+    }
+  uint32_t transits = 0;
+  GlobalRoutingLinkRecord *transitLink = 0;
+  for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork
+          || l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          transits++;
+          transitLink = l;
+        }
+    }
+  if (transits == 0)
+    {
+      return true;
+    }
+  if (transits > 1 || transitLink->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+    {
+      return false;
+    }
+  GlobalRoutingLSA *w_lsa = lsdb.GetLSA (transitLink->GetLinkId ());
+  if (w_lsa == 0)
+    {
+      return false;
+    }
+  for (uint32_t j = 0; j < w_lsa->GetNLinkRecords (); ++j)
+    {
+      GlobalRoutingLinkRecord *lr = w_lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+          && lr->GetLinkId () == rlsa->GetLinkStateId ())
+        {
+          return true;
+        }
+    }
+  return false;
 }
 
 //
@@ -959,7 +1722,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1246,7 +2009,9 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  FindRouters ();
   SPFCalculate (root);
+  m_routers.clear ();
 }
 
 //
@@ -1319,7 +2084,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
+                  Ptr<GlobalRouter> router = m_spfrootNode->GetObject<GlobalRouter> ();
                   NS_ASSERT (router);
                   Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
                   NS_ASSERT (gr);
@@ -1365,6 +2130,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  RouterMap_t::const_iterator node = m_routers.find (root);
+  m_spfrootNode = node != m_routers.end () ? node->second : 0;
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
@@ -1376,10 +2143,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootNode != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = 0;
       return;
     }
 
@@ -1501,6 +2270,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = 0;
 }
 
 void
@@ -1559,58 +2329,37 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node at the root of the SPF tree is the one we're going to write the
+// routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1625,39 +2374,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1728,60 +2474,37 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node at the root of the SPF tree is the one we're going to write the
+// routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,39 +2519,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1852,61 +2572,40 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
+// The node at the root of the SPF tree is the node for which we are
 // building the routing table.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1943,60 +2642,37 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node at the root of the SPF tree is the one we're going to write the
+// routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2681,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,44 +2706,38 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
-//
-// Done adding the routes for the selected node.
-//
-          return;
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
         }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
+            }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2088,95 +2758,70 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node at the root of the SPF tree is the one we're going to write the
+// routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -27,6 +27,8 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <set>
+#include <atomic>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -38,6 +40,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -674,6 +677,34 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the Link State Advertisements other than the external ones.
+   *
+   * @param lsas the Link State Advertisements, in the order of their link
+   * state IDs.
+   */
+  void GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const;
+
+  /**
+   * @brief Insert a copy of each Link State Advertisement of another
+   * database.
+   *
+   * The SPF calculation updates the status of the LSAs, so each thread of
+   * a parallel route computation works on its own copy of the database.
+   *
+   * @param lsdb the database to copy.
+   */
+  void Copy (const GlobalRouteManagerLSDB &lsdb);
+
+  /**
+   * @brief Compare the External Link State Advertisements with those of
+   * another database.
+   *
+   * @param lsdb the other database.
+   * @returns true if the two databases hold the same External LSAs, in the
+   * same order.
+   */
+  bool IsSameExternal (const GlobalRouteManagerLSDB &lsdb) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +712,9 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  /// container of the LSAs with the lowest link state ID which have a TransitNetwork link record, by link data
+  typedef std::map<Ipv4Address, LSDBMap_t::const_iterator> LinkDataMap_t;
+  LinkDataMap_t m_linkData; //!< index of GetLSAByLinkData
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -746,6 +780,28 @@ public:
  */
   void DebugSPFCalculate (Ipv4Address root);
 
+/**
+ * @brief Rebuild the routing database and compute again the routes of the
+ * routers which may have changed since the last computation.
+ *
+ * The new Link State Advertisements are compared to those of the current
+ * database.  The routers whose routes depend on a changed LSA are those
+ * whose own LSA changed, those which reach an LSA whose stub networks,
+ * point-to-point addresses or network mask changed, those for which a
+ * link which appeared or disappeared is on a shortest path, and those
+ * whose next hops towards a neighbor are given by a changed link record.
+ * Only the routes of those routers are deleted and computed again; a
+ * router which is a stub keeps its default route unless its neighbor's
+ * link records towards it changed.
+ *
+ * If the database is empty or the External LSAs changed, all the routes
+ * are computed again.  The routes of the routers which are not computed
+ * again are kept in the order in which they were added, so the route
+ * chosen among several equal-cost routes may differ from the one which a
+ * full recomputation would choose.
+ */
+  void UpdateRoutes ();
+
 private:
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
@@ -769,6 +825,74 @@ private:
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /// container of the nodes of the routers, by router ID
+  typedef std::map<Ipv4Address, Ptr<Node> > RouterMap_t;
+  RouterMap_t m_routers; //!< the nodes of the routers, by router ID
+  Ptr<Node> m_spfrootNode; //!< the node of the root of the SPF calculation
+  const std::vector<Ipv4Address> *m_roots; //!< the roots of a parallel computation
+  std::atomic<uint32_t> m_nextRoot; //!< the index of the next root of a parallel computation
+
+  /**
+   * \brief Find the node of each router, so that the SPF calculations
+   * look up the node of their root without a walk of the NodeList.
+   */
+  void FindRouters (void);
+
+  /**
+   * \brief Get the routers of this system which have Link State
+   * Advertisements.
+   *
+   * \param roots the router IDs of the routers, in the order of the NodeList.
+   */
+  void GetRoots (std::vector<Ipv4Address> &roots) const;
+
+  /**
+   * \brief Delete the routes of a node.
+   *
+   * \param node the node
+   */
+  void DeleteRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Run the SPF calculation of each root, in parallel if the
+   * GlobalRoutingThreads GlobalValue allows it.
+   *
+   * Each thread has a copy of the database and of the map of the routers,
+   * and writes to the routing tables of its roots only.
+   *
+   * \param roots the router IDs of the roots
+   */
+  void CalculateRoutes (const std::vector<Ipv4Address> &roots);
+
+  /**
+   * \brief Run the SPF calculations of the roots which remain.
+   *
+   * \param self the route manager which shares out the roots
+   * \param worker the route manager of the thread
+   */
+  static void RunWorker (GlobalRouteManagerImpl *self, GlobalRouteManagerImpl *worker);
+
+  /**
+   * \brief Find the routers whose routes may differ between two databases.
+   *
+   * \param oldLsdb the database of the current routes
+   * \param roots the router IDs of the routers which have LSAs
+   * \param affected the router IDs of the routers whose routes may differ
+   */
+  void GetAffectedRoots (const GlobalRouteManagerLSDB &oldLsdb,
+                         const std::vector<Ipv4Address> &roots,
+                         std::set<Ipv4Address> &affected) const;
+
+  /**
+   * \brief Test if a router is a stub for which CheckForStubNode adds
+   * its routes, without adding them.
+   *
+   * \param lsdb the database
+   * \param root the router ID of the router
+   * \returns true if the router is a stub
+   */
+  static bool IsStubNode (const GlobalRouteManagerLSDB &lsdb, Ipv4Address root);
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
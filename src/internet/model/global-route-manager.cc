@@ -21,6 +21,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulation-singleton.h"
+#include "ns3/ensemble-runner.h"
 #include "global-route-manager.h"
 #include "global-route-manager-impl.h"
 
@@ -58,11 +59,19 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes ();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint32_t routerId = 0;
+  static NS_ENSEMBLE_ATOMIC (uint32_t) routerId (0);
   return routerId++;
 }
 
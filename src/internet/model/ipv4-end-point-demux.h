@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,10 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed in hash tables by local port, and by local
+ * port and peer, so that a lookup only looks at the endpoints which can
+ * match the four-tuple, whatever the number of connections of the node.
  */
 
 class Ipv4EndPointDemux {
@@ -167,6 +172,66 @@ public:
 
 private:
 
+  /**
+   * \brief The local port and peer of the endpoints of a bucket.
+   */
+  struct Key
+  {
+    uint16_t localPort;       //!< The local port
+    Ipv4Address peerAddress;  //!< The peer address
+    uint16_t peerPort;        //!< The peer port
+
+    /**
+     * \param other The other key.
+     * \return true if the keys are equal
+     */
+    bool operator == (const Key &other) const;
+  };
+
+  /**
+   * \brief Hash function of the keys.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key The key.
+     * \return the hash of the key
+     */
+    std::size_t operator () (const Key &key) const;
+  };
+
+  /**
+   * \brief The positions of an endpoint in the list and the buckets.
+   */
+  struct Position
+  {
+    EndPointsI all;   //!< The position in m_endPoints
+    EndPointsI port;  //!< The position in the bucket of m_ports
+    EndPointsI peer;  //!< The position in the bucket of m_peers
+    Key key;          //!< The key of the bucket of m_peers
+  };
+
+  /**
+   * \brief Add an endpoint to the list and to the buckets.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Move an endpoint to the bucket of its new peer.
+   * \param endPoint the end point
+   */
+  void UpdatePeer (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Find the bucket of a local port and a peer.
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the endpoints of the bucket, or 0 if there are none
+   */
+  EndPoints *FindPeers (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort);
+
   /**
    * \brief Allocate an ephemeral port.
    * \returns the ephemeral port
@@ -192,6 +257,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+
+  /**
+   * \brief The end points, by local port and peer.
+   */
+  std::unordered_map<Key, EndPoints, KeyHash> m_peers;
+
+  /**
+   * \brief The positions of the end points.
+   */
+  std::unordered_map<Ipv4EndPoint *, Position> m_positions;
 };
 
 } // namespace ns3
@@ -47,6 +47,7 @@ Ipv4EndPoint::~Ipv4EndPoint ()
   m_rxCallback.Nullify ();
   m_icmpCallback.Nullify ();
   m_destroyCallback.Nullify ();
+  m_peerCallback.Nullify ();
 }
 
 Ipv4Address 
@@ -90,6 +91,10 @@ Ipv4EndPoint::SetPeer (Ipv4Address address, uint16_t port)
   NS_LOG_FUNCTION (this << address << port);
   m_peerAddr = address;
   m_peerPort = port;
+  if (!m_peerCallback.IsNull ())
+    {
+      m_peerCallback (this);
+    }
 }
 
 void
@@ -128,6 +133,13 @@ Ipv4EndPoint::SetDestroyCallback (Callback<void> callback)
   m_destroyCallback = callback;
 }
 
+void
+Ipv4EndPoint::SetPeerCallback (Callback<void, Ipv4EndPoint *> callback)
+{
+  NS_LOG_FUNCTION (this << &callback);
+  m_peerCallback = callback;
+}
+
 void 
 Ipv4EndPoint::ForwardUp (Ptr<Packet> p, const Ipv4Header& header, uint16_t sport,
                          Ptr<Ipv4Interface> incomingInterface)
@@ -141,6 +141,16 @@ public:
    */
   void SetDestroyCallback (Callback<void> callback);
 
+  /**
+   * \brief Set the callback invoked when the peer of the endpoint changes.
+   *
+   * The Ipv4EndPointDemux which allocated the endpoint uses it to keep
+   * its index of the peers up to date.
+   *
+   * \param callback callback function
+   */
+  void SetPeerCallback (Callback<void, Ipv4EndPoint *> callback);
+
   /**
    * \brief Forward the packet to the upper level.
    *
@@ -223,6 +233,11 @@ private:
    */
   Callback<void> m_destroyCallback;
 
+  /**
+   * \brief The callback invoked when the peer changes.
+   */
+  Callback<void, Ipv4EndPoint *> m_peerCallback;
+
   /**
    * \brief true if the endpoint can receive packets.
    */
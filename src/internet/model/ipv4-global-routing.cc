@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <cstring>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -27,6 +28,8 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/hash.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -53,13 +56,29 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("EcmpMode",
+                   "How a route is chosen among equal-cost routes; RandomEcmpRouting set to true selects Random",
+                   EnumValue (Ipv4GlobalRouting::ECMP_FIRST),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::m_ecmpMode),
+                   MakeEnumChecker (Ipv4GlobalRouting::ECMP_FIRST, "First",
+                                    Ipv4GlobalRouting::ECMP_RANDOM, "Random",
+                                    Ipv4GlobalRouting::ECMP_FLOW_HASH, "FlowHash",
+                                    Ipv4GlobalRouting::ECMP_FLOWLET, "Flowlet"))
+    .AddAttribute ("FlowletGap",
+                   "The idle time after which the next packet of a flow starts a new flowlet, with the Flowlet EcmpMode",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&Ipv4GlobalRouting::m_flowletGap),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_ecmpMode (ECMP_FIRST),
+    m_flowletsCleanupSize (1024),
+    m_indexesValid (true)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +99,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostIndex, route);
 }
 
 void 
@@ -90,6 +110,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostIndex, route);
 }
 
 void 
@@ -105,6 +126,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkIndex, route);
 }
 
 void 
@@ -118,6 +140,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkIndex, route);
 }
 
 void 
@@ -133,101 +156,220 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalIndex, route);
 }
 
+void
+Ipv4GlobalRouting::IndexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  if (m_indexesValid)
+    {
+      uint8_t address[4];
+      uint8_t mask[4];
+      if (route->IsHost ())
+        {
+          route->GetDest ().Serialize (address);
+          Ipv4Address (Ipv4Mask::GetOnes ().Get ()).Serialize (mask);
+        }
+      else
+        {
+          route->GetDestNetwork ().Serialize (address);
+          Ipv4Address (route->GetDestNetworkMask ().Get ()).Serialize (mask);
+        }
+      trie.Insert (address, mask, route);
+    }
+}
+
+void
+Ipv4GlobalRouting::UpdateIndexes (void)
+{
+  if (m_indexesValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_indexesValid = true;
+  m_hostIndex.Clear ();
+  m_networkIndex.Clear ();
+  m_ASexternalIndex.Clear ();
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      IndexRoute (m_hostIndex, *i);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      IndexRoute (m_networkIndex, *j);
+    }
+  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+    {
+      IndexRoute (m_ASexternalIndex, *k);
+    }
+}
+
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const
+{
+  // source, destination, protocol, source and destination ports, node
+  uint8_t buffer[17];
+  header.GetSource ().Serialize (buffer);
+  header.GetDestination ().Serialize (buffer + 4);
+  buffer[8] = header.GetProtocol ();
+  memset (buffer + 9, 0, 4);
+  // the TCP and UDP headers start with the ports; the fragments of a
+  // packet follow the same route without them
+  if (p != 0 && (header.GetProtocol () == 6 || header.GetProtocol () == 17)
+      && header.IsLastFragment () && header.GetFragmentOffset () == 0
+      && p->GetSize () >= 4)
+    {
+      p->CopyData (buffer + 9, 4);
+    }
+  uint32_t node = m_ipv4->GetObject<Node> ()->GetId ();
+  memcpy (buffer + 13, &node, 4);
+  return Hash32 (reinterpret_cast<char *> (buffer), sizeof (buffer));
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectRoute (const std::vector<Ipv4RoutingTableEntry*> &routes, uint32_t flowHash)
+{
+  if (routes.size () == 1)
+    {
+      return 0;
+    }
+  if (m_randomEcmpRouting || m_ecmpMode == ECMP_RANDOM)
+    {
+      return m_rand->GetInteger (0, routes.size () - 1);
+    }
+  if (m_ecmpMode == ECMP_FLOW_HASH)
+    {
+      return flowHash % routes.size ();
+    }
+  if (m_ecmpMode != ECMP_FLOWLET)
+    {
+      return 0;
+    }
+
+  Time now = Simulator::Now ();
+  std::unordered_map<uint32_t, Flowlet>::iterator i = m_flowlets.find (flowHash);
+  if (i != m_flowlets.end () && now - i->second.lastSeen <= m_flowletGap)
+    {
+      // the same flowlet: keep its route if it is still a candidate
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          if (routes[j]->GetInterface () == i->second.interface
+              && routes[j]->GetGateway () == i->second.gateway)
+            {
+              i->second.lastSeen = now;
+              return j;
+            }
+        }
+    }
+  uint32_t selectIndex = m_rand->GetInteger (0, routes.size () - 1);
+  if (i == m_flowlets.end ())
+    {
+      if (m_flowlets.size () >= m_flowletsCleanupSize)
+        {
+          // remove the flows which are idle
+          for (i = m_flowlets.begin (); i != m_flowlets.end (); )
+            {
+              if (now - i->second.lastSeen > m_flowletGap)
+                {
+                  i = m_flowlets.erase (i);
+                }
+              else
+                {
+                  i++;
+                }
+            }
+          m_flowletsCleanupSize = std::max<uint32_t> (1024, 2 * m_flowlets.size ());
+        }
+      i = m_flowlets.insert (std::make_pair (flowHash, Flowlet ())).first;
+    }
+  NS_LOG_LOGIC ("New flowlet of flow " << flowHash << " on route " << selectIndex);
+  i->second.interface = routes[selectIndex]->GetInterface ();
+  i->second.gateway = routes[selectIndex]->GetGateway ();
+  i->second.lastSeen = now;
+  return selectIndex;
+}
 
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif, uint32_t flowHash)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_FUNCTION (this << dest << oif << flowHash);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
-
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
+  RouteVec_t &allRoutes = m_allRoutes;
+  allRoutes.clear ();
+  // the routes which match the destination, in the order of the tables
+  RouteVec_t &matches = m_matches;
+  uint8_t address[4];
+  dest.Serialize (address);
+  UpdateIndexes ();
+
+  m_hostIndex.Match (address, matches);
+  NS_LOG_LOGIC ("Number of matching m_hostRoutes = " << matches.size ());
+  for (RouteVec_t::const_iterator i = matches.begin (); 
+       i != matches.end (); 
        i++) 
     {
       NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      if (oif != 0)
         {
-          if (oif != 0)
+          if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
+      allRoutes.push_back (*i);
+      NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
+      m_networkIndex.Match (address, matches);
+      NS_LOG_LOGIC ("Number of matching m_networkRoutes" << matches.size ());
+      for (RouteVec_t::const_iterator j = matches.begin (); 
+           j != matches.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (*j);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      m_ASexternalIndex.Match (address, matches);
+      for (RouteVec_t::const_iterator k = matches.begin ();
+           k != matches.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Found external route" << *k);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (*k);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else 
-        {
-          selectIndex = 0;
-        }
+      // pick up one of the routes as the ECMP mode says
+      uint32_t selectIndex = SelectRoute (allRoutes, flowHash);
       Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
@@ -321,6 +463,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
               delete *i;
               m_hostRoutes.erase (i);
+              m_indexesValid = false;
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
               return;
             }
@@ -338,6 +481,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
           delete *j;
           m_networkRoutes.erase (j);
+          m_indexesValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -354,6 +498,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
           delete *k;
           m_ASexternalRoutes.erase (k);
+          m_indexesValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -370,6 +515,26 @@ Ipv4GlobalRouting::AssignStreams (int64_t stream)
   return 1;
 }
 
+uint64_t
+Ipv4GlobalRouting::GetForwardedPackets (uint32_t interface) const
+{
+  return interface < m_forwardedPackets.size () ? m_forwardedPackets[interface] : 0;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetForwardedBytes (uint32_t interface) const
+{
+  return interface < m_forwardedBytes.size () ? m_forwardedBytes[interface] : 0;
+}
+
+void
+Ipv4GlobalRouting::ResetLoadCounters (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_forwardedPackets.clear ();
+  m_forwardedBytes.clear ();
+}
+
 void
 Ipv4GlobalRouting::DoDispose (void)
 {
@@ -392,6 +557,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostIndex.Clear ();
+  m_networkIndex.Clear ();
+  m_ASexternalIndex.Clear ();
+  m_flowlets.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -468,7 +637,8 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  uint32_t flowHash = m_ecmpMode >= ECMP_FLOW_HASH ? GetFlowHash (header, 0) : 0;
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif, flowHash);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,9 +687,18 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  uint32_t flowHash = m_ecmpMode >= ECMP_FLOW_HASH ? GetFlowHash (header, p) : 0;
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), 0, flowHash);
   if (rtentry != 0)
     {
+      uint32_t interface = m_ipv4->GetInterfaceForDevice (rtentry->GetOutputDevice ());
+      if (interface >= m_forwardedPackets.size ())
+        {
+          m_forwardedPackets.resize (interface + 1, 0);
+          m_forwardedBytes.resize (interface + 1, 0);
+        }
+      m_forwardedPackets[interface]++;
+      m_forwardedBytes[interface] += p->GetSize () + header.GetSerializedSize ();
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
       ucb (rtentry, p, header);
       return true;
@@ -537,9 +716,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -549,9 +726,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -561,9 +736,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -573,9 +746,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -65,6 +69,21 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * When several routes of equal cost lead to a destination, the EcmpMode
+ * attribute selects how one of them is chosen for each packet: always the
+ * first one, one at random, one by a hash of the flow of the packet, so that
+ * the packets of a flow are not reordered, or one at random for each
+ * flowlet of a flow, that is each burst of packets separated from the
+ * previous one by more than the FlowletGap attribute.  The flow of a
+ * forwarded packet is its 5-tuple (addresses, protocol, and the ports of a
+ * TCP or UDP packet which is not fragmented); the node ID is hashed with it
+ * so that the successive routers of a path do not make the same choices.
+ * The ports of a packet sent by the node itself are not known when it is
+ * routed, so that its flow is hashed without them.
+ *
+ * The number of packets and bytes which the node forwards on each interface
+ * is counted, to evaluate the balance of the load.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -76,6 +95,16 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// How a route is chosen among equal-cost routes
+  enum EcmpMode_e
+  {
+    ECMP_FIRST,      //!< The first route, always
+    ECMP_RANDOM,     //!< A random route for each packet
+    ECMP_FLOW_HASH,  //!< A route by a hash of the flow of the packet
+    ECMP_FLOWLET,    //!< A random route for each flowlet of a flow
+  };
+
   /**
    * \brief Construct an empty Ipv4GlobalRouting routing protocol,
    *
@@ -228,6 +257,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \param interface The index of an interface.
+   * \returns The number of packets forwarded on the interface.
+   */
+  uint64_t GetForwardedPackets (uint32_t interface) const;
+  /**
+   * \param interface The index of an interface.
+   * \returns The number of bytes, with the IP headers, forwarded on the
+   * interface.
+   */
+  uint64_t GetForwardedBytes (uint32_t interface) const;
+  /**
+   * \brief Set the counters of the forwarded packets and bytes to zero.
+   */
+  void ResetLoadCounters (void);
+
 protected:
   void DoDispose (void);
 
@@ -238,6 +283,25 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// How a route is chosen among equal-cost routes
+  EcmpMode_e m_ecmpMode;
+  /// The idle time after which a flow starts a new flowlet
+  Time m_flowletGap;
+
+  /// The route of the current flowlet of a flow
+  struct Flowlet
+  {
+    uint32_t interface;   //!< The output interface
+    Ipv4Address gateway;  //!< The gateway
+    Time lastSeen;        //!< The time of the last packet
+  };
+  /// The flowlets, by hash of their flow
+  std::unordered_map<uint32_t, Flowlet> m_flowlets;
+  /// The number of flowlets above which the idle ones are removed
+  uint32_t m_flowletsCleanupSize;
+
+  std::vector<uint64_t> m_forwardedPackets;  //!< Forwarded packets, by interface
+  std::vector<uint64_t> m_forwardedBytes;    //!< Forwarded bytes, by interface
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -260,18 +324,60 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// index of Ipv4RoutingTableEntry by destination prefix
+  typedef PrefixTrie<Ipv4RoutingTableEntry *, 4> RouteTrie;
+
+  /**
+   * \brief Add a route to the index of its table, if the indexes are
+   * up to date.
+   * \param trie the index of the table
+   * \param route the route
+   */
+  void IndexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Build the indexes of the tables again, if a route was removed.
+   */
+  void UpdateIndexes (void);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param flowHash the hash of the flow of the packet
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0, uint32_t flowHash = 0);
+
+  /**
+   * \brief Hash the flow of a packet.
+   * \param header the IPv4 header of the packet
+   * \param p the packet, without its IPv4 header, to hash its ports, or 0
+   * \return the hash of the flow and of the node
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const;
+
+  /**
+   * \brief Choose a route among equal-cost routes, by the EcmpMode.
+   * \param routes the routes
+   * \param flowHash the hash of the flow of the packet
+   * \return the index of the route
+   */
+  uint32_t SelectRoute (const std::vector<Ipv4RoutingTableEntry*> &routes, uint32_t flowHash);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteTrie m_hostIndex;        //!< Index of the routes to hosts
+  RouteTrie m_networkIndex;     //!< Index of the routes to networks
+  RouteTrie m_ASexternalIndex;  //!< Index of the external routes
+  bool m_indexesValid;          //!< True if the indexes hold all the routes
+  /// The routes which match the destination of a lookup, kept to reuse its memory
+  std::vector<Ipv4RoutingTableEntry *> m_matches;
+  /// The routes to the destination of a lookup, kept to reuse its memory
+  std::vector<Ipv4RoutingTableEntry *> m_allRoutes;
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
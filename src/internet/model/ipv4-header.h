@@ -147,6 +147,10 @@ public:
   void SetFragmentOffset (uint16_t offsetBytes);
   /**
    * \param ttl the ipv4 TTL
+   *
+   * If the header knows its checksum, because it verified it in
+   * Deserialize or calculated it in Serialize, the checksum is updated
+   * incrementally (RFC 1624) instead of being calculated again.
    */
   void SetTtl (uint8_t ttl);
   /**
@@ -257,7 +261,8 @@ private:
   uint16_t m_fragmentOffset;  //!< Fragment offset
   Ipv4Address m_source; //!< source address
   Ipv4Address m_destination; //!< destination address
-  uint16_t m_checksum; //!< checksum
+  mutable uint16_t m_checksum; //!< checksum, in the byte order of Buffer::Iterator::ReadU16
+  mutable bool m_checksumValid; //!< true if m_checksum matches the fields of the header
   bool m_goodChecksum; //!< true if checksum is correct
   uint16_t m_headerSize; //!< IP header size
 };
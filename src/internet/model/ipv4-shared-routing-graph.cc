@@ -0,0 +1,451 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <cstring>
+#include <queue>
+#include <functional>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ipv4.h"
+#include "ipv4-routing-table-entry.h"
+#include "ipv4-shared-routing-graph.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4SharedRoutingGraph");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4SharedRoutingGraph);
+
+const uint32_t Ipv4SharedRoutingGraph::INFINITE_DISTANCE;
+
+TypeId
+Ipv4SharedRoutingGraph::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4SharedRoutingGraph")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4SharedRoutingGraph> ()
+    .AddAttribute ("MaxCachedPrefixes",
+                   "The maximum number of prefixes whose distances are cached, 0 for no limit",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&Ipv4SharedRoutingGraph::m_maxCachedPrefixes),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+Ipv4SharedRoutingGraph::Ipv4SharedRoutingGraph ()
+  : m_valid (false),
+    m_maxCachedPrefixes (1024),
+    m_nComputations (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4SharedRoutingGraph::~Ipv4SharedRoutingGraph ()
+{
+  NS_LOG_FUNCTION (this);
+  ClearCache ();
+}
+
+void
+Ipv4SharedRoutingGraph::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ClearCache ();
+  m_ipv4.clear ();
+  m_firstEdge.clear ();
+  m_edges.clear ();
+  m_prefixes.clear ();
+  m_prefixIndex.Clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+Ipv4SharedRoutingGraph::AddIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  m_ipv4.push_back (ipv4);
+  m_valid = false;
+  return m_ipv4.size () - 1;
+}
+
+void
+Ipv4SharedRoutingGraph::RemoveIpv4 (uint32_t node)
+{
+  NS_LOG_FUNCTION (this << node);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  NS_ASSERT (node < m_ipv4.size ());
+  m_ipv4[node] = 0;
+  m_valid = false;
+}
+
+void
+Ipv4SharedRoutingGraph::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  m_valid = false;
+}
+
+void
+Ipv4SharedRoutingGraph::ClearCache (void)
+{
+  for (std::vector<Distances *>::iterator i = m_cache.begin (); i != m_cache.end (); i++)
+    {
+      delete *i;
+    }
+  m_cache.clear ();
+  m_lru.clear ();
+}
+
+void
+Ipv4SharedRoutingGraph::Update (void)
+{
+  if (m_valid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_valid = true;
+  ClearCache ();
+  m_firstEdge.clear ();
+  m_edges.clear ();
+  m_prefixes.clear ();
+  m_prefixIndex.Clear ();
+
+  const uint32_t none = 0xffffffff;
+  std::vector<uint32_t> indexOf;
+  for (uint32_t i = 0; i < m_ipv4.size (); i++)
+    {
+      if (m_ipv4[i] != 0)
+        {
+          uint32_t id = m_ipv4[i]->GetObject<Node> ()->GetId ();
+          if (id >= indexOf.size ())
+            {
+              indexOf.resize (id + 1, none);
+            }
+          indexOf[id] = i;
+        }
+    }
+
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> prefixOf;
+  for (uint32_t i = 0; i < m_ipv4.size (); i++)
+    {
+      m_firstEdge.push_back (m_edges.size ());
+      Ptr<Ipv4> ipv4 = m_ipv4[i];
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); j++)
+        {
+          if (!ipv4->IsUp (j) || ipv4->GetNAddresses (j) == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < ipv4->GetNAddresses (j); k++)
+            {
+              Ipv4InterfaceAddress address = ipv4->GetAddress (j, k);
+              if (address.GetLocal () == Ipv4Address::GetLoopback ())
+                {
+                  continue;
+                }
+              Ipv4Address network = address.GetLocal ().CombineMask (address.GetMask ());
+              std::pair<uint32_t, uint32_t> key (network.Get (), address.GetMask ().Get ());
+              std::map<std::pair<uint32_t, uint32_t>, uint32_t>::iterator found = prefixOf.find (key);
+              if (found == prefixOf.end ())
+                {
+                  found = prefixOf.insert (std::make_pair (key, m_prefixes.size ())).first;
+                  Prefix prefix;
+                  prefix.network = network;
+                  prefix.mask = address.GetMask ();
+                  m_prefixes.push_back (prefix);
+                }
+              Attachment attachment;
+              attachment.node = i;
+              attachment.interface = j;
+              m_prefixes[found->second].attached.push_back (attachment);
+            }
+
+          Ptr<NetDevice> device = ipv4->GetNetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          Ipv4InterfaceAddress local = ipv4->GetAddress (j, 0);
+          for (uint32_t d = 0; d < channel->GetNDevices (); d++)
+            {
+              Ptr<NetDevice> peerDevice = channel->GetDevice (d);
+              if (peerDevice == device)
+                {
+                  continue;
+                }
+              uint32_t id = peerDevice->GetNode ()->GetId ();
+              if (id >= indexOf.size () || indexOf[id] == none)
+                {
+                  continue;
+                }
+              Ptr<Ipv4> peer = m_ipv4[indexOf[id]];
+              int32_t peerInterface = peer->GetInterfaceForDevice (peerDevice);
+              if (peerInterface < 0 || !peer->IsUp (peerInterface) || peer->GetNAddresses (peerInterface) == 0)
+                {
+                  continue;
+                }
+              // the address of the neighbor in the subnet of the interface
+              Ipv4Address gateway = peer->GetAddress (peerInterface, 0).GetLocal ();
+              for (uint32_t k = 0; k < peer->GetNAddresses (peerInterface); k++)
+                {
+                  Ipv4Address candidate = peer->GetAddress (peerInterface, k).GetLocal ();
+                  if (local.GetMask ().IsMatch (candidate, local.GetLocal ()))
+                    {
+                      gateway = candidate;
+                      break;
+                    }
+                }
+              Edge edge;
+              edge.to = indexOf[id];
+              edge.interface = j;
+              edge.gateway = gateway;
+              edge.metric = ipv4->GetMetric (j);
+              edge.reverseMetric = peer->GetMetric (peerInterface);
+              m_edges.push_back (edge);
+            }
+        }
+    }
+  m_firstEdge.push_back (m_edges.size ());
+
+  for (uint32_t p = 0; p < m_prefixes.size (); p++)
+    {
+      uint8_t address[4];
+      uint8_t mask[4];
+      m_prefixes[p].network.Serialize (address);
+      Ipv4Address (m_prefixes[p].mask.Get ()).Serialize (mask);
+      m_prefixIndex.Insert (address, mask, p);
+    }
+  m_cache.resize (m_prefixes.size (), 0);
+  NS_LOG_LOGIC ("graph of " << m_ipv4.size () << " nodes, " << m_edges.size () <<
+                " links and " << m_prefixes.size () << " prefixes");
+}
+
+uint32_t
+Ipv4SharedRoutingGraph::FindPrefix (Ipv4Address dest) const
+{
+  uint8_t address[4];
+  dest.Serialize (address);
+  uint32_t best;
+  if (!m_prefixIndex.MatchLongest (address, best))
+    {
+      return m_prefixes.size ();
+    }
+  return best;
+}
+
+void
+Ipv4SharedRoutingGraph::ComputeDistances (uint32_t prefix, std::vector<uint32_t> &distance) const
+{
+  NS_LOG_FUNCTION (this << prefix);
+  distance.assign (m_ipv4.size (), INFINITE_DISTANCE);
+  // (distance, node), the closest node on top
+  typedef std::pair<uint32_t, uint32_t> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  const std::vector<Attachment> &attached = m_prefixes[prefix].attached;
+  for (std::vector<Attachment>::const_iterator i = attached.begin (); i != attached.end (); i++)
+    {
+      if (distance[i->node] != 0)
+        {
+          distance[i->node] = 0;
+          queue.push (Item (0, i->node));
+        }
+    }
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (item.first > distance[item.second])
+        {
+          continue;
+        }
+      // the links towards this node, from its neighbors
+      for (uint32_t e = m_firstEdge[item.second]; e < m_firstEdge[item.second + 1]; e++)
+        {
+          const Edge &edge = m_edges[e];
+          uint32_t candidate = item.first + edge.reverseMetric;
+          if (candidate < distance[edge.to])
+            {
+              distance[edge.to] = candidate;
+              queue.push (Item (candidate, edge.to));
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t> &
+Ipv4SharedRoutingGraph::GetDistances (uint32_t prefix)
+{
+  Distances *entry = m_cache[prefix];
+  if (entry != 0)
+    {
+      m_lru.splice (m_lru.begin (), m_lru, entry->lru);
+      return entry->distance;
+    }
+  m_nComputations++;
+  if (m_maxCachedPrefixes > 0 && m_lru.size () >= m_maxCachedPrefixes)
+    {
+      // reuse the entry of the prefix which was used least recently
+      uint32_t victim = m_lru.back ();
+      m_lru.pop_back ();
+      entry = m_cache[victim];
+      m_cache[victim] = 0;
+    }
+  else
+    {
+      entry = new Distances;
+    }
+  ComputeDistances (prefix, entry->distance);
+  m_lru.push_front (prefix);
+  entry->lru = m_lru.begin ();
+  m_cache[prefix] = entry;
+  return entry->distance;
+}
+
+bool
+Ipv4SharedRoutingGraph::GetRoute (uint32_t node, uint32_t prefix, Ipv4Address dest, Ptr<NetDevice> oif,
+                                  Ipv4RoutingTableEntry &route)
+{
+  NS_ASSERT (node < m_ipv4.size () && m_ipv4[node] != 0);
+  const Prefix &p = m_prefixes[prefix];
+  for (std::vector<Attachment>::const_iterator i = p.attached.begin (); i != p.attached.end (); i++)
+    {
+      if (i->node == node && (oif == 0 || oif == m_ipv4[node]->GetNetDevice (i->interface)))
+        {
+          route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (p.network, p.mask, i->interface);
+          return true;
+        }
+    }
+
+  const std::vector<uint32_t> &distance = GetDistances (prefix);
+  if (distance[node] == INFINITE_DISTANCE)
+    {
+      return false;
+    }
+  std::vector<uint32_t> nextHops;
+  for (uint32_t e = m_firstEdge[node]; e < m_firstEdge[node + 1]; e++)
+    {
+      const Edge &edge = m_edges[e];
+      if (distance[edge.to] != INFINITE_DISTANCE
+          && edge.metric + distance[edge.to] == distance[node]
+          && (oif == 0 || oif == m_ipv4[node]->GetNetDevice (edge.interface)))
+        {
+          nextHops.push_back (e);
+        }
+    }
+  if (nextHops.empty ())
+    {
+      return false;
+    }
+  uint32_t e = nextHops[0];
+  if (nextHops.size () > 1)
+    {
+      // the node takes part in the hash so that the choices of successive
+      // nodes are not correlated
+      char buffer[8];
+      dest.Serialize (reinterpret_cast<uint8_t *> (buffer));
+      memcpy (buffer + 4, &node, 4);
+      e = nextHops[Hash32 (buffer, 8) % nextHops.size ()];
+    }
+  route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (p.network, p.mask, m_edges[e].gateway, m_edges[e].interface);
+  return true;
+}
+
+bool
+Ipv4SharedRoutingGraph::Lookup (uint32_t node, Ipv4Address dest, Ptr<NetDevice> oif, Ipv4RoutingTableEntry &route)
+{
+  NS_LOG_FUNCTION (this << node << dest << oif);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Update ();
+  uint32_t prefix = FindPrefix (dest);
+  if (prefix == m_prefixes.size ())
+    {
+      NS_LOG_LOGIC ("no prefix matches " << dest);
+      return false;
+    }
+  return GetRoute (node, prefix, dest, oif, route);
+}
+
+void
+Ipv4SharedRoutingGraph::GetRoutes (uint32_t node, std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << node);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Update ();
+  routes.clear ();
+  for (uint32_t p = 0; p < m_prefixes.size (); p++)
+    {
+      Ipv4RoutingTableEntry route;
+      if (GetRoute (node, p, m_prefixes[p].network, 0, route))
+        {
+          routes.push_back (route);
+        }
+    }
+}
+
+uint32_t
+Ipv4SharedRoutingGraph::GetNPrefixes (void)
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Update ();
+  return m_prefixes.size ();
+}
+
+uint32_t
+Ipv4SharedRoutingGraph::GetNCachedPrefixes (void) const
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  return m_lru.size ();
+}
+
+uint64_t
+Ipv4SharedRoutingGraph::GetNComputations (void) const
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  return m_nComputations;
+}
+
+} // namespace ns3
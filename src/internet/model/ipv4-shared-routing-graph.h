@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_SHARED_ROUTING_GRAPH_H
+#define IPV4_SHARED_ROUTING_GRAPH_H
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/system-mutex.h"
+
+namespace ns3 {
+
+class Ipv4;
+class NetDevice;
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief The graph of the nodes of an Ipv4SharedRouting domain, from which
+ * the routes are computed on demand.
+ *
+ * With Ipv4GlobalRouting, every node stores a route to every destination,
+ * so that the memory grows as the square of the number of nodes.  The
+ * Ipv4SharedRouting protocols of a domain instead share a single graph of
+ * their nodes: the links between the nodes whose devices are attached to
+ * the same channel, and the prefixes of the addresses of their interfaces.
+ *
+ * When a route to a prefix is needed, the distance of every node to the
+ * prefix is computed with the Dijkstra algorithm, from the nodes attached
+ * to the prefix, over the metrics of the interfaces; the next hops of a
+ * node towards the prefix are then its neighbors which are closer to the
+ * prefix by the metric of the link.  The distances to the prefixes which
+ * were used most recently are kept in a cache, whose size is limited by
+ * the MaxCachedPrefixes attribute, so that the memory grows with the
+ * number of nodes and links only.
+ *
+ * Among equal-cost next hops, a node chooses one by a hash of the
+ * destination address, so that the packets to a destination follow a
+ * single path and the destinations are spread over the paths.
+ *
+ * The graph is built again, and the cache emptied, on the first lookup
+ * after a change of an interface or of an address of a node.  Nodes which
+ * are connected through a bridge are not adjacent in the graph.
+ *
+ * With --enable-mtp, the nodes of a domain may route packets in several
+ * threads at once, and each lookup updates the cache: the public methods
+ * then hold a mutex of the graph.
+ */
+class Ipv4SharedRoutingGraph : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4SharedRoutingGraph ();
+  virtual ~Ipv4SharedRoutingGraph ();
+
+  /**
+   * \brief Add a node to the graph.
+   *
+   * \param ipv4 The Ipv4 of the node.
+   * \returns The index of the node in the graph.
+   */
+  uint32_t AddIpv4 (Ptr<Ipv4> ipv4);
+  /**
+   * \brief Remove a node from the graph.
+   *
+   * \param node The index of the node in the graph.
+   */
+  void RemoveIpv4 (uint32_t node);
+  /**
+   * \brief Build the graph again on the next lookup, after a change of the
+   * interfaces or of the addresses of a node.
+   */
+  void Invalidate (void);
+
+  /**
+   * \brief Look up the route of a node to a destination.
+   *
+   * \param node The index of the node in the graph.
+   * \param dest The destination address.
+   * \param oif The output device, if the route must use one.
+   * \param [out] route The route, to the prefix which matches the
+   * destination.
+   * \returns true if a route was found.
+   */
+  bool Lookup (uint32_t node, Ipv4Address dest, Ptr<NetDevice> oif, Ipv4RoutingTableEntry &route);
+  /**
+   * \brief Get the routes of a node to all the prefixes which it can reach.
+   *
+   * The distances to every prefix are computed, and may replace the
+   * content of the cache.
+   *
+   * \param node The index of the node in the graph.
+   * \param [out] routes The routes.
+   */
+  void GetRoutes (uint32_t node, std::vector<Ipv4RoutingTableEntry> &routes);
+
+  /** \returns The number of prefixes of the graph. */
+  uint32_t GetNPrefixes (void);
+  /** \returns The number of prefixes whose distances are in the cache. */
+  uint32_t GetNCachedPrefixes (void) const;
+  /**
+   * \returns The number of times the distances to a prefix were computed
+   * because they were not in the cache.
+   */
+  uint64_t GetNComputations (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** A link from a node to a neighbor. */
+  struct Edge
+  {
+    uint32_t to;             //!< The index of the neighbor
+    uint32_t interface;      //!< The interface of the node
+    Ipv4Address gateway;     //!< The address of the neighbor on the link
+    uint32_t metric;         //!< The metric of the interface of the node
+    uint32_t reverseMetric;  //!< The metric of the interface of the neighbor
+  };
+
+  /** An interface of a node with an address in a prefix. */
+  struct Attachment
+  {
+    uint32_t node;           //!< The index of the node
+    uint32_t interface;      //!< The interface
+  };
+
+  /** A prefix of the addresses of the interfaces. */
+  struct Prefix
+  {
+    Ipv4Address network;                 //!< The network address
+    Ipv4Mask mask;                       //!< The mask
+    std::vector<Attachment> attached;    //!< The interfaces in the prefix
+  };
+
+  /** The distances of the nodes to a prefix. */
+  struct Distances
+  {
+    std::vector<uint32_t> distance;      //!< The distance of each node
+    std::list<uint32_t>::iterator lru;   //!< The prefix in m_lru
+  };
+
+  /** Build the graph if it was invalidated. */
+  void Update (void);
+  /**
+   * \param dest A destination address.
+   * \returns The index of the longest prefix which matches the address,
+   * or the number of prefixes if none does.
+   */
+  uint32_t FindPrefix (Ipv4Address dest) const;
+  /**
+   * \param prefix The index of a prefix.
+   * \returns The distances of the nodes to the prefix, from the cache or
+   * computed.
+   */
+  const std::vector<uint32_t> & GetDistances (uint32_t prefix);
+  /**
+   * \brief Compute the distances of the nodes to a prefix.
+   *
+   * \param prefix The index of the prefix.
+   * \param [out] distance The distance of each node.
+   */
+  void ComputeDistances (uint32_t prefix, std::vector<uint32_t> &distance) const;
+  /** Empty the cache. */
+  void ClearCache (void);
+  /**
+   * \brief Get the route of a node to a prefix.
+   *
+   * \param node The index of the node.
+   * \param prefix The index of the prefix.
+   * \param dest The destination address, which chooses among equal-cost
+   * next hops.
+   * \param oif The output device, if the route must use one.
+   * \param [out] route The route.
+   * \returns true if a route was found.
+   */
+  bool GetRoute (uint32_t node, uint32_t prefix, Ipv4Address dest, Ptr<NetDevice> oif,
+                 Ipv4RoutingTableEntry &route);
+
+  /// The value of an unreachable distance
+  static const uint32_t INFINITE_DISTANCE = 0xffffffff;
+
+  std::vector<Ptr<Ipv4> > m_ipv4;      //!< The nodes, by index
+  bool m_valid;                        //!< Whether the graph is up to date
+  std::vector<uint32_t> m_firstEdge;   //!< The first edge of each node, and the end
+  std::vector<Edge> m_edges;           //!< The edges, by node
+  std::vector<Prefix> m_prefixes;      //!< The prefixes
+  PrefixTrie<uint32_t, 4> m_prefixIndex;  //!< Index of the prefixes
+  std::vector<Distances *> m_cache;    //!< The cached distances, by prefix
+  std::list<uint32_t> m_lru;           //!< The cached prefixes, most recent first
+  uint32_t m_maxCachedPrefixes;        //!< The maximum number of cached prefixes
+  uint64_t m_nComputations;            //!< The number of computed distances
+#ifdef NS3_MTP
+  mutable SystemMutex m_mutex;         //!< Serializes the lookups of the partitions
+#endif
+};
+
+} // namespace ns3
+
+#endif /* IPV4_SHARED_ROUTING_GRAPH_H */
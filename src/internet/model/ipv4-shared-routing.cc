@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <iomanip>
+#include "ns3/names.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/node.h"
+#include "ipv4-shared-routing.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4SharedRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4SharedRouting);
+
+TypeId
+Ipv4SharedRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4SharedRouting")
+    .SetParent<Ipv4RoutingProtocol> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4SharedRouting> ()
+  ;
+  return tid;
+}
+
+Ipv4SharedRouting::Ipv4SharedRouting ()
+  : m_node (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4SharedRouting::~Ipv4SharedRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4SharedRouting::SetGraph (Ptr<Ipv4SharedRoutingGraph> graph)
+{
+  NS_LOG_FUNCTION (this << graph);
+  NS_ASSERT (m_graph == 0 && graph != 0);
+  m_graph = graph;
+  if (m_ipv4 != 0)
+    {
+      m_node = m_graph->AddIpv4 (m_ipv4);
+    }
+}
+
+Ptr<Ipv4SharedRoutingGraph>
+Ipv4SharedRouting::GetGraph (void) const
+{
+  return m_graph;
+}
+
+void
+Ipv4SharedRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_graph != 0 && m_ipv4 != 0)
+    {
+      m_graph->RemoveIpv4 (m_node);
+    }
+  m_graph = 0;
+  m_ipv4 = 0;
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
+Ptr<Ipv4Route>
+Ipv4SharedRouting::LookupShared (Ipv4Address dest, Ptr<NetDevice> oif) const
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  if (m_graph == 0)
+    {
+      return 0;
+    }
+  Ipv4RoutingTableEntry route;
+  if (!m_graph->Lookup (m_node, dest, oif, route))
+    {
+      NS_LOG_LOGIC ("No route to " << dest);
+      return 0;
+    }
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (dest);
+  /// \todo handle multi-address case
+  rtentry->SetSource (m_ipv4->GetAddress (route.GetInterface (), 0).GetLocal ());
+  rtentry->SetGateway (route.GetGateway ());
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (route.GetInterface ()));
+  NS_LOG_LOGIC ("Route to " << dest << " through " << route.GetGateway () <<
+                " on interface " << route.GetInterface ());
+  return rtentry;
+}
+
+// Formatted like output of "route -n" command
+void
+Ipv4SharedRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+  NS_LOG_FUNCTION (this << stream);
+  std::ostream* os = stream->GetStream ();
+
+  *os << "Node: " << m_ipv4->GetObject<Node> ()->GetId ()
+      << ", Time: " << Now().As (unit)
+      << ", Local time: " << m_ipv4->GetObject<Node> ()->GetLocalTime ().As (unit)
+      << ", Ipv4SharedRouting table" << std::endl;
+
+  std::vector<Ipv4RoutingTableEntry> routes;
+  if (m_graph != 0)
+    {
+      m_graph->GetRoutes (m_node, routes);
+    }
+  if (routes.size () > 0)
+    {
+      *os << "Destination     Gateway         Genmask         Flags Metric Ref    Use Iface" << std::endl;
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          std::ostringstream dest, gw, mask, flags;
+          const Ipv4RoutingTableEntry &route = routes[j];
+          dest << route.GetDestNetwork ();
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
+          gw << route.GetGateway ();
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << gw.str ();
+          mask << route.GetDestNetworkMask ();
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << mask.str ();
+          flags << "U";
+          if (route.IsGateway ())
+            {
+              flags << "G";
+            }
+          *os << std::setiosflags (std::ios::left) << std::setw (6) << flags.str ();
+          // Metric not implemented
+          *os << "-" << "      ";
+          // Ref ct not implemented
+          *os << "-" << "      ";
+          // Use not implemented
+          *os << "-" << "   ";
+          if (Names::FindName (m_ipv4->GetNetDevice (route.GetInterface ())) != "")
+            {
+              *os << Names::FindName (m_ipv4->GetNetDevice (route.GetInterface ()));
+            }
+          else
+            {
+              *os << route.GetInterface ();
+            }
+          *os << std::endl;
+        }
+    }
+  *os << std::endl;
+}
+
+Ptr<Ipv4Route>
+Ipv4SharedRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << p << &header << oif << &sockerr);
+  if (header.GetDestination ().IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination-- returning false");
+      return 0; // Let other routing protocols try to handle this
+    }
+  Ptr<Ipv4Route> rtentry = LookupShared (header.GetDestination (), oif);
+  if (rtentry)
+    {
+      sockerr = Socket::ERROR_NOTERROR;
+    }
+  else
+    {
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+    }
+  return rtentry;
+}
+
+bool
+Ipv4SharedRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p << header << header.GetSource () << header.GetDestination () << idev << &lcb << &ecb);
+  // Check if input device supports IP
+  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+
+  if (m_ipv4->IsDestinationAddress (header.GetDestination (), iif))
+    {
+      if (!lcb.IsNull ())
+        {
+          NS_LOG_LOGIC ("Local delivery to " << header.GetDestination ());
+          lcb (p, header, iif);
+          return true;
+        }
+      else
+        {
+          // The local delivery callback is null.  This may be a multicast
+          // or broadcast packet, so return false so that another
+          // multicast routing protocol can handle it.
+          return false;
+        }
+    }
+
+  // Check if input device supports IP forwarding
+  if (m_ipv4->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+  Ptr<Ipv4Route> rtentry = LookupShared (header.GetDestination ());
+  if (rtentry != 0)
+    {
+      NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
+      ucb (rtentry, p, header);
+      return true;
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Did not find unicast destination- returning false");
+      return false; // Let other routing protocols try to handle this
+                    // route request.
+    }
+}
+
+void
+Ipv4SharedRouting::NotifyInterfaceUp (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_graph != 0)
+    {
+      m_graph->Invalidate ();
+    }
+}
+
+void
+Ipv4SharedRouting::NotifyInterfaceDown (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_graph != 0)
+    {
+      m_graph->Invalidate ();
+    }
+}
+
+void
+Ipv4SharedRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  if (m_graph != 0)
+    {
+      m_graph->Invalidate ();
+    }
+}
+
+void
+Ipv4SharedRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  if (m_graph != 0)
+    {
+      m_graph->Invalidate ();
+    }
+}
+
+void
+Ipv4SharedRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+  NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
+  m_ipv4 = ipv4;
+  if (m_graph != 0)
+    {
+      m_node = m_graph->AddIpv4 (m_ipv4);
+    }
+}
+
+} // namespace ns3
@@ -54,11 +54,41 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_indexValid (true),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4StaticRouting::IndexRoute (const std::pair <Ipv4RoutingTableEntry *, uint32_t> &route)
+{
+  if (m_indexValid)
+    {
+      uint8_t address[4];
+      uint8_t mask[4];
+      route.first->GetDestNetwork ().Serialize (address);
+      Ipv4Address (route.first->GetDestNetworkMask ().Get ()).Serialize (mask);
+      m_networkIndex.Insert (address, mask, route);
+    }
+}
+
+void
+Ipv4StaticRouting::UpdateIndex (void)
+{
+  if (m_indexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_indexValid = true;
+  m_networkIndex.Clear ();
+  for (NetworkRoutesCI i = m_networkRoutes.begin (); i != m_networkRoutes.end (); i++)
+    {
+      IndexRoute (*i);
+    }
+}
+
 void 
 Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network, 
                                       Ipv4Mask networkMask, 
@@ -73,6 +103,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  IndexRoute (m_networkRoutes.back ());
 }
 
 void 
@@ -87,6 +118,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  IndexRoute (m_networkRoutes.back ());
 }
 
 void 
@@ -144,6 +176,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  IndexRoute (m_networkRoutes.back ());
 }
 
 uint32_t 
@@ -240,8 +273,13 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  // scan the routes which match the destination, in the order of the table
+  uint8_t address[4];
+  dest.Serialize (address);
+  UpdateIndex ();
+  m_networkIndex.Match (address, m_matches);
+  for (std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::const_iterator i = m_matches.begin (); 
+       i != m_matches.end (); 
        i++) 
     {
       Ipv4RoutingTableEntry *j=i->first;
@@ -449,6 +487,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_indexValid = false;
           return;
         }
       tmp++;
@@ -575,6 +614,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkIndex.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -615,6 +655,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_indexValid = false;
         }
       else
         {
@@ -662,6 +703,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_indexValid = false;
         }
       else
         {
@@ -29,7 +29,7 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6AutoconfiguredPrefix");
 
-uint32_t Ipv6AutoconfiguredPrefix::m_prefixId = 0;
+NS_ENSEMBLE_ATOMIC (uint32_t) Ipv6AutoconfiguredPrefix::m_prefixId (0);
 
 Ipv6AutoconfiguredPrefix::Ipv6AutoconfiguredPrefix (Ptr<Node> node, uint32_t interface, Ipv6Address prefix, Ipv6Prefix mask, uint32_t preferredLifeTime, uint32_t validLifeTime, Ipv6Address router)
 {
@@ -41,8 +41,7 @@ Ipv6AutoconfiguredPrefix::Ipv6AutoconfiguredPrefix (Ptr<Node> node, uint32_t int
   m_interface = interface;
   m_validLifeTime = validLifeTime;
   m_preferredLifeTime = preferredLifeTime;
-  m_id = m_prefixId;
-  m_prefixId++;
+  m_id = m_prefixId++;
   m_preferred = false;
   m_valid = false;
   m_prefix = prefix;
@@ -29,6 +29,7 @@
 
 #include "ns3/timer.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/ensemble-runner.h"
 
 namespace ns3
 {
@@ -207,7 +208,7 @@ private:
   /**
    * \brief a static identifier.
    */
-  static uint32_t m_prefixId;
+  static NS_ENSEMBLE_ATOMIC (uint32_t) m_prefixId;
 
   /**
    * \brief the identifier of this prefix.
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed in hash tables by local port, and by local
+ * port and peer, so that a lookup only looks at the endpoints which can
+ * match the four-tuple, whatever the number of connections of the node.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +158,72 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  /**
+   * \brief The local port and peer of the endpoints of a bucket.
+   */
+  struct Key
+  {
+    uint16_t localPort;       //!< The local port
+    Ipv6Address peerAddress;  //!< The peer address
+    uint16_t peerPort;        //!< The peer port
+
+    /**
+     * \param other The other key.
+     * \return true if the keys are equal
+     */
+    bool operator == (const Key &other) const;
+  };
+
+  /**
+   * \brief Hash function of the keys.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key The key.
+     * \return the hash of the key
+     */
+    std::size_t operator () (const Key &key) const;
+  };
+
+  /**
+   * \brief The positions of an endpoint in the list and the buckets.
+   */
+  struct Position
+  {
+    EndPointsI all;   //!< The position in m_endPoints
+    EndPointsI port;  //!< The position in the bucket of m_ports
+    EndPointsI peer;  //!< The position in the bucket of m_peers
+    Key key;          //!< The key of the buckets of m_ports and m_peers
+  };
+
+  /**
+   * \brief Add an endpoint to the list and to the buckets.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the buckets of its key.
+   * \param position the position of the end point
+   */
+  void RemoveFromBuckets (Position &position);
+
+  /**
+   * \brief Move an endpoint to the buckets of its new local port and peer.
+   * \param endPoint the end point
+   */
+  void UpdatePeer (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Find the bucket of a local port and a peer.
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the endpoints of the bucket, or 0 if there are none
+   */
+  EndPoints *FindPeers (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +249,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+
+  /**
+   * \brief The end points, by local port and peer.
+   */
+  std::unordered_map<Key, EndPoints, KeyHash> m_peers;
+
+  /**
+   * \brief The positions of the end points.
+   */
+  std::unordered_map<Ipv6EndPoint *, Position> m_positions;
 };
 
 } /* namespace ns3 */
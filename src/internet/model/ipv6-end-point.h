@@ -151,6 +151,17 @@ public:
    */
   void SetDestroyCallback (Callback<void> callback);
 
+  /**
+   * \brief Set the callback invoked when the local port or the peer of
+   * the endpoint changes.
+   *
+   * The Ipv6EndPointDemux which allocated the endpoint uses it to keep
+   * its indexes up to date.
+   *
+   * \param callback callback function
+   */
+  void SetPeerCallback (Callback<void, Ipv6EndPoint *> callback);
+
   /**
    * \brief Forward the packet to the upper level.
    *
@@ -232,6 +243,11 @@ private:
    */
   Callback<void> m_destroyCallback;
 
+  /**
+   * \brief The callback invoked when the local port or the peer changes.
+   */
+  Callback<void, Ipv6EndPoint *> m_peerCallback;
+
   /**
    * \brief true if the endpoint can receive packets.
    */
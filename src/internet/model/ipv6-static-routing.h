@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -255,6 +256,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<std::pair <Ipv6RoutingTableEntry *, uint32_t>, 16> NetworkRoutesIndex;
+
   /// Container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -281,11 +285,38 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Add a network route to the index, if it is up to date.
+   * \param route the route and its metric
+   */
+  void IndexRoute (const std::pair <Ipv6RoutingTableEntry *, uint32_t> &route);
+
+  /**
+   * \brief Build the index again, if a route was removed.
+   */
+  void UpdateIndex ();
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of m_networkRoutes by destination prefix.
+   */
+  NetworkRoutesIndex m_networkIndex;
+
+  /**
+   * \brief true if m_networkIndex holds all the network routes.
+   */
+  bool m_indexValid;
+
+  /**
+   * \brief the network routes which match the destination of a lookup,
+   * kept to reuse its memory.
+   */
+  std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > m_matches;
+
   /**
    * \brief the forwarding table for multicast.
    */
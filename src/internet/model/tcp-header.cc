@@ -51,6 +51,34 @@ TcpHeader::~TcpHeader ()
 {
 }
 
+Header *
+TcpHeader::Clone (void) const
+{
+  return new TcpHeader (*this);
+}
+
+bool
+TcpHeader::Assign (const Header &header)
+{
+  if (m_calcChecksum)
+    {
+      // the checksum covers the pseudo-header set by this header
+      return false;
+    }
+  const TcpHeader &o = static_cast<const TcpHeader &> (header);
+  m_sourcePort = o.m_sourcePort;
+  m_destinationPort = o.m_destinationPort;
+  m_sequenceNumber = o.m_sequenceNumber;
+  m_ackNumber = o.m_ackNumber;
+  m_length = o.m_length;
+  m_flags = o.m_flags;
+  m_windowSize = o.m_windowSize;
+  m_urgentPointer = o.m_urgentPointer;
+  m_options = o.m_options;
+  m_optionsLen = o.m_optionsLen;
+  return true;
+}
+
 std::string
 TcpHeader::FlagsToString (uint8_t flags, const std::string& delimiter)
 {
@@ -315,14 +343,32 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+  // the fixed part of the header is written at once
+  uint8_t buffer[20];
+  uint32_t sequenceNumber = m_sequenceNumber.GetValue ();
+  uint32_t ackNumber = m_ackNumber.GetValue ();
+  uint16_t field = GetLength () << 12 | m_flags; //reserved bits are all zero
+  buffer[0] = m_sourcePort >> 8;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = m_destinationPort >> 8;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = sequenceNumber >> 24;
+  buffer[5] = (sequenceNumber >> 16) & 0xff;
+  buffer[6] = (sequenceNumber >> 8) & 0xff;
+  buffer[7] = sequenceNumber & 0xff;
+  buffer[8] = ackNumber >> 24;
+  buffer[9] = (ackNumber >> 16) & 0xff;
+  buffer[10] = (ackNumber >> 8) & 0xff;
+  buffer[11] = ackNumber & 0xff;
+  buffer[12] = field >> 8;
+  buffer[13] = field & 0xff;
+  buffer[14] = m_windowSize >> 8;
+  buffer[15] = m_windowSize & 0xff;
+  buffer[16] = 0;
+  buffer[17] = 0;
+  buffer[18] = m_urgentPointer >> 8;
+  buffer[19] = m_urgentPointer & 0xff;
+  i.Write (buffer, 20);
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
@@ -361,16 +407,17 @@ TcpHeader::Deserialize (Buffer::Iterator start)
 {
   m_optionsLen = 0;
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_sequenceNumber = i.ReadNtohU32 ();
-  m_ackNumber = i.ReadNtohU32 ();
-  uint16_t field = i.ReadNtohU16 ();
-  m_flags = field & 0xFF;
-  m_length = field >> 12;
-  m_windowSize = i.ReadNtohU16 ();
-  i.Next (2);
-  m_urgentPointer = i.ReadNtohU16 ();
+  // the fixed part of the header is read at once
+  uint8_t buffer[20];
+  i.Read (buffer, 20);
+  m_sourcePort = (buffer[0] << 8) | buffer[1];
+  m_destinationPort = (buffer[2] << 8) | buffer[3];
+  m_sequenceNumber = (uint32_t (buffer[4]) << 24) | (buffer[5] << 16) | (buffer[6] << 8) | buffer[7];
+  m_ackNumber = (uint32_t (buffer[8]) << 24) | (buffer[9] << 16) | (buffer[10] << 8) | buffer[11];
+  m_flags = buffer[13];
+  m_length = buffer[12] >> 4;
+  m_windowSize = (buffer[14] << 8) | buffer[15];
+  m_urgentPointer = (buffer[18] << 8) | buffer[19];
 
   // Deserialize options if they exist
   m_options.clear ();
@@ -299,6 +299,15 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual Header * Clone (void) const;
+  /**
+   * \param header a copy of a TcpHeader, made by Clone.
+   * \returns false if this header verifies its checksum.
+   *
+   * Set the fields and the options of this header to those of
+   * \pname{header}, keeping the checksum settings of this header.
+   */
+  virtual bool Assign (const Header &header);
 
   /**
    * \brief Is the TCP checksum correct ?
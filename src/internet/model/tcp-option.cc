@@ -27,6 +27,7 @@
 
 #include "ns3/type-id.h"
 #include "ns3/log.h"
+#include "ns3/ensemble-runner.h"
 
 #include <vector>
 
@@ -70,7 +71,7 @@ TcpOption::CreateOption (uint8_t kind)
     TypeId tid;
   };
 
-  static ObjectFactory objectFactory;
+  static NS_ENSEMBLE_THREAD_LOCAL ObjectFactory objectFactory;
   static kindToTid toTid[] =
   {
     { TcpOption::END,           TcpOptionEnd::GetTypeId () },
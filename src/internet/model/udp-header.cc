@@ -185,21 +185,22 @@ UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  if (m_payloadSize == 0)
-    {
-      i.WriteHtonU16 (start.GetSize ());
-    }
-  else
-    {
-      i.WriteHtonU16 (m_payloadSize);
-    }
+  // the header is written at once
+  uint8_t buffer[8];
+  uint16_t length = m_payloadSize == 0 ? start.GetSize () : m_payloadSize;
+  buffer[0] = m_sourcePort >> 8;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = m_destinationPort >> 8;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = length >> 8;
+  buffer[5] = length & 0xff;
+  // the checksum is kept in the byte order of the packet
+  buffer[6] = m_checksum & 0xff;
+  buffer[7] = m_checksum >> 8;
+  i.Write (buffer, 8);
 
   if ( m_checksum == 0)
     {
-      i.WriteU16 (0);
-
       if (m_calcChecksum)
         {
           uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
@@ -211,19 +212,18 @@ UdpHeader::Serialize (Buffer::Iterator start) const
           i.WriteU16 (checksum);
         }
     }
-  else
-    {
-      i.WriteU16 (m_checksum);
-    }
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_payloadSize = i.ReadNtohU16 () - GetSerializedSize ();
-  m_checksum = i.ReadU16 ();
+  // the header is read at once
+  uint8_t buffer[8];
+  i.Read (buffer, 8);
+  m_sourcePort = (buffer[0] << 8) | buffer[1];
+  m_destinationPort = (buffer[2] << 8) | buffer[3];
+  m_payloadSize = ((buffer[4] << 8) | buffer[5]) - GetSerializedSize ();
+  m_checksum = buffer[6] | (buffer[7] << 8);
 
   if (m_calcChecksum)
     {
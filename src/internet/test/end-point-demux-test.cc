@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * The number of connections of the server in the tests.
+ */
+static const uint32_t N_CONNECTIONS = 100000;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of an Ipv4EndPointDemux with a server which
+ * has a hundred thousand connections on the same port, and the
+ * precedence of the exact and wildcard matches.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param i The index of a connection.
+   * \return the address of the peer of the connection
+   */
+  static Ipv4Address GetPeerAddress (uint32_t i);
+  /**
+   * \param i The index of a connection.
+   * \return the port of the peer of the connection
+   */
+  static uint16_t GetPeerPort (uint32_t i);
+  /**
+   * Look up the endpoint of a packet, which must be unique.
+   *
+   * \param demux The demux.
+   * \param daddr The destination address.
+   * \param dport The destination port.
+   * \param saddr The source address.
+   * \param sport The source port.
+   * \return the endpoint, or 0 if there is none
+   */
+  Ipv4EndPoint *Lookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                        Ipv4Address saddr, uint16_t sport);
+
+  Ptr<Ipv4Interface> m_interface; //!< The incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Look up the endpoints of 100000 IPv4 connections")
+{
+}
+
+Ipv4Address
+Ipv4EndPointDemuxTestCase::GetPeerAddress (uint32_t i)
+{
+  return Ipv4Address (Ipv4Address ("10.2.0.0").Get () + i / 1000);
+}
+
+uint16_t
+Ipv4EndPointDemuxTestCase::GetPeerPort (uint32_t i)
+{
+  return 1024 + i % 1000;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::Lookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                                   Ipv4Address saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  Ipv4EndPointDemux demux;
+  Ipv4Address local ("10.1.0.1");
+  Ipv4Address other ("10.1.0.2");
+  Ipv4Address unknown ("10.3.0.1");
+
+  Ipv4EndPoint *any = demux.Allocate (0, Ipv4Address::GetAny (), 80);
+  Ipv4EndPoint *listener = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (any, 0, "cannot listen on any address");
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "cannot listen on " << local);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80), 0, "duplicated listener");
+
+  std::vector<Ipv4EndPoint *> connections (N_CONNECTIONS);
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      connections[i] = demux.Allocate (0, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_NE (connections[i], 0, "cannot allocate connection " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, GetPeerAddress (7), GetPeerPort (7)), 0,
+                         "duplicated connection");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), N_CONNECTIONS + 2, "wrong number of endpoints");
+
+  // each connection gets its own packets, the listeners get the others
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      Ipv4EndPoint *endPoint = Lookup (demux, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_EQ (endPoint, connections[i], "wrong endpoint of connection " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), listener, "no listener on " << local);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, other, 80, unknown, 1024), any, "no listener on any address");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 81, unknown, 1024), 0, "no endpoint on port 81");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, GetPeerAddress (12345), GetPeerPort (12345)),
+                         connections[12345], "wrong simple lookup of a connection");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 81, unknown, 1024), 0, "wrong simple lookup on port 81");
+
+  // a connection on any local address is less specific than one on the
+  // destination address, and more specific than the listeners
+  Ipv4EndPoint *wildcard = demux.Allocate (0, Ipv4Address::GetAny (), 80, unknown, 1024);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), wildcard, "wrong wildcard connection");
+  Ipv4EndPoint *exact = demux.Allocate (0, local, 80, unknown, 1024);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), exact, "wrong exact connection");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, other, 80, unknown, 1024), wildcard, "wrong wildcard connection");
+
+  // endpoints which cannot receive are skipped
+  connections[0]->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, GetPeerAddress (0), GetPeerPort (0)), listener,
+                         "endpoint with rx disabled");
+  connections[0]->SetRxEnabled (true);
+
+  // a socket which connects sets the peer of its endpoint after allocation
+  Ipv4EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "cannot allocate an ephemeral port");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "ephemeral port not in use");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5000), client, "unconnected client");
+  client->SetPeer (unknown, 5000);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5000), client, "connected client");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5001), 0, "client with the old peer");
+
+  // closing a connection sends its packets to the listener again
+  for (uint32_t i = 0; i < N_CONNECTIONS; i += 2)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      Ipv4EndPoint *endPoint = Lookup (demux, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_EQ (endPoint, (i % 2 == 0) ? listener : connections[i], "wrong endpoint after close " << i);
+    }
+  for (uint32_t i = 1; i < N_CONNECTIONS; i += 2)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  demux.DeAllocate (wildcard);
+  demux.DeAllocate (exact);
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "ephemeral port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "no listener on port 80");
+  demux.DeAllocate (listener);
+  demux.DeAllocate (any);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "port 80 still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 0, "endpoints left");
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of an Ipv6EndPointDemux with a server which
+ * has a hundred thousand connections on the same port, and the
+ * precedence of the exact and wildcard matches.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param i The index of a connection.
+   * \return the address of the peer of the connection
+   */
+  static Ipv6Address GetPeerAddress (uint32_t i);
+  /**
+   * \param i The index of a connection.
+   * \return the port of the peer of the connection
+   */
+  static uint16_t GetPeerPort (uint32_t i);
+  /**
+   * Look up the endpoint of a packet, which must be unique.
+   *
+   * \param demux The demux.
+   * \param daddr The destination address.
+   * \param dport The destination port.
+   * \param saddr The source address.
+   * \param sport The source port.
+   * \return the endpoint, or 0 if there is none
+   */
+  Ipv6EndPoint *Lookup (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                        Ipv6Address saddr, uint16_t sport);
+
+  Ptr<Ipv6Interface> m_interface; //!< The incoming interface
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Look up the endpoints of 100000 IPv6 connections")
+{
+}
+
+Ipv6Address
+Ipv6EndPointDemuxTestCase::GetPeerAddress (uint32_t i)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 2 };
+  uint32_t host = i / 1000;
+  buf[14] = host >> 8;
+  buf[15] = host & 0xff;
+  return Ipv6Address (buf);
+}
+
+uint16_t
+Ipv6EndPointDemuxTestCase::GetPeerPort (uint32_t i)
+{
+  return 1024 + i % 1000;
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::Lookup (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                                   Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv6Interface> ();
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:db8:1::1");
+  Ipv6Address other ("2001:db8:1::2");
+  Ipv6Address unknown ("2001:db8:3::1");
+
+  Ipv6EndPoint *any = demux.Allocate (0, Ipv6Address::GetAny (), 80);
+  Ipv6EndPoint *listener = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (any, 0, "cannot listen on any address");
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "cannot listen on " << local);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80), 0, "duplicated listener");
+
+  std::vector<Ipv6EndPoint *> connections (N_CONNECTIONS);
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      connections[i] = demux.Allocate (0, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_NE (connections[i], 0, "cannot allocate connection " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, GetPeerAddress (7), GetPeerPort (7)), 0,
+                         "duplicated connection");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), N_CONNECTIONS + 2, "wrong number of endpoints");
+
+  // each connection gets its own packets, the listeners get the others
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      Ipv6EndPoint *endPoint = Lookup (demux, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_EQ (endPoint, connections[i], "wrong endpoint of connection " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), listener, "no listener on " << local);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, other, 80, unknown, 1024), any, "no listener on any address");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 81, unknown, 1024), 0, "no endpoint on port 81");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, GetPeerAddress (12345), GetPeerPort (12345)),
+                         connections[12345], "wrong simple lookup of a connection");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 81, unknown, 1024), 0, "wrong simple lookup on port 81");
+
+  // a connection on any local address is less specific than one on the
+  // destination address, and more specific than the listeners
+  Ipv6EndPoint *wildcard = demux.Allocate (0, Ipv6Address::GetAny (), 80, unknown, 1024);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), wildcard, "wrong wildcard connection");
+  Ipv6EndPoint *exact = demux.Allocate (0, local, 80, unknown, 1024);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, unknown, 1024), exact, "wrong exact connection");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, other, 80, unknown, 1024), wildcard, "wrong wildcard connection");
+
+  // endpoints which cannot receive are skipped
+  connections[0]->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, GetPeerAddress (0), GetPeerPort (0)), listener,
+                         "endpoint with rx disabled");
+  connections[0]->SetRxEnabled (true);
+
+  // a socket which connects sets the peer of its endpoint after allocation
+  Ipv6EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "cannot allocate an ephemeral port");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "ephemeral port not in use");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5000), client, "unconnected client");
+  client->SetPeer (unknown, 5000);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5000), client, "connected client");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, unknown, 5001), 0, "client with the old peer");
+  client->SetLocalPort (port + 1);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "old local port still in use");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port + 1, unknown, 5000), client, "client with a new port");
+
+  // closing a connection sends its packets to the listener again
+  for (uint32_t i = 0; i < N_CONNECTIONS; i += 2)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  for (uint32_t i = 0; i < N_CONNECTIONS; i++)
+    {
+      Ipv6EndPoint *endPoint = Lookup (demux, local, 80, GetPeerAddress (i), GetPeerPort (i));
+      NS_TEST_ASSERT_MSG_EQ (endPoint, (i % 2 == 0) ? listener : connections[i], "wrong endpoint after close " << i);
+    }
+  for (uint32_t i = 1; i < N_CONNECTIONS; i += 2)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  demux.DeAllocate (wildcard);
+  demux.DeAllocate (exact);
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port + 1), false, "ephemeral port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "no listener on port 80");
+  demux.DeAllocate (listener);
+  demux.DeAllocate (any);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "port 80 still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 0, "endpoints left");
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux and Ipv6EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/ensemble-runner.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/names.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A UDP flow across a lossy three-node chain, with random packet
+ * sizes and intervals.
+ *
+ * The results only depend on the run number, so they must be the same
+ * whether the simulation runs alone in the main thread or concurrently
+ * with other simulations in the threads of an EnsembleRunner.
+ */
+class EnsembleChainSimulation
+{
+public:
+  EnsembleChainSimulation ();
+  /**
+   * Build and run the simulation.
+   * \returns The results of the simulation.
+   */
+  EnsembleRunner::Results Run (void);
+
+private:
+  /// Send a packet and schedule the next one
+  void Send (void);
+  /**
+   * Receive the packets of the flow.
+   * \param socket The receiving socket.
+   */
+  void Receive (Ptr<Socket> socket);
+
+  Ptr<Socket> m_tx;                               ///< The sending socket
+  Ptr<UniformRandomVariable> m_size;              ///< Packet sizes
+  Ptr<ExponentialRandomVariable> m_interval;      ///< Intervals between packets
+  uint32_t m_txPackets;                           ///< Number of packets sent
+  uint32_t m_rxPackets;                           ///< Number of packets received
+  uint64_t m_rxBytes;                             ///< Number of bytes received
+  uint64_t m_digest;                              ///< Digest of the received packets
+};
+
+EnsembleChainSimulation::EnsembleChainSimulation ()
+  : m_txPackets (0),
+    m_rxPackets (0),
+    m_rxBytes (0),
+    m_digest (0)
+{}
+
+void
+EnsembleChainSimulation::Send (void)
+{
+  uint32_t size = m_size->GetInteger ();
+  std::vector<uint8_t> payload (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      payload[i] = static_cast<uint8_t> (m_txPackets + i);
+    }
+  m_tx->Send (Create<Packet> (&payload[0], size));
+  m_txPackets++;
+  if (Simulator::Now () < Seconds (2))
+    {
+      Simulator::Schedule (Seconds (m_interval->GetValue ()), &EnsembleChainSimulation::Send, this);
+    }
+}
+
+void
+EnsembleChainSimulation::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      std::vector<uint8_t> payload (packet->GetSize ());
+      packet->CopyData (&payload[0], payload.size ());
+      m_rxPackets++;
+      m_rxBytes += payload.size ();
+      // FNV-1a over the arrival time and the contents of the packets
+      uint64_t time = Simulator::Now ().GetTimeStep ();
+      for (uint32_t i = 0; i < 8; ++i)
+        {
+          m_digest = (m_digest ^ ((time >> (8 * i)) & 0xff)) * 1099511628211ULL;
+        }
+      for (std::vector<uint8_t>::const_iterator i = payload.begin (); i != payload.end (); ++i)
+        {
+          m_digest = (m_digest ^ *i) * 1099511628211ULL;
+        }
+    }
+}
+
+EnsembleRunner::Results
+EnsembleChainSimulation::Run (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  Names::Add ("source", nodes.Get (0));
+
+  SimpleNetDeviceHelper simple;
+  simple.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simple.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer first = simple.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer second = simple.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+
+  Ptr<RateErrorModel> errors = CreateObject<RateErrorModel> ();
+  errors->SetAttribute ("ErrorRate", DoubleValue (0.05));
+  errors->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+  second.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.1.1.0", "255.255.255.0");
+  addresses.Assign (first);
+  addresses.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = addresses.Assign (second);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Socket> rx = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  rx->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  rx->SetRecvCallback (MakeCallback (&EnsembleChainSimulation::Receive, this));
+
+  m_tx = Socket::CreateSocket (Names::Find<Node> ("source"), UdpSocketFactory::GetTypeId ());
+  m_tx->Connect (InetSocketAddress (interfaces.GetAddress (1), 9));
+  m_size = CreateObject<UniformRandomVariable> ();
+  m_size->SetAttribute ("Min", DoubleValue (64));
+  m_size->SetAttribute ("Max", DoubleValue (1400));
+  m_interval = CreateObject<ExponentialRandomVariable> ();
+  m_interval->SetAttribute ("Mean", DoubleValue (0.002));
+  Simulator::Schedule (Seconds (0.1), &EnsembleChainSimulation::Send, this);
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  EnsembleRunner::Results results;
+  results["nodes"] = NodeList::GetNNodes ();
+  results["txPackets"] = m_txPackets;
+  results["rxPackets"] = m_rxPackets;
+  results["rxBytes"] = m_rxBytes;
+  // keep the digest exact in a double
+  results["digest"] = m_digest >> 12;
+  m_tx = 0;
+  Simulator::Destroy ();
+  return results;
+}
+
+/**
+ * Run a replication of the chain simulation.
+ * \param run The run number.
+ * \returns The results of the replication.
+ */
+static EnsembleRunner::Results
+RunChain (uint64_t run)
+{
+  EnsembleChainSimulation simulation;
+  return simulation.Run ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that concurrent simulations match sequential runs.
+ */
+class EnsembleSimulationsTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param threads The number of concurrent simulations.
+   */
+  EnsembleSimulationsTestCase (uint32_t threads);
+  virtual void DoRun (void);
+
+private:
+  uint32_t m_threads; ///< The number of concurrent simulations
+};
+
+EnsembleSimulationsTestCase::EnsembleSimulationsTestCase (uint32_t threads)
+  : TestCase ("Check that " + std::to_string (threads) + " concurrent simulations match sequential runs"),
+    m_threads (threads)
+{}
+
+void
+EnsembleSimulationsTestCase::DoRun (void)
+{
+  const uint32_t replications = 2 * m_threads;
+  uint64_t savedRun = RngSeedManager::GetRun ();
+
+  EnsembleRunner runner;
+  runner.SetThreadCount (m_threads);
+  runner.SetFirstRun (5);
+  runner.Run (MakeCallback (&RunChain), replications);
+
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      RngSeedManager::SetRun (5 + i);
+      RngSeedManager::ResetNextStreamIndex ();
+      EnsembleRunner::Results expected = RunChain (5 + i);
+      Names::Clear ();
+      const EnsembleRunner::Results &results = runner.GetResults (i);
+      NS_TEST_ASSERT_MSG_EQ (results.find ("nodes")->second, 3, "the simulations shared their nodes");
+      NS_TEST_ASSERT_MSG_GT (results.find ("rxPackets")->second, 0, "no packet was received");
+      NS_TEST_ASSERT_MSG_LT (results.find ("rxPackets")->second, results.find ("txPackets")->second,
+                             "no packet was lost");
+      for (EnsembleRunner::Results::const_iterator j = expected.begin (); j != expected.end (); ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (results.find (j->first)->second, j->second,
+                                 "metric " << j->first << " of run " << 5 + i
+                                 << " differs from a sequential run");
+        }
+    }
+  NS_TEST_ASSERT_MSG_NE (runner.GetResults (0).find ("digest")->second,
+                         runner.GetResults (1).find ("digest")->second,
+                         "the runs used the same random streams");
+
+  RngSeedManager::SetRun (savedRun);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Concurrent simulations TestSuite
+ */
+class EnsembleSimulationsTestSuite : public TestSuite
+{
+public:
+  EnsembleSimulationsTestSuite ()
+    : TestSuite ("ensemble-simulations", UNIT)
+  {
+    AddTestCase (new EnsembleSimulationsTestCase (1), TestCase::QUICK);
+    AddTestCase (new EnsembleSimulationsTestCase (2), TestCase::QUICK);
+    AddTestCase (new EnsembleSimulationsTestCase (4), TestCase::QUICK);
+  }
+};
+
+static EnsembleSimulationsTestSuite g_ensembleSimulationsTestSuite; //!< Static variable for test initialization
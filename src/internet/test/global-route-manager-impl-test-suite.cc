@@ -27,6 +27,8 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <list>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -226,6 +228,81 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the order in which the CandidateQueue pops its vertices,
+ * when some of their distances are lowered, against a sorted list.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param v1 A vertex.
+   * \param v2 Another vertex.
+   * \returns true if the first vertex is closer to the root.
+   */
+  static bool CompareDistance (const SPFVertex *v1, const SPFVertex *v2);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("Pop the vertices of a CandidateQueue in order")
+{
+}
+
+bool
+CandidateQueueTestCase::CompareDistance (const SPFVertex *v1, const SPFVertex *v2)
+{
+  return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  // the list which the queue used to be: vertices of equal distance are
+  // popped in the order of their insertion
+  std::list<SPFVertex *> expected;
+
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetVertexId (Ipv4Address (i));
+      v->SetDistanceFromRoot (std::rand () % 50);
+      candidate.Push (v);
+      expected.insert (std::upper_bound (expected.begin (), expected.end (), v, &CompareDistance), v);
+
+      if (i % 3 == 2)
+        {
+          // lower the distance of a vertex which was pushed earlier
+          SPFVertex *w = candidate.Find (Ipv4Address (std::rand () % i));
+          NS_TEST_ASSERT_MSG_NE (w, 0, "vertex not found");
+          if (w->GetDistanceFromRoot () > 0)
+            {
+              w->SetDistanceFromRoot (w->GetDistanceFromRoot () / 2);
+              candidate.Reorder (w);
+              expected.sort (&CompareDistance);
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), expected.size (), "wrong size");
+  NS_TEST_EXPECT_MSG_EQ (candidate.Find (Ipv4Address (1000)), 0, "vertex found");
+
+  for (std::list<SPFVertex *>::iterator i = expected.begin (); i != expected.end (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (candidate.Top (), *i, "wrong top vertex");
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_EXPECT_MSG_EQ (v, *i, "wrong vertex popped, distance " << v->GetDistanceFromRoot ());
+      delete v;
+    }
+  NS_TEST_EXPECT_MSG_EQ (candidate.Empty (), true, "vertices left in the queue");
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +320,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -14,9 +14,13 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <set>
 #include <vector>
+#include <sstream>
+#include <algorithm>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -37,6 +41,7 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/udp-header.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
@@ -1244,6 +1249,339 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes which are computed in several threads, and
+ * updated after a change of the topology, are those of a full computation.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \param nodes The nodes.
+   * \param sorted Sort the routes of each node.
+   * \returns The routes of the nodes, one per line.
+   */
+  static std::string GetRoutes (const NodeContainer &nodes, bool sorted);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Global routing computed in threads and updated incrementally")
+{
+}
+
+std::string
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (const NodeContainer &nodes, bool sorted)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<Ipv4> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (j);
+          routes.push_back (route.str ());
+        }
+      if (sorted)
+        {
+          std::sort (routes.begin (), routes.end ());
+        }
+      oss << "node " << i << std::endl;
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          oss << routes[j] << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+// Six routers r0-r5 in a ring of point-to-point links, with a chord
+// between r0 and r3, a LAN between r1, r4 and the host h0, and the hosts
+// h1 and h2 on point-to-point links to r2 and r5.
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  NodeContainer routers;
+  routers.Create (6);
+  NodeContainer hosts;
+  hosts.Create (3);
+  NodeContainer nodes (routers, hosts);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      links.push_back (p2pHelper.Install (NodeContainer (routers.Get (i), routers.Get ((i + 1) % 6))));
+    }
+  links.push_back (p2pHelper.Install (NodeContainer (routers.Get (0), routers.Get (3))));
+  links.push_back (p2pHelper.Install (NodeContainer (hosts.Get (1), routers.Get (2))));
+  links.push_back (p2pHelper.Install (NodeContainer (hosts.Get (2), routers.Get (5))));
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      ipv4.Assign (links[i]);
+      ipv4.NewNetwork ();
+    }
+
+  SimpleNetDeviceHelper lanHelper;
+  NetDeviceContainer lan = lanHelper.Install (NodeContainer (routers.Get (1), routers.Get (4), hosts.Get (0)));
+  ipv4.SetBase ("10.2.1.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string routes = GetRoutes (nodes, false);
+  std::string sortedRoutes = GetRoutes (nodes, true);
+
+  // the same routes, in the same order, from several threads
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes, false), routes, "wrong routes from the threads");
+
+  // a higher metric on the chord
+  Ptr<Ipv4> ipv4R0 = routers.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4R3 = routers.Get (3)->GetObject<Ipv4> ();
+  int32_t chordR0 = ipv4R0->GetInterfaceForDevice (links[6].Get (0));
+  int32_t chordR3 = ipv4R3->GetInterfaceForDevice (links[6].Get (1));
+  ipv4R0->SetMetric (chordR0, 5);
+  ipv4R3->SetMetric (chordR3, 5);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  std::string updated = GetRoutes (nodes, true);
+  NS_TEST_EXPECT_MSG_NE (updated, sortedRoutes, "the routes were not updated");
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (updated, GetRoutes (nodes, true), "wrong routes after a change of metric");
+
+  // the interface of r2 to r1 down, then the chord down
+  Ptr<Ipv4> ipv4R2 = routers.Get (2)->GetObject<Ipv4> ();
+  int32_t ringR2 = ipv4R2->GetInterfaceForDevice (links[1].Get (1));
+  ipv4R2->SetDown (ringR2);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  updated = GetRoutes (nodes, true);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (updated, GetRoutes (nodes, true), "wrong routes after an interface down");
+
+  ipv4R0->SetDown (chordR0);
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  updated = GetRoutes (nodes, true);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (updated, GetRoutes (nodes, true), "wrong routes after a link down");
+
+  // back to the first topology
+  ipv4R0->SetMetric (chordR0, 1);
+  ipv4R3->SetMetric (chordR3, 1);
+  ipv4R0->SetUp (chordR0);
+  ipv4R2->SetUp (ringR2);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes, true), sortedRoutes, "wrong routes after the interfaces up");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the choice among equal-cost routes of each EcmpMode, and the
+ * counters of the forwarded packets.
+ */
+class Ipv4GlobalRoutingEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingEcmpTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Forward a UDP packet from n0 to n5 through a router.
+   * \param routing The routing protocol of the router.
+   * \param idev The input device of the packet.
+   * \param port The source port of the packet.
+   * \returns The output interface of the packet.
+   */
+  uint32_t Route (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev, uint16_t port);
+  /**
+   * \brief Forward a UDP packet, and store its output interface.
+   * \param routing The routing protocol of the router.
+   * \param idev The input device of the packet.
+   * \param port The source port of the packet.
+   */
+  void RouteLater (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev, uint16_t port);
+  /**
+   * \brief The unicast forward callback.
+   * \param route The route of the packet.
+   * \param p The packet.
+   * \param header The IPv4 header of the packet.
+   */
+  void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+
+  Ipv4Address m_source;                 //!< The address of n0
+  Ipv4Address m_destination;            //!< The address of n5
+  Ptr<NetDevice> m_outputDevice;        //!< The output device of the last packet
+  std::vector<uint32_t> m_interfaces;   //!< The output interfaces of RouteLater
+};
+
+Ipv4GlobalRoutingEcmpTestCase::Ipv4GlobalRoutingEcmpTestCase ()
+  : TestCase ("Global routing among equal-cost routes")
+{
+}
+
+uint32_t
+Ipv4GlobalRoutingEcmpTestCase::Route (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev, uint16_t port)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (port);
+  udpHeader.SetDestinationPort (9);
+  p->AddHeader (udpHeader);
+  Ipv4Header header;
+  header.SetSource (m_source);
+  header.SetDestination (m_destination);
+  header.SetProtocol (17);
+  header.SetPayloadSize (p->GetSize ());
+  m_outputDevice = 0;
+  bool routed = routing->RouteInput (p, header, idev,
+                                     MakeCallback (&Ipv4GlobalRoutingEcmpTestCase::Forward, this),
+                                     Ipv4RoutingProtocol::MulticastForwardCallback (),
+                                     Ipv4RoutingProtocol::LocalDeliverCallback (),
+                                     Ipv4RoutingProtocol::ErrorCallback ());
+  NS_TEST_EXPECT_MSG_EQ (routed, true, "packet not routed");
+  NS_TEST_EXPECT_MSG_NE (m_outputDevice, 0, "packet not forwarded");
+  if (m_outputDevice == 0)
+    {
+      return 0;
+    }
+  return idev->GetNode ()->GetObject<Ipv4> ()->GetInterfaceForDevice (m_outputDevice);
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::RouteLater (Ptr<Ipv4GlobalRouting> routing, Ptr<NetDevice> idev, uint16_t port)
+{
+  m_interfaces.push_back (Route (routing, idev, port));
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::Forward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  m_outputDevice = route->GetOutputDevice ();
+}
+
+// The routers r1-r4 in a diamond of point-to-point links, with two paths
+// of equal cost from r1 to r4, through r2 and r3, and the hosts n0 and n5
+// on point-to-point links to r1 and r4.
+void
+Ipv4GlobalRoutingEcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (6);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  uint32_t links[6][2] = { {0, 1}, {1, 2}, {1, 3}, {2, 4}, {3, 4}, {4, 5} };
+  std::vector<Ipv4InterfaceContainer> interfaces;
+  std::vector<NetDeviceContainer> devices;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      devices.push_back (p2pHelper.Install (NodeContainer (nodes.Get (links[i][0]), nodes.Get (links[i][1]))));
+      interfaces.push_back (ipv4.Assign (devices.back ()));
+      ipv4.NewNetwork ();
+    }
+  m_source = interfaces[0].GetAddress (0);
+  m_destination = interfaces[5].GetAddress (1);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4GlobalRouting> routing = nodes.Get (1)->GetObject<Ipv4> ()
+    ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  Ptr<NetDevice> idev = devices[0].Get (1);
+  // the interfaces of r1 to r2 and r3
+  const uint32_t toR2 = 2;
+  const uint32_t toR3 = 3;
+
+  // the first route, always
+  std::set<uint32_t> used;
+  for (uint16_t port = 1000; port < 1032; port++)
+    {
+      used.insert (Route (routing, idev, port));
+    }
+  NS_TEST_EXPECT_MSG_EQ (used.size (), 1, "several routes used in the First mode");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (*used.begin ()), 32, "wrong number of forwarded packets");
+  // 100 bytes of payload, with the UDP and IPv4 headers
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedBytes (*used.begin ()), 32 * 128, "wrong number of forwarded bytes");
+  routing->ResetLoadCounters ();
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (*used.begin ()), 0, "counters not reset");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedBytes (*used.begin ()), 0, "counters not reset");
+
+  // a route by flow: the packets of a flow follow the same route, and the
+  // flows are spread over both routes
+  routing->SetAttribute ("EcmpMode", EnumValue (Ipv4GlobalRouting::ECMP_FLOW_HASH));
+  uint64_t counts[4] = { 0, 0, 0, 0 };
+  for (uint16_t port = 1000; port < 1032; port++)
+    {
+      uint32_t interface = Route (routing, idev, port);
+      NS_TEST_ASSERT_MSG_EQ ((interface == toR2 || interface == toR3), true, "not an equal-cost route");
+      counts[interface]++;
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (Route (routing, idev, port), interface, "flow " << port << " reordered");
+          counts[interface]++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_NE (counts[toR2], 0, "no flow through r2");
+  NS_TEST_EXPECT_MSG_NE (counts[toR3], 0, "no flow through r3");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (toR2), counts[toR2], "wrong load to r2");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (toR3), counts[toR3], "wrong load to r3");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (toR2) + routing->GetForwardedPackets (toR3), 128,
+                         "wrong number of forwarded packets");
+  NS_TEST_EXPECT_MSG_EQ (routing->GetForwardedPackets (1), 0, "packet forwarded to its source");
+
+  // a route by flowlet: the packets of a burst follow the same route, and
+  // the flowlets of a flow are spread over both routes
+  routing->SetAttribute ("EcmpMode", EnumValue (Ipv4GlobalRouting::ECMP_FLOWLET));
+  routing->SetAttribute ("FlowletGap", TimeValue (MicroSeconds (500)));
+  routing->AssignStreams (1);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (MicroSeconds (100 * i), &Ipv4GlobalRoutingEcmpTestCase::RouteLater, this,
+                           routing, idev, 1000);
+    }
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Simulator::Schedule (MilliSeconds (1 + i), &Ipv4GlobalRoutingEcmpTestCase::RouteLater, this,
+                           routing, idev, 1000);
+    }
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces.size (), 50, "wrong number of routed packets");
+  for (uint32_t i = 1; i < 10; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_interfaces[i], m_interfaces[0], "flowlet reordered");
+    }
+  used.clear ();
+  used.insert (m_interfaces.begin () + 10, m_interfaces.end ());
+  NS_TEST_EXPECT_MSG_EQ (used.size (), 2, "the flowlets of a flow do not use both routes");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1605,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -43,6 +43,7 @@
 #include <string>
 #include <sstream>
 #include <limits>
+#include <cstring>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -265,6 +266,81 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the checksum which an IPv4 header keeps after a
+ * deserialization, and updates when the TTL is decremented, matches
+ * the checksum calculated on the bytes.
+ */
+class Ipv4HeaderChecksumTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumTest ();
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header checksum update")
+{
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  Ipv4Header sent;
+  sent.EnableChecksum ();
+  sent.SetSource (Ipv4Address ("10.1.2.3"));
+  sent.SetDestination (Ipv4Address ("192.168.17.254"));
+  sent.SetProtocol (6);
+  sent.SetPayloadSize (1460);
+  sent.SetIdentification (0xbeef);
+  sent.SetTtl (64);
+  Ptr<Packet> p = Create<Packet> (1460);
+  p->AddHeader (sent);
+
+  // Forward over many hops, as Ipv4L3Protocol::IpForward does
+  for (uint8_t ttl = 63; ttl > 0; ttl--)
+    {
+      Ipv4Header received;
+      received.EnableChecksum ();
+      p->RemoveHeader (received);
+      NS_TEST_ASSERT_MSG_EQ (received.IsChecksumOk (), true, "bad checksum at ttl " << uint32_t (ttl + 1));
+      Ipv4Header forwarded = received;
+      forwarded.SetTtl (received.GetTtl () - 1);
+      p->AddHeader (forwarded);
+
+      // the checksum of a header built from scratch
+      Ipv4Header expected;
+      expected.EnableChecksum ();
+      expected.SetSource (sent.GetSource ());
+      expected.SetDestination (sent.GetDestination ());
+      expected.SetProtocol (6);
+      expected.SetPayloadSize (1460);
+      expected.SetIdentification (0xbeef);
+      expected.SetTtl (ttl);
+      Ptr<Packet> q = Create<Packet> (1460);
+      q->AddHeader (expected);
+      uint8_t updated[20];
+      uint8_t calculated[20];
+      p->CopyData (updated, 20);
+      q->CopyData (calculated, 20);
+      NS_TEST_ASSERT_MSG_EQ (memcmp (updated, calculated, 20), 0, "bad updated checksum at ttl " << uint32_t (ttl));
+    }
+
+  // a change of another field invalidates the checksum
+  Ipv4Header received;
+  received.EnableChecksum ();
+  p->RemoveHeader (received);
+  received.SetTos (0x10);
+  p->AddHeader (received);
+  Ipv4Header check;
+  check.EnableChecksum ();
+  p->PeekHeader (check);
+  NS_TEST_ASSERT_MSG_EQ (check.IsChecksumOk (), true, "bad checksum after a change of TOS");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +353,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <set>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-shared-routing-helper.h"
+#include "ns3/ipv4-shared-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the paths of Ipv4SharedRouting in a leaf-spine topology,
+ * the cache of its graph, and the paths after links go down.
+ */
+class Ipv4SharedRoutingTestCase : public TestCase
+{
+public:
+  Ipv4SharedRoutingTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Follow the routes from a node to a destination.
+   *
+   * \param from The source node.
+   * \param to The destination address.
+   * \param [out] path The nodes after the source, up to the destination.
+   * \returns true if the destination was reached.
+   */
+  bool GetPath (Ptr<Node> from, Ipv4Address to, std::vector<Ptr<Node> > &path);
+  /**
+   * \brief Send a packet.
+   * \param socket The sending socket.
+   * \param to The address of the receiver.
+   */
+  void Send (Ptr<Socket> socket, Ipv4Address to);
+  /**
+   * \brief Receive a packet.
+   * \param socket The receiving socket.
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::map<Ipv4Address, Ptr<Node> > m_owners;  //!< The node of each address
+  uint32_t m_received;                         //!< The number of received packets
+};
+
+Ipv4SharedRoutingTestCase::Ipv4SharedRoutingTestCase ()
+  : TestCase ("Shared routing in a leaf-spine topology"),
+    m_received (0)
+{
+}
+
+bool
+Ipv4SharedRoutingTestCase::GetPath (Ptr<Node> from, Ipv4Address to, std::vector<Ptr<Node> > &path)
+{
+  path.clear ();
+  Ptr<Node> node = from;
+  Ipv4Header header;
+  header.SetDestination (to);
+  while (path.size () < 10)
+    {
+      Socket::SocketErrno sockerr;
+      Ptr<Ipv4Route> route = node->GetObject<Ipv4> ()->GetRoutingProtocol ()
+        ->RouteOutput (Create<Packet> (), header, 0, sockerr);
+      if (route == 0)
+        {
+          return false;
+        }
+      Ipv4Address next = route->GetGateway () == Ipv4Address::GetZero () ? to : route->GetGateway ();
+      node = m_owners[next];
+      path.push_back (node);
+      if (next == to)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Ipv4SharedRoutingTestCase::Send (Ptr<Socket> socket, Ipv4Address to)
+{
+  NS_TEST_EXPECT_MSG_EQ (socket->SendTo (Create<Packet> (123), 0, InetSocketAddress (to, 1234)), 123, "packet not sent");
+}
+
+void
+Ipv4SharedRoutingTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+// Two spines s0 and s1, three leaves l0-l2 connected to both spines, and
+// two hosts on each leaf, all with point-to-point links.
+void
+Ipv4SharedRoutingTestCase::DoRun (void)
+{
+  NodeContainer spines;
+  spines.Create (2);
+  NodeContainer leaves;
+  leaves.Create (3);
+  NodeContainer hosts;
+  hosts.Create (6);
+
+  Ipv4SharedRoutingHelper sharedRouting;
+  sharedRouting.GetGraph ()->SetAttribute ("MaxCachedPrefixes", UintegerValue (4));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (sharedRouting);
+  internet.Install (spines);
+  internet.Install (leaves);
+  internet.Install (hosts);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<Ipv4InterfaceContainer> uplinks;
+  for (uint32_t l = 0; l < 3; l++)
+    {
+      for (uint32_t s = 0; s < 2; s++)
+        {
+          uplinks.push_back (ipv4.Assign (p2pHelper.Install (NodeContainer (leaves.Get (l), spines.Get (s)))));
+          ipv4.NewNetwork ();
+        }
+    }
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  std::vector<Ipv4Address> hostAddresses;
+  for (uint32_t h = 0; h < 6; h++)
+    {
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (p2pHelper.Install (NodeContainer (hosts.Get (h), leaves.Get (h / 2))));
+      hostAddresses.push_back (interfaces.GetAddress (0));
+      ipv4.NewNetwork ();
+    }
+
+  NodeContainer nodes (spines, leaves, hosts);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = nodes.Get (i)->GetObject<Ipv4> ();
+      for (uint32_t j = 1; j < ip->GetNInterfaces (); j++)
+        {
+          m_owners[ip->GetAddress (j, 0).GetLocal ()] = nodes.Get (i);
+        }
+    }
+
+  Ptr<Ipv4SharedRoutingGraph> graph = sharedRouting.GetGraph ();
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNPrefixes (), 12, "wrong number of prefixes");
+
+  // the shortest paths, spread over both spines
+  std::set<Ptr<Node> > spinesUsed;
+  std::vector<Ptr<Node> > path;
+  for (uint32_t from = 0; from < 6; from++)
+    {
+      for (uint32_t to = 0; to < 6; to++)
+        {
+          if (from == to)
+            {
+              continue;
+            }
+          bool reached = GetPath (hosts.Get (from), hostAddresses[to], path);
+          NS_TEST_ASSERT_MSG_EQ (reached, true, "host " << to << " not reached from host " << from);
+          NS_TEST_EXPECT_MSG_EQ (path.back (), hosts.Get (to), "wrong destination");
+          NS_TEST_EXPECT_MSG_EQ (path[0], leaves.Get (from / 2), "wrong first hop");
+          if (from / 2 == to / 2)
+            {
+              NS_TEST_EXPECT_MSG_EQ (path.size (), 2, "wrong path from host " << from << " to host " << to);
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (path.size (), 4, "wrong path from host " << from << " to host " << to);
+              spinesUsed.insert (path[1]);
+              NS_TEST_EXPECT_MSG_EQ (path[2], leaves.Get (to / 2), "wrong leaf");
+            }
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (spinesUsed.size (), 2, "a spine is not used");
+
+  // the cache keeps the last prefixes only
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNCachedPrefixes (), 4, "wrong size of the cache");
+  uint64_t computations = graph->GetNComputations ();
+  GetPath (hosts.Get (0), hostAddresses[4], path);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNComputations (), computations, "cached distances computed again");
+  GetPath (hosts.Get (0), hostAddresses[5], path);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNComputations (), computations + 1, "distances not computed");
+
+  // a packet through the network
+  Ptr<Socket> rxSocket = hosts.Get (5)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->Bind (InetSocketAddress (hostAddresses[5], 1234)), 0, "trivial");
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4SharedRoutingTestCase::Receive, this));
+  Ptr<Socket> txSocket = hosts.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  Simulator::ScheduleWithContext (hosts.Get (0)->GetId (), Seconds (1), &Ipv4SharedRoutingTestCase::Send, this,
+                                  txSocket, hostAddresses[5]);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "packet not received");
+
+  // the links of l0 to s0, then to s1, down
+  Ptr<Ipv4> ipv4Leaf = leaves.Get (0)->GetObject<Ipv4> ();
+  ipv4Leaf->SetDown (ipv4Leaf->GetInterfaceForAddress (uplinks[0].GetAddress (0)));
+  for (uint32_t to = 2; to < 6; to++)
+    {
+      bool reached = GetPath (hosts.Get (0), hostAddresses[to], path);
+      NS_TEST_ASSERT_MSG_EQ (reached, true, "host " << to << " not reached after a link down");
+      NS_TEST_EXPECT_MSG_EQ (path[1], spines.Get (1), "wrong spine after a link down");
+      reached = GetPath (hosts.Get (to), hostAddresses[0], path);
+      NS_TEST_ASSERT_MSG_EQ (reached, true, "host 0 not reached after a link down");
+      NS_TEST_EXPECT_MSG_EQ (path[1], spines.Get (1), "wrong spine after a link down");
+    }
+  ipv4Leaf->SetDown (ipv4Leaf->GetInterfaceForAddress (uplinks[1].GetAddress (0)));
+  NS_TEST_EXPECT_MSG_EQ (GetPath (hosts.Get (0), hostAddresses[4], path), false, "host reached without links");
+  NS_TEST_EXPECT_MSG_EQ (GetPath (hosts.Get (0), hostAddresses[1], path), true, "host on the same leaf not reached");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 SharedRouting TestSuite
+ */
+class Ipv4SharedRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4SharedRoutingTestSuite ()
+    : TestSuite ("ipv4-shared-routing", UNIT)
+  {
+    AddTestCase (new Ipv4SharedRoutingTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4SharedRoutingTestSuite g_ipv4SharedRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <string.h>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the matches and the longest match of a PrefixTrie against
+ * a scan of all its prefixes, with random prefixes of random lengths and a few masks which
+ * are not contiguous.
+ *
+ * \tparam N The number of bytes of the addresses.
+ */
+template <uint32_t N>
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param name The name of the test.
+   */
+  PrefixTrieTestCase (std::string name);
+  virtual void DoRun (void);
+private:
+  /** A prefix of the test. */
+  struct Prefix
+  {
+    uint8_t address[N];  //!< The address
+    uint8_t mask[N];     //!< The mask
+  };
+
+  /**
+   * Draw a random address, in a few blocks so that the prefixes overlap.
+   *
+   * \param [out] address The address.
+   */
+  void GetAddress (uint8_t address[N]);
+  /**
+   * \param [in] address An address.
+   * \param [in] prefix A prefix.
+   * \returns true if the prefix matches the address
+   */
+  static bool IsMatch (const uint8_t address[N], const Prefix &prefix);
+  /**
+   * \param [in] prefix A prefix.
+   * \returns the index of the bit after the last one of the mask
+   */
+  static uint32_t GetLength (const Prefix &prefix);
+
+  Ptr<UniformRandomVariable> m_random; //!< The random generator
+};
+
+template <uint32_t N>
+PrefixTrieTestCase<N>::PrefixTrieTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+template <uint32_t N>
+void
+PrefixTrieTestCase<N>::GetAddress (uint8_t address[N])
+{
+  for (uint32_t i = 0; i < N; i++)
+    {
+      address[i] = m_random->GetInteger (0, 255);
+    }
+  address[0] = 10 * m_random->GetInteger (0, 3);
+  address[1] &= 0x0f;
+}
+
+template <uint32_t N>
+bool
+PrefixTrieTestCase<N>::IsMatch (const uint8_t address[N], const Prefix &prefix)
+{
+  for (uint32_t i = 0; i < N; i++)
+    {
+      if ((address[i] & prefix.mask[i]) != (prefix.address[i] & prefix.mask[i]))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+template <uint32_t N>
+uint32_t
+PrefixTrieTestCase<N>::GetLength (const Prefix &prefix)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; i < 8 * N; i++)
+    {
+      if ((prefix.mask[i / 8] >> (7 - i % 8)) & 1)
+        {
+          length = i + 1;
+        }
+    }
+  return length;
+}
+
+template <uint32_t N>
+void
+PrefixTrieTestCase<N>::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  PrefixTrie<uint32_t, N> trie;
+  std::vector<Prefix> prefixes;
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      Prefix prefix;
+      GetAddress (prefix.address);
+      // many host routes, some duplicate prefixes and a few default routes
+      uint32_t length = m_random->GetInteger (0, 8 * N + 8 * N / 4);
+      length = std::min (length, 8 * N);
+      for (uint32_t j = 0; j < N; j++)
+        {
+          uint32_t bits = std::min<uint32_t> (8, length > 8 * j ? length - 8 * j : 0);
+          prefix.mask[j] = 0xff00 >> bits;
+        }
+      if (i % 100 == 50)
+        {
+          // a mask which is not contiguous
+          prefix.mask[N - 1] = 0x0f;
+        }
+      if (i % 10 == 0 && i > 0)
+        {
+          // the same prefix as an earlier one
+          prefix = prefixes[m_random->GetInteger (0, i - 1)];
+        }
+      prefixes.push_back (prefix);
+      trie.Insert (prefix.address, prefix.mask, i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (trie.GetN (), prefixes.size (), "wrong number of values");
+
+  std::vector<uint32_t> values;
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      uint8_t address[N];
+      if (i % 2 == 0)
+        {
+          // an address of one of the prefixes
+          memcpy (address, prefixes[m_random->GetInteger (0, prefixes.size () - 1)].address, N);
+        }
+      else
+        {
+          GetAddress (address);
+        }
+      std::vector<uint32_t> expected;
+      uint32_t longest = prefixes.size ();
+      for (uint32_t j = 0; j < prefixes.size (); j++)
+        {
+          if (IsMatch (address, prefixes[j]))
+            {
+              expected.push_back (j);
+              if (longest == prefixes.size () || GetLength (prefixes[j]) > GetLength (prefixes[longest]))
+                {
+                  longest = j;
+                }
+            }
+        }
+      uint32_t value = prefixes.size ();
+      NS_TEST_ASSERT_MSG_EQ (trie.MatchLongest (address, value), !expected.empty (), "wrong longest match for address " << i);
+      if (!expected.empty ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (value, longest, "wrong longest match for address " << i);
+        }
+      trie.Match (address, values);
+      NS_TEST_ASSERT_MSG_EQ (values.size (), expected.size (), "wrong number of matches for address " << i);
+      for (uint32_t j = 0; j < expected.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[j], expected[j], "wrong match " << j << " for address " << i);
+        }
+    }
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.GetN (), 0, "the trie was not cleared");
+  trie.Match (prefixes[0].address, values);
+  NS_TEST_EXPECT_MSG_EQ (values.size (), 0, "the trie was not cleared");
+  uint32_t value;
+  NS_TEST_EXPECT_MSG_EQ (trie.MatchLongest (prefixes[0].address, value), false, "the trie was not cleared");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ()
+    : TestSuite ("prefix-trie", UNIT)
+  {
+    AddTestCase (new PrefixTrieTestCase<4> ("Match random IPv4 prefixes"), TestCase::QUICK);
+    AddTestCase (new PrefixTrieTestCase<16> ("Match random IPv6 prefixes"), TestCase::QUICK);
+  }
+};
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
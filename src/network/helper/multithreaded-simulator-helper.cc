@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorHelper");
+
+/**
+ * \param [in] groups The union-find forest.
+ * \param [in] node A node id.
+ * \returns The representative of the group of the node.
+ */
+static uint32_t
+FindGroup (std::vector<uint32_t> &groups, uint32_t node)
+{
+  while (groups[node] != node)
+    {
+      groups[node] = groups[groups[node]];
+      node = groups[node];
+    }
+  return node;
+}
+
+/**
+ * \param [in] channel A channel.
+ * \param [out] delay The propagation delay of the channel.
+ * \returns \c true if the nodes on this channel can be in different partitions.
+ */
+static bool
+IsPartitionable (Ptr<Channel> channel, Time &delay)
+{
+  TimeValue value;
+  if (!channel->GetAttributeFailSafe ("Delay", value)
+      || !value.Get ().IsStrictlyPositive ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      if (!channel->GetDevice (i)->IsPointToPoint ())
+        {
+          return false;
+        }
+    }
+  delay = value.Get ();
+  return true;
+}
+
+void
+MultithreadedSimulatorHelper::Partition (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl == 0)
+    {
+      NS_LOG_LOGIC ("not a MultithreadedSimulatorImpl");
+      return;
+    }
+
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> groups (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      groups[i] = i;
+    }
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Time delay;
+      if (IsPartitionable (*i, delay) || (*i)->GetNDevices () == 0)
+        {
+          continue;
+        }
+      uint32_t first = FindGroup (groups, (*i)->GetDevice (0)->GetNode ()->GetId ());
+      for (uint32_t j = 1; j < (*i)->GetNDevices (); ++j)
+        {
+          uint32_t other = FindGroup (groups, (*i)->GetDevice (j)->GetNode ()->GetId ());
+          groups[std::max (first, other)] = std::min (first, other);
+          first = std::min (first, other);
+        }
+    }
+
+  std::vector<uint32_t> sizes (nNodes, 0);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      sizes[FindGroup (groups, i)]++;
+    }
+
+  // fill the partitions one after the other, in node id order, to keep
+  // the nodes built together by the topology helpers together.
+  uint32_t nPartitions = impl->GetPartitionCount ();
+  uint32_t target = (nNodes + nPartitions - 1) / nPartitions;
+  std::vector<uint32_t> partitionOf (nNodes, nPartitions);
+  uint32_t partition = 0;
+  uint32_t load = 0;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      uint32_t group = FindGroup (groups, i);
+      if (partitionOf[group] == nPartitions)
+        {
+          partitionOf[group] = partition;
+          load += sizes[group];
+          if (load >= target && partition + 1 < nPartitions)
+            {
+              partition++;
+              load = 0;
+            }
+        }
+      impl->SetPartition (i, partitionOf[group]);
+    }
+
+  Time lookahead = Time::Max ();
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Time delay;
+      if (!IsPartitionable (*i, delay))
+        {
+          continue;
+        }
+      for (uint32_t j = 1; j < (*i)->GetNDevices (); ++j)
+        {
+          if (impl->GetPartition ((*i)->GetDevice (j)->GetNode ()->GetId ())
+              != impl->GetPartition ((*i)->GetDevice (0)->GetNode ()->GetId ()))
+            {
+              lookahead = Min (lookahead, delay);
+            }
+        }
+    }
+  NS_LOG_INFO ("partitioned " << nNodes << " nodes in " << nPartitions
+               << " partitions with a lookahead of " << lookahead);
+  impl->SetLookahead (lookahead);
+}
+
+} // namespace ns3
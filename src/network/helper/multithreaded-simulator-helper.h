@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MULTITHREADED_SIMULATOR_HELPER_H
+#define MULTITHREADED_SIMULATOR_HELPER_H
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Configure a MultithreadedSimulatorImpl from the topology.
+ *
+ * Typical use:
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::MultithreadedSimulatorImpl"));
+ *   Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount",
+ *                       UintegerValue (8));
+ *   // build the topology, install the applications ...
+ *   MultithreadedSimulatorHelper::Partition ();
+ *   Simulator::Run ();
+ * \endcode
+ */
+class MultithreadedSimulatorHelper
+{
+public:
+  /**
+   * \brief Assign every node of the NodeList to a partition of the
+   * current MultithreadedSimulatorImpl and set its lookahead.
+   *
+   * The nodes attached to a shared medium (a channel whose devices are
+   * not point-to-point, such as a CsmaChannel) or to a channel without
+   * a positive "Delay" attribute are kept in the same partition, since
+   * all of them read and write the state of that channel.  The groups
+   * of nodes so formed are assigned, in node id order, to contiguous
+   * partitions of about the same number of nodes.  The lookahead is the
+   * smallest "Delay" of the channels (PointToPointChannel, ...) which
+   * join two partitions.
+   *
+   * This must be called after the topology is built and before
+   * Simulator::Run.  It does nothing if the simulator implementation
+   * is not a MultithreadedSimulatorImpl.
+   */
+  static void Partition (void);
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_HELPER_H */
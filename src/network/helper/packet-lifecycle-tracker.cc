@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-lifecycle-tracker.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/node.h"
+#include "ns3/queue.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketLifecycleTracker implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketLifecycleTracker");
+
+namespace {
+
+/** The magic number of the files, "NS3L". */
+const uint32_t LIFECYCLE_MAGIC = 0x4c33534e;
+/** The version of the file format. */
+const uint32_t LIFECYCLE_VERSION = 1;
+
+/**
+ * Record an event of a trace source of a device.
+ *
+ * \tparam EVENT The event.
+ * \param [in] tracker The tracker.
+ * \param [in] node The node id of the device.
+ * \param [in] interface The interface index of the device.
+ * \param [in] packet The packet.
+ */
+template <PacketLifecycleTracker::Event EVENT>
+void
+TraceEvent (PacketLifecycleTracker *tracker, uint32_t node, uint32_t interface, Ptr<const Packet> packet)
+{
+  tracker->Record (packet, node, interface, EVENT);
+}
+
+/**
+ * Write a column to a file.
+ *
+ * \param [in] os The file.
+ * \param [in] column The column.
+ */
+template <typename T>
+void
+WriteColumn (std::ofstream &os, const std::vector<T> &column)
+{
+  os.write (reinterpret_cast<const char *> (column.data ()), column.size () * sizeof (T));
+}
+
+/**
+ * Rotate a column so that a given row becomes the first one.
+ *
+ * \param [in,out] column The column.
+ * \param [in] first The index of the new first row.
+ */
+template <typename T>
+void
+RotateColumn (std::vector<T> &column, uint32_t first)
+{
+  std::rotate (column.begin (), column.begin () + first, column.end ());
+}
+
+/**
+ * Remove the first rows of a column.
+ *
+ * \param [in,out] column The column.
+ * \param [in] n The number of rows to keep.
+ */
+template <typename T>
+void
+EraseOldest (std::vector<T> &column, uint32_t n)
+{
+  column.erase (column.begin (), column.end () - n);
+}
+
+/**
+ * Append the rows of a chunk to a column.
+ *
+ * \param [in] is The file.
+ * \param [in] n The number of rows of the chunk.
+ * \param [in,out] column The column.
+ * \returns \c false if the file is too short.
+ */
+template <typename T>
+bool
+ReadColumn (std::ifstream &is, uint32_t n, std::vector<T> &column)
+{
+  std::size_t start = column.size ();
+  column.resize (start + n);
+  is.read (reinterpret_cast<char *> (column.data () + start), n * sizeof (T));
+  return is.good ();
+}
+
+}  // unnamed namespace
+
+std::size_t
+PacketLifecycleTracker::Columns::GetN (void) const
+{
+  return uid.size ();
+}
+
+void
+PacketLifecycleTracker::Columns::Reserve (std::size_t n)
+{
+  uid.reserve (n);
+  time.reserve (n);
+  node.reserve (n);
+  interface.reserve (n);
+  size.reserve (n);
+  event.reserve (n);
+}
+
+void
+PacketLifecycleTracker::Columns::Clear (void)
+{
+  uid.clear ();
+  time.clear ();
+  node.clear ();
+  interface.clear ();
+  size.clear ();
+  event.clear ();
+}
+
+PacketLifecycleTracker::PacketLifecycleTracker ()
+  : m_oldest (0),
+    m_chunkSize (65536),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_columns.Reserve (m_chunkSize);
+}
+
+PacketLifecycleTracker::~PacketLifecycleTracker ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+PacketLifecycleTracker::SetChunkSize (uint32_t rows)
+{
+  NS_LOG_FUNCTION (this << rows);
+  NS_ABORT_MSG_IF (rows == 0, "PacketLifecycleTracker::SetChunkSize(): a chunk needs at least one row");
+  Unwrap ();
+  m_chunkSize = rows;
+  if (m_file.is_open () && m_columns.GetN () >= m_chunkSize)
+    {
+      WriteChunk ();
+    }
+  else if (m_columns.GetN () > m_chunkSize)
+    {
+      // keep the newest rows
+      EraseOldest (m_columns.uid, m_chunkSize);
+      EraseOldest (m_columns.time, m_chunkSize);
+      EraseOldest (m_columns.node, m_chunkSize);
+      EraseOldest (m_columns.interface, m_chunkSize);
+      EraseOldest (m_columns.size, m_chunkSize);
+      EraseOldest (m_columns.event, m_chunkSize);
+    }
+  m_columns.Reserve (m_chunkSize);
+}
+
+bool
+PacketLifecycleTracker::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_LOG_WARN ("Cannot create " << filename);
+      return false;
+    }
+  // the rows kept in the ring go first, and the next ones are appended
+  // after them
+  Unwrap ();
+  uint32_t header[2] = { LIFECYCLE_MAGIC, LIFECYCLE_VERSION };
+  m_file.write (reinterpret_cast<const char *> (header), sizeof (header));
+  return true;
+}
+
+void
+PacketLifecycleTracker::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+}
+
+void
+PacketLifecycleTracker::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      if (m_columns.GetN () > 0)
+        {
+          WriteChunk ();
+        }
+      m_file.flush ();
+    }
+}
+
+void
+PacketLifecycleTracker::WriteChunk (void)
+{
+  NS_LOG_FUNCTION (this);
+  Unwrap ();
+  uint32_t n = m_columns.GetN ();
+  m_file.write (reinterpret_cast<const char *> (&n), sizeof (n));
+  WriteColumn (m_file, m_columns.uid);
+  WriteColumn (m_file, m_columns.time);
+  WriteColumn (m_file, m_columns.node);
+  WriteColumn (m_file, m_columns.interface);
+  WriteColumn (m_file, m_columns.size);
+  WriteColumn (m_file, m_columns.event);
+  m_columns.Clear ();
+}
+
+void
+PacketLifecycleTracker::Unwrap (void)
+{
+  if (m_oldest != 0)
+    {
+      RotateColumn (m_columns.uid, m_oldest);
+      RotateColumn (m_columns.time, m_oldest);
+      RotateColumn (m_columns.node, m_oldest);
+      RotateColumn (m_columns.interface, m_oldest);
+      RotateColumn (m_columns.size, m_oldest);
+      RotateColumn (m_columns.event, m_oldest);
+      m_oldest = 0;
+    }
+}
+
+void
+PacketLifecycleTracker::Install (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  uint32_t node = device->GetNode ()->GetId ();
+  uint32_t interface = device->GetIfIndex ();
+  device->TraceConnectWithoutContext ("MacTx", MakeBoundCallback (&TraceEvent<TX>, this, node, interface));
+  device->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&TraceEvent<RX>, this, node, interface));
+  device->TraceConnectWithoutContext ("MacTxDrop", MakeBoundCallback (&TraceEvent<TX_DROP>, this, node, interface));
+  device->TraceConnectWithoutContext ("PhyTxDrop", MakeBoundCallback (&TraceEvent<TX_DROP>, this, node, interface));
+  device->TraceConnectWithoutContext ("MacRxDrop", MakeBoundCallback (&TraceEvent<RX_DROP>, this, node, interface));
+  device->TraceConnectWithoutContext ("PhyRxDrop", MakeBoundCallback (&TraceEvent<RX_DROP>, this, node, interface));
+
+  PointerValue ptr;
+  if (device->GetAttributeFailSafe ("TxQueue", ptr))
+    {
+      Ptr<Queue<Packet> > queue = ptr.Get<Queue<Packet> > ();
+      if (queue != 0)
+        {
+          queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&TraceEvent<ENQUEUE>, this, node, interface));
+          queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&TraceEvent<DEQUEUE>, this, node, interface));
+          queue->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&TraceEvent<QUEUE_DROP>, this, node, interface));
+        }
+    }
+}
+
+void
+PacketLifecycleTracker::Install (NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Install (*i);
+    }
+}
+
+void
+PacketLifecycleTracker::Install (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+        {
+          Install ((*i)->GetDevice (j));
+        }
+    }
+}
+
+void
+PacketLifecycleTracker::InstallAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  Install (NodeContainer::GetGlobal ());
+}
+
+void
+PacketLifecycleTracker::Record (Ptr<const Packet> packet, uint32_t node, uint32_t interface, Event event)
+{
+  m_nRecords++;
+  if (m_columns.GetN () >= m_chunkSize && !m_file.is_open ())
+    {
+      // without a file, the table is a ring which overwrites the oldest row
+      m_columns.uid[m_oldest] = packet->GetUid ();
+      m_columns.time[m_oldest] = Simulator::Now ().GetNanoSeconds ();
+      m_columns.node[m_oldest] = node;
+      m_columns.interface[m_oldest] = interface;
+      m_columns.size[m_oldest] = packet->GetSize ();
+      m_columns.event[m_oldest] = event;
+      m_oldest = (m_oldest + 1) % m_chunkSize;
+      return;
+    }
+  m_columns.uid.push_back (packet->GetUid ());
+  m_columns.time.push_back (Simulator::Now ().GetNanoSeconds ());
+  m_columns.node.push_back (node);
+  m_columns.interface.push_back (interface);
+  m_columns.size.push_back (packet->GetSize ());
+  m_columns.event.push_back (event);
+  if (m_columns.GetN () >= m_chunkSize && m_file.is_open ())
+    {
+      WriteChunk ();
+    }
+}
+
+const PacketLifecycleTracker::Columns &
+PacketLifecycleTracker::GetColumns (void)
+{
+  Unwrap ();
+  return m_columns;
+}
+
+uint64_t
+PacketLifecycleTracker::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+bool
+PacketLifecycleTracker::Read (std::string filename, Columns &columns)
+{
+  NS_LOG_FUNCTION (filename);
+  columns.Clear ();
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  uint32_t header[2];
+  is.read (reinterpret_cast<char *> (header), sizeof (header));
+  if (!is.good () || header[0] != LIFECYCLE_MAGIC || header[1] != LIFECYCLE_VERSION)
+    {
+      NS_LOG_WARN ("Not a packet lifecycle file: " << filename);
+      return false;
+    }
+  uint32_t n;
+  while (is.read (reinterpret_cast<char *> (&n), sizeof (n)))
+    {
+      if (!ReadColumn (is, n, columns.uid)
+          || !ReadColumn (is, n, columns.time)
+          || !ReadColumn (is, n, columns.node)
+          || !ReadColumn (is, n, columns.interface)
+          || !ReadColumn (is, n, columns.size)
+          || !ReadColumn (is, n, columns.event))
+        {
+          NS_LOG_WARN ("Truncated packet lifecycle file: " << filename);
+          return false;
+        }
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -24,6 +24,9 @@
 #include <cstring>
 #include <iostream>
 #include <iomanip>
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+#include <atomic>
+#endif
 
 namespace ns3 {
 
@@ -138,9 +141,14 @@ uint8_t
 Address::Register (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+  // the address types are registered by the first thread to use them,
+  // and shared by all the threads
+  static std::atomic<uint8_t> type (1);
+#else
   static uint8_t type = 1;
-  type++;
-  return type;
+#endif
+  return ++type;
 }
 
 uint32_t
@@ -43,6 +43,50 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Add up the 16-bit words of contiguous bytes, in the byte
+ * order of Buffer::Iterator::ReadU16, for the Internet checksum.
+ *
+ * The bytes are loaded 4 at a time into a 64-bit sum, which the
+ * compiler can vectorize, and the sum is folded to 16 bits at the
+ * end.  A last odd byte is added as if it were followed by a zero.
+ *
+ * \param [in] data the bytes.
+ * \param [in] size the number of bytes.
+ * \returns the ones' complement sum of the words.
+ */
+static uint16_t
+SumWords (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  uint32_t words = size / 4;
+  for (uint32_t j = 0; j < words; j++)
+    {
+      uint32_t word;
+      memcpy (&word, data + 4 * j, 4);
+      sum += word;
+    }
+  for (uint32_t j = 4 * words; j < size; j += 2)
+    {
+      uint16_t word = 0;
+      memcpy (&word, data + j, std::min<uint32_t> (2, size - j));
+      sum += word;
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  uint16_t result = sum;
+  // the words were loaded in the byte order of the host
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const uint8_t *> (&one) == 0)
+    {
+      result = (result >> 8) | (result << 8);
+    }
+  return result;
+}
+
 }
 
 namespace ns3 {
@@ -50,7 +94,13 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint64_t Buffer::g_materializedBytes = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+uint64_t Buffer::g_materializedBytes = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -75,9 +125,15 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
+#ifdef NS3_ENSEMBLE
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList *Buffer::g_freeList = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#else
 uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList *Buffer::g_freeList = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#endif
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
@@ -123,6 +179,10 @@ Buffer::Create (uint32_t dataSize)
   if (IS_UNINITIALIZED (g_freeList))
     {
       g_freeList = new Buffer::FreeList ();
+#ifdef NS3_ENSEMBLE
+      // the destructor of a thread_local is only registered by its first use
+      (void) &g_localStaticDestructor;
+#endif
     }
   else if (IS_INITIALIZED (g_freeList))
     {
@@ -186,18 +246,21 @@ Buffer::Deallocate (struct Buffer::Data *data)
 }
 
 Buffer::Buffer ()
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this);
   Initialize (0);
 }
 
 Buffer::Buffer (uint32_t dataSize)
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this << dataSize);
   Initialize (dataSize);
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -226,13 +289,17 @@ Buffer::CheckInternalState (void) const
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool chainOk = m_chain == 0 ||
+    (m_chain->m_count > 0 && !m_chain->m_slices.empty ());
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && chainOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this << 
                           ", " << (offsetsOk ? "true" : "false") <<
                           ", " << (dirtyOk ? "true" : "false") <<
-                          ", " << (internalSizeOk ? "true" : "false") << " ");
+                          ", " << (internalSizeOk ? "true" : "false") <<
+                          ", " << (chainOk ? "true" : "false") << " ");
     }
   return ok;
 #else
@@ -262,14 +329,25 @@ Buffer::operator = (Buffer const&o)
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Recycle (m_data);
         }
       m_data = o.m_data;
       m_data->m_count++;
     }
+  if (m_chain != o.m_chain)
+    {
+      if (o.m_chain != 0)
+        {
+          o.m_chain->m_count++;
+        }
+      if (m_chain != 0)
+        {
+          ReleaseChain (m_chain);
+        }
+      m_chain = o.m_chain;
+    }
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
@@ -285,11 +363,63 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
+  if (m_chain != 0)
+    {
+      ReleaseChain (m_chain);
+    }
+}
+
+void
+Buffer::ReleaseChain (struct Buffer::Chain *chain)
+{
+  NS_LOG_FUNCTION (chain);
+  if (--chain->m_count == 0)
+    {
+      delete chain;
+    }
+}
+
+void
+Buffer::UnshareChain (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_chain->m_count > 1)
+    {
+      struct Buffer::Chain *chain = new Buffer::Chain;
+      chain->m_count = 1;
+      chain->m_size = m_chain->m_size;
+      chain->m_slices = m_chain->m_slices;
+      ReleaseChain (m_chain);
+      m_chain = chain;
+    }
+}
+
+Buffer
+Buffer::GetFirstSlice (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer slice = *this;
+  if (slice.m_chain != 0)
+    {
+      ReleaseChain (slice.m_chain);
+      slice.m_chain = 0;
+    }
+  return slice;
+}
+
+void
+Buffer::SetFirstSlice (const Buffer &slice)
+{
+  NS_LOG_FUNCTION (this << &slice);
+  NS_ASSERT (slice.m_chain == 0);
+  struct Buffer::Chain *chain = m_chain;
+  m_chain = 0;
+  *this = slice;
+  m_chain = chain;
 }
 
 uint32_t
@@ -310,7 +440,13 @@ Buffer::AddAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+#ifdef NS3_MTP
+  // never write in place in shared data: its other owners may run in
+  // other threads of MultithreadedSimulatorImpl.
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -328,8 +464,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (--m_data->m_count == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -355,7 +490,20 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      UnshareChain ();
+      m_chain->m_slices.back ().AddAtEnd (end);
+      m_chain->m_size += end;
+      return;
+    }
+#ifdef NS3_MTP
+  // never write in place in shared data: its other owners may run in
+  // other threads of MultithreadedSimulatorImpl.
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -373,8 +521,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Buffer::Recycle (m_data);
         }
@@ -400,9 +547,73 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
+  bool small = o.m_chain == 0 && o.GetInternalSize () < BUFFER_MIN_SLICE_SIZE;
+  if (m_chain == 0 && small)
+    {
+      CopyAtEnd (o);
+    }
+  else if (o.GetSize () == 0)
+    {
+      return;
+    }
+  else if (GetSize () == 0)
+    {
+      *this = o;
+    }
+  else if (small)
+    {
+      // not worth a slice of its own
+      UnshareChain ();
+      m_chain->m_slices.back ().CopyAtEnd (o);
+      m_chain->m_size += o.GetSize ();
+    }
+  else
+    {
+      AddSlicesAtEnd (o);
+    }
+  NS_ASSERT (CheckInternalState ());
+}
+
+void
+Buffer::AddSlicesAtEnd (const Buffer &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (&o == this)
+    {
+      Buffer copy = o;
+      AddSlicesAtEnd (copy);
+      return;
+    }
+  if (m_chain == 0)
+    {
+      m_chain = new Buffer::Chain;
+      m_chain->m_count = 1;
+      m_chain->m_size = 0;
+    }
+  else
+    {
+      UnshareChain ();
+    }
+  if (o.m_end != o.m_start)
+    {
+      m_chain->m_slices.push_back (o.GetFirstSlice ());
+      m_chain->m_size += o.m_end - o.m_start;
+    }
+  if (o.m_chain != 0)
+    {
+      m_chain->m_slices.insert (m_chain->m_slices.end (),
+                                o.m_chain->m_slices.begin (), o.m_chain->m_slices.end ());
+      m_chain->m_size += o.m_chain->m_size;
+    }
+  LOG_INTERNAL_STATE ("add slices=" << m_chain->m_slices.size () << ", ");
+}
+
+void
+Buffer::CopyAtEnd (const Buffer &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (m_chain == 0 && o.m_chain == 0);
+  if (m_end == m_zeroAreaEnd &&
       o.m_start == o.m_zeroAreaStart &&
       o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
@@ -411,6 +622,13 @@ Buffer::AddAtEnd (const Buffer &o)
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
+      if (m_data->m_count > 1)
+        {
+          /* The other owners of the data may use the bytes which follow
+           * our end in their own virtual offsets.
+           */
+          Unshare ();
+        }
       uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
       m_zeroAreaEnd += zeroSize;
       m_end = m_zeroAreaEnd;
@@ -426,11 +644,58 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  *this = CreateFullCopy ();
+  /**
+   * A buffer has a single zero area, so one of the two zero areas must
+   * be written to real memory: keep the larger one.
+   */
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (zeroSize < oZeroSize && m_data != o.m_data)
+    {
+      Buffer tmp = o;
+      tmp.AddAtStart (GetSize ());
+      tmp.Begin ().Write (Begin (), End ());
+      // our bytes are payload, not headers: keep them out of the
+      // heuristics which size the headroom of new buffers.
+      tmp.m_maxZeroAreaStart = std::max (o.m_maxZeroAreaStart, m_maxZeroAreaStart);
+      g_materializedBytes += zeroSize;
+      *this = tmp;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_data == o.m_data)
+    {
+      Unshare ();
+    }
   AddAtEnd (o.GetSize ());
   Buffer::Iterator destStart = End ();
   destStart.Prev (o.GetSize ());
   destStart.Write (o.Begin (), o.End ());
+  g_materializedBytes += oZeroSize;
+  NS_ASSERT (CheckInternalState ());
+}
+
+void
+Buffer::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct Buffer::Data *newData = Buffer::Create (GetInternalSize ());
+  memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+  if (--m_data->m_count == 0)
+    {
+      Buffer::Recycle (m_data);
+    }
+  m_data = newData;
+
+  int32_t delta = -m_start;
+  m_zeroAreaStart += delta;
+  m_zeroAreaEnd += delta;
+  m_end += delta;
+  m_start += delta;
+
+  // update dirty area
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -439,6 +704,46 @@ Buffer::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0 && start >= m_end - m_start)
+    {
+      /* remove the first slice: the next slice which keeps some
+       * bytes becomes the first one.
+       */
+      start -= m_end - m_start;
+      uint32_t removed = 0;
+      uint32_t i = 0;
+      while (i < m_chain->m_slices.size () && start >= m_chain->m_slices[i].GetSize ())
+        {
+          start -= m_chain->m_slices[i].GetSize ();
+          removed += m_chain->m_slices[i].GetSize ();
+          i++;
+        }
+      if (i == m_chain->m_slices.size ())
+        {
+          ReleaseChain (m_chain);
+          m_chain = 0;
+          RemoveAtStart (m_end - m_start);
+          return;
+        }
+      Buffer first = m_chain->m_slices[i];
+      removed += first.GetSize ();
+      first.RemoveAtStart (start);
+      SetFirstSlice (first);
+      if (i + 1 == m_chain->m_slices.size ())
+        {
+          ReleaseChain (m_chain);
+          m_chain = 0;
+        }
+      else
+        {
+          UnshareChain ();
+          m_chain->m_slices.erase (m_chain->m_slices.begin (), m_chain->m_slices.begin () + i + 1);
+          m_chain->m_size -= removed;
+        }
+      LOG_INTERNAL_STATE ("rem start=" << start << ", ");
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   uint32_t newStart = m_start + start;
   if (newStart <= m_zeroAreaStart)
     {
@@ -484,6 +789,35 @@ Buffer::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      if (end < m_chain->m_size)
+        {
+          UnshareChain ();
+          m_chain->m_size -= end;
+          while (end > 0)
+            {
+              Buffer &last = m_chain->m_slices.back ();
+              if (end >= last.GetSize ())
+                {
+                  end -= last.GetSize ();
+                  m_chain->m_slices.pop_back ();
+                }
+              else
+                {
+                  last.RemoveAtEnd (end);
+                  end = 0;
+                }
+            }
+          LOG_INTERNAL_STATE ("rem end slices=" << m_chain->m_slices.size () << ", ");
+          NS_ASSERT (CheckInternalState ());
+          return;
+        }
+      /* remove all the slices after the first one */
+      end -= m_chain->m_size;
+      ReleaseChain (m_chain);
+      m_chain = 0;
+    }
   uint32_t newEnd = m_end - std::min (end, m_end - m_start);
   if (newEnd > m_zeroAreaEnd)
     {
@@ -532,11 +866,26 @@ Buffer::CreateFullCopy (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      /* gather the slices */
+      Buffer tmp;
+      tmp.AddAtStart (GetSize ());
+      CopyData (tmp.m_data->m_data + tmp.m_start, GetSize ());
+      g_materializedBytes += m_zeroAreaEnd - m_zeroAreaStart;
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_slices.begin (); i != m_chain->m_slices.end (); ++i)
+        {
+          g_materializedBytes += i->m_zeroAreaEnd - i->m_zeroAreaStart;
+        }
+      NS_ASSERT (tmp.CheckInternalState ());
+      return tmp;
+    }
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
       Buffer tmp;
       tmp.AddAtStart (m_zeroAreaEnd - m_zeroAreaStart);
       tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+      g_materializedBytes += m_zeroAreaEnd - m_zeroAreaStart;
       uint32_t dataStart = m_zeroAreaStart - m_start;
       tmp.AddAtStart (dataStart);
       tmp.Begin ().Write (m_data->m_data+m_start, dataStart);
@@ -556,6 +905,10 @@ uint32_t
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_chain != 0)
+    {
+      return CreateFullCopy ().GetSerializedSize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -576,6 +929,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_chain != 0)
+    {
+      return CreateFullCopy ().Serialize (buffer, maxSize);
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -711,10 +1068,37 @@ Buffer::PeekData (void) const
   return m_data->m_data + m_start;
 }
 
+uint64_t
+Buffer::GetMaterializedBytes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_materializedBytes;
+}
+
+void
+Buffer::ResetMaterializedBytes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_materializedBytes = 0;
+}
+
 void
 Buffer::CopyData (std::ostream *os, uint32_t size) const
 {
   NS_LOG_FUNCTION (this << &os << size);
+  if (m_chain != 0)
+    {
+      uint32_t tmpsize = std::min (m_end - m_start, size);
+      GetFirstSlice ().CopyData (os, tmpsize);
+      size -= tmpsize;
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_slices.begin (); i != m_chain->m_slices.end () && size > 0; ++i)
+        {
+          tmpsize = std::min (i->GetSize (), size);
+          i->CopyData (os, tmpsize);
+          size -= tmpsize;
+        }
+      return;
+    }
   if (size > 0)
     {
       uint32_t tmpsize = std::min (m_zeroAreaStart-m_start, size);
@@ -744,6 +1128,15 @@ uint32_t
 Buffer::CopyData (uint8_t *buffer, uint32_t size) const
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_chain != 0)
+    {
+      uint32_t copied = GetFirstSlice ().CopyData (buffer, size);
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_slices.begin (); i != m_chain->m_slices.end () && copied < size; ++i)
+        {
+          copied += i->CopyData (buffer + copied, size - copied);
+        }
+      return copied;
+    }
   uint32_t originalSize = size;
   if (size > 0)
     {
@@ -783,8 +1176,8 @@ uint32_t
 Buffer::Iterator::GetDistanceFrom (Iterator const &o) const
 {
   NS_LOG_FUNCTION (this << &o);
-  NS_ASSERT (m_data == o.m_data);
-  int32_t diff = m_current - o.m_current;
+  NS_ASSERT (m_buffer == o.m_buffer && (m_buffer != 0 || m_data == o.m_data));
+  int32_t diff = GetPosition () - o.GetPosition ();
   if (diff < 0)
     {
       return -diff;
@@ -799,13 +1192,120 @@ bool
 Buffer::Iterator::IsEnd (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_current == m_dataEnd;
+  return GetPosition () == GetSize ();
 }
 bool 
 Buffer::Iterator::IsStart (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_current == m_dataStart;
+  return GetPosition () == 0;
+}
+
+void
+Buffer::Iterator::SetSlice (uint32_t slice)
+{
+  NS_LOG_FUNCTION (this << slice);
+  const Buffer *buffer = m_buffer;
+  if (slice > 0)
+    {
+      buffer = &m_buffer->m_chain->m_slices[slice - 1];
+    }
+  m_zeroStart = buffer->m_zeroAreaStart;
+  m_zeroEnd = buffer->m_zeroAreaEnd;
+  m_dataStart = buffer->m_start;
+  m_dataEnd = buffer->m_end;
+  m_data = buffer->m_data->m_data;
+  m_slice = slice;
+}
+
+bool
+Buffer::Iterator::NextSlice (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_buffer == 0 || m_slice == m_buffer->m_chain->m_slices.size ())
+    {
+      return false;
+    }
+  m_offset += m_dataEnd - m_dataStart;
+  SetSlice (m_slice + 1);
+  m_current = m_dataStart;
+  return true;
+}
+
+bool
+Buffer::Iterator::PrevSlice (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_buffer == 0 || m_slice == 0)
+    {
+      return false;
+    }
+  SetSlice (m_slice - 1);
+  m_offset -= m_dataEnd - m_dataStart;
+  m_current = m_dataEnd;
+  return true;
+}
+
+void
+Buffer::Iterator::SlowNext (uint32_t delta)
+{
+  NS_LOG_FUNCTION (this << delta);
+  delta -= m_dataEnd - m_current;
+  m_current = m_dataEnd;
+  while (delta > 0)
+    {
+      if (!NextSlice ())
+        {
+          NS_ASSERT_MSG (false, "You have attempted to move after the end of the buffer.");
+          return;
+        }
+      uint32_t step = std::min (delta, m_dataEnd - m_dataStart);
+      m_current += step;
+      delta -= step;
+    }
+}
+
+void
+Buffer::Iterator::SlowPrev (uint32_t delta)
+{
+  NS_LOG_FUNCTION (this << delta);
+  delta -= m_current - m_dataStart;
+  m_current = m_dataStart;
+  while (delta > 0)
+    {
+      if (!PrevSlice ())
+        {
+          NS_ASSERT_MSG (false, "You have attempted to move before the start of the buffer.");
+          return;
+        }
+      uint32_t step = std::min (delta, m_dataEnd - m_dataStart);
+      m_current -= step;
+      delta -= step;
+    }
+}
+
+uint8_t
+Buffer::Iterator::SlowPeekU8 (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!NextSlice ())
+    {
+      NS_ASSERT_MSG (false, GetReadErrorMessage ());
+      return 0;
+    }
+  return PeekU8 ();
+}
+
+void
+Buffer::Iterator::SlowWriteU8 (uint8_t data)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (data));
+  if (!NextSlice ())
+    {
+      NS_ASSERT_MSG (false, GetWriteErrorMessage ());
+      return;
+    }
+  WriteU8 (data);
 }
 
 bool 
@@ -835,6 +1335,17 @@ void
 Buffer::Iterator::Write (Iterator start, Iterator end)
 {
   NS_LOG_FUNCTION (this << &start << &end);
+  if (m_buffer != 0 || start.m_buffer != 0)
+    {
+      // one of the buffers is a chain of slices
+      NS_ASSERT (start.GetPosition () <= end.GetPosition ());
+      uint32_t size = end.GetPosition () - start.GetPosition ();
+      for (uint32_t i = 0; i < size; ++i)
+        {
+          WriteU8 (start.ReadU8 ());
+        }
+      return;
+    }
   NS_ASSERT (start.m_data == end.m_data);
   NS_ASSERT (start.m_current <= end.m_current);
   NS_ASSERT (start.m_zeroStart == end.m_zeroStart);
@@ -843,27 +1354,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the destination is either before or after our zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -953,7 +1473,20 @@ void
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  NS_ASSERT_MSG (CheckNoZero (m_current, size),
+  while (m_current + size > m_dataEnd)
+    {
+      // the bytes span several slices
+      uint32_t toCopy = m_dataEnd - m_current;
+      Write (buffer, toCopy);
+      buffer += toCopy;
+      size -= toCopy;
+      if (!NextSlice ())
+        {
+          NS_ASSERT_MSG (false, GetWriteErrorMessage ());
+          return;
+        }
+    }
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
   uint8_t *to;
   if (m_current <= m_zeroStart)
@@ -1123,6 +1656,18 @@ void
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_current + size <= m_zeroStart)
+    {
+      memcpy (buffer, &m_data[m_current], size);
+      m_current += size;
+      return;
+    }
+  if (m_current >= m_zeroEnd && m_current + size <= m_dataEnd)
+    {
+      memcpy (buffer, &m_data[m_current - (m_zeroEnd - m_zeroStart)], size);
+      m_current += size;
+      return;
+    }
   for (uint32_t i = 0; i < size; i++)
     {
       buffer[i] = ReadU8 ();
@@ -1140,14 +1685,45 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  /* see RFC 1071 to understand this code. The bytes are added up
+   * by runs of contiguous real bytes; the zero area adds nothing.
+   */
+  uint64_t sum = initialChecksum;
+  bool odd = false;
+  uint32_t left = size;
+  while (left > 0)
+    {
+      if (m_current == m_dataEnd && !NextSlice ())
+        {
+          NS_ASSERT_MSG (false, GetReadErrorMessage ());
+          break;
+        }
+      uint32_t n;
+      const uint8_t *data = 0;
+      if (m_current < m_zeroStart)
+        {
+          n = std::min (left, m_zeroStart - m_current);
+          data = &m_data[m_current];
+        }
+      else if (m_current < m_zeroEnd)
+        {
+          n = std::min (left, m_zeroEnd - m_current);
+        }
+      else
+        {
+          n = std::min (left, m_dataEnd - m_current);
+          data = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        }
+      if (data != 0)
+        {
+          uint16_t partial = SumWords (data, n);
+          // a run which starts at an odd offset adds its words swapped
+          sum += odd ? static_cast<uint16_t> ((partial >> 8) | (partial << 8)) : partial;
+        }
+      odd ^= (n & 1) != 0;
+      m_current += n;
+      left -= n;
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -1158,6 +1734,10 @@ uint32_t
 Buffer::Iterator::GetSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_buffer != 0)
+    {
+      return m_buffer->GetSize ();
+    }
   return m_dataEnd - m_dataStart;
 }
 
@@ -1165,7 +1745,7 @@ uint32_t
 Buffer::Iterator::GetRemainingSize (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_dataEnd - m_current;
+  return GetSize () - GetPosition ();
 }
 
 
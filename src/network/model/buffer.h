@@ -25,7 +25,11 @@
 #include <ostream>
 #include "ns3/assert.h"
 
+#ifdef NS3_MTP
+#include <atomic>
+#else
 #define BUFFER_FREE_LIST 1
+#endif
 
 namespace ns3 {
 
@@ -65,8 +69,9 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
+ * zero bytes of application-level payload unless the user calls
+ * PeekData or concatenates two Buffers whose zero areas are not
+ * adjacent: this application-level payload is kept track of with
  * a pair of integers which describe where in the buffer content
  * the "virtual zero area" starts and ends.
  *
@@ -88,6 +93,16 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * Appending a buffer with many real bytes to another one does not copy
+ * these bytes: the buffer becomes a chain of slices, as a scatter-gather
+ * list.  The fields above describe the first slice, and a Buffer::Chain
+ * shared with the copies of the buffer, and copied on write, holds the
+ * other slices, each one a Buffer without a chain.  Headers are added to
+ * and removed from the first slice, trailers from the last one, and
+ * AddAtEnd and CreateFragment only copy the list of slices.  The
+ * iterators move from a slice to the next one in their slow paths, and
+ * PeekData and Serialize gather the slices into one data storage.
  */
 class Buffer 
 {
@@ -342,7 +357,9 @@ public:
      *
      * Copy size bytes of data from the internal buffer to the
      * input buffer and advance the Iterator by the number of
-     * bytes read.
+     * bytes read.  The bytes are copied with a single memcpy if
+     * they are real bytes of the same slice, so fixed-layout headers
+     * read them at once and decode the fields from the copy.
      */
     void Read (uint8_t *buffer, uint32_t size);
 
@@ -365,6 +382,11 @@ public:
 
     /**
      * \brief Calculate the checksum.
+     *
+     * The real bytes are added up a run of contiguous bytes at a time,
+     * which the compiler can vectorize, and the virtual zero area is
+     * skipped.
+     *
      * \param size size of the buffer.
      * \param initialChecksum initial value
      * \return checksum
@@ -403,6 +425,55 @@ private:
      * \param buffer the buffer this iterator refers to
      */
     inline void Construct (const Buffer *buffer);
+    /**
+     * Point the iterator to a slice of a chained buffer, without
+     * changing m_current and m_offset.
+     *
+     * \param slice the index of the slice, 0 for the first one
+     */
+    void SetSlice (uint32_t slice);
+    /**
+     * Move to the start of the next slice of a chained buffer.
+     *
+     * \returns false if the iterator is in the last slice.
+     */
+    bool NextSlice (void);
+    /**
+     * Move to the end of the previous slice of a chained buffer.
+     *
+     * \returns false if the iterator is in the first slice.
+     */
+    bool PrevSlice (void);
+    /**
+     * Go forward across the end of the current slice.
+     *
+     * \param delta number of bytes to go forward
+     */
+    void SlowNext (uint32_t delta);
+    /**
+     * Go backward across the start of the current slice.
+     *
+     * \param delta number of bytes to go backward
+     */
+    void SlowPrev (uint32_t delta);
+    /**
+     * \returns the byte at the start of the next slice.
+     *
+     * \warning this is the slow version, please use PeekU8 (void)
+     */
+    uint8_t SlowPeekU8 (void);
+    /**
+     * Write a byte at the start of the next slice.
+     *
+     * \param data data to write in buffer
+     *
+     * \warning this is the slow version, please use WriteU8 (uint8_t)
+     */
+    void SlowWriteU8 (uint8_t data);
+    /**
+     * \returns the offset of the iterator from the start of the buffer.
+     */
+    inline uint32_t GetPosition (void) const;
     /**
      * Checks that the [start, end) is not in the "virtual zero area".
      *
@@ -482,6 +553,19 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * the buffer, if it is a chain of slices, or zero. The offsets
+     * above describe the slice m_slice of the buffer.
+     */
+    const Buffer *m_buffer;
+    /**
+     * the index of the current slice, 0 for the first one.
+     */
+    uint32_t m_slice;
+    /**
+     * the number of bytes of the buffer before the current slice.
+     */
+    uint32_t m_offset;
   };
 
   /**
@@ -524,7 +608,10 @@ private:
   /**
    * \param o the buffer to append to the end of this buffer.
    *
-   * Add bytes at the end of the Buffer.
+   * Add bytes at the end of the Buffer.  If \pname{o} has at least
+   * BUFFER_MIN_SLICE_SIZE real bytes, or if one of the buffers is
+   * already a chain of slices, the bytes are not copied: the slices of
+   * \pname{o} are appended to the slices of this buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
@@ -611,6 +698,28 @@ private:
    */
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * \brief Get the number of virtual zero bytes which were written
+   * to real memory.
+   *
+   * A Buffer keeps its payload in a single virtual zero area, so its
+   * zero bytes must be materialized when PeekData is called, or when
+   * AddAtEnd concatenates two buffers whose zero areas are not adjacent
+   * (in that case, the smaller of the two zero areas is materialized).
+   * The count is kept for each thread, so each replication of an
+   * EnsembleRunner counts its own bytes when ns-3 is configured with
+   * --enable-ensemble.
+   *
+   * \returns the number of bytes materialized by the calling thread
+   * since its start or since the last call to ResetMaterializedBytes.
+   */
+  static uint64_t GetMaterializedBytes (void);
+  /**
+   * \brief Reset the count of GetMaterializedBytes, for example at
+   * the start of a simulation.
+   */
+  static void ResetMaterializedBytes (void);
+
   /**
    * \brief Copy constructor
    * \param o the buffer to copy
@@ -663,7 +772,11 @@ private:
      * The reference count of an instance of this data structure.
      * Each buffer which references an instance holds a count.
      */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /**
      * the size of the m_data field below.
      */
@@ -685,6 +798,13 @@ private:
     uint8_t m_data[1];
   };
 
+  /**
+   * The slices of a buffer after the first one, shared by the copies of
+   * the buffer.  Each slice is a Buffer without a chain, and holds at
+   * least one byte.
+   */
+  struct Chain;
+
   /**
    * \brief Create a full copy of the buffer, including
    * all the internal structures.
@@ -693,6 +813,51 @@ private:
    */
   Buffer CreateFullCopy (void) const;
 
+  /**
+   * \returns the first slice of the buffer, without the chain.
+   */
+  Buffer GetFirstSlice (void) const;
+
+  /**
+   * \brief Replace the first slice of the buffer, keeping the chain.
+   *
+   * \param slice the new first slice, without a chain
+   */
+  void SetFirstSlice (const Buffer &slice);
+
+  /**
+   * \brief Append a buffer by copying its bytes into the data storage
+   * of the last slice.
+   *
+   * \param o the buffer to append, without a chain
+   */
+  void CopyAtEnd (const Buffer &o);
+
+  /**
+   * \brief Append the slices of a buffer to the chain of this buffer.
+   *
+   * \param o the buffer to append
+   */
+  void AddSlicesAtEnd (const Buffer &o);
+
+  /**
+   * \brief Copy the chain before changing it if other buffers share it.
+   */
+  void UnshareChain (void);
+
+  /**
+   * \brief Release a chain of slices.
+   *
+   * \param chain the chain
+   */
+  static void ReleaseChain (struct Buffer::Chain *chain);
+
+  /**
+   * \brief Copy the real bytes of the buffer to a new data storage
+   * of its own, leaving the zero area virtual.
+   */
+  void Unshare (void);
+
   /**
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
@@ -750,6 +915,7 @@ private:
   static void Deallocate (struct Buffer::Data *data);
 
   struct Data *m_data; //!< the buffer data storage
+  struct Chain *m_chain; //!< the slices after the first one, or zero
 
   /**
    * keep track of the maximum value of m_zeroAreaStart across
@@ -767,7 +933,20 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+  static thread_local uint32_t g_recommendedStart;
+#else
   static uint32_t g_recommendedStart;
+#endif
+  /**
+   * number of virtual zero bytes written to real memory, reported by
+   * GetMaterializedBytes.
+   */
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+  static thread_local uint64_t g_materializedBytes;
+#else
+  static uint64_t g_materializedBytes;
+#endif
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -798,10 +977,39 @@ private:
   {
     ~LocalStaticDestructor ();
   };
+#ifdef NS3_ENSEMBLE
+  // each thread runs its own simulation, with its own free list
+  static thread_local uint32_t g_maxSize; //!< Max observed data size
+  static thread_local FreeList *g_freeList; //!< Buffer data container
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+#else
   static uint32_t g_maxSize; //!< Max observed data size
   static FreeList *g_freeList; //!< Buffer data container
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
+#endif
+};
+
+/**
+ * \ingroup packet
+ * Minimum number of real bytes of a buffer appended with
+ * Buffer::AddAtEnd which makes it a slice instead of a copy.
+ */
+#define BUFFER_MIN_SLICE_SIZE 256
+
+struct Buffer::Chain
+{
+  /**
+   * The reference count of the chain. Each buffer which references
+   * it holds a count.
+   */
+#ifdef NS3_MTP
+  std::atomic<uint32_t> m_count;
+#else
+  uint32_t m_count;
+#endif
+  uint32_t m_size; //!< the number of bytes of the slices
+  std::vector<Buffer> m_slices; //!< the slices
 };
 
 } // namespace ns3
@@ -817,7 +1025,10 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_buffer (0),
+    m_slice (0),
+    m_offset (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -828,6 +1039,11 @@ Buffer::Iterator::Iterator (Buffer const*buffer)
 Buffer::Iterator::Iterator (Buffer const*buffer, bool dummy)
 {
   Construct (buffer);
+  if (m_buffer != 0)
+    {
+      SetSlice (buffer->m_chain->m_slices.size ());
+      m_offset = buffer->GetSize () - (m_dataEnd - m_dataStart);
+    }
   m_current = m_dataEnd;
 }
 
@@ -839,31 +1055,64 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_buffer = buffer->m_chain != 0 ? buffer : 0;
+  m_slice = 0;
+  m_offset = 0;
+}
+
+uint32_t
+Buffer::Iterator::GetPosition (void) const
+{
+  return m_offset + m_current - m_dataStart;
 }
 
 void 
 Buffer::Iterator::Next (void)
 {
-  NS_ASSERT (m_current + 1 <= m_dataEnd);
-  m_current++;
+  if (m_current < m_dataEnd)
+    {
+      m_current++;
+    }
+  else
+    {
+      SlowNext (1);
+    }
 }
 void 
 Buffer::Iterator::Prev (void)
 {
-  NS_ASSERT (m_current >= 1);
-  m_current--;
+  if (m_current > m_dataStart)
+    {
+      m_current--;
+    }
+  else
+    {
+      SlowPrev (1);
+    }
 }
 void 
 Buffer::Iterator::Next (uint32_t delta)
 {
-  NS_ASSERT (m_current + delta <= m_dataEnd);
-  m_current += delta;
+  if (m_current + delta <= m_dataEnd)
+    {
+      m_current += delta;
+    }
+  else
+    {
+      SlowNext (delta);
+    }
 }
 void 
 Buffer::Iterator::Prev (uint32_t delta)
 {
-  NS_ASSERT (m_current >= delta);
-  m_current -= delta;
+  if (m_current - m_dataStart >= delta)
+    {
+      m_current -= delta;
+    }
+  else
+    {
+      SlowPrev (delta);
+    }
 }
 void
 Buffer::Iterator::WriteU8 (uint8_t data)
@@ -876,16 +1125,29 @@ Buffer::Iterator::WriteU8 (uint8_t data)
       m_data[m_current] = data;
       m_current++;
     }
-  else
+  else if (m_current < m_dataEnd)
     {
       m_data[m_current - (m_zeroEnd-m_zeroStart)] = data;
       m_current++;
     }
+  else
+    {
+      SlowWriteU8 (data);
+    }
 }
 
 void 
 Buffer::Iterator::WriteU8 (uint8_t  data, uint32_t len)
 {
+  if (m_current + len > m_dataEnd)
+    {
+      // the bytes span several slices
+      for (uint32_t i = 0; i < len; ++i)
+        {
+          WriteU8 (data);
+        }
+      return;
+    }
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + len),
                  GetWriteErrorMessage ());
   if (m_current <= m_zeroStart)
@@ -904,6 +1166,12 @@ Buffer::Iterator::WriteU8 (uint8_t  data, uint32_t len)
 void 
 Buffer::Iterator::WriteHtonU16 (uint16_t data)
 {
+  if (m_current + 2 > m_dataEnd)
+    {
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + 2),
                  GetWriteErrorMessage ());
   uint8_t *buffer;
@@ -923,6 +1191,14 @@ Buffer::Iterator::WriteHtonU16 (uint16_t data)
 void 
 Buffer::Iterator::WriteHtonU32 (uint32_t data)
 {
+  if (m_current + 4 > m_dataEnd)
+    {
+      WriteU8 ((data >> 24) & 0xff);
+      WriteU8 ((data >> 16) & 0xff);
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + 4),
                  GetWriteErrorMessage ());
 
@@ -950,7 +1226,7 @@ Buffer::Iterator::ReadNtohU16 (void)
     {
       buffer = &m_data[m_current];
     }
-  else if (m_current >= m_zeroEnd)
+  else if (m_current >= m_zeroEnd && m_current + 2 <= m_dataEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
@@ -974,7 +1250,7 @@ Buffer::Iterator::ReadNtohU32 (void)
     {
       buffer = &m_data[m_current];
     }
-  else if (m_current >= m_zeroEnd)
+  else if (m_current >= m_zeroEnd && m_current + 4 <= m_dataEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
@@ -997,8 +1273,7 @@ Buffer::Iterator::ReadNtohU32 (void)
 uint8_t
 Buffer::Iterator::PeekU8 (void)
 {
-  NS_ASSERT_MSG (m_current >= m_dataStart &&
-                 m_current < m_dataEnd,
+  NS_ASSERT_MSG (m_current >= m_dataStart,
                  GetReadErrorMessage ());
 
   if (m_current < m_zeroStart)
@@ -1010,11 +1285,15 @@ Buffer::Iterator::PeekU8 (void)
     {
       return 0;
     }
-  else
+  else if (m_current < m_dataEnd)
     {
       uint8_t data = m_data[m_current - (m_zeroEnd-m_zeroStart)];
       return data;
     }
+  else
+    {
+      return SlowPeekU8 ();
+    }
 }
 
 uint8_t
@@ -1049,6 +1328,7 @@ Buffer::Iterator::Read (Buffer::Iterator start, uint32_t size)
 
 Buffer::Buffer (Buffer const&o)
   : m_data (o.m_data),
+    m_chain (o.m_chain),
     m_maxZeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
@@ -1056,12 +1336,20 @@ Buffer::Buffer (Buffer const&o)
     m_end (o.m_end)
 {
   m_data->m_count++;
+  if (m_chain != 0)
+    {
+      m_chain->m_count++;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
 uint32_t 
 Buffer::GetSize (void) const
 {
+  if (m_chain != 0)
+    {
+      return m_end - m_start + m_chain->m_size;
+    }
   return m_end - m_start;
 }
 
@@ -18,13 +18,15 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-pool.h"
 #include "ns3/log.h"
-#include <vector>
 #include <cstring>
+#include <algorithm>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
-#define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -40,37 +42,15 @@ NS_LOG_COMPONENT_DEFINE ("ByteTagList");
  */
 struct ByteTagListData {
   uint32_t size;   //!< size of the data
+#ifdef NS3_MTP
+  std::atomic<uint32_t> count;  //!< use counter (for smart deallocation)
+#else
   uint32_t count;  //!< use counter (for smart deallocation)
+#endif
   uint32_t dirty;  //!< number of bytes actually in use
   uint8_t data[4]; //!< data
 };
 
-#ifdef USE_FREE_LIST
-/**
- * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
- *
- * Internal use only.
- */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
-#endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
@@ -152,13 +132,10 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     m_maxEnd (o.m_maxEnd),
     m_adjustment (o.m_adjustment),
     m_used (o.m_used),
-    m_data (o.m_data)
+    m_data (0)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data != 0)
-    {
-      m_data->count++;
-    }
+  CopyData (o);
 }
 ByteTagList &
 ByteTagList::operator = (const ByteTagList &o)
@@ -172,12 +149,8 @@ ByteTagList::operator = (const ByteTagList &o)
   m_minStart = o.m_minStart;
   m_maxEnd = o.m_maxEnd;
   m_adjustment = o.m_adjustment;
-  m_data = o.m_data;
   m_used = o.m_used;
-  if (m_data != 0)
-    {
-      m_data->count++;
-    }
+  CopyData (o);
   return *this;
 }
 ByteTagList::~ByteTagList ()
@@ -196,19 +169,36 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   NS_ASSERT (m_used <= spaceNeeded);
   if (m_data == 0)
     {
-      m_data = Allocate (spaceNeeded);
-      m_used = 0;
-    } 
+      if (spaceNeeded > INLINE_SIZE)
+        {
+          struct ByteTagListData *newData = Allocate (spaceNeeded);
+          std::memcpy (&newData->data, m_inline, m_used);
+          m_data = newData;
+        }
+    }
+#ifdef NS3_MTP
+  // the data may be appended to by another thread: never write in place
+  // into shared data
+  else if (m_data->size < spaceNeeded || m_data->count != 1)
+#else
   else if (m_data->size < spaceNeeded ||
            (m_data->count != 1 && m_data->dirty != m_used))
+#endif
     {
-      struct ByteTagListData *newData = Allocate (spaceNeeded);
+      // grow geometrically, so that adding many tags copies them
+      // a logarithmic number of times
+      uint32_t size = spaceNeeded;
+      if (m_data->size < spaceNeeded)
+        {
+          size = std::max (spaceNeeded, 2 * m_data->size);
+        }
+      struct ByteTagListData *newData = Allocate (size);
       std::memcpy (&newData->data, &m_data->data, m_used);
       Deallocate (m_data);
       m_data = newData;
     }
-  TagBuffer tag = TagBuffer (&m_data->data[m_used], 
-                             &m_data->data[spaceNeeded]);
+  uint8_t *buffer = GetBuffer ();
+  TagBuffer tag = TagBuffer (&buffer[m_used], &buffer[spaceNeeded]);
   tag.WriteU32 (tid.GetUid ());
   tag.WriteU32 (bufferSize);
   tag.WriteU32 (start - m_adjustment);
@@ -222,7 +212,10 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_maxEnd = end - m_adjustment;
     }
   m_used = spaceNeeded;
-  m_data->dirty = m_used;
+  if (m_data != 0)
+    {
+      m_data->dirty = m_used;
+    }
   return tag;
 }
 
@@ -264,13 +257,14 @@ ByteTagList::Iterator
 ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
 {
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
-  if (m_data == 0)
+  if (m_used == 0)
     {
       return Iterator (0, 0, offsetStart, offsetEnd, 0);
     }
   else
     {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+      uint8_t *buffer = GetBuffer ();
+      return Iterator (buffer, &buffer[m_used], offsetStart, offsetEnd, m_adjustment);
     }
 }
 
@@ -339,69 +333,40 @@ ByteTagList::AddAtStart (int32_t prependOffset)
   *this = list;
 }
 
-#ifdef USE_FREE_LIST
-
-struct ByteTagListData *
-ByteTagList::Allocate (uint32_t size)
+uint8_t *
+ByteTagList::GetBuffer (void) const
 {
-  NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  if (m_data != 0)
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      return m_data->data;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
-  data->count = 1;
-  data->size = size;
-  data->dirty = 0;
-  return data;
+  return reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (m_inline));
 }
 
-void 
-ByteTagList::Deallocate (struct ByteTagListData *data)
+void
+ByteTagList::CopyData (const ByteTagList &o)
 {
-  NS_LOG_FUNCTION (this << data);
-  if (data == 0)
+  NS_LOG_FUNCTION (this << &o);
+  m_data = o.m_data;
+  if (m_data != 0)
     {
-      return;
+      m_data->count++;
     }
-  g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  else if (m_used != 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
 }
 
-#else /* USE_FREE_LIST */
-
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  // use all the block of the PacketPool, to grow in place up to its size
+  std::size_t blockSize = PacketPool::GetBlockSize (size + sizeof (struct ByteTagListData) - 4);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (PacketPool::Allocate (blockSize));
   data->count = 1;
-  data->size = size;
+  data->size = blockSize - (sizeof (struct ByteTagListData) - 4);
   data->dirty = 0;
   return data;
 }
@@ -414,15 +379,11 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  if (--data->count == 0)
     {
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      PacketPool::Deallocate (data, data->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 
-#endif /* USE_FREE_LIST */
-
 
 } // namespace ns3
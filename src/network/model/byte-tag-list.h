@@ -45,9 +45,14 @@ struct ByteTagListData;
  *     as 4 32bit integers (TypeId, tag data size, start, end) followed 
  *     by the tag data as generated by Tag::Serialize.
  *
- *   - The struct ByteTagListData structure which contains the tag byte buffer
- *     is shared and, thus, reference-counted. This data structure is unshared
- *     as-needed to emulate COW semantics.
+ *   - The first INLINE_SIZE bytes of tags are stored in the ByteTagList
+ *     itself, and copied with it, so that a packet with a single small
+ *     byte tag does not allocate memory.
+ *
+ *   - When more tags are added, they are all moved to a struct
+ *     ByteTagListData structure which contains the tag byte buffer.  It
+ *     is shared and, thus, reference-counted. This data structure is
+ *     unshared as-needed to emulate COW semantics.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
@@ -252,11 +257,26 @@ private:
    */
   void Deallocate (struct ByteTagListData *data);
 
+  /**
+   * \returns the tag byte buffer, in the ByteTagListData or inline
+   */
+  uint8_t *GetBuffer (void) const;
+
+  /**
+   * \brief Share the ByteTagListData of another list, or copy its inline tags
+   * \param o the other list
+   */
+  void CopyData (const ByteTagList &o);
+
+  /// The size of the tags stored in the list itself
+  static const uint32_t INLINE_SIZE = 32;
+
   int32_t m_minStart; //!< minimal start offset
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
-  struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  struct ByteTagListData *m_data; //!< the ByteTagListData structure, or 0 if the tags are in m_inline
+  uint32_t m_inline[INLINE_SIZE / 4]; //!< the tag byte buffer when it fits in it
 };
 
 void
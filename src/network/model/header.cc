@@ -42,6 +42,20 @@ Header::GetTypeId (void)
   return tid;
 }
 
+Header *
+Header::Clone (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 0;
+}
+
+bool
+Header::Assign (const Header &header)
+{
+  NS_LOG_FUNCTION (this << &header);
+  return false;
+}
+
 std::ostream & operator << (std::ostream &os, const Header &header)
 {
   header.Print (os);
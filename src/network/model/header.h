@@ -101,6 +101,26 @@ public:
    * i.e.: (field1 val1 field2 val2 field3 val3) field4 val4 field5 val5
    */
   virtual void Print (std::ostream &os) const = 0;
+  /**
+   * \returns a copy of this header allocated with new, or zero if
+   * this type of header cannot be copied, which is the default.
+   *
+   * Packet::PeekHeader keeps a copy of the last header it deserialized,
+   * and a later Packet::PeekHeader or Packet::RemoveHeader of a header
+   * of the same type assigns the copy with Assign instead of
+   * deserializing the bytes again.  A header whose deserialization is
+   * expensive, for example because it parses options, can override
+   * both methods to benefit from this cache.
+   */
+  virtual Header * Clone (void) const;
+  /**
+   * \param header a copy of a header of the same type, made by Clone.
+   * \returns false if this header does not take the copy, for example
+   * because it must verify a checksum on the bytes of the packet.
+   *
+   * Set this header to \pname{header}.  The default returns false.
+   */
+  virtual bool Assign (const Header &header);
 };
 
 
@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "net-device.h"
+#include "ns3/packet-burst.h"
 
 namespace ns3 {
 
@@ -41,4 +42,16 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  bool ret = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      ret = Send (*i, dest, protocolNumber) && ret;
+    }
+  return ret;
+}
+
 } // namespace ns3
@@ -34,6 +34,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class PacketBurst;
 
 /**
  * \ingroup network
@@ -246,6 +247,20 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        these packets.
+   *
+   *  Called from higher layer to send several packets to the same
+   *  destination at once.  A device can transmit them back to back with
+   *  a single event for the whole burst; the default implementation
+   *  calls Send for each packet.
+   *
+   * \return whether the Send operation succeeded for all the packets
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \param packet packet sent from above down to Network Device
    * \param source source mac address (so called "MAC spoofing")
@@ -30,14 +30,14 @@ NS_LOG_COMPONENT_DEFINE ("NixVector");
 typedef std::vector<uint32_t> NixBits_t;  //!< typedef for the nixVector
 
 NixVector::NixVector ()
-  : m_nixVector (0),
-    m_used (0),
-    m_currentVectorBitSize (0),
-    m_totalBitSize (0)
+  : m_bits (Create<Bits> ()),
+    m_used (0)
 {
   NS_LOG_FUNCTION (this);
 
-  m_nixVector.push_back (0);
+  m_bits->nixVector.push_back (0);
+  m_bits->currentVectorBitSize = 0;
+  m_bits->totalBitSize = 0;
 }
 
 NixVector::~NixVector ()
@@ -46,10 +46,8 @@ NixVector::~NixVector ()
 }
 
 NixVector::NixVector (const NixVector &o)
-  : m_nixVector (o.m_nixVector),
-    m_used (o.m_used),
-    m_currentVectorBitSize (o.m_currentVectorBitSize),
-    m_totalBitSize (o.m_totalBitSize)
+  : m_bits (o.m_bits),
+    m_used (o.m_used)
 {
 }
 
@@ -60,10 +58,8 @@ NixVector::operator = (const NixVector &o)
     {
       return *this;
     }
-  m_nixVector = o.m_nixVector;
+  m_bits = o.m_bits;
   m_used = o.m_used;
-  m_currentVectorBitSize = o.m_currentVectorBitSize;
-  m_totalBitSize = o.m_totalBitSize;
   return *this;
 }
 
@@ -77,6 +73,16 @@ NixVector::Copy (void) const
   return Ptr<NixVector> (new NixVector (*this), false);
 }
 
+void
+NixVector::UnshareBits (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_bits->GetReferenceCount () > 1)
+    {
+      m_bits = Create<Bits> (*m_bits);
+    }
+}
+
 /* For printing the nix vector */
 std::ostream & operator << (std::ostream &os, const NixVector &nix)
 {
@@ -94,46 +100,48 @@ NixVector::AddNeighborIndex (uint32_t newBits, uint32_t numberOfBits)
       NS_FATAL_ERROR ("Can't add more than 32 bits to a nix-vector at one time");
     }
 
+  UnshareBits ();
+
   // Check to see if the number
   // of new bits forces the creation of 
   // a new entry into the NixVector vector
   // i.e., we will overflow int o.w.
-  if (m_currentVectorBitSize + numberOfBits > 32) 
+  if (m_bits->currentVectorBitSize + numberOfBits > 32) 
     {
-      if (m_currentVectorBitSize == 32)
+      if (m_bits->currentVectorBitSize == 32)
         {
           // can't add any more to this vector, so 
           // start a new one
-          m_nixVector.push_back (newBits);
+          m_bits->nixVector.push_back (newBits);
 
           // also reset number of bits in
-          // m_currentVectorBitSize
+          // m_bits->currentVectorBitSize
           // because we are working with a new 
           // entry in the vector
-          m_currentVectorBitSize = numberOfBits;
-          m_totalBitSize += numberOfBits;
+          m_bits->currentVectorBitSize = numberOfBits;
+          m_bits->totalBitSize += numberOfBits;
         }
       else
         {
           // Put what we can in the remaining portion of the 
           // vector entry
           uint32_t tempBits = newBits;
-          tempBits = newBits << m_currentVectorBitSize;
-          tempBits |= m_nixVector.back ();
-          m_nixVector.back () = tempBits;
+          tempBits = newBits << m_bits->currentVectorBitSize;
+          tempBits |= m_bits->nixVector.back ();
+          m_bits->nixVector.back () = tempBits;
 
           // Now start a new vector entry
           // and push the remaining bits 
           // there
-          newBits = newBits >> (32 - m_currentVectorBitSize);
-          m_nixVector.push_back (newBits);
+          newBits = newBits >> (32 - m_bits->currentVectorBitSize);
+          m_bits->nixVector.push_back (newBits);
 
           // also reset number of bits in
-          // m_currentVectorBitSize
+          // m_bits->currentVectorBitSize
           // because we are working with a new 
           // entry in the vector
-          m_currentVectorBitSize = (numberOfBits - (32 - m_currentVectorBitSize));
-          m_totalBitSize += numberOfBits;
+          m_bits->currentVectorBitSize = (numberOfBits - (32 - m_bits->currentVectorBitSize));
+          m_bits->totalBitSize += numberOfBits;
         }
     }
   else
@@ -143,16 +151,16 @@ NixVector::AddNeighborIndex (uint32_t newBits, uint32_t numberOfBits)
       // us to logically OR with the present 
       // NixVector, resulting in the new 
       // NixVector
-      newBits = newBits << m_currentVectorBitSize;
-      newBits |= m_nixVector.back ();
+      newBits = newBits << m_bits->currentVectorBitSize;
+      newBits |= m_bits->nixVector.back ();
 
       // Now insert the new NixVector and 
       // increment number of bits for
-      // m_currentVectorBitSize and m_totalBitSize
+      // m_bits->currentVectorBitSize and m_bits->totalBitSize
       // accordingly 
-      m_nixVector.back () = newBits;
-      m_currentVectorBitSize += numberOfBits;
-      m_totalBitSize += numberOfBits;
+      m_bits->nixVector.back () = newBits;
+      m_bits->currentVectorBitSize += numberOfBits;
+      m_bits->totalBitSize += numberOfBits;
     }
 }
 
@@ -193,10 +201,10 @@ NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
     {
       if ((numberOfBits-1) > ((totalRemainingBits-1) % 32)) // we do span more than one
         {
-          extractedBits = m_nixVector.at (vectorIndex) << (32 - (totalRemainingBits % 32));
+          extractedBits = m_bits->nixVector.at (vectorIndex) << (32 - (totalRemainingBits % 32));
           extractedBits = extractedBits >> ((32 - (totalRemainingBits % 32)) 
                                             - (numberOfBits - (totalRemainingBits % 32)));
-          extractedBits |= (m_nixVector.at (vectorIndex-1) 
+          extractedBits |= (m_bits->nixVector.at (vectorIndex-1) 
                             >> (32 - (numberOfBits - (totalRemainingBits % 32))));
           m_used += numberOfBits;
           return extractedBits;
@@ -204,7 +212,7 @@ NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
     }
 
   // we don't span more than one
-  extractedBits = m_nixVector.at (vectorIndex) << (32 - (totalRemainingBits % 32));
+  extractedBits = m_bits->nixVector.at (vectorIndex) << (32 - (totalRemainingBits % 32));
   extractedBits = extractedBits >> (32 - (numberOfBits));
   m_used += numberOfBits;
   return extractedBits;
@@ -215,8 +223,8 @@ NixVector::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t totalSizeInBytes = 0;
-  totalSizeInBytes = sizeof (m_used) + sizeof (m_currentVectorBitSize) + 
-    sizeof (m_totalBitSize) + (4 * m_nixVector.size ());
+  totalSizeInBytes = sizeof (m_used) + sizeof (m_bits->currentVectorBitSize) + 
+    sizeof (m_bits->totalBitSize) + (4 * m_bits->nixVector.size ());
 
   return totalSizeInBytes;
 }
@@ -244,7 +252,7 @@ NixVector::Serialize (uint32_t* buffer, uint32_t maxSize) const
       size += 4;
       // grab number of current used bits
       // for the front vector
-      *p++ = m_currentVectorBitSize;
+      *p++ = m_bits->currentVectorBitSize;
     }
   else
     {
@@ -255,18 +263,18 @@ NixVector::Serialize (uint32_t* buffer, uint32_t maxSize) const
     {
       size += 4;
       // grab total bit size
-      *p++ = m_totalBitSize;
+      *p++ = m_bits->totalBitSize;
     }
   else 
     {
       return 0;
     }
-  for (uint32_t j = 0; j < m_nixVector.size (); j++)
+  for (uint32_t j = 0; j < m_bits->nixVector.size (); j++)
     {
       if (size + 4 <= maxSize)
         {
           size += 4;
-          *p++ = m_nixVector.at (j);
+          *p++ = m_bits->nixVector.at (j);
         }
       else
         {
@@ -285,26 +293,28 @@ NixVector::Deserialize (const uint32_t* buffer, uint32_t size)
   const uint32_t* p = buffer;
   uint32_t sizeCheck = size - 4;
 
+  UnshareBits ();
+
   NS_ASSERT (sizeCheck >= 4);
   m_used = *p++;
   sizeCheck -= 4;
 
   NS_ASSERT (sizeCheck >= 4);
-  m_currentVectorBitSize = *p++;
+  m_bits->currentVectorBitSize = *p++;
   sizeCheck -= 4;
 
   NS_ASSERT (sizeCheck >= 4);
-  m_totalBitSize = *p++;
+  m_bits->totalBitSize = *p++;
   sizeCheck -= 4;
 
   // make sure the nix-vector
   // is empty
-  m_nixVector.clear ();
+  m_bits->nixVector.clear ();
   while (sizeCheck > 0)
     {
       NS_ASSERT (sizeCheck >= 4);
       uint32_t nix = *p++;
-      m_nixVector.push_back (nix);
+      m_bits->nixVector.push_back (nix);
       sizeCheck -= 4;
     }
 
@@ -319,9 +329,9 @@ void
 NixVector::DumpNixVector (std::ostream &os) const
 {
   NS_LOG_FUNCTION (this << &os);
-  uint32_t i = m_nixVector.size ();
+  uint32_t i = m_bits->nixVector.size ();
   std::vector<uint32_t>::const_reverse_iterator rIter;
-  for (rIter = m_nixVector.rbegin (); rIter != m_nixVector.rend (); rIter++)
+  for (rIter = m_bits->nixVector.rbegin (); rIter != m_bits->nixVector.rend (); rIter++)
     {
       uint32_t numBits = BitCount (*rIter);
 
@@ -331,17 +341,17 @@ NixVector::DumpNixVector (std::ostream &os) const
       // if it's not the first entry in the vector, 
       // we may have to add some zeros and fill 
       // out the vector
-      if (m_totalBitSize > ((sizeof (uint32_t)*8) * i))
+      if (m_bits->totalBitSize > ((sizeof (uint32_t)*8) * i))
         {
           PrintDec2BinNixFill (*rIter,numBits,os);
         }
-      else if (m_totalBitSize%32 == 0)
+      else if (m_bits->totalBitSize%32 == 0)
         {
           PrintDec2BinNix (*rIter,32,os);
         }
       else
         {
-          PrintDec2BinNix (*rIter,m_totalBitSize%32,os);
+          PrintDec2BinNix (*rIter,m_bits->totalBitSize%32,os);
         }
 
       i--;
@@ -358,7 +368,7 @@ NixVector::GetRemainingBits (void)
 {
   NS_LOG_FUNCTION (this);
 
-  return (m_totalBitSize - m_used);
+  return (m_bits->totalBitSize - m_used);
 }
 
 uint32_t
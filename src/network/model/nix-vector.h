@@ -24,6 +24,7 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 #include "ns3/buffer.h"
+#include "packet-pool.h"
 
 namespace ns3 {
 
@@ -58,6 +59,15 @@ namespace ns3 {
  * to use.  The number of bits used would then be 
  * incremented accordingly, and the packet would be 
  * routed.
+ *
+ * The bits of a nix-vector do not change once it is built, so the
+ * copies of a nix-vector share them: Copy only allocates the small
+ * object which holds the number of used bits, and AddNeighborIndex and
+ * Deserialize copy the bits first if they are shared.  The packets go
+ * one step further and share the NixVector itself when they are copied;
+ * Packet::GetNixVector makes it private to the packet before returning
+ * it, so that ExtractNeighborIndex does not move the copies of the
+ * packet along the route.
  */
 
 class NixVector : public SimpleRefCount<NixVector>
@@ -66,7 +76,27 @@ public:
   NixVector ();
   ~NixVector ();
   /**
-   * \return a copy of this nix-vector
+   * Allocate a nix-vector from the PacketPool of the calling thread.
+   *
+   * \param [in] size The size of the nix-vector.
+   * \returns The nix-vector memory.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return PacketPool::Allocate (size);
+  }
+  /**
+   * Release a nix-vector to the PacketPool of the calling thread.
+   *
+   * \param [in] p The nix-vector memory.
+   * \param [in] size The size of the nix-vector.
+   */
+  static void operator delete (void *p, std::size_t size)
+  {
+    PacketPool::Deallocate (p, size);
+  }
+  /**
+   * \return a copy of this nix-vector, which shares its bits
    */
   Ptr<NixVector> Copy (void) const;
   /**
@@ -172,22 +202,35 @@ private:
    */
   friend std::ostream & operator << ( std::ostream &os, const NixVector &nix);
 
-  NixBits_t m_nixVector; //!< the actual nix-vector
-  uint32_t m_used; //!< For tracking where we are in the nix-vector
-
   /**
-   * For tracking how many bits we
-   * have used in the current vector
-   * entry. need this in order to
-   * expand the vector passed 32bits
+   * The bits of a nix-vector, shared by its copies.
    */
-  uint32_t m_currentVectorBitSize;
+  struct Bits : public SimpleRefCount<Bits>
+  {
+    NixBits_t nixVector; //!< the actual nix-vector
+
+    /**
+     * For tracking how many bits we
+     * have used in the current vector
+     * entry. need this in order to
+     * expand the vector passed 32bits
+     */
+    uint32_t currentVectorBitSize;
+
+    /**
+     * A counter of how total bits are in
+     * the nix-vector
+     */
+    uint32_t totalBitSize;
+  };
 
   /**
-   * A counter of how total bits are in
-   * the nix-vector
+   * Copy the bits before changing them if other nix-vectors share them.
    */
-  uint32_t m_totalBitSize;
+  void UnshareBits (void);
+
+  Ptr<Bits> m_bits; //!< the bits, shared with the copies of this nix-vector
+  uint32_t m_used; //!< For tracking where we are in the nix-vector
 
   /**
    * Internal for pretty printing of nix-vector (fill)
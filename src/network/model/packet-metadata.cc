@@ -26,17 +26,39 @@
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
+/**
+ * \relates PacketMetadata
+ * \anchor GlobalValueCompactPacketMetadata
+ * Record only the outermost headers and trailers of the packets.
+ */
+static GlobalValue g_compactPacketMetadata = GlobalValue ("CompactPacketMetadata",
+                                                          "Record only the TypeId and the size of the outermost headers and trailers "
+                                                          "of the packets when the packet metadata is enabled, for example by the ASCII traces.",
+                                                          BooleanValue (false),
+                                                          MakeBooleanChecker ());
+
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_compact = false;
 bool PacketMetadata::m_metadataSkipped = false;
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#else
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#endif
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -59,9 +81,29 @@ PacketMetadata::Enable (void)
                  "after sending any packets.  One way to fix this problem is "
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
+  if (!m_enable)
+    {
+      BooleanValue compact;
+      g_compactPacketMetadata.GetValue (compact);
+      m_compact = compact.Get ();
+    }
   m_enable = true;
 }
 
+void
+PacketMetadata::EnableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (!m_enable || m_compact,
+                 "Error: attempting to switch the packet metadata to the "
+                 "compact format after enabling the full format, which is not "
+                 "allowed.\nThe packets already created would be read in the "
+                 "wrong format.  Call ns3::PacketMetadata::EnableCompact () "
+                 "instead of, not after, ns3::PacketMetadata::Enable ().");
+  Enable ();
+  m_compact = true;
+}
+
 void 
 PacketMetadata::EnableChecking (void)
 {
@@ -75,12 +117,14 @@ PacketMetadata::ReserveCopy (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
-  memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
     {
-      PacketMetadata::Recycle (m_data);
+      memcpy (newData->m_data, m_data->m_data, m_used);
+      if (--m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
     }
   m_data = newData;
   if (m_head != 0xffff)
@@ -99,11 +143,19 @@ void
 PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
+#ifdef NS3_MTP
+  // never write in place in shared data: its other owners may run in
+  // other threads of MultithreadedSimulatorImpl.
+  if (m_data != 0 &&
+      m_data->m_size >= m_used + size &&
+      m_data->m_count == 1)
+#else
+  if (m_data != 0 &&
+      m_data->m_size >= m_used + size &&
       (m_head == 0xffff ||
        m_data->m_count == 1 ||
        m_data->m_dirtyEnd == m_used))
+#endif
     {
       /* enough room, not dirty. */
     }
@@ -133,6 +185,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff && m_used == 0;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -374,15 +430,21 @@ uint16_t
 PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
 {
   NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
   NS_ASSERT (m_used != item->prev && m_used != item->next);
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
+#ifdef NS3_MTP
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
+      m_data->m_count != 1)
+#else
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
+#endif
     {
       ReserveCopy (n);
     }
@@ -407,7 +469,6 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   NS_LOG_FUNCTION (this << next << prev <<
                    item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
                    extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
   uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   NS_ASSERT (m_used != prev && m_used != next);
 
@@ -417,10 +478,17 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-  if (m_used + n > m_data->m_size ||
+#ifdef NS3_MTP
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
+      m_data->m_count != 1)
+#else
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
+#endif
     {
       ReserveCopy (n);
     }
@@ -650,24 +718,20 @@ PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
   return fragment;
 }
 
-void 
-PacketMetadata::AddHeader (const Header &header, uint32_t size)
-{
-  NS_LOG_FUNCTION (this << &header << size);
-  NS_ASSERT (IsStateOk ());
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
-  DoAddHeader (uid, size);
-  NS_ASSERT (IsStateOk ());
-}
 void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (m_compact)
     {
-      m_metadataSkipped = true;
+      // the payload is what lies between the headers and the trailers
+      if (uid != 0)
+        {
+          CompactAdd (uid >> 1, size, true);
+        }
       return;
     }
+  NS_ASSERT (IsStateOk ());
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -678,16 +742,37 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   m_chunkUid++;
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
+  NS_ASSERT (IsStateOk ());
 }
 void 
-PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
+PacketMetadata::DoRemoveHeader (uint32_t uid, uint32_t size)
 {
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
-  NS_LOG_FUNCTION (this << &header << size);
+  NS_LOG_FUNCTION (this << uid << size);
+  if (m_compact)
+    {
+      if (m_data != 0 && m_head > 0)
+        {
+          const struct CompactItem *item = &GetCompactItems ()[m_head - 1];
+          if (item->typeUid == (uid >> 1) && item->size == size)
+            {
+              m_head--;
+              return;
+            }
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+        }
+      CompactRemoveAtStart (size);
+      return;
+    }
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_head == 0xffff)
     {
-      m_metadataSkipped = true;
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ("Removing unexpected header.");
+        }
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -728,16 +813,15 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   NS_ASSERT (IsStateOk ());
 }
 void 
-PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
+PacketMetadata::DoAddTrailer (uint32_t uid, uint32_t size)
 {
-  uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
-  NS_LOG_FUNCTION (this << &trailer << size);
-  NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  NS_LOG_FUNCTION (this << uid << size);
+  if (m_compact)
     {
-      m_metadataSkipped = true;
+      CompactAdd (uid >> 1, size, false);
       return;
     }
+  NS_ASSERT (IsStateOk ());
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -750,14 +834,34 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
 }
 void 
-PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
+PacketMetadata::DoRemoveTrailer (uint32_t uid, uint32_t size)
 {
-  uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
-  NS_LOG_FUNCTION (this << &trailer << size);
+  NS_LOG_FUNCTION (this << uid << size);
+  if (m_compact)
+    {
+      if (m_data != 0 && m_tail > 0)
+        {
+          const struct CompactItem *item = &GetCompactItems ()[PACKET_METADATA_COMPACT_ITEMS - m_tail];
+          if (item->typeUid == (uid >> 1) && item->size == size)
+            {
+              m_tail--;
+              return;
+            }
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+        }
+      CompactRemoveAtEnd (size);
+      return;
+    }
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_tail == 0xffff)
     {
-      m_metadataSkipped = true;
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ("Removing unexpected trailer.");
+        }
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -798,15 +902,15 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
 }
 void
-PacketMetadata::AddAtEnd (PacketMetadata const&o)
+PacketMetadata::DoAddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
-  NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_compact)
     {
-      m_metadataSkipped = true;
+      CompactAddAtEnd (o);
       return;
     }
+  NS_ASSERT (IsStateOk ());
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -876,26 +980,35 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
   NS_ASSERT (IsStateOk ());
 }
 void
-PacketMetadata::AddPaddingAtEnd (uint32_t end)
+PacketMetadata::DoAddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  if (!m_compact || end == 0 || m_data == 0 || m_tail == 0)
     {
-      m_metadataSkipped = true;
+      // without trailers, the padding is part of the payload
       return;
     }
+  struct CompactItem *item = &GetCompactItems ()[PACKET_METADATA_COMPACT_ITEMS - m_tail];
+  if (item->typeUid == 0)
+    {
+      CompactUnshare ();
+      GetCompactItems ()[PACKET_METADATA_COMPACT_ITEMS - m_tail].size += end;
+    }
+  else
+    {
+      CompactAdd (0, end, false);
+    }
 }
 void 
-PacketMetadata::RemoveAtStart (uint32_t start)
+PacketMetadata::DoRemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
-  NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_compact)
     {
-      m_metadataSkipped = true;
+      CompactRemoveAtStart (start);
       return;
     }
-  NS_ASSERT (m_data != 0);
+  NS_ASSERT (IsStateOk ());
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
@@ -949,16 +1062,15 @@ PacketMetadata::RemoveAtStart (uint32_t start)
   NS_ASSERT (IsStateOk ());
 }
 void 
-PacketMetadata::RemoveAtEnd (uint32_t end)
+PacketMetadata::DoRemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_compact)
     {
-      m_metadataSkipped = true;
+      CompactRemoveAtEnd (end);
       return;
     }
-  NS_ASSERT (m_data != 0);
+  NS_ASSERT (IsStateOk ());
 
   uint32_t leftToRemove = end;
   uint16_t current = m_tail;
@@ -1013,6 +1125,254 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
 }
+
+void
+PacketMetadata::CompactUnshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = PACKET_METADATA_COMPACT_ITEMS * sizeof (struct CompactItem);
+  if (m_data == 0)
+    {
+      m_data = PacketMetadata::Create (size);
+      m_head = 0;
+      m_tail = 0;
+    }
+  else if (m_data->m_count != 1)
+    {
+      struct PacketMetadata::Data *newData = PacketMetadata::Create (size);
+      memcpy (newData->m_data, m_data->m_data, size);
+      if (--m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+      m_data = newData;
+    }
+}
+
+void
+PacketMetadata::CompactAdd (uint16_t uid, uint32_t size, bool isHeader)
+{
+  NS_LOG_FUNCTION (this << uid << size << isHeader);
+  const uint16_t n = PACKET_METADATA_COMPACT_ITEMS;
+  CompactUnshare ();
+  struct CompactItem *items = GetCompactItems ();
+  if (m_head + m_tail == n)
+    {
+      // The array is full: the innermost item becomes part of the payload.
+      if (m_tail == 0 || (isHeader && m_head > 0))
+        {
+          memmove (&items[0], &items[1], (m_head - 1) * sizeof (struct CompactItem));
+          m_head--;
+        }
+      else
+        {
+          memmove (&items[n - m_tail + 1], &items[n - m_tail], (m_tail - 1) * sizeof (struct CompactItem));
+          m_tail--;
+        }
+    }
+  if (isHeader)
+    {
+      items[m_head].size = size;
+      items[m_head].typeUid = uid;
+      m_head++;
+    }
+  else
+    {
+      m_tail++;
+      items[n - m_tail].size = size;
+      items[n - m_tail].typeUid = uid;
+    }
+}
+
+void
+PacketMetadata::CompactRemoveAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
+  if (m_data == 0)
+    {
+      return;
+    }
+  while (start > 0 && m_head > 0)
+    {
+      uint32_t size = GetCompactItems ()[m_head - 1].size;
+      if (size <= start)
+        {
+          start -= size;
+          m_head--;
+        }
+      else
+        {
+          // the rest of the header is shown as payload
+          CompactUnshare ();
+          struct CompactItem *item = &GetCompactItems ()[m_head - 1];
+          item->size = size - start;
+          item->typeUid = 0;
+          start = 0;
+        }
+    }
+  // The other bytes are removed from the payload, and from the innermost
+  // trailers if the payload is shorter: see GetCompactItem.
+}
+
+void
+PacketMetadata::CompactRemoveAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  if (m_data == 0)
+    {
+      return;
+    }
+  while (end > 0 && m_tail > 0)
+    {
+      uint32_t size = GetCompactItems ()[PACKET_METADATA_COMPACT_ITEMS - m_tail].size;
+      if (size <= end)
+        {
+          end -= size;
+          m_tail--;
+        }
+      else
+        {
+          // the rest of the trailer is shown as payload
+          CompactUnshare ();
+          struct CompactItem *item = &GetCompactItems ()[PACKET_METADATA_COMPACT_ITEMS - m_tail];
+          item->size = size - end;
+          item->typeUid = 0;
+          end = 0;
+        }
+    }
+}
+
+void
+PacketMetadata::CompactAddAtEnd (PacketMetadata const&o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  const uint16_t n = PACKET_METADATA_COMPACT_ITEMS;
+  // Our trailers and the headers of o become payload: only our headers
+  // and the trailers of o keep their place from the ends of the packet.
+  struct CompactItem trailers[PACKET_METADATA_COMPACT_ITEMS];
+  uint16_t nTrailers = 0;
+  if (o.m_data != 0 && o.m_tail > 0)
+    {
+      nTrailers = o.m_tail;
+      memcpy (trailers, &o.GetCompactItems ()[n - nTrailers], nTrailers * sizeof (struct CompactItem));
+    }
+  if (m_data != 0)
+    {
+      m_tail = 0;
+    }
+  if (nTrailers == 0)
+    {
+      return;
+    }
+  CompactUnshare ();
+  // keep the outermost trailers of o which fit
+  nTrailers = std::min<uint16_t> (nTrailers, n - m_head);
+  memcpy (&GetCompactItems ()[n - nTrailers], trailers, nTrailers * sizeof (struct CompactItem));
+  m_tail = nTrailers;
+}
+
+uint16_t
+PacketMetadata::GetCompactItemCount (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return 1;
+    }
+  return m_head + 1 + m_tail;
+}
+
+bool
+PacketMetadata::GetCompactItem (uint16_t index, uint32_t total,
+                                struct PacketMetadata::Item *item) const
+{
+  NS_LOG_FUNCTION (this << index << total << item);
+  const uint16_t n = PACKET_METADATA_COMPACT_ITEMS;
+  uint16_t nHeaders = 0;
+  uint16_t nTrailers = 0;
+  const struct CompactItem *items = 0;
+  if (m_data != 0)
+    {
+      nHeaders = m_head;
+      nTrailers = m_tail;
+      items = GetCompactItems ();
+    }
+  uint32_t headers = 0;
+  for (uint16_t i = 0; i < nHeaders; i++)
+    {
+      headers += items[i].size;
+    }
+  uint32_t trailers = 0;
+  for (uint16_t i = n - nTrailers; i < n; i++)
+    {
+      trailers += items[i].size;
+    }
+  // The bytes removed beyond the payload were taken from the innermost
+  // trailers, and then from the innermost headers.
+  uint32_t excess = 0;
+  if (headers + trailers > total)
+    {
+      excess = headers + trailers - total;
+    }
+  uint32_t trailerExcess = std::min (excess, trailers);
+  uint32_t headerExcess = excess - trailerExcess;
+
+  item->isFragment = false;
+  item->currentTrimedFromStart = 0;
+  item->currentTrimedFromEnd = 0;
+  uint32_t size;
+  uint32_t inner = 0;
+  const struct CompactItem *compactItem;
+  if (index == nHeaders)
+    {
+      item->type = PacketMetadata::Item::PAYLOAD;
+      item->tid.SetUid (0);
+      item->currentSize = total + excess - headers - trailers;
+      return item->currentSize > 0;
+    }
+  else if (index < nHeaders)
+    {
+      // the headers from the outermost, which is the last added
+      uint16_t i = nHeaders - 1 - index;
+      for (uint16_t j = 0; j < i; j++)
+        {
+          inner += items[j].size;
+        }
+      compactItem = &items[i];
+      size = compactItem->size;
+      if (headerExcess > inner)
+        {
+          item->currentTrimedFromEnd = std::min (headerExcess - inner, size);
+        }
+      item->type = PacketMetadata::Item::HEADER;
+    }
+  else
+    {
+      // the trailers from the innermost, which is the first added
+      uint16_t i = n - 1 - (index - nHeaders - 1);
+      for (uint16_t j = i + 1; j < n; j++)
+        {
+          inner += items[j].size;
+        }
+      compactItem = &items[i];
+      size = compactItem->size;
+      if (trailerExcess > inner)
+        {
+          item->currentTrimedFromStart = std::min (trailerExcess - inner, size);
+        }
+      item->type = PacketMetadata::Item::TRAILER;
+    }
+  if (compactItem->typeUid == 0)
+    {
+      item->type = PacketMetadata::Item::PAYLOAD;
+    }
+  item->tid.SetUid (compactItem->typeUid);
+  uint32_t trimmed = item->currentTrimedFromStart + item->currentTrimedFromEnd;
+  item->currentSize = size - trimmed;
+  item->isFragment = trimmed != 0;
+  return size == 0 || item->currentSize > 0;
+}
+
 uint32_t
 PacketMetadata::GetTotalSize (void) const
 {
@@ -1056,11 +1416,31 @@ PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buff
     m_hasReadTail (false)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
+  if (m_compact)
+    {
+      m_current = 0;
+      SkipEmptyCompactItems ();
+    }
+}
+void
+PacketMetadata::ItemIterator::SkipEmptyCompactItems (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct PacketMetadata::Item item;
+  while (m_current < m_metadata->GetCompactItemCount () &&
+         !m_metadata->GetCompactItem (m_current, m_buffer.GetSize (), &item))
+    {
+      m_current++;
+    }
 }
 bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_compact)
+    {
+      return m_current < m_metadata->GetCompactItemCount ();
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1076,6 +1456,24 @@ PacketMetadata::ItemIterator::Next (void)
 {
   NS_LOG_FUNCTION (this);
   struct PacketMetadata::Item item;
+  if (m_compact)
+    {
+      m_metadata->GetCompactItem (m_current, m_buffer.GetSize (), &item);
+      if (item.type == PacketMetadata::Item::HEADER && !item.isFragment)
+        {
+          item.current = m_buffer.Begin ();
+          item.current.Next (m_offset);
+        }
+      else if (item.type == PacketMetadata::Item::TRAILER && !item.isFragment)
+        {
+          item.current = m_buffer.End ();
+          item.current.Prev (m_buffer.GetSize () - (m_offset + item.currentSize));
+        }
+      m_offset += item.currentSize;
+      m_current++;
+      SkipEmptyCompactItems ();
+      return item;
+    }
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
   m_metadata->ReadItems (m_current, &smallItem, &extraItem);
@@ -1146,6 +1544,32 @@ PacketMetadata::GetSerializedSize (void) const
       return totalSize;
     }
 
+  if (m_compact)
+    {
+      // the numbers of headers and of trailers, then their items
+      totalSize += 2;
+      if (m_data == 0)
+        {
+          return totalSize;
+        }
+      const struct CompactItem *items = GetCompactItems ();
+      for (uint16_t i = 0; i < PACKET_METADATA_COMPACT_ITEMS; i++)
+        {
+          if (i >= m_head && i < PACKET_METADATA_COMPACT_ITEMS - m_tail)
+            {
+              continue;
+            }
+          totalSize += 4 + 4;
+          if (items[i].typeUid != 0)
+            {
+              TypeId tid;
+              tid.SetUid (items[i].typeUid);
+              totalSize += tid.GetName ().size ();
+            }
+        }
+      return totalSize;
+    }
+
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t current = m_head;
@@ -1186,6 +1610,56 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
       return 0;
     }
 
+  if (m_compact)
+    {
+      uint8_t nHeaders = m_data != 0 ? m_head : 0;
+      uint8_t nTrailers = m_data != 0 ? m_tail : 0;
+      buffer = AddToRawU8 (nHeaders, start, buffer, maxSize);
+      if (buffer == 0) 
+        {
+          return 0;
+        }
+      buffer = AddToRawU8 (nTrailers, start, buffer, maxSize);
+      if (buffer == 0) 
+        {
+          return 0;
+        }
+      for (uint16_t i = 0; i < PACKET_METADATA_COMPACT_ITEMS; i++)
+        {
+          if (i >= nHeaders && i < PACKET_METADATA_COMPACT_ITEMS - nTrailers)
+            {
+              continue;
+            }
+          const struct CompactItem *item = &GetCompactItems ()[i];
+          std::string uidString;
+          if (item->typeUid != 0)
+            {
+              TypeId tid;
+              tid.SetUid (item->typeUid);
+              uidString = tid.GetName ();
+            }
+          uint32_t uidStringSize = uidString.size ();
+          buffer = AddToRawU32 (uidStringSize, start, buffer, maxSize);
+          if (buffer == 0) 
+            {
+              return 0;
+            }
+          buffer = AddToRaw (reinterpret_cast<const uint8_t *> (uidString.c_str ()), 
+                             uidStringSize, start, buffer, maxSize);
+          if (buffer == 0) 
+            {
+              return 0;
+            }
+          buffer = AddToRawU32 (item->size, start, buffer, maxSize);
+          if (buffer == 0) 
+            {
+              return 0;
+            }
+        }
+      NS_ASSERT (static_cast<uint32_t> (buffer - start) == maxSize);
+      return 1;
+    }
+
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t current = m_head;
@@ -1285,6 +1759,50 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
 
+  if (m_compact)
+    {
+      uint8_t nHeaders = 0;
+      uint8_t nTrailers = 0;
+      buffer = ReadFromRawU8 (nHeaders, start, buffer, size);
+      buffer = ReadFromRawU8 (nTrailers, start, buffer, size);
+      desSize -= 2;
+      if (nHeaders + nTrailers > PACKET_METADATA_COMPACT_ITEMS)
+        {
+          return 0;
+        }
+      CompactUnshare ();
+      m_head = nHeaders;
+      m_tail = nTrailers;
+      for (uint16_t i = 0; i < PACKET_METADATA_COMPACT_ITEMS; i++)
+        {
+          if (i >= nHeaders && i < PACKET_METADATA_COMPACT_ITEMS - nTrailers)
+            {
+              continue;
+            }
+          struct CompactItem *item = &GetCompactItems ()[i];
+          uint32_t uidStringSize = 0;
+          buffer = ReadFromRawU32 (uidStringSize, start, buffer, size);
+          desSize -= 4;
+          item->typeUid = 0;
+          if (uidStringSize != 0)
+            {
+              std::string uidString;
+              for (uint32_t j = 0; j < uidStringSize; j++)
+                {
+                  uint8_t ch = 0;
+                  buffer = ReadFromRawU8 (ch, start, buffer, size);
+                  uidString.push_back (ch);
+                  desSize--;
+                }
+              item->typeUid = TypeId::LookupByName (uidString).GetUid ();
+            }
+          buffer = ReadFromRawU32 (item->size, start, buffer, size);
+          desSize -= 4;
+        }
+      NS_ASSERT (desSize == 0);
+      return (desSize !=0) ? 0 : 1;
+    }
+
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
   while (desSize > 0)
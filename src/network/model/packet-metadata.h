@@ -23,17 +23,20 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "header.h"
+#include "trailer.h"
 
 namespace ns3 {
 
 class Chunk;
 class Buffer;
-class Header;
-class Trailer;
 
 /**
  * \ingroup packet
@@ -74,6 +77,19 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * The compact mode, selected with EnableCompact or with the
+ * "CompactPacketMetadata" GlobalValue, records instead only the TypeId
+ * and the size of the outermost headers and trailers, in a fixed array
+ * of PACKET_METADATA_COMPACT_ITEMS items stored in struct
+ * PacketMetadata::Data. The headers and trailers grow from the two ends
+ * of the array and the payload is whatever the buffer holds between them,
+ * so that adding or removing a header never decodes the list. Fragments,
+ * concatenated packets and the headers which do not fit in the array are
+ * shown as payload, which is enough for Packet::Print and the ASCII traces.
+ *
+ * When the metadata is disabled, a PacketMetadata holds no data and each
+ * operation returns after an inlined test of a static flag.
  */
 class PacketMetadata 
 {
@@ -145,6 +161,11 @@ public:
      */
     Item Next (void);
 private:
+    /**
+     * \brief Skip the empty items of the compact metadata
+     */
+    void SkipEmptyCompactItems (void);
+
     const PacketMetadata *m_metadata; //!< pointer to the metadata
     Buffer m_buffer; //!< buffer the metadata refers to
     uint16_t m_current; //!< current position
@@ -154,8 +175,19 @@ private:
 
   /**
    * \brief Enable the packet metadata
+   *
+   * The first call selects the compact mode if the "CompactPacketMetadata"
+   * GlobalValue is true, and the full metadata otherwise.
    */
   static void Enable (void);
+  /**
+   * \brief Enable the compact packet metadata, which records only the
+   * TypeId and the size of the outermost headers and trailers.
+   *
+   * It must be called before any packet is sent, and not after Enable()
+   * selected the full metadata.
+   */
+  static void EnableCompact (void);
   /**
    * \brief Enable the packet metadata checking
    */
@@ -185,26 +217,26 @@ private:
    * \param header header to add
    * \param size header serialized size
    */
-  void AddHeader (Header const &header, uint32_t size);
+  inline void AddHeader (Header const &header, uint32_t size);
   /**
    * \brief Remove an header
    * \param header header to remove
    * \param size header serialized size
    */
-  void RemoveHeader (Header const &header, uint32_t size);
+  inline void RemoveHeader (Header const &header, uint32_t size);
 
   /**
    * Add a trailer
    * \param trailer trailer to add
    * \param size trailer serialized size
    */
-  void AddTrailer (Trailer const &trailer, uint32_t size);
+  inline void AddTrailer (Trailer const &trailer, uint32_t size);
   /**
    * Remove a trailer
    * \param trailer trailer to remove
    * \param size trailer serialized size
    */
-  void RemoveTrailer (Trailer const &trailer, uint32_t size);
+  inline void RemoveTrailer (Trailer const &trailer, uint32_t size);
 
   /**
    * \brief Creates a fragment.
@@ -222,22 +254,22 @@ private:
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
    */
-  void AddAtEnd (PacketMetadata const&o);
+  inline void AddAtEnd (PacketMetadata const&o);
   /**
    * \brief Add some padding at the end
    * \param end size of padding
    */
-  void AddPaddingAtEnd (uint32_t end);
+  inline void AddPaddingAtEnd (uint32_t end);
   /**
    * \brief Remove a chunk of metadata at the metadata start
    * \param start the size of metadata to remove
    */
-  void RemoveAtStart (uint32_t start);
+  inline void RemoveAtStart (uint32_t start);
   /**
    * \brief Remove a chunk of metadata at the metadata end
    * \param end the size of metadata to remove
    */
-  void RemoveAtEnd (uint32_t end);
+  inline void RemoveAtEnd (uint32_t end);
 
   /**
    * \brief Get the packet Uid
@@ -413,7 +445,11 @@ private:
    */
   struct Data {
     /** number of references to this struct Data instance. */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /** size (in bytes) of m_data buffer below */
     uint16_t m_size;
     /** max of the m_used field over all objects which
@@ -494,6 +530,23 @@ private:
     uint64_t packetUid;
   };
 
+  /**
+   * the number of items of the compact metadata
+   */
+#define PACKET_METADATA_COMPACT_ITEMS 8
+
+  /**
+   * \brief Item of the compact metadata, stored in the m_data buffer
+   * of struct PacketMetadata::Data
+   */
+  struct CompactItem {
+    /** the size (in bytes) of the header or trailer */
+    uint32_t size;
+    /** the uid of the TypeId of the header or trailer, or zero for
+       bytes shown as payload */
+    uint16_t typeUid;
+  };
+
   /**
    * \brief Class to hold all the metadata
    */
@@ -620,6 +673,97 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Remove an header
+   * \param uid header's uid to remove
+   * \param size header serialized size
+   */
+  void DoRemoveHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add a trailer
+   * \param uid trailer's uid to add
+   * \param size trailer serialized size
+   */
+  void DoAddTrailer (uint32_t uid, uint32_t size);
+  /**
+   * \brief Remove a trailer
+   * \param uid trailer's uid to remove
+   * \param size trailer serialized size
+   */
+  void DoRemoveTrailer (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add a metadata at the metadata end
+   * \param o the metadata to add
+   */
+  void DoAddAtEnd (PacketMetadata const&o);
+  /**
+   * \brief Add some padding at the end
+   * \param end size of padding
+   */
+  void DoAddPaddingAtEnd (uint32_t end);
+  /**
+   * \brief Remove a chunk of metadata at the metadata start
+   * \param start the size of metadata to remove
+   */
+  void DoRemoveAtStart (uint32_t start);
+  /**
+   * \brief Remove a chunk of metadata at the metadata end
+   * \param end the size of metadata to remove
+   */
+  void DoRemoveAtEnd (uint32_t end);
+  /**
+   * \brief Record that an operation was skipped because the metadata
+   * is disabled
+   */
+  inline static void NotifySkipped (void);
+
+  /**
+   * \brief Get the items of the compact metadata
+   * \returns the items, stored in m_data
+   */
+  inline struct CompactItem *GetCompactItems (void) const;
+  /**
+   * \brief Get the number of items of the compact metadata, including
+   * the payload
+   * \returns the number of items
+   */
+  uint16_t GetCompactItemCount (void) const;
+  /**
+   * \brief Get an item of the compact metadata
+   * \param index the index of the item: the headers from the outermost,
+   *        the payload, then the trailers from the innermost
+   * \param total the size of the packet buffer
+   * \param item the item to fill
+   * \returns false if the item is empty
+   */
+  bool GetCompactItem (uint16_t index, uint32_t total,
+                       struct PacketMetadata::Item *item) const;
+  /**
+   * \brief Allocate the compact metadata, or copy it if it is shared
+   */
+  void CompactUnshare (void);
+  /**
+   * \brief Add an header or a trailer to the compact metadata
+   * \param uid the uid of the TypeId, zero for payload
+   * \param size the serialized size
+   * \param isHeader true for an header, false for a trailer
+   */
+  void CompactAdd (uint16_t uid, uint32_t size, bool isHeader);
+  /**
+   * \brief Remove bytes at the start of the compact metadata
+   * \param start the number of bytes to remove
+   */
+  void CompactRemoveAtStart (uint32_t start);
+  /**
+   * \brief Remove bytes at the end of the compact metadata
+   * \param end the number of bytes to remove
+   */
+  void CompactRemoveAtEnd (uint32_t end);
+  /**
+   * \brief Append a compact metadata
+   * \param o the metadata to append
+   */
+  void CompactAddAtEnd (PacketMetadata const&o);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -661,9 +805,14 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage
+#else
   static DataFreeList m_freeList; //!< the metadata data storage
+#endif
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_compact; //!< Enable the compact packet metadata
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -672,8 +821,13 @@ public:
    */
   static bool m_metadataSkipped;
 
+#if defined (NS3_MTP) || defined (NS3_ENSEMBLE)
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
+#else
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
+#endif
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -681,8 +835,8 @@ public:
        ^             |
         \---(prev)---|
    */
-  uint16_t m_head; //!< list head
-  uint16_t m_tail; //!< list tail
+  uint16_t m_head; //!< list head, or number of headers of the compact metadata
+  uint16_t m_tail; //!< list tail, or number of trailers of the compact metadata
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
 };
@@ -692,15 +846,19 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
+      if (!m_enable)
+        {
+          NotifySkipped ();
+          return;
+        }
       DoAddHeader (0, size);
     }
 }
@@ -711,9 +869,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -721,15 +881,15 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0 && --m_data->m_count == 0) 
         {
           PacketMetadata::Recycle (m_data);
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -739,14 +899,108 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0 && --m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
 }
 
+void
+PacketMetadata::NotifySkipped (void)
+{
+  // test first, to not write to a cache line shared by all the threads
+  if (!m_metadataSkipped)
+    {
+      m_metadataSkipped = true;
+    }
+}
+void
+PacketMetadata::AddHeader (Header const &header, uint32_t size)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoAddHeader (header.GetInstanceTypeId ().GetUid () << 1, size);
+}
+void
+PacketMetadata::RemoveHeader (Header const &header, uint32_t size)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoRemoveHeader (header.GetInstanceTypeId ().GetUid () << 1, size);
+}
+void
+PacketMetadata::AddTrailer (Trailer const &trailer, uint32_t size)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoAddTrailer (trailer.GetInstanceTypeId ().GetUid () << 1, size);
+}
+void
+PacketMetadata::RemoveTrailer (Trailer const &trailer, uint32_t size)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoRemoveTrailer (trailer.GetInstanceTypeId ().GetUid () << 1, size);
+}
+void
+PacketMetadata::AddAtEnd (PacketMetadata const&o)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoAddAtEnd (o);
+}
+void
+PacketMetadata::AddPaddingAtEnd (uint32_t end)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoAddPaddingAtEnd (end);
+}
+void
+PacketMetadata::RemoveAtStart (uint32_t start)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoRemoveAtStart (start);
+}
+void
+PacketMetadata::RemoveAtEnd (uint32_t end)
+{
+  if (!m_enable)
+    {
+      NotifySkipped ();
+      return;
+    }
+  DoRemoveAtEnd (end);
+}
+
+struct PacketMetadata::CompactItem *
+PacketMetadata::GetCompactItems (void) const
+{
+  return reinterpret_cast<struct CompactItem *> (m_data->m_data);
+}
+
 } // namespace ns3
 
 
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-pool.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketPool implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \relates PacketPool
+ * \anchor GlobalValuePacketPool
+ * Recycle the memory of the packets through per-thread free lists.
+ */
+static GlobalValue g_packetPool = GlobalValue ("PacketPool",
+                                               "Recycle the memory of the packets and of their tags through per-thread free lists.  "
+                                               "Disable to debug with AddressSanitizer or valgrind.",
+                                               BooleanValue (true),
+                                               MakeBooleanChecker ());
+
+namespace {
+
+/**
+ * \ingroup packet
+ * Configuration of the free lists of the packets.
+ */
+struct PacketPoolTraits
+{
+  /** Number of size classes; larger blocks are not pooled. */
+  static const std::size_t CLASSES = 32;
+  /** Maximum number of free blocks kept in each size class. */
+  static const uint32_t MAX_CACHED = 4096;
+  /** \returns The value of the PacketPool GlobalValue. */
+  static bool IsEnabled (void)
+  {
+    BooleanValue value;
+    g_packetPool.GetValue (value);
+    return value.Get ();
+  }
+};
+
+/** The free lists of the packets. */
+typedef SizeClassAllocator<PacketPoolTraits> ThreadPacketPool;
+
+}  // unnamed namespace
+
+void *
+PacketPool::Allocate (std::size_t size)
+{
+  return ThreadPacketPool::Allocate (size);
+}
+
+void
+PacketPool::Deallocate (void *p, std::size_t size)
+{
+  ThreadPacketPool::Deallocate (p, size);
+}
+
+std::size_t
+PacketPool::GetBlockSize (std::size_t size)
+{
+  return ThreadPacketPool::GetBlockSize (size);
+}
+
+PacketPool::Stats
+PacketPool::GetStats (void)
+{
+  return ThreadPacketPool::GetStats ();
+}
+
+void
+PacketPool::ResetStats (void)
+{
+  ThreadPacketPool::ResetStats ();
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+#include "ns3/size-class-allocator.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Per-thread free lists for the Packet objects and the arrays of
+ * their tag lists.
+ *
+ * Every hop creates or copies Packet objects, and the PacketTagList and
+ * ByteTagList of these packets allocate small arrays of their own.  The
+ * PacketPool recycles this memory through free lists, one for each size
+ * class of 16 bytes up to 512 bytes, in the same way as the free lists of
+ * the Buffer data, so that forwarding a packet does not usually reach
+ * malloc.  Larger blocks are not pooled.
+ *
+ * The free lists belong to the calling thread: a block released by
+ * another thread than the one which allocated it goes to the free list
+ * of the releasing thread.  They can be disabled, for example to let
+ * AddressSanitizer or valgrind check the packets, with the "PacketPool"
+ * GlobalValue or the NS_GLOBAL_VALUE environment variable:
+ * \code
+ *   NS_GLOBAL_VALUE="PacketPool=false" ./waf --run ...
+ * \endcode
+ */
+class PacketPool
+{
+public:
+  /** Statistics of the PacketPool free lists of a thread. */
+  typedef SizeClassAllocatorStats Stats;
+
+  /**
+   * Allocate a block, from the free list of its size class if possible.
+   *
+   * \param [in] size The size of the block.
+   * \returns The block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release a block to the free list of its size class.
+   *
+   * \param [in] p The block.
+   * \param [in] size The size of the block, as passed to Allocate.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the usable size of the blocks allocated for a given size, so
+   * that variable-size structures can grow in place up to it.
+   *
+   * \param [in] size The requested size.
+   * \returns The size of the block which Allocate returns for \pname{size}.
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+  /**
+   * \returns The allocation statistics of the calling thread.
+   */
+  static Stats GetStats (void);
+  /** Reset the allocation statistics of the calling thread. */
+  static void ResetStats (void);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
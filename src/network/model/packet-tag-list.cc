@@ -20,240 +20,160 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags stored in a shared array, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
 #include "tag-buffer.h"
 #include "tag.h"
+#include "packet-pool.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
+#include <cstddef>
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
-{
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
+/** The size of the first TagBlock of a list, when its tags leave the inline array. */
+static const uint32_t INITIAL_SIZE = 112;
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+const uint32_t PacketTagList::INLINE_SIZE;
 
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
+uint32_t
+PacketTagList::GetEntrySize (uint32_t size)
+{
+  const uint32_t align = alignof (struct TagData);
+  return (offsetof (struct TagData, data) + size + align - 1) & ~(align - 1);
 }
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+struct PacketTagList::TagBlock *
+PacketTagList::Allocate (uint32_t size)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+  NS_LOG_FUNCTION (size);
+  // use all the block of the PacketPool, to grow in place up to its size
+  std::size_t blockSize = PacketPool::GetBlockSize (size + sizeof (struct TagBlock) - 4);
+  struct TagBlock *data = static_cast<struct TagBlock *> (PacketPool::Allocate (blockSize));
+  data->count = 1;
+  data->size = blockSize - (sizeof (struct TagBlock) - 4);
+  data->dirty = 0;
+  return data;
+}
 
-  // trivial case when list is empty
-  if (m_next == 0)
+void
+PacketTagList::Deallocate (struct TagBlock *data)
+{
+  NS_LOG_FUNCTION (data);
+  if (data == 0)
     {
-      return false;
+      return;
     }
+  if (--data->count == 0)
+    {
+      PacketPool::Deallocate (data, data->size + sizeof (struct TagBlock) - 4);
+    }
+}
 
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+uint32_t
+PacketTagList::Find (TypeId tid) const
+{
+  const uint8_t *buffer = GetBuffer ();
+  uint32_t offset = 0;
+  while (offset < m_used)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
+      const struct TagData *cur = reinterpret_cast<const struct TagData *> (&buffer[offset]);
+      if (cur->tid == tid)
         {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
           break;
         }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
-
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
-    {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      offset += GetEntrySize (cur->size);
     }
+  return offset;
+}
 
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
+void
+PacketTagList::Unshare (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  struct TagBlock *newData = Allocate (size);
+  std::memcpy (newData->data, GetBuffer (), m_used);
+  newData->dirty = m_used;
+  Deallocate (m_data);
+  m_data = newData;
+}
 
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+void
+PacketTagList::RemoveEntry (uint32_t offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  const struct TagData *cur = reinterpret_cast<const struct TagData *> (&GetBuffer ()[offset]);
+  uint32_t entrySize = GetEntrySize (cur->size);
+  uint32_t tail = m_used - offset - entrySize;
+  if (tail > 0)
     {
-      if (it->tid == tid)
+      // the last tag is removed without writing to the block, even if
+      // it is shared; any other one is moved over in a block of our own.
+      if (m_data != 0 && m_data->count != 1)
         {
-          break;
+          Unshare (m_data->size);
         }
+      uint8_t *buffer = GetBuffer ();
+      std::memmove (&buffer[offset], &buffer[offset + entrySize], tail);
     }
-  if (it == 0)
+  m_used -= entrySize;
+  if (m_used == 0)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      RemoveAll ();
     }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+  else if (m_data != 0 && m_data->count == 1)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      m_data->dirty = m_used;
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
 }
 
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
-}
-
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
-    {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
-    }
-  else
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
+      return false;
     }
-  return found;
+  struct TagData *cur = reinterpret_cast<struct TagData *> (&GetBuffer ()[offset]);
+  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
+  RemoveEntry (offset);
+  return true;
 }
 
 bool
 PacketTagList::Replace (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
       Add (tag);
+      return false;
     }
-  return found;
-}
-
-// COWWriter implementing Replace
-bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
+  struct TagData *cur = reinterpret_cast<struct TagData *> (&GetBuffer ()[offset]);
+  if (cur->size != tag.GetSerializedSize ())
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+      RemoveEntry (offset);
+      Add (tag);
+      return true;
     }
-  else
+  if (m_data != 0 && m_data->count != 1)
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      Unshare (m_data->size);
+      cur = reinterpret_cast<struct TagData *> (&m_data->data[offset]);
     }
-  return found;
+  tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+  return true;
 }
 
 void 
@@ -261,44 +181,89 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_ASSERT_MSG (Find (tag.GetInstanceTypeId ()) == m_used,
+                 "Error: cannot add the same kind of tag twice.");
+  PacketTagList *list = const_cast<PacketTagList *> (this);
+  uint32_t size = tag.GetSerializedSize ();
+  uint32_t spaceNeeded = m_used + GetEntrySize (size);
+  if (m_data == 0)
     {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
+      // the few tags which a packet usually carries stay inline
+      if (spaceNeeded > INLINE_SIZE)
+        {
+          list->Unshare (std::max (spaceNeeded, INITIAL_SIZE));
+        }
+    }
+#ifdef NS3_MTP
+  // the data may be appended to by another thread: never write in place
+  // into shared data
+  else if (m_data->size < spaceNeeded || m_data->count != 1)
+#else
+  else if (m_data->size < spaceNeeded ||
+           (m_data->count != 1 && m_data->dirty != m_used))
+#endif
+    {
+      // grow geometrically, as the ByteTagList does
+      uint32_t newSize = spaceNeeded;
+      if (m_data->size < spaceNeeded)
+        {
+          newSize = std::max (spaceNeeded, 2 * m_data->size);
+        }
+      list->Unshare (newSize);
+    }
+  struct TagData *entry = reinterpret_cast<struct TagData *> (&GetBuffer ()[m_used]);
+  entry->tid = tag.GetInstanceTypeId ();
+  entry->size = size;
+  tag.Serialize (TagBuffer (entry->data, entry->data + size));
+  list->m_used = spaceNeeded;
+  if (m_data != 0)
+    {
+      m_data->dirty = spaceNeeded;
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  const struct TagData *cur = reinterpret_cast<const struct TagData *> (&GetBuffer ()[offset]);
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (cur->data),
+                              const_cast<uint8_t *> (cur->data) + cur->size));
+  return true;
 }
 
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  if (m_used == 0)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const struct TagData *> (GetBuffer ());
 }
 
-} /* namespace ns3 */
+const struct PacketTagList::TagData *
+PacketTagList::End (void) const
+{
+  if (m_used == 0)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const struct TagData *> (&GetBuffer ()[m_used]);
+}
 
+const struct PacketTagList::TagData *
+PacketTagList::Next (const struct PacketTagList::TagData *cur)
+{
+  return reinterpret_cast<const struct TagData *>
+           (reinterpret_cast<const uint8_t *> (cur) + GetEntrySize (cur->size));
+}
+
+} /* namespace ns3 */
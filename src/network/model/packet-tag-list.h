@@ -22,11 +22,15 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags stored in a shared array, including copy-on-write semantics.
 */
 
 #include <stdint.h>
 #include <ostream>
+#include <cstring>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 #include "ns3/type-id.h"
 
 namespace ns3 {
@@ -43,88 +47,58 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * A packet usually carries a handful of small tags, which are copied
+ * with the packet at every hop and looked up by type.  The tags are
+ * therefore stored in serialized form, one after the other, in a single
+ * array rather than in a node each.  The first INLINE_SIZE bytes of tags
+ * are stored in the PacketTagList itself, and copied with it.  When more
+ * tags are added, they are all moved to a TagBlock, which is shared by
+ * the copies of the list:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ * \verbatim
+ *   PacketTagList A: m_data, m_used = 3 tags ----.
+ *   PacketTagList B: m_data, m_used = 4 tags ---------.
+ *                                                |    |
+ *   TagBlock: count = 2 | T1 | T2 | T3 | T4 |****|
+ *                                           ^ dirty
+ * \endverbatim
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
+ *   - Each TagData entry holds the TypeId and the size of a tag,
+ *     followed by its serialized data, padded to the alignment of
+ *     the entries.
  *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
+ *   - Each PacketTagList uses the first \c m_used bytes of the block
+ *     which it points to.  \c count is the number of PacketTagLists
+ *     which point to the block, and \c dirty is the largest \c m_used
+ *     among them.
  *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
+ * \par <b> Copy-on-write </b> of a TagBlock is implemented as follows,
+ * in the same way as the ByteTagList:
  *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
  *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
+ *     share the block of \c o, incrementing its \c count, or copy
+ *     the inline tags of \c o.
+ *
+ *   - #Add appends the new tag in place if the block is not shared or
+ *     if no other PacketTagList uses the bytes after \c m_used (that is,
+ *     if \c m_used is \c dirty), and the block is large enough.
+ *     Otherwise, the tags are copied to a new block first, which grows
+ *     geometrically.  #Add does not affect any other PacketTagList,
+ *     hence this is a \c const function.
+ *
+ *   - #Remove of the last tag only decrements \c m_used.  #Remove of
+ *     another tag, and #Replace, modify the block in place if it is not
+ *     shared, and otherwise copy it first.
  *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ * The blocks are allocated from the PacketPool, so that the packets
+ * with more tags do not usually reach malloc either.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
+   * Serialized tag, stored in the array of a TagBlock.
    *
    * See PacketTagList for a discussion of the data structure.
    *
@@ -133,15 +107,9 @@ public:
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
     TypeId tid;                 /**< Type of the tag serialized into #data */
     uint32_t size;              /**< Size of the \c data buffer */
     uint8_t data[1];            /**< Serialization buffer */
@@ -156,8 +124,7 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy, sharing the tags of \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -167,18 +134,18 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * sharing the tags of \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag at the end of this list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,78 +177,105 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the first tag of the list, or 0 if it is empty.
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns pointer past the last tag of the list, or 0 if it is empty.
+   */
+  const struct PacketTagList::TagData *End (void) const;
+  /**
+   * \param [in] cur A tag of a list.
+   * \returns pointer to the tag which follows \pname{cur} in its list.
+   */
+  static const struct PacketTagList::TagData *Next (const struct PacketTagList::TagData *cur);
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
+   * Shared array of serialized tags.
+   */
+  struct TagBlock
+  {
+    uint32_t size;               /**< Size of the \c data array */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; /**< Number of PacketTagLists using the block */
+#else
+    uint32_t count;              /**< Number of PacketTagLists using the block */
+#endif
+    uint32_t dirty;              /**< Number of bytes used by the longest list */
+    uint8_t data[4];             /**< The TagData entries */
+  };  /* struct TagBlock */
+
+  /** The size of the tags stored in the list itself. */
+  static const uint32_t INLINE_SIZE = 48;
+
+  /**
+   * \param [in] size The serialized size of a tag.
+   * \returns The size of the TagData entry which holds it.
+   */
+  static uint32_t GetEntrySize (uint32_t size);
+  /**
+   * Allocate a TagBlock from the PacketPool.
    *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * \param [in] size The minimum size of its array.
+   * \returns The TagBlock, which uses the whole PacketPool block.
+   */
+  static struct TagBlock *Allocate (uint32_t size);
+  /**
+   * Release a reference to a TagBlock, and its memory if it was the
+   * last one.
+   *
+   * \param [in] data The TagBlock, or 0.
+   */
+  static void Deallocate (struct TagBlock *data);
+  /**
+   * \returns The array of the tags, in the TagBlock or inline.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  inline uint8_t *GetBuffer (void) const;
   /**
-   * Typedef of method function pointer for copy-on-write operations
+   * Copy the inline tags of another list, which has no TagBlock.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] o The other list.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  inline void CopyInline (PacketTagList const &o);
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Find a tag in this list.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] tid The type of the tag.
+   * \returns The offset of its entry in the block, or m_used if
+   *          it is not found.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  uint32_t Find (TypeId tid) const;
   /**
-   * Copy-on-write implementing Remove.
+   * Remove a tag from this list.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] offset The offset of its entry in the block.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void RemoveEntry (uint32_t offset);
   /**
-   * Copy-on-write implementing Replace
+   * Copy the tags of this list to a new block of its own, from its
+   * shared block or from its inline array.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] size The minimum size of the new block.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void Unshare (uint32_t size);
 
   /**
-   * Pointer to first \ref TagData on the list
+   * The array of the tags, or 0 if they are stored in #m_inline.
+   */
+  struct TagBlock *m_data;
+  /**
+   * The number of bytes of the array used by this list.
    */
-  struct TagData *m_next;
+  uint32_t m_used;
+  /**
+   * The array of the tags when they fit in it, aligned as a TagData.
+   */
+  uint32_t m_inline[INLINE_SIZE / 4];
 };
 
 } // namespace ns3
@@ -293,32 +287,48 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_data (0),
+    m_used (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_data (o.m_data),
+    m_used (o.m_used)
 {
-  if (m_next != 0)
+  if (m_data != 0)
+    {
+      m_data->count++;
+    }
+  else
     {
-      m_next->count++;
+      CopyInline (o);
     }
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
-  // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
+    {
+      return *this;
+    }
+  // assignment of a list sharing the same block
+  if (m_data != 0 && m_data == o.m_data)
     {
+      m_used = o.m_used;
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_data = o.m_data;
+  m_used = o.m_used;
+  if (m_data != 0) 
+    {
+      m_data->count++;
+    }
+  else
     {
-      m_next->count++;
+      CopyInline (o);
     }
   return *this;
 }
@@ -328,30 +338,31 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
-void
-PacketTagList::RemoveAll (void)
+uint8_t *
+PacketTagList::GetBuffer (void) const
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_data != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-          prev->~TagData ();
-          std::free (prev);
-        }
-      prev = cur;
+      return m_data->data;
     }
-  if (prev != 0) 
+  return reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (m_inline));
+}
+
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  if (m_used != 0)
     {
-      prev->~TagData ();
-      std::free (prev);
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
-  m_next = 0;
+}
+
+void
+PacketTagList::RemoveAll (void)
+{
+  Deallocate (m_data);
+  m_data = 0;
+  m_used = 0;
 }
 
 } // namespace ns3
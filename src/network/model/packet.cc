@@ -21,6 +21,9 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#ifdef NS3_MTP
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +31,31 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
+#ifdef NS3_MTP
+std::atomic<uint32_t> Packet::m_globalUid (0);
+#elif defined (NS3_ENSEMBLE)
+thread_local uint32_t Packet::m_globalUid = 0;
+#else
 uint32_t Packet::m_globalUid = 0;
+#endif
+
+uint64_t
+Packet::AllocateUid (void)
+{
+#ifdef NS3_MTP
+  // the packets created by the events of a partition take their uids in
+  // the sequence of the partition, with the partition in the upper bits
+  uint64_t uid = MultithreadedSimulatorImpl::AllocateUid ();
+  if (uid != 0)
+    {
+      return uid;
+    }
+#endif
+  // The upper 32 bits of the packet id in metadata is for the system id.
+  // For non-distributed simulations, this is simply zero.  The lower 32
+  // bits are for the global UID
+  return static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++;
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,21 +108,23 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head,
+                                      const struct PacketTagList::TagData *end)
+  : m_current (head),
+    m_end (end)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_end;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
   const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
+  m_current = PacketTagList::Next (m_current);
   return PacketTagIterator::Item (prev);
 }
 
@@ -130,26 +159,27 @@ Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
-    m_nixVector (0)
+    m_metadata (AllocateUid (), 0),
+    m_nixVector (0),
+    m_headerCache (0),
+    m_headerCacheSize (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_nixVector (o.m_nixVector),
+    m_headerCache (0),
+    m_headerCacheSize (0)
+{
+}
+
+Packet::~Packet ()
 {
-  o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
-    : m_nixVector = 0;
+  ClearHeaderCache ();
 }
 
 Packet &
@@ -163,8 +193,8 @@ Packet::operator = (const Packet &o)
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
-  o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
-    : m_nixVector = 0;
+  m_nixVector = o.m_nixVector;
+  ClearHeaderCache ();
   return *this;
 }
 
@@ -172,23 +202,20 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_metadata (AllocateUid (), size),
+    m_nixVector (0),
+    m_headerCache (0),
+    m_headerCacheSize (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
     m_byteTagList (),
     m_packetTagList (),
     m_metadata (0,0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_headerCache (0),
+    m_headerCacheSize (0)
 {
   NS_ASSERT (magic);
   Deserialize (buffer, size);
@@ -198,16 +225,11 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
-{
-  m_globalUid++;
+    m_metadata (AllocateUid (), size),
+    m_nixVector (0),
+    m_headerCache (0),
+    m_headerCacheSize (0)
+{
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -219,7 +241,9 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
     m_metadata (metadata),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_headerCache (0),
+    m_headerCacheSize (0)
 {
 }
 
@@ -236,7 +260,7 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   // again, call the constructor directly rather than
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
-  ret->SetNixVector (GetNixVector ());
+  ret->m_nixVector = m_nixVector;
   return ret;
 }
 
@@ -249,14 +273,21 @@ Packet::SetNixVector (Ptr<NixVector> nixVector)
 Ptr<NixVector>
 Packet::GetNixVector (void) const
 {
+  // the copies of a packet share its nix-vector until one of them
+  // hands it out to be changed
+  if (m_nixVector && m_nixVector->GetReferenceCount () > 1)
+    {
+      m_nixVector = m_nixVector->Copy ();
+    }
   return m_nixVector;
-} 
+}
 
 void
 Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  ClearHeaderCache ();
   m_buffer.AddAtStart (size);
   m_byteTagList.Adjust (size);
   m_byteTagList.AddAtStart (size);
@@ -266,6 +297,7 @@ Packet::AddHeader (const Header &header)
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
 {
+  ClearHeaderCache ();
   Buffer::Iterator end;
   end = m_buffer.Begin ();
   end.Next (size);
@@ -279,7 +311,12 @@ Packet::RemoveHeader (Header &header, uint32_t size)
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  uint32_t deserialized = PeekCachedHeader (header);
+  ClearHeaderCache ();
+  if (deserialized == 0)
+    {
+      deserialized = header.Deserialize (m_buffer.Begin ());
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
@@ -289,7 +326,12 @@ Packet::RemoveHeader (Header &header)
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  uint32_t deserialized = PeekCachedHeader (header);
+  if (deserialized == 0)
+    {
+      deserialized = header.Deserialize (m_buffer.Begin ());
+      CacheHeader (header, deserialized);
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
@@ -304,10 +346,36 @@ Packet::PeekHeader (Header &header, uint32_t size) const
   return deserialized;
 }
 void
+Packet::CacheHeader (const Header &header, uint32_t size) const
+{
+#ifndef NS3_MTP
+  // with --enable-mtp, the threads may peek at the same packet
+  Header *copy = header.Clone ();
+  if (copy != 0)
+    {
+      delete m_headerCache;
+      m_headerCache = copy;
+      m_headerCacheSize = size;
+    }
+#endif
+}
+uint32_t
+Packet::PeekCachedHeader (Header &header) const
+{
+  if (m_headerCache != 0
+      && m_headerCache->GetInstanceTypeId () == header.GetInstanceTypeId ()
+      && header.Assign (*m_headerCache))
+    {
+      return m_headerCacheSize;
+    }
+  return 0;
+}
+void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
+  ClearHeaderCache ();
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   Buffer::Iterator end = m_buffer.End ();
@@ -319,6 +387,7 @@ Packet::RemoveTrailer (Trailer &trailer)
 {
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
+  ClearHeaderCache ();
   m_buffer.RemoveAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
   return deserialized;
@@ -335,6 +404,7 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
+  ClearHeaderCache ();
   m_byteTagList.AddAtEnd (GetSize ());
   ByteTagList copy = packet->m_byteTagList;
   copy.AddAtStart (0);
@@ -347,6 +417,7 @@ void
 Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  ClearHeaderCache ();
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   m_metadata.AddPaddingAtEnd (size);
@@ -355,6 +426,7 @@ void
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  ClearHeaderCache ();
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
 }
@@ -362,6 +434,7 @@ void
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  ClearHeaderCache ();
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
@@ -575,6 +648,13 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnableCompactPrinting (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableCompact ();
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -920,7 +1000,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Head (), m_packetTagList.End ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -21,6 +21,9 @@
 #define PACKET_H
 
 #include <stdint.h>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -29,6 +32,7 @@
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
 #include "nix-vector.h"
+#include "packet-pool.h"
 #include "ns3/mac48-address.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
@@ -174,9 +178,12 @@ private:
   /**
    * Constructor
    * \param head head of the items
+   * \param end end of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *head,
+                     const struct PacketTagList::TagData *end);
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  const struct PacketTagList::TagData *m_end;      //!< end of the set of tags in a packet
 };
 
 /**
@@ -199,7 +206,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. Packet::EnableCompactPrinting, or the
+ * "CompactPacketMetadata" GlobalValue, records only the outermost headers
+ * and trailers, at a still lower cost.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -231,12 +240,36 @@ private:
 class Packet : public SimpleRefCount<Packet>
 {
 public:
+  /**
+   * Allocate a packet from the PacketPool of the calling thread.
+   *
+   * \param [in] size The size of the packet.
+   * \returns The packet memory.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return PacketPool::Allocate (size);
+  }
+  /**
+   * Release a packet to the PacketPool of the calling thread.
+   *
+   * \param [in] p The packet memory.
+   * \param [in] size The size of the packet.
+   */
+  static void operator delete (void *p, std::size_t size)
+  {
+    PacketPool::Deallocate (p, size);
+  }
 
   /**
    * \brief Create an empty packet with a new uid (as returned
    * by getUid).
    */
   Packet ();
+  /**
+   * \brief Destructor
+   */
+  ~Packet ();
   /**
    * \brief Copy constructor
    * \param o object to copy
@@ -338,7 +371,11 @@ public:
   /**
    * \brief Deserialize but does _not_ remove the header from the internal buffer.
    * s
-   * This method invokes Header::Deserialize.
+   * This method invokes Header::Deserialize.  If the header supports
+   * Header::Clone, the packet keeps a copy of it until its bytes
+   * change, and a later PeekHeader or RemoveHeader of a header of the
+   * same type assigns the copy instead of deserializing the header
+   * again.
    *
    * \param header a reference to the header to read from the internal buffer.
    * \returns the number of bytes read from the packet.
@@ -517,8 +554,21 @@ public:
    * want to be able the Packet::Print method, 
    * you need to invoke this method at least once during the 
    * simulation setup and before any packet is created.
+   *
+   * The full metadata is recorded, unless the "CompactPacketMetadata"
+   * GlobalValue is true.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing packets with the compact metadata.
+   *
+   * The compact metadata records only the TypeId and the size of the
+   * outermost headers and trailers of each packet, in a fixed array.
+   * Packet::Print shows the fragments and the other headers and trailers
+   * as payload.  As EnablePrinting, this method must be invoked before
+   * any packet is created.
+   */
+  static void EnableCompactPrinting (void);
   /**
    * \brief Enable packets metadata checking.
    *
@@ -702,6 +752,11 @@ public:
    *
    * See the comment on SetNixVector
    *
+   * The copies of a packet share its nix-vector.  If it is shared,
+   * this method first replaces it with a copy, which shares the bits
+   * but not the number of used bits, so that the caller can extract
+   * neighbor-indexes without moving the other packets along the route.
+   *
    * \returns the Nix vector
    */
   Ptr<NixVector> GetNixVector (void) const; 
@@ -779,15 +834,69 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Keep a copy of a header deserialized from the start of the
+   * packet, if the header supports it.
+   *
+   * \param [in] header the header.
+   * \param [in] size the size of the header.
+   */
+  void CacheHeader (const Header &header, uint32_t size) const;
+  /**
+   * \brief Assign the cached copy of the header at the start of the
+   * packet to a header of the same type.
+   *
+   * \param [in,out] header the header.
+   * \returns the size of the header, or zero if there is no copy
+   * which the header accepts.
+   */
+  uint32_t PeekCachedHeader (Header &header) const;
+  /**
+   * \brief Drop the cached copy of the header at the start of the
+   * packet, before the bytes of the packet change.
+   */
+  inline void ClearHeaderCache (void);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
   PacketMetadata m_metadata;      //!< the packet's metadata
 
   /* Please see comments above about nix-vector */
-  Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
+  mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector, shared with its copies
+
+  mutable Header *m_headerCache;      //!< copy of the header at the start of the packet, or zero
+  mutable uint32_t m_headerCacheSize; //!< the size of the header at the start of the packet
+
+  /**
+   * Allocate the uid of a new packet.
+   *
+   * With --enable-mtp, the packets created by the events of a partition
+   * of MultithreadedSimulatorImpl take their uids from the sequence of
+   * that partition, so that the uids do not depend on the interleaving
+   * of the threads.  The other packets use m_globalUid.
+   *
+   * \returns The uid.
+   */
+  static uint64_t AllocateUid (void);
 
+#ifdef NS3_MTP
+  /**
+   * Global counter of the uids of the packets created outside of the
+   * partitions of MultithreadedSimulatorImpl, for example before
+   * Simulator::Run.
+   */
+  static std::atomic<uint32_t> m_globalUid;
+#elif defined (NS3_ENSEMBLE)
+  /**
+   * Counter of packets Uid of the simulation run by this thread, so that
+   * the uids of a replication of EnsembleRunner do not depend on the
+   * other replications.
+   */
+  static thread_local uint32_t m_globalUid;
+#else
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
@@ -854,6 +963,16 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+void
+Packet::ClearHeaderCache (void)
+{
+  if (m_headerCache != 0)
+    {
+      delete m_headerCache;
+      m_headerCache = 0;
+    }
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
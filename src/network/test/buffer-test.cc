@@ -23,6 +23,9 @@
 #include "ns3/double.h"
 #include "ns3/test.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -389,6 +392,287 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that segmenting, fragmenting and reassembling a payload keeps
+ * its zero area virtual, and that the bytes which must be written to
+ * memory are counted.
+ */
+class BufferZeroAreaTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferZeroAreaTest ();
+};
+
+BufferZeroAreaTest::BufferZeroAreaTest ()
+  : TestCase ("Buffer zero area") {
+}
+
+void
+BufferZeroAreaTest::DoRun (void)
+{
+  Buffer::ResetMaterializedBytes ();
+
+  // A 64 KB payload cut in segments, as a TCP sender does, each one
+  // sharing the data of the payload, then put back together.
+  Buffer payload (65536);
+  Buffer stream;
+  for (uint32_t offset = 0; offset < payload.GetSize (); offset += 1448)
+    {
+      uint32_t length = std::min<uint32_t> (1448, payload.GetSize () - offset);
+      stream.AddAtEnd (payload.CreateFragment (offset, length));
+    }
+  NS_TEST_ASSERT_MSG_EQ (stream.GetSize (), 65536, "Bad size of the reassembled payload");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetMaterializedBytes (), 0, "A segment was materialized");
+
+  // A header in front of the payload, then fragments of the whole
+  // datagram, reassembled after the header of each fragment is removed.
+  Buffer datagram = stream;
+  datagram.AddAtStart (20);
+  datagram.Begin ().WriteU8 (0xaa, 20);
+  Buffer reassembled;
+  for (uint32_t offset = 0; offset < datagram.GetSize (); offset += 1480)
+    {
+      uint32_t length = std::min<uint32_t> (1480, datagram.GetSize () - offset);
+      Buffer fragment = datagram.CreateFragment (offset, length);
+      fragment.AddAtStart (20);
+      fragment.Begin ().WriteU8 (0xbb, 20);
+      Buffer received = fragment;
+      received.RemoveAtStart (20);
+      reassembled.AddAtEnd (received);
+    }
+  NS_TEST_ASSERT_MSG_EQ (reassembled.GetSize (), 65556, "Bad size of the reassembled datagram");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetMaterializedBytes (), 0, "A fragment was materialized");
+  Buffer::Iterator i = reassembled.Begin ();
+  for (uint32_t j = 0; j < 20; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)i.ReadU8 (), 0xaa, "Bad header byte");
+    }
+  for (uint32_t j = 0; j < 65536; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)i.ReadU8 (), 0, "Bad payload byte");
+    }
+
+  // Two payloads with a trailer between them: only the smaller zero
+  // area is written to memory.
+  Buffer first (100);
+  first.AddAtEnd (4);
+  i = first.End ();
+  i.Prev (4);
+  i.WriteU8 (0xcc, 4);
+  Buffer second (1000);
+  first.AddAtEnd (second);
+  NS_TEST_ASSERT_MSG_EQ (first.GetSize (), 1104, "Bad size of the aggregate");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetMaterializedBytes (), 100, "The larger zero area was materialized");
+  i = first.Begin ();
+  for (uint32_t j = 0; j < 1104; j++)
+    {
+      uint32_t expected = (j >= 100 && j < 104) ? 0xcc : 0;
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)i.ReadU8 (), expected, "Bad aggregate byte");
+    }
+
+  first.PeekData ();
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetMaterializedBytes (), 1100, "PeekData was not counted");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that appending large buffers makes a chain of slices without
+ * copying their bytes, and that the iterators, fragments and copies of
+ * the chain see the same bytes as a contiguous buffer.
+ */
+class BufferSliceTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferSliceTest ();
+};
+
+BufferSliceTest::BufferSliceTest ()
+  : TestCase ("Buffer slices") {
+}
+
+void
+BufferSliceTest::DoRun (void)
+{
+  // Three frames of 1000 bytes, each one the value of its index
+  // modulo 251, appended after a 14-byte header.
+  std::vector<uint8_t> expected;
+  Buffer aggregate;
+  aggregate.AddAtStart (14);
+  aggregate.Begin ().WriteU8 (0xee, 14);
+  expected.insert (expected.end (), 14, 0xee);
+  for (uint32_t f = 0; f < 3; f++)
+    {
+      Buffer frame;
+      frame.AddAtStart (1000);
+      Buffer::Iterator i = frame.Begin ();
+      for (uint32_t j = 0; j < 1000; j++)
+        {
+          uint8_t v = (f * 1000 + j) % 251;
+          i.WriteU8 (v);
+          expected.push_back (v);
+        }
+      uint8_t const *data = frame.PeekData ();
+      aggregate.AddAtEnd (frame);
+      // the frame still owns the bytes it shares with the aggregate
+      NS_TEST_ASSERT_MSG_EQ ((data == frame.PeekData ()), true, "The frame was copied");
+    }
+  NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), 3014, "Bad size of the aggregate");
+
+  // A small trailer, copied into the last slice
+  Buffer trailer;
+  trailer.AddAtStart (4);
+  trailer.Begin ().WriteHtonU32 (0x01020304);
+  aggregate.AddAtEnd (trailer);
+  for (uint8_t v = 1; v <= 4; v++)
+    {
+      expected.push_back (v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), 3018, "Bad size of the aggregate");
+
+  // Read the chain forward and backward across the slice boundaries
+  Buffer::Iterator i = aggregate.Begin ();
+  bool ok = true;
+  for (uint32_t j = 0; j < expected.size (); j++)
+    {
+      ok = ok && i.ReadU8 () == expected[j];
+    }
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Bad byte read forward");
+  NS_TEST_ASSERT_MSG_EQ (i.IsEnd (), true, "The iterator is not at the end");
+  i = aggregate.End ();
+  for (uint32_t j = expected.size (); j > 0; j--)
+    {
+      i.Prev ();
+      ok = ok && i.PeekU8 () == expected[j - 1];
+    }
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Bad byte read backward");
+  NS_TEST_ASSERT_MSG_EQ (i.IsStart (), true, "The iterator is not at the start");
+  i = aggregate.Begin ();
+  i.Next (1012);
+  uint32_t spanning = i.ReadNtohU32 ();
+  uint32_t expectedSpanning = (expected[1012] << 24) | (expected[1013] << 16) | (expected[1014] << 8) | expected[1015];
+  NS_TEST_ASSERT_MSG_EQ (spanning, expectedSpanning, "Bad value read across slices");
+  NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (aggregate.Begin ()), 1016, "Bad distance across slices");
+  NS_TEST_ASSERT_MSG_EQ (i.GetRemainingSize (), 2002, "Bad remaining size");
+
+  // A fragment across two frames, and a copy of the data
+  Buffer fragment = aggregate.CreateFragment (900, 1200);
+  NS_TEST_ASSERT_MSG_EQ (fragment.GetSize (), 1200, "Bad size of the fragment");
+  std::vector<uint8_t> copy (1200);
+  uint32_t copied = fragment.CopyData (&copy[0], 1200);
+  NS_TEST_ASSERT_MSG_EQ (copied, 1200, "Bad size of the copied data");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (&copy[0], &expected[900], 1200), 0, "Bad fragment data");
+
+  // Headers and trailers of a chain
+  Buffer framed = aggregate;
+  framed.RemoveAtStart (1014);
+  framed.RemoveAtEnd (1004);
+  NS_TEST_ASSERT_MSG_EQ (framed.GetSize (), 1000, "Bad size of the middle frame");
+  framed.AddAtStart (2);
+  framed.Begin ().WriteHtonU16 (0xabcd);
+  i = framed.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU16 (), 0xabcd, "Bad header");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)i.ReadU8 (), expected[1014], "Bad frame byte");
+  NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), 3018, "A copy changed the aggregate");
+
+  // Gather the slices
+  Buffer::ResetMaterializedBytes ();
+  NS_TEST_ASSERT_MSG_EQ (memcmp (aggregate.PeekData (), &expected[0], expected.size ()), 0, "Bad gathered data");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetMaterializedBytes (), 0, "Zero bytes were materialized");
+  NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), 3018, "Bad size of the gathered buffer");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the Internet checksum of buffers with a zero area and slices,
+ * from even and odd offsets, against a byte by byte sum.
+ */
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  /**
+   * Calculate the checksum one byte at a time.
+   *
+   * \param i the start of the bytes
+   * \param size the number of bytes
+   * \returns the checksum
+   */
+  uint16_t ReferenceChecksum (Buffer::Iterator i, uint32_t size);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum") {
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (Buffer::Iterator i, uint32_t size)
+{
+  uint32_t sum = 0;
+  for (uint32_t j = 0; j < size; j++)
+    {
+      uint8_t byte = i.ReadU8 ();
+      sum += (j & 1) ? (byte << 8) : byte;
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  // A payload with a zero area, headers of odd and even sizes, and a
+  // large frame appended as a slice.
+  Buffer buffer (1001);
+  buffer.AddAtStart (33);
+  buffer.AddAtEnd (7);
+  Buffer frame;
+  frame.AddAtStart (2001);
+  Buffer::Iterator i = frame.Begin ();
+  for (uint32_t j = 0; j < 2001; j++)
+    {
+      i.WriteU8 (rand->GetInteger (0, 255));
+    }
+  buffer.AddAtEnd (frame);
+  i = buffer.Begin ();
+  for (uint32_t j = 0; j < 33; j++)
+    {
+      i.WriteU8 (rand->GetInteger (0, 255));
+    }
+  i = buffer.End ();
+  i.Prev (2008);
+  for (uint32_t j = 0; j < 7; j++)
+    {
+      i.WriteU8 (rand->GetInteger (0, 255));
+    }
+
+  uint32_t offsets[] = { 0, 1, 2, 31, 33, 34, 1034, 1035, 1041, 3000 };
+  for (uint32_t k = 0; k < sizeof (offsets) / sizeof (offsets[0]); k++)
+    {
+      for (uint32_t size = 0; size + offsets[k] <= buffer.GetSize () && size < 65536; size += 97)
+        {
+          Buffer::Iterator start = buffer.Begin ();
+          start.Next (offsets[k]);
+          Buffer::Iterator fast = start;
+          uint16_t checksum = fast.CalculateIpChecksum (size);
+          uint16_t expected = ReferenceChecksum (start, size);
+          NS_TEST_ASSERT_MSG_EQ (checksum, expected, "bad checksum of " << size << " bytes at " << offsets[k]);
+          NS_TEST_ASSERT_MSG_EQ (fast.GetDistanceFrom (buffer.Begin ()), offsets[k] + size, "the iterator did not advance");
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +689,9 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferZeroAreaTest, TestCase::QUICK);
+  AddTestCase (new BufferSliceTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
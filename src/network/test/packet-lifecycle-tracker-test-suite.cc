@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet-lifecycle-tracker.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the events which the PacketLifecycleTracker records from the
+ * transmit queue of a device, in memory and through a file.
+ */
+class PacketLifecycleTrackerTestCase : public TestCase
+{
+public:
+  PacketLifecycleTrackerTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Send packets on a device.
+   *
+   * \param device The device.
+   * \param n The number of packets.
+   */
+  void Send (Ptr<NetDevice> device, uint32_t n);
+};
+
+PacketLifecycleTrackerTestCase::PacketLifecycleTrackerTestCase ()
+  : TestCase ("Check the events of the packet lifecycle tracker")
+{
+}
+
+void
+PacketLifecycleTrackerTestCase::Send (Ptr<NetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (1000), Mac48Address::GetBroadcast (), 0x800);
+    }
+}
+
+void
+PacketLifecycleTrackerTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  helper.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("2p"));
+  NetDeviceContainer devices = helper.Install (nodes);
+
+  PacketLifecycleTracker memory;
+  memory.Install (nodes);
+  PacketLifecycleTracker ring;
+  ring.SetChunkSize (4);
+  ring.Install (nodes);
+  PacketLifecycleTracker file;
+  file.SetChunkSize (3);
+  std::string filename = CreateTempDirFilename ("lifecycle.bin");
+  NS_TEST_ASSERT_MSG_EQ (file.Open (filename), true, "cannot create " << filename);
+  file.Install (devices.Get (0));
+
+  // the first packet is sent at once, the next two wait in the queue and
+  // the last one is dropped
+  Simulator::Schedule (MicroSeconds (10), &PacketLifecycleTrackerTestCase::Send, this, devices.Get (0), 4);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  const PacketLifecycleTracker::Columns &columns = memory.GetColumns ();
+  NS_TEST_ASSERT_MSG_EQ (columns.GetN (), 7, "wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (memory.GetNRecords (), 7, "wrong number of events");
+  uint8_t events[] = {
+    PacketLifecycleTracker::ENQUEUE, PacketLifecycleTracker::DEQUEUE,
+    PacketLifecycleTracker::ENQUEUE, PacketLifecycleTracker::ENQUEUE,
+    PacketLifecycleTracker::QUEUE_DROP,
+    PacketLifecycleTracker::DEQUEUE, PacketLifecycleTracker::DEQUEUE
+  };
+  // the first event of the packet of each event
+  uint32_t packets[] = { 0, 0, 2, 3, 4, 2, 3 };
+  int64_t times[] = { 10000, 10000, 10000, 10000, 10000, 1010000, 2010000 };
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (uint32_t (columns.event[i]), uint32_t (events[i]), "wrong event " << i);
+      NS_TEST_EXPECT_MSG_EQ (columns.uid[i], columns.uid[packets[i]], "wrong packet " << i);
+      NS_TEST_EXPECT_MSG_EQ ((packets[i] != i || i == 0 || columns.uid[i - 1] != columns.uid[i]), true, "wrong packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (columns.time[i], times[i], "wrong time " << i);
+      NS_TEST_EXPECT_MSG_EQ (columns.node[i], nodes.Get (0)->GetId (), "wrong node " << i);
+      NS_TEST_EXPECT_MSG_EQ (columns.interface[i], devices.Get (0)->GetIfIndex (), "wrong interface " << i);
+      NS_TEST_EXPECT_MSG_EQ (columns.size[i], 1000, "wrong size " << i);
+    }
+
+  // without a file, only the last chunk is kept
+  const PacketLifecycleTracker::Columns &last = ring.GetColumns ();
+  NS_TEST_ASSERT_MSG_EQ (last.GetN (), 4, "wrong number of events in the ring");
+  NS_TEST_EXPECT_MSG_EQ (ring.GetNRecords (), 7, "wrong number of events");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (uint32_t (last.event[i]), uint32_t (events[i + 3]), "wrong event " << i << " in the ring");
+      NS_TEST_EXPECT_MSG_EQ (last.uid[i], columns.uid[i + 3], "wrong packet " << i << " in the ring");
+      NS_TEST_EXPECT_MSG_EQ (last.time[i], times[i + 3], "wrong time " << i << " in the ring");
+    }
+
+  // two full chunks are in the file, the last event is still in memory
+  NS_TEST_EXPECT_MSG_EQ (file.GetColumns ().GetN (), 1, "wrong number of events in memory");
+  file.Close ();
+  PacketLifecycleTracker::Columns read;
+  NS_TEST_ASSERT_MSG_EQ (PacketLifecycleTracker::Read (filename, read), true, "cannot read " << filename);
+  NS_TEST_EXPECT_MSG_EQ ((read.uid == columns.uid), true, "wrong uids in the file");
+  NS_TEST_EXPECT_MSG_EQ ((read.time == columns.time), true, "wrong times in the file");
+  NS_TEST_EXPECT_MSG_EQ ((read.node == columns.node), true, "wrong nodes in the file");
+  NS_TEST_EXPECT_MSG_EQ ((read.interface == columns.interface), true, "wrong interfaces in the file");
+  NS_TEST_EXPECT_MSG_EQ ((read.size == columns.size), true, "wrong sizes in the file");
+  NS_TEST_EXPECT_MSG_EQ ((read.event == columns.event), true, "wrong events in the file");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the rows which a tracker kept in its ring, once it wrapped,
+ * are written in order when a file is opened.
+ */
+class PacketLifecycleTrackerRingTestCase : public TestCase
+{
+public:
+  PacketLifecycleTrackerRingTestCase ();
+  virtual void DoRun (void);
+};
+
+PacketLifecycleTrackerRingTestCase::PacketLifecycleTrackerRingTestCase ()
+  : TestCase ("Check the order of the rows of the ring written to a file")
+{
+}
+
+void
+PacketLifecycleTrackerRingTestCase::DoRun (void)
+{
+  // the size of the packets numbers the rows
+  PacketLifecycleTracker tracker;
+  tracker.SetChunkSize (3);
+  for (uint32_t i = 1; i <= 5; i++)
+    {
+      tracker.Record (Create<Packet> (i), 0, 0, PacketLifecycleTracker::TX);
+    }
+  std::string filename = CreateTempDirFilename ("lifecycle-ring.bin");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Open (filename), true, "cannot create " << filename);
+  for (uint32_t i = 6; i <= 7; i++)
+    {
+      tracker.Record (Create<Packet> (i), 0, 0, PacketLifecycleTracker::TX);
+    }
+  tracker.Close ();
+
+  PacketLifecycleTracker::Columns read;
+  NS_TEST_ASSERT_MSG_EQ (PacketLifecycleTracker::Read (filename, read), true, "cannot read " << filename);
+  NS_TEST_ASSERT_MSG_EQ (read.GetN (), 5, "the file should hold the last 3 rows of the ring and the next 2");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (read.size[i], i + 3, "wrong row " << i << " in the file");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PacketLifecycleTracker TestSuite
+ */
+class PacketLifecycleTrackerTestSuite : public TestSuite
+{
+public:
+  PacketLifecycleTrackerTestSuite ()
+    : TestSuite ("packet-lifecycle-tracker", UNIT)
+  {
+    AddTestCase (new PacketLifecycleTrackerTestCase (), TestCase::QUICK);
+    AddTestCase (new PacketLifecycleTrackerRingTestCase (), TestCase::QUICK);
+  }
+};
+
+static PacketLifecycleTrackerTestSuite g_packetLifecycleTrackerTestSuite; //!< Static variable for test initialization
@@ -319,6 +319,11 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
 class PacketMetadataTest : public TestCase {
 public:
   PacketMetadataTest ();
+  /**
+   * Constructor
+   * \param name The name of the test case
+   */
+  PacketMetadataTest (std::string name);
   virtual ~PacketMetadataTest ();
   /**
    * Checks the packet header and trailer history
@@ -344,6 +349,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -902,6 +912,93 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Compact packet metadata unit tests.  The packet metadata cannot switch
+ * from the full to the compact format, so they run in their own suite.
+ */
+class PacketMetadataCompactTest : public PacketMetadataTest {
+public:
+  PacketMetadataCompactTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataCompactTest::PacketMetadataCompactTest ()
+  : PacketMetadataTest ("Compact packet metadata")
+{
+}
+
+void
+PacketMetadataCompactTest::DoRun (void)
+{
+  PacketMetadata::EnableCompact ();
+
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_TRAILER (p, 4);
+  CHECK_HISTORY (p, 5, 3, 2, 1, 10, 4);
+
+  // copy on write
+  Ptr<Packet> p1 = p->Copy ();
+  REM_HEADER (p1, 3);
+  REM_TRAILER (p1, 4);
+  CHECK_HISTORY (p1, 3, 2, 1, 10);
+  ADD_HEADER (p1, 5);
+  ADD_TRAILER (p1, 6);
+  CHECK_HISTORY (p1, 5, 5, 2, 1, 10, 6);
+  CHECK_HISTORY (p, 5, 3, 2, 1, 10, 4);
+
+  // the innermost headers which do not fit are shown as payload
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_HEADER (p, 5);
+  ADD_HEADER (p, 6);
+  ADD_HEADER (p, 7);
+  ADD_HEADER (p, 8);
+  ADD_HEADER (p, 9);
+  CHECK_HISTORY (p, 9, 9, 8, 7, 6, 5, 4, 3, 2, 11);
+  REM_HEADER (p, 9);
+  REM_HEADER (p, 8);
+  CHECK_HISTORY (p, 7, 7, 6, 5, 4, 3, 2, 11);
+
+  // fragments and concatenation
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 8);
+  ADD_TRAILER (p, 4);
+  p1 = p->CreateFragment (0, 12);
+  CHECK_HISTORY (p1, 2, 8, 4);
+  Ptr<Packet> p2 = p->CreateFragment (4, 10);
+  CHECK_HISTORY (p2, 2, 4, 6);
+  p2->AddAtEnd (p->CreateFragment (14, 8));
+  CHECK_HISTORY (p2, 3, 4, 10, 4);
+  ADD_TRAILER (p1, 5);
+  p1->AddAtEnd (p2);
+  CHECK_HISTORY (p1, 3, 8, 23, 4);
+  REM_TRAILER (p1, 4);
+  REM_HEADER (p1, 8);
+  CHECK_HISTORY (p1, 1, 23);
+
+  // padding after the trailers
+  p = Create<Packet> (10);
+  ADD_TRAILER (p, 4);
+  p->AddPaddingAtEnd (3);
+  CHECK_HISTORY (p, 3, 10, 4, 3);
+  p->RemoveAtEnd (5);
+  CHECK_HISTORY (p, 2, 10, 2);
+
+  // bytes removed beyond the payload are taken from the trailers
+  p = Create<Packet> (2);
+  ADD_TRAILER (p, 4);
+  p->RemoveAtStart (4);
+  CHECK_HISTORY (p, 1, 2);
+}
 
 /**
  * \ingroup network-test
@@ -922,3 +1019,23 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Compact Packet Metadata TestSuite
+ */
+class PacketMetadataCompactTestSuite : public TestSuite
+{
+public:
+  PacketMetadataCompactTestSuite ();
+};
+
+PacketMetadataCompactTestSuite::PacketMetadataCompactTestSuite ()
+  : TestSuite ("packet-metadata-compact", UNIT)
+{
+  AddTestCase (new PacketMetadataCompactTest, TestCase::QUICK);
+}
+
+static PacketMetadataCompactTestSuite g_packetMetadataCompactTest; //!< Static variable for test initialization
@@ -19,6 +19,8 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-pool.h"
+#include "ns3/nix-vector.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -773,6 +775,15 @@ private:
                      const char * msg,
                      int miss = 0);
 
+  /**
+   * Checks that the copies of a list stay independent when tags are
+   * added, removed and replaced in one of them.
+   * \param orig List holding tags 1 to 3 with data value 1, and maybe more
+   * \param msg Message
+   */
+  void CheckSharing (const PacketTagList & orig,
+                     const char * msg);
+
   /**
    * Prints the remove time
    * \param ref Reference.
@@ -848,6 +859,85 @@ PacketTagListTest::CheckRefList (const PacketTagList & ptl,
   CheckRef (ptl, t7, msg, miss == 7);
 }
   
+void
+PacketTagListTest::CheckSharing (const PacketTagList & orig,
+                                 const char * msg)
+{
+  ATestTag<1> t1 (1);
+  ATestTag<2> t2 (1);
+  ATestTag<3> t3 (1);
+  ATestTag<8> t8 (8);
+  ATestTag<9> t9 (9);
+
+  { // both copies add a tag after the shared ones
+    PacketTagList a = orig;
+    PacketTagList b = a;
+    b.Add (t8);
+    a.Add (t9);
+    CheckRef (b, t8, msg);
+    CheckRef (b, t9, msg, true);
+    CheckRef (a, t9, msg);
+    CheckRef (a, t8, msg, true);
+    CheckRef (orig, t8, msg, true);
+    CheckRef (orig, t9, msg, true);
+    CheckRef (a, t1, msg);
+    CheckRef (b, t1, msg);
+  }
+
+  { // a copy removes tags, then the other one adds a tag
+    PacketTagList a = orig;
+    PacketTagList b = a;
+    ATestTag<1> r1;
+    ATestTag<3> r3;
+    NS_TEST_EXPECT_MSG_EQ (b.Remove (r1), true, msg << ": remove t1");
+    NS_TEST_EXPECT_MSG_EQ (b.Remove (r3), true, msg << ": remove t3");
+    a.Add (t8);
+    CheckRef (b, t1, msg, true);
+    CheckRef (b, t2, msg);
+    CheckRef (b, t3, msg, true);
+    CheckRef (b, t8, msg, true);
+    CheckRef (a, t1, msg);
+    CheckRef (a, t3, msg);
+    CheckRef (a, t8, msg);
+    CheckRef (orig, t1, msg);
+    CheckRef (orig, t3, msg);
+  }
+
+  { // a copy replaces a tag
+    PacketTagList b = orig;
+    ATestTag<2> r2 (5);
+    NS_TEST_EXPECT_MSG_EQ (b.Replace (r2), true, msg << ": replace t2");
+    CheckRef (b, r2, msg);
+    CheckRef (orig, t2, msg);
+  }
+
+  { // a copy grows, beyond the inline tags of a small list
+    PacketTagList b = orig;
+    ATestTag<20> t20 (20);
+    ATestTag<30> t30 (30);
+    b.Add (t20);
+    b.Add (t30);
+    CheckRef (b, t20, msg);
+    CheckRef (b, t30, msg);
+    CheckRef (b, t3, msg);
+    CheckRef (orig, t20, msg, true);
+    CheckRef (orig, t3, msg);
+  }
+
+  { // a copy outlives the list it was copied from
+    PacketTagList *a = new PacketTagList (orig);
+    a->Add (t8);
+    PacketTagList b = *a;
+    PacketTagList c;
+    c = *a;
+    delete a;
+    CheckRef (b, t8, msg);
+    CheckRef (b, t2, msg);
+    CheckRef (c, t8, msg);
+    CheckRef (c, t3, msg);
+  }
+}
+
 int
 PacketTagListTest::RemoveTime (const PacketTagList & ref,
                                ATestTagBase & t,
@@ -993,6 +1083,27 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (6);
     ReplaceCheck (7);
   }
+
+  { // Copy-on-write
+    std::cout << GetName () << "check copies of shared lists stay independent" << std::endl;
+    ATestTag<1> s1 (1);
+    ATestTag<2> s2 (1);
+    ATestTag<3> s3 (1);
+    PacketTagList small;  // inline tags
+    small.Add (s1);
+    small.Add (s2);
+    small.Add (s3);
+    CheckSharing (small, "inline list");
+    PacketTagList large;  // shared block
+    large.Add (s1);
+    large.Add (s2);
+    large.Add (s3);
+    large.Add (t4);
+    large.Add (t5);
+    large.Add (t6);
+    large.Add (t7);
+    CheckSharing (large, "shared list");
+  }
   
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
@@ -1035,6 +1146,338 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the copies of a packet keep their own byte tags, when
+ * they are inline and when they are shared.
+ */
+class ByteTagListSharingTest : public TestCase
+{
+public:
+  ByteTagListSharingTest ();
+private:
+  void DoRun (void);
+  /**
+   * \param p A packet.
+   * \returns The names of the types of its byte tags, in order.
+   */
+  static std::string GetByteTags (Ptr<const Packet> p);
+};
+
+ByteTagListSharingTest::ByteTagListSharingTest ()
+  : TestCase ("ByteTagList copy-on-write")
+{
+}
+
+std::string
+ByteTagListSharingTest::GetByteTags (Ptr<const Packet> p)
+{
+  std::ostringstream oss;
+  ByteTagIterator i = p->GetByteTagIterator ();
+  while (i.HasNext ())
+    {
+      oss << i.Next ().GetTypeId ().GetName () << " ";
+    }
+  return oss.str ();
+}
+
+void
+ByteTagListSharingTest::DoRun (void)
+{
+  std::string t1 = ATestTag<1>::GetTypeId ().GetName () + " ";
+  std::string t2 = ATestTag<2>::GetTypeId ().GetName () + " ";
+  std::string t3 = ATestTag<3>::GetTypeId ().GetName () + " ";
+  std::string t4 = ATestTag<4>::GetTypeId ().GetName () + " ";
+
+  // a single small tag is inline
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddByteTag (ATestTag<1> (1));
+  Ptr<Packet> a = p->Copy ();
+  a->AddByteTag (ATestTag<2> (2));
+  Ptr<Packet> b = p->Copy ();
+  p->AddByteTag (ATestTag<3> (3));
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (a), t1 + t2, "tags of the first copy");
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (b), t1, "tags of the second copy");
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (p), t1 + t3, "tags of the original");
+
+  // more tags are in a shared buffer
+  Ptr<Packet> c = a->Copy ();
+  c->AddByteTag (ATestTag<3> (3));
+  a->AddByteTag (ATestTag<4> (4));
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (c), t1 + t2 + t3, "tags of the copy of a shared list");
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (a), t1 + t2 + t4, "tags of a shared list");
+
+  // removing the tags of a copy leaves the other ones
+  c->RemoveAllByteTags ();
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (c), "", "tags of the cleared copy");
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (a), t1 + t2 + t4, "tags of the list shared with the cleared copy");
+
+  // the copies outlive the original
+  Ptr<Packet> d = a->Copy ();
+  Ptr<Packet> e = b->Copy ();
+  a = 0;
+  b = 0;
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (d), t1 + t2 + t4, "tags of the copy of a released packet");
+  NS_TEST_EXPECT_MSG_EQ (GetByteTags (e), t1, "inline tags of the copy of a released packet");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets and their tags are recycled through the
+ * PacketPool.
+ */
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+private:
+  void DoRun (void);
+  /**
+   * Create a packet with packet and byte tags, copy it and check the copy.
+   * \param data The data of the tags.
+   */
+  void CreateAndCheck (uint8_t data);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("PacketPool")
+{
+}
+
+void
+PacketPoolTest::CreateAndCheck (uint8_t data)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (ATestTag<5> (data));
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      p->AddByteTag (ATestTag<3> (data + i));
+    }
+  Ptr<Packet> copy = p->Copy ();
+  p = 0;
+
+  ATestTag<5> tag;
+  NS_TEST_ASSERT_MSG_EQ (copy->PeekPacketTag (tag), true, "packet tag lost");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetData (), data, "wrong packet tag");
+  NS_TEST_ASSERT_MSG_EQ (tag.m_error, false, "corrupted packet tag");
+  ByteTagIterator i = copy->GetByteTagIterator ();
+  for (uint32_t j = 0; j < 10; ++j)
+    {
+      NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "byte tag lost");
+      ATestTag<3> byteTag;
+      i.Next ().GetTag (byteTag);
+      NS_TEST_ASSERT_MSG_EQ (byteTag.GetData (), static_cast<uint8_t> (data + j), "wrong byte tag");
+      NS_TEST_ASSERT_MSG_EQ (byteTag.m_error, false, "corrupted byte tag");
+    }
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), false, "extra byte tag");
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  CreateAndCheck (1);
+  PacketPool::ResetStats ();
+  // The blocks released by the first packet serve the second one
+  CreateAndCheck (100);
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.allocations, 3, "the packets were not allocated from the PacketPool");
+  NS_TEST_ASSERT_MSG_EQ (stats.hits, stats.allocations, "the PacketPool did not recycle the blocks");
+  NS_TEST_ASSERT_MSG_EQ (stats.deallocations, stats.allocations, "blocks leaked");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the copies of a packet share its nix-vector until
+ * one of them extracts a neighbor-index.
+ */
+class PacketNixVectorTest : public TestCase
+{
+public:
+  PacketNixVectorTest ();
+private:
+  void DoRun (void);
+};
+
+PacketNixVectorTest::PacketNixVectorTest ()
+  : TestCase ("Packet nix-vector copy on write")
+{
+}
+
+void
+PacketNixVectorTest::DoRun (void)
+{
+  Ptr<NixVector> nix = Create<NixVector> ();
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      nix->AddNeighborIndex (i, 4);
+    }
+  Ptr<NixVector> nixCopy = nix->Copy ();
+  nix->AddNeighborIndex (5, 4);
+  NS_TEST_ASSERT_MSG_EQ (nixCopy->GetRemainingBits (), 40, "AddNeighborIndex changed a copy");
+  NS_TEST_ASSERT_MSG_EQ (nix->GetRemainingBits (), 44, "AddNeighborIndex lost bits");
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->SetNixVector (nixCopy);
+  NixVector *shared = PeekPointer (nixCopy);
+  nixCopy = 0;
+  Ptr<Packet> copy = p->Copy ();
+  NS_TEST_ASSERT_MSG_EQ (shared->GetReferenceCount (), 2, "the copies of the packet do not share the nix-vector");
+
+  Ptr<NixVector> forwarded = copy->GetNixVector ();
+  NS_TEST_ASSERT_MSG_NE (PeekPointer (forwarded), shared, "the nix-vector was not copied before being handed out");
+  NS_TEST_ASSERT_MSG_EQ (shared->GetReferenceCount (), 1, "the nix-vector is still shared");
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      uint32_t index = forwarded->ExtractNeighborIndex (4);
+      NS_TEST_ASSERT_MSG_EQ (index, 9 - i, "wrong neighbor-index");
+    }
+  NS_TEST_ASSERT_MSG_EQ (copy->GetNixVector ()->GetRemainingBits (), 28, "the extraction was lost");
+  NS_TEST_ASSERT_MSG_EQ (p->GetNixVector ()->GetRemainingBits (), 40, "the extraction changed another packet");
+  uint32_t index = p->GetNixVector ()->ExtractNeighborIndex (4);
+  NS_TEST_ASSERT_MSG_EQ (index, 9, "wrong neighbor-index");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header which supports the header cache of the packets,
+ * and counts its deserializations.
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class ACachedTestHeader : public Header
+{
+public:
+  ACachedTestHeader () : m_value (0), m_verify (false) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ACachedTestHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ACachedTestHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    iter.WriteHtonU32 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_deserialized++;
+    m_value = iter.ReadNtohU32 ();
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const {
+  }
+  virtual Header * Clone (void) const {
+    return new ACachedTestHeader (*this);
+  }
+  virtual bool Assign (const Header &header) {
+    if (m_verify)
+      {
+        return false;
+      }
+    m_value = static_cast<const ACachedTestHeader &> (header).m_value;
+    return true;
+  }
+
+  uint32_t m_value;                 //!< The value of the header
+  bool m_verify;                    //!< Whether the header must be deserialized
+  static uint32_t m_deserialized;   //!< The number of deserializations
+};
+
+uint32_t ACachedTestHeader::m_deserialized = 0;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that repeated PeekHeader and RemoveHeader calls assign
+ * the header cached by the packet, until the bytes of the packet change.
+ */
+class PacketHeaderCacheTest : public TestCase
+{
+public:
+  PacketHeaderCacheTest ();
+private:
+  void DoRun (void);
+};
+
+PacketHeaderCacheTest::PacketHeaderCacheTest ()
+  : TestCase ("Packet header cache")
+{
+}
+
+void
+PacketHeaderCacheTest::DoRun (void)
+{
+  ACachedTestHeader::m_deserialized = 0;
+  ACachedTestHeader header;
+  header.m_value = 42;
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (header);
+
+  ACachedTestHeader first;
+  p->PeekHeader (first);
+  ACachedTestHeader second;
+  uint32_t size = p->PeekHeader (second);
+  NS_TEST_ASSERT_MSG_EQ (size, 4, "bad size of the cached header");
+  NS_TEST_ASSERT_MSG_EQ (second.m_value, 42, "bad value of the cached header");
+  NS_TEST_ASSERT_MSG_EQ (ACachedTestHeader::m_deserialized, 1, "the header was deserialized again");
+
+  // a header of another type does not use the cache
+  ATestHeader<4> other;
+  p->PeekHeader (other);
+  NS_TEST_ASSERT_MSG_EQ (other.m_error, true, "the bytes were not deserialized");
+
+  // the copies of the packet have no cache
+  Ptr<Packet> copy = p->Copy ();
+  ACachedTestHeader copied;
+  copy->PeekHeader (copied);
+  NS_TEST_ASSERT_MSG_EQ (ACachedTestHeader::m_deserialized, 2, "a copy used the cache");
+
+  // a header which must see the bytes is deserialized
+  ACachedTestHeader verified;
+  verified.m_verify = true;
+  p->PeekHeader (verified);
+  NS_TEST_ASSERT_MSG_EQ (ACachedTestHeader::m_deserialized, 3, "the header did not see the bytes");
+
+  ACachedTestHeader removed;
+  size = p->RemoveHeader (removed);
+  NS_TEST_ASSERT_MSG_EQ (size, 4, "bad size of the removed header");
+  NS_TEST_ASSERT_MSG_EQ (removed.m_value, 42, "bad value of the removed header");
+  NS_TEST_ASSERT_MSG_EQ (ACachedTestHeader::m_deserialized, 3, "the removed header was deserialized again");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "the header was not removed");
+
+  // a change of the bytes drops the cache
+  header.m_value = 7;
+  p->AddHeader (header);
+  p->PeekHeader (first);
+  NS_TEST_ASSERT_MSG_EQ (first.m_value, 7, "a stale header was cached");
+  p->RemoveAtStart (2);
+  p->AddPaddingAtEnd (2);
+  p->PeekHeader (first);
+  NS_TEST_ASSERT_MSG_EQ (ACachedTestHeader::m_deserialized, 5, "the cache survived a change of the packet");
+  NS_TEST_ASSERT_MSG_EQ (first.m_value, 7 << 16, "a stale header was cached");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1495,13 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new ByteTagListSharingTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
+  AddTestCase (new PacketNixVectorTest, TestCase::QUICK);
+#ifndef NS3_MTP
+  // the packets do not cache their headers with --enable-mtp
+  AddTestCase (new PacketHeaderCacheTest, TestCase::QUICK);
+#endif
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
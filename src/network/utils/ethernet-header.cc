@@ -166,9 +166,13 @@ EthernetHeader::Serialize (Buffer::Iterator start) const
     {
       i.WriteU64 (m_preambleSfd);
     }
-  WriteTo (i, m_destination);
-  WriteTo (i, m_source);
-  i.WriteHtonU16 (m_lengthType);
+  // the addresses and the length/type are written at once
+  uint8_t buffer[2*MAC_ADDR_SIZE + LENGTH_SIZE];
+  m_destination.CopyTo (buffer);
+  m_source.CopyTo (buffer + MAC_ADDR_SIZE);
+  buffer[2*MAC_ADDR_SIZE] = m_lengthType >> 8;
+  buffer[2*MAC_ADDR_SIZE + 1] = m_lengthType & 0xff;
+  i.Write (buffer, sizeof (buffer));
 }
 uint32_t
 EthernetHeader::Deserialize (Buffer::Iterator start)
@@ -181,9 +185,11 @@ EthernetHeader::Deserialize (Buffer::Iterator start)
       m_enPreambleSfd = i.ReadU64 ();
     }
 
-  ReadFrom (i, m_destination);
-  ReadFrom (i, m_source);
-  m_lengthType = i.ReadNtohU16 ();
+  uint8_t buffer[2*MAC_ADDR_SIZE + LENGTH_SIZE];
+  i.Read (buffer, sizeof (buffer));
+  m_destination.CopyFrom (buffer);
+  m_source.CopyFrom (buffer + MAC_ADDR_SIZE);
+  m_lengthType = (buffer[2*MAC_ADDR_SIZE] << 8) | buffer[2*MAC_ADDR_SIZE + 1];
 
   return GetSerializedSize ();
 }
@@ -19,6 +19,7 @@
  */
 #include "flow-id-tag.h"
 #include "ns3/log.h"
+#include "ns3/ensemble-runner.h"
 
 namespace ns3 {
 
@@ -95,10 +96,8 @@ uint32_t
 FlowIdTag::AllocateFlowId (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint32_t nextFlowId = 1;
-  uint32_t flowId = nextFlowId;
-  nextFlowId++;
-  return flowId;
+  static NS_ENSEMBLE_ATOMIC (uint32_t) nextFlowId (1);
+  return nextFlowId++;
 }
 
 } // namespace ns3
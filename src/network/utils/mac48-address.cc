@@ -21,6 +21,7 @@
 #include "ns3/address.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/ensemble-runner.h"
 #include <iomanip>
 #include <iostream>
 #include <cstring>
@@ -135,8 +136,8 @@ Mac48Address
 Mac48Address::Allocate (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint64_t id = 0;
-  id++;
+  static NS_ENSEMBLE_ATOMIC (uint64_t) allocated (0);
+  uint64_t id = ++allocated;
   Mac48Address address;
   address.m_address[0] = (id >> 40) & 0xff;
   address.m_address[1] = (id >> 32) & 0xff;
@@ -20,6 +20,7 @@
 
 #include "mac8-address.h"
 #include "ns3/address.h"
+#include "ns3/ensemble-runner.h"
 
 namespace ns3 {
 
@@ -91,13 +92,10 @@ Mac8Address::GetBroadcast ()
 Mac8Address
 Mac8Address::Allocate ()
 {
-  static uint8_t nextAllocated = 0;
+  static NS_ENSEMBLE_ATOMIC (uint32_t) allocated (0);
 
-  uint8_t address = nextAllocated++;
-  if (nextAllocated == 255)
-    {
-      nextAllocated = 0;
-    }
+  // the addresses from 0 to 254, then from 0 again
+  uint8_t address = (allocated++) % 255;
 
   return Mac8Address (address);
 }
@@ -295,6 +295,16 @@ public:
    */
   void Flush (void);
 
+  /**
+   * Check whether the removal of an item can be observed otherwise than by
+   * the size of the queue seen by the next Enqueue, for example by the
+   * flow control of a NetDeviceQueue.
+   *
+   * \return true if a sink is connected to the Dequeue trace source or to
+   *         the trace sources of the size of the queue.
+   */
+  bool IsDequeueTraced (void) const;
+
   /// Define ItemType as the type of the stored elements
   typedef Item ItemType;
 
@@ -577,6 +587,13 @@ Queue<Item>::Flush (void)
     }
 }
 
+template <typename Item>
+bool
+Queue<Item>::IsDequeueTraced (void) const
+{
+  return !m_traceDequeue.IsEmpty () || !m_nPackets.IsEmpty () || !m_nBytes.IsEmpty ();
+}
+
 template <typename Item>
 Ptr<const Item>
 Queue<Item>::DoPeek (ConstIterator pos) const
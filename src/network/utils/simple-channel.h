@@ -30,6 +30,7 @@ namespace ns3 {
 
 class SimpleNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup channel
@@ -68,6 +69,22 @@ public:
   virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
                      Ptr<SimpleNetDevice> sender);
 
+  /**
+   * A burst of packets is sent by a net device.  Each packet is received
+   * by the net devices connected to the channel other than the sender as
+   * if it was passed to Send at the time it is sent.
+   *
+   * \param burst packets to be sent
+   * \param protocol protocol number
+   * \param to address to send the packets to
+   * \param from address the packets are coming from
+   * \param sender netdevice who sent the packets
+   * \param txStart time from now at which each packet is sent
+   */
+  virtual void SendBurst (Ptr<const PacketBurst> burst, uint16_t protocol, Mac48Address to,
+                          Mac48Address from, Ptr<SimpleNetDevice> sender,
+                          const std::vector<Time> &txStart);
+
   /**
    * Attached a net device to the channel.
    *
@@ -30,6 +30,7 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
+#include "ns3/packet-burst.h"
 
 namespace ns3 {
 
@@ -467,6 +468,58 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
 }
 
 
+bool
+SimpleNetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  if (m_queue->GetNPackets () > 0 || TransmitCompleteEvent.IsRunning ())
+    {
+      // the device is busy: the packets wait in the queue one at a time
+      return NetDevice::SendBurst (burst, dest, protocolNumber);
+    }
+
+  // the first packet leaves the queue at once and the next ones wait in
+  // it, so the queue drops the same packets as with Send
+  bool ret = true;
+  Ptr<PacketBurst> train = CreateObject<PacketBurst> ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      if ((*i)->GetSize () > GetMtu () || !m_queue->Enqueue (*i))
+        {
+          ret = false;
+          continue;
+        }
+      if (train->GetNPackets () == 0)
+        {
+          train->AddPacket (m_queue->Dequeue ());
+        }
+    }
+  for (Ptr<Packet> packet = m_queue->Dequeue (); packet != 0; packet = m_queue->Dequeue ())
+    {
+      train->AddPacket (packet);
+    }
+  if (train->GetNPackets () == 0)
+    {
+      return ret;
+    }
+
+  // each packet is sent when the previous one has been transmitted
+  std::vector<Time> txStart;
+  txStart.reserve (train->GetNPackets ());
+  Time txTime = Time (0);
+  for (std::list<Ptr<Packet> >::const_iterator i = train->Begin (); i != train->End (); ++i)
+    {
+      txStart.push_back (txTime);
+      if (m_bps > DataRate (0))
+        {
+          txTime += m_bps.CalculateBytesTxTime ((*i)->GetSize ());
+        }
+    }
+  m_channel->SendBurst (train, protocolNumber, Mac48Address::ConvertFrom (dest), m_address, this, txStart);
+  TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+  return ret;
+}
+
 void
 SimpleNetDevice::TransmitComplete ()
 {
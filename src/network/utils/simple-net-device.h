@@ -72,6 +72,7 @@ public:
    * \param from address packet was sent from
    */
   void Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
+
   
   /**
    * Attach a channel to this net device.  This will be the 
@@ -125,6 +126,20 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  /**
+   * Send a burst of packets.  If the device is idle, the packets go
+   * through the queue as with Send, and the packets which the queue
+   * accepts are sent back to back with a single event for the end of
+   * their transmission.  Each packet reaches the remote devices at the
+   * same time as if the packets were sent one at a time.  Otherwise they
+   * are sent one at a time.
+   *
+   * \param burst the packets
+   * \param dest the address of the destination
+   * \param protocolNumber the protocol number of the packets
+   * \returns true if all the packets were accepted
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+// A k-ary fat-tree of point-to-point links: k pods of k/2 edge and k/2
+// aggregation switches, (k/2)^2 core switches and k^3/4 hosts.  Every
+// switch is an IPv4 router which uses nix-vector routing.
+//
+// - Every host sends UDP packets to the host half of the tree away, so
+//   that all the packets go through a core switch (6 hops).
+// - At the end, the program prints the wall-clock time, the heap
+//   allocations and the peak memory per delivered packet.  The program
+//   replaces the global operator new to count the heap allocations.
+//
+// For example, to benchmark a fat-tree of 1024 hosts:
+//   ./waf --run "nix-vector-fat-tree --k=16 --packets=100"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sys/resource.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("NixVectorFatTree");
+
+/// The number of heap allocations.
+static uint64_t g_allocations = 0;
+/// The number of bytes allocated on the heap.
+static uint64_t g_allocatedBytes = 0;
+
+/**
+ * Allocate memory from the heap, and count the allocation.
+ *
+ * \param [in] size The number of bytes.
+ * \returns The memory.
+ */
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  g_allocatedBytes += size;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Release memory allocated by operator new.
+ *
+ * \param [in] p The memory.
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * Release memory allocated by operator new.
+ *
+ * \param [in] p The memory.
+ * \param [in] size The number of bytes.
+ */
+void
+operator delete (void *p, std::size_t size) noexcept
+{
+  NS_UNUSED (size);
+  std::free (p);
+}
+
+/**
+ * \returns the peak resident memory of the process, in kilobytes.
+ */
+static long
+GetPeakMemory (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t k = 8;
+  uint32_t packets = 100;
+  uint32_t packetSize = 1000;
+  Time interval = MicroSeconds (10);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("k", "Number of ports of the switches (even)", k);
+  cmd.AddValue ("packets", "Number of packets sent by each host", packets);
+  cmd.AddValue ("packetSize", "Size of the UDP payload", packetSize);
+  cmd.AddValue ("interval", "Interval between the packets of a host", interval);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (k < 2 || k % 2 != 0, "k must be even");
+  uint32_t half = k / 2;
+  uint32_t nHosts = k * half * half;
+
+  NodeContainer hosts;
+  hosts.Create (nHosts);
+  NodeContainer edges;
+  edges.Create (k * half);
+  NodeContainer aggregations;
+  aggregations.Create (k * half);
+  NodeContainer cores;
+  cores.Create (half * half);
+
+  Ipv4NixVectorHelper nixRouting;
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.Install (hosts);
+  stack.Install (edges);
+  stack.Install (aggregations);
+  stack.Install (cores);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1us"));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  std::vector<Ipv4Address> hostAddresses;
+  for (uint32_t pod = 0; pod < k; ++pod)
+    {
+      for (uint32_t e = 0; e < half; ++e)
+        {
+          Ptr<Node> edge = edges.Get (pod * half + e);
+          for (uint32_t h = 0; h < half; ++h)
+            {
+              NetDeviceContainer devices = pointToPoint.Install (hosts.Get ((pod * half + e) * half + h), edge);
+              hostAddresses.push_back (address.Assign (devices).GetAddress (0));
+              address.NewNetwork ();
+            }
+          for (uint32_t a = 0; a < half; ++a)
+            {
+              address.Assign (pointToPoint.Install (edge, aggregations.Get (pod * half + a)));
+              address.NewNetwork ();
+            }
+        }
+      for (uint32_t a = 0; a < half; ++a)
+        {
+          for (uint32_t c = 0; c < half; ++c)
+            {
+              address.Assign (pointToPoint.Install (aggregations.Get (pod * half + a), cores.Get (a * half + c)));
+              address.NewNetwork ();
+            }
+        }
+    }
+
+  uint16_t port = 9;
+  UdpServerHelper server (port);
+  ApplicationContainer servers = server.Install (hosts);
+  servers.Start (Seconds (0));
+  for (uint32_t i = 0; i < nHosts; ++i)
+    {
+      UdpClientHelper client (hostAddresses[(i + nHosts / 2) % nHosts], port);
+      client.SetAttribute ("MaxPackets", UintegerValue (packets));
+      client.SetAttribute ("Interval", TimeValue (interval));
+      client.SetAttribute ("PacketSize", UintegerValue (packetSize));
+      ApplicationContainer apps = client.Install (hosts.Get (i));
+      apps.Start (MicroSeconds (i));
+    }
+
+  std::cout << "fat-tree k=" << k << ": " << nHosts << " hosts, "
+            << edges.GetN () + aggregations.GetN () + cores.GetN () << " switches" << std::endl;
+
+  uint64_t allocations = g_allocations;
+  uint64_t allocatedBytes = g_allocatedBytes;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  allocations = g_allocations - allocations;
+  allocatedBytes = g_allocatedBytes - allocatedBytes;
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < servers.GetN (); ++i)
+    {
+      received += DynamicCast<UdpServer> (servers.Get (i))->GetReceived ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << "packets received: " << received << " of " << uint64_t (nHosts) * packets << std::endl;
+  if (received > 0)
+    {
+      std::cout << "wall-clock time:  " << elapsed << " ms, "
+                << elapsed * 1000.0 / received << " us per packet" << std::endl;
+      std::cout << "heap allocations: " << double (allocations) / received << " per packet, "
+                << double (allocatedBytes) / received << " bytes per packet" << std::endl;
+      std::cout << "peak memory:      " << GetPeakMemory () << " kB, "
+                << GetPeakMemory () * 1024.0 / received << " bytes per packet" << std::endl;
+    }
+  return 0;
+}
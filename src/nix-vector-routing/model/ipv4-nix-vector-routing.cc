@@ -34,7 +34,7 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
-bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+NS_ENSEMBLE_ATOMIC (bool) Ipv4NixVectorRouting::g_isCacheDirty (false);
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -519,8 +519,8 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
       NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache);
 
       // create a new nix vector to be used, 
-      // we want to keep the cached version clean
-      nixVectorForPacket = Create<NixVector> ();
+      // we want to keep the cached version clean.
+      // The copy shares the bits of the cached version.
       nixVectorForPacket = nixVectorInCache->Copy (); 
 
       // Get the interface number that we go out of, by extracting
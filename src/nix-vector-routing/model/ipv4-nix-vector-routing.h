@@ -32,6 +32,7 @@
 #include "ns3/nix-vector.h"
 #include "ns3/bridge-net-device.h"
 #include "ns3/nstime.h"
+#include "ns3/ensemble-runner.h"
 
 namespace ns3 {
 
@@ -231,7 +232,7 @@ private:
    * Flag to mark when caches are dirty and need to be flushed.  
    * Used for lazy cleanup of caches when there are many topology changes.
    */
-  static bool g_isCacheDirty;
+  static NS_ENSEMBLE_ATOMIC (bool) g_isCacheDirty;
 
   /** Cache stores nix-vectors based on destination ip */
   mutable NixMap_t m_nixCache;
@@ -10,6 +10,7 @@
 cpp_examples = [
     ("nix-simple", "True", "True"),
     ("nms-p2p-nix", "False", "True"), # Takes too long to run
+    ("nix-vector-fat-tree --k=4 --packets=10", "True", "True"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
@@ -20,6 +20,7 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -106,6 +107,31 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  const std::vector<Time> &txEnd)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+  NS_ASSERT (txEnd.size () == burst->GetNPackets ());
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  uint32_t context = m_link[wire].m_dst->GetNode ()->GetId ();
+
+  std::vector<Time>::const_iterator t = txEnd.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++t)
+    {
+      Simulator::ScheduleWithContext (context, *t + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, (*i)->Copy ());
+      m_txrxPointToPoint (*i, src, m_link[wire].m_dst, *t, *t + m_delay);
+    }
+  return true;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
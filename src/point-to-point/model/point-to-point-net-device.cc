@@ -177,7 +177,8 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_burstNext (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -214,6 +215,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_burstTxStart.clear ();
   m_queue = 0;
   NetDevice::DoDispose ();
 }
@@ -262,6 +264,98 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitBurst (Ptr<PacketBurst> burst)
+{
+  NS_LOG_FUNCTION (this << burst);
+
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  m_txMachineState = BUSY;
+
+  //
+  // The packets follow each other on the wire, separated by the interframe
+  // gap: each one starts when the previous one would have completed if
+  // they were sent one at a time.  Each packet leaves the queue and the
+  // trace sources of the start of its transmission are fired at that
+  // time, by an event for each packet only if this can be traced.
+  // Otherwise the packets are dequeued when the queue is used again, so
+  // that it drops the same packets.
+  //
+  bool traced = !m_phyTxEndTrace.IsEmpty () || !m_snifferTrace.IsEmpty ()
+    || !m_promiscSnifferTrace.IsEmpty () || !m_phyTxBeginTrace.IsEmpty ()
+    || m_queue->IsDequeueTraced ();
+  NS_ASSERT (m_burstTxStart.empty ());
+  m_burstNext = 0;
+  std::vector<Time> txEnd;
+  txEnd.reserve (burst->GetNPackets ());
+  Time txStart;
+  Ptr<Packet> previous;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      if (previous == 0)
+        {
+          m_snifferTrace (*i);
+          m_promiscSnifferTrace (*i);
+          m_phyTxBeginTrace (*i);
+        }
+      else if (traced)
+        {
+          Simulator::Schedule (txStart, &PointToPointNetDevice::TransmitNextInBurst, this, previous);
+        }
+      else
+        {
+          m_burstTxStart.push_back (Simulator::Now () + txStart);
+        }
+      txEnd.push_back (txStart + m_bps.CalculateBytesTxTime ((*i)->GetSize ()));
+      txStart = txEnd.back () + m_tInterframeGap;
+      previous = *i;
+    }
+  m_currentPkt = previous;
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txStart.GetSeconds () << "sec");
+  Simulator::Schedule (txStart, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitBurst (burst, this, txEnd);
+  if (result == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+        {
+          m_phyTxDropTrace (*i);
+        }
+    }
+  return result;
+}
+
+void
+PointToPointNetDevice::TransmitNextInBurst (Ptr<Packet> previous)
+{
+  NS_LOG_FUNCTION (this << previous);
+  Ptr<Packet> next = m_queue->Dequeue ();
+  NS_ASSERT_MSG (next != 0, "The next packet of the burst should be in the queue");
+  m_phyTxEndTrace (previous);
+  m_snifferTrace (next);
+  m_promiscSnifferTrace (next);
+  m_phyTxBeginTrace (next);
+}
+
+void
+PointToPointNetDevice::DequeueStartedInBurst (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_burstNext < m_burstTxStart.size ()
+         && m_burstTxStart[m_burstNext] <= Simulator::Now ())
+    {
+      Ptr<Packet> p = m_queue->Dequeue ();
+      NS_ASSERT_MSG (p != 0, "The next packet of the burst should be in the queue");
+      m_burstNext++;
+    }
+  if (m_burstNext == m_burstTxStart.size ())
+    {
+      m_burstTxStart.clear ();
+      m_burstNext = 0;
+    }
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -281,6 +375,9 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
+  DequeueStartedInBurst ();
+  NS_ASSERT_MSG (m_burstTxStart.empty (), "The packets of the burst should have left the queue");
+
   Ptr<Packet> p = m_queue->Dequeue ();
   if (p == 0)
     {
@@ -531,6 +628,12 @@ PointToPointNetDevice::Send (
 
   m_macTxTrace (packet);
 
+  //
+  // The packets of a burst whose transmission has started must have left
+  // the queue before this one is enqueued.
+  //
+  DequeueStartedInBurst ();
+
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
@@ -556,6 +659,51 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::SendBurst (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  //
+  // If the transmitter is busy, the packets wait in the queue anyway, and
+  // they are transmitted one at a time when it becomes ready.
+  //
+  if (IsLinkUp () == false || m_txMachineState != READY)
+    {
+      return NetDevice::SendBurst (burst, dest, protocolNumber);
+    }
+
+  //
+  // Hit the same tracing hooks as Send.  The first packet leaves the queue
+  // at once and the next ones wait in it until their transmission starts,
+  // so the queue drops the same packets as if they were sent one at a
+  // time; all of them are transmitted back to back.
+  //
+  bool ret = true;
+  Ptr<PacketBurst> train = CreateObject<PacketBurst> ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Ptr<Packet> packet = *i;
+      AddHeader (packet, protocolNumber);
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+          ret = false;
+          continue;
+        }
+      train->AddPacket (train->GetNPackets () == 0 ? m_queue->Dequeue () : packet);
+    }
+  if (train->GetNPackets () == 0)
+    {
+      return ret;
+    }
+  return TransmitBurst (train) && ret;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
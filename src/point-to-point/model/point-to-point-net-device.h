@@ -20,11 +20,13 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
 #include "ns3/callback.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/traced-callback.h"
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
@@ -176,6 +178,23 @@ public:
   virtual bool IsBridge (void) const;
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+  /**
+   * \brief Send a burst of packets back to back
+   *
+   * If the transmitter is ready, the packets go through the queue as with
+   * Send, and the packets which the queue accepts are then transmitted
+   * back to back, with a single event for the end of the transmission.
+   * Each packet reaches the remote device, and fires the trace sources of
+   * the transmission, at the same time as if the packets were sent one at
+   * a time.  If the transmitter is busy, the packets are sent one at a
+   * time.
+   *
+   * \param burst the packets
+   * \param dest the address of the destination
+   * \param protocolNumber the protocol number of the packets
+   * \returns true if all the packets were accepted
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
@@ -267,6 +286,39 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start Sending a Burst of Packets Down the Wire.
+   *
+   * The first packet of the burst has been dequeued and the next ones wait
+   * in the queue.  The packets are transmitted back to back, separated by
+   * the interframe gap, and a single event is scheduled for the time at
+   * which the bits of the last packet have been completely transmitted.
+   * Each of the next packets leaves the queue when its transmission
+   * starts, in TransmitNextInBurst if that can be traced, or else in
+   * DequeueStartedInBurst before the queue is used again.
+   *
+   * \see PointToPointChannel::TransmitBurst ()
+   * \see TransmitComplete()
+   * \param burst the packets to send
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurst (Ptr<PacketBurst> burst);
+
+  /**
+   * Dequeue the next packet of a burst when its transmission starts, and
+   * fire the trace sources of the end of the transmission of the previous
+   * one and of the start of the next one.
+   *
+   * \param previous the packet whose transmission is complete
+   */
+  void TransmitNextInBurst (Ptr<Packet> previous);
+
+  /**
+   * Dequeue the packets of the current burst whose transmission has
+   * started, if their dequeue was not traced.
+   */
+  void DequeueStartedInBurst (void);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -456,6 +508,8 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  std::vector<Time> m_burstTxStart; //!< Start times of the packets of the burst waiting in the queue
+  uint32_t m_burstNext; //!< Index in m_burstTxStart of the next packet to dequeue
 
   /**
    * \brief PPP to Ethernet protocol number mapping
@@ -24,6 +24,8 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/packet-burst.h"
+#include "ns3/string.h"
 
 using namespace ns3;
 
@@ -94,6 +96,201 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the bursts of the PointToPoint model
+ *
+ * It sends a burst of packets from one NetDevice to another, and checks
+ * that the packets which the queue accepts are received, and start their
+ * transmission, at the same times as if they were sent one at a time,
+ * with fewer events when the transmission is not traced.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param n number of packets
+   * \param burst whether to send them as a burst
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n, bool burst);
+
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving NetDevice
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the address of the sender
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Record the start of the transmission of a packet
+   *
+   * \param packet the packet
+   */
+  void PhyTxBegin (Ptr<const Packet> packet);
+
+  /**
+   * \brief Record the dequeue of a packet
+   *
+   * \param packet the packet
+   */
+  void Dequeue (Ptr<const Packet> packet);
+
+  /**
+   * \brief Send packets over a link and record their reception
+   *
+   * Two more packets are sent one at a time while the first ones are
+   * being transmitted.
+   *
+   * \param n number of packets
+   * \param burst whether to send them as a burst
+   * \param traced whether to record the start of their transmission and
+   *        their dequeue
+   * \returns the number of events of the simulation
+   */
+  uint64_t Run (uint32_t n, bool burst, bool traced);
+
+  std::vector<Time> m_rxTimes; //!< the reception times of the packets
+  std::vector<Time> m_txTimes; //!< the transmission start times of the packets
+  std::vector<Time> m_dequeueTimes; //!< the dequeue times of the packets
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint bursts")
+{
+}
+
+void
+PointToPointBurstTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n, bool burst)
+{
+  Ptr<PacketBurst> packets = CreateObject<PacketBurst> ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      packets->AddPacket (Create<Packet> (998));
+    }
+  if (burst)
+    {
+      device->SendBurst (packets, device->GetBroadcast (), 0x800);
+      return;
+    }
+  for (std::list<Ptr<Packet> >::const_iterator i = packets->Begin (); i != packets->End (); ++i)
+    {
+      device->Send (*i, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointBurstTest::PhyTxBegin (Ptr<const Packet> packet)
+{
+  m_txTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointBurstTest::Dequeue (Ptr<const Packet> packet)
+{
+  m_dequeueTimes.push_back (Simulator::Now ());
+}
+
+uint64_t
+PointToPointBurstTest::Run (uint32_t n, bool burst, bool traced)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", StringValue ("1ms"));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetAttribute ("MaxSize", StringValue ("3p"));
+  devA->SetQueue (queue);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+  if (traced)
+    {
+      devA->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&PointToPointBurstTest::PhyTxBegin, this));
+      queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&PointToPointBurstTest::Dequeue, this));
+    }
+
+  m_rxTimes.clear ();
+  m_txTimes.clear ();
+  m_dequeueTimes.clear ();
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendPackets, this, devA, n, burst);
+  Simulator::Schedule (MicroSeconds (1001500), &PointToPointBurstTest::SendPackets, this, devA, 2, false);
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  // the first packet is transmitted at once and three wait in the queue,
+  // the last one is dropped; each packet takes 1 ms with its header.
+  // When the next two are sent, the second packet has left the queue, so
+  // there is room for one of them only.
+  uint64_t events = Run (5, false, false);
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 5, "wrong number of packets");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], MilliSeconds (1002 + i), "wrong reception time of packet " << i);
+    }
+  std::vector<Time> rxTimes = m_rxTimes;
+
+  uint64_t burstEvents = Run (5, true, false);
+  NS_TEST_EXPECT_MSG_EQ ((m_rxTimes == rxTimes), true, "the packets of the burst should be received as if they were sent one at a time");
+  NS_TEST_EXPECT_MSG_LT (burstEvents, events, "the burst should need fewer events");
+
+  // the start of the transmission of each packet is traced at its own time
+  // and leaves the queue at that time
+  Run (5, false, true);
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes.size (), 5, "wrong number of transmissions");
+  NS_TEST_ASSERT_MSG_EQ (m_dequeueTimes.size (), 5, "wrong number of dequeues");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_txTimes[i], MilliSeconds (1000 + i), "wrong transmission time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_dequeueTimes[i], MilliSeconds (1000 + i), "wrong dequeue time of packet " << i);
+    }
+  std::vector<Time> txTimes = m_txTimes;
+  std::vector<Time> dequeueTimes = m_dequeueTimes;
+  Run (5, true, true);
+  NS_TEST_EXPECT_MSG_EQ ((m_txTimes == txTimes), true, "the packets of the burst should be transmitted as if they were sent one at a time");
+  NS_TEST_EXPECT_MSG_EQ ((m_dequeueTimes == dequeueTimes), true, "the packets of the burst should be dequeued as if they were sent one at a time");
+  NS_TEST_EXPECT_MSG_EQ ((m_rxTimes == rxTimes), true, "the packets of the traced burst should be received as if they were sent one at a time");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +307,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -22,9 +22,11 @@
 #include "ns3/log.h"
 #include "ns3/object-map.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
 #include <tuple>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -398,4 +400,100 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
     }
 }
 
+void
+TrafficControlLayer::SendBurst (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << device << items.size ());
+
+  Ptr<NetDeviceQueueInterface> devQueueIface;
+  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+
+  if (ndi != m_netDevices.end ())
+    {
+      devQueueIface = ndi->second.m_ndqi;
+    }
+
+  if (devQueueIface && devQueueIface->GetNTxQueues () > 1)
+    {
+      // each packet may select another transmission queue
+      if (ndi->second.m_rootQueueDisc == 0)
+        {
+          for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); ++i)
+            {
+              Send (device, *i);
+            }
+          return;
+        }
+      std::vector<Ptr<QueueDisc> > toRun;
+      for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); ++i)
+        {
+          std::size_t txq = devQueueIface->GetSelectQueueCallback () (*i);
+          NS_ASSERT (txq < devQueueIface->GetNTxQueues ());
+          (*i)->SetTxQueueIndex (txq);
+          Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+          NS_ASSERT (qDisc);
+          qDisc->Enqueue (*i);
+          if (std::find (toRun.begin (), toRun.end (), qDisc) == toRun.end ())
+            {
+              toRun.push_back (qDisc);
+            }
+        }
+      for (std::vector<Ptr<QueueDisc> >::iterator q = toRun.begin (); q != toRun.end (); ++q)
+        {
+          (*q)->Run ();
+        }
+      return;
+    }
+
+  if (ndi == m_netDevices.end () || ndi->second.m_rootQueueDisc == 0)
+    {
+      // The device has no attached queue disc, thus add the headers to the packets
+      // and send them directly to the device if its queue is not stopped
+      Ptr<PacketBurst> burst;
+      Address dest;
+      uint16_t protocol = 0;
+      for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); ++i)
+        {
+          if (burst != 0 && ((*i)->GetAddress () != dest || (*i)->GetProtocol () != protocol))
+            {
+              device->SendBurst (burst, dest, protocol);
+              burst = 0;
+            }
+          // as in Send, the queue is checked for each packet; it may have
+          // been stopped by the packets already passed to the device
+          if (devQueueIface && devQueueIface->GetTxQueue (0)->IsStopped ())
+            {
+              continue;
+            }
+          (*i)->AddHeader ();
+          // a single queue device makes no use of the priority tag
+          SocketPriorityTag priorityTag;
+          (*i)->GetPacket ()->RemovePacketTag (priorityTag);
+          if (burst == 0)
+            {
+              burst = CreateObject<PacketBurst> ();
+              dest = (*i)->GetAddress ();
+              protocol = (*i)->GetProtocol ();
+            }
+          burst->AddPacket ((*i)->GetPacket ());
+        }
+      if (burst != 0)
+        {
+          device->SendBurst (burst, dest, protocol);
+        }
+      return;
+    }
+
+  // Enqueue the packets in the queue disc of the single transmission queue,
+  // then dequeue them at once
+  Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[0];
+  NS_ASSERT (qDisc);
+  for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); ++i)
+    {
+      (*i)->SetTxQueueIndex (0);
+      qDisc->Enqueue (*i);
+    }
+  qDisc->Run ();
+}
+
 } // namespace ns3
@@ -195,6 +195,19 @@ public:
    */
   virtual void Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item);
 
+  /**
+   * \brief Called from upper layer to queue several packets for the transmission.
+   *
+   * If the device has no queue disc, the consecutive packets with the same
+   * destination and protocol are passed to NetDevice::SendBurst together.
+   * Otherwise all the packets are enqueued in the queue discs, which then
+   * run once for the whole burst.
+   *
+   * \param device the device the packets must be sent to
+   * \param items the queue items including the packets and additional information
+   */
+  virtual void SendBurst (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items);
+
 protected:
 
   virtual void DoDispose (void);
@@ -363,6 +363,129 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Layer burst Test Case
+ *
+ * Send a burst of packets through the traffic control layer, with and
+ * without a queue disc, and check when they are received.
+ */
+class TcSendBurstTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param queueDisc whether to install a queue disc on the device
+   */
+  TcSendBurstTestCase (bool queueDisc);
+private:
+  virtual void DoRun (void);
+  /**
+   * Instruct a node to send a burst of packets
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendBurst (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Receive a packet
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the address of the sender
+   * \param to the address of the destination
+   * \param packetType the type of the packet
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  bool m_queueDisc;            //!< whether to install a queue disc
+  std::vector<Time> m_rxTimes; //!< the reception times of the packets
+};
+
+TcSendBurstTestCase::TcSendBurstTestCase (bool queueDisc)
+  : TestCase ("Test the transmission of a burst of packets"),
+    m_queueDisc (queueDisc)
+{
+}
+
+void
+TcSendBurstTestCase::SendBurst (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      items.push_back (Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+  tc->SendBurst (n->GetDevice (0), items);
+}
+
+bool
+TcSendBurstTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                              const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+TcSendBurstTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+  rxDevC.Get (0)->SetPromiscReceiveCallback (MakeCallback (&TcSendBurstTestCase::Receive, this));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("5p"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+
+  if (m_queueDisc)
+    {
+      TrafficControlHelper tch = TrafficControlHelper::Default ();
+      tch.Install (txDev);
+    }
+
+  // transmit 10 packets at time 0
+  Simulator::Schedule (Time (Seconds (0)), &TcSendBurstTestCase::SendBurst,
+                       this, n.Get (0), 10);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  if (m_queueDisc)
+    {
+      // the queue disc holds the packets which do not fit in the device
+      // queue, and they are sent one at a time, every 8ms
+      NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 10, "All the packets must be received");
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], MilliSeconds (8 * i), "Wrong reception time of packet " << i);
+        }
+    }
+  else
+    {
+      // the device sends one packet and queues five of them, which are
+      // sent back to back and received every 8ms, as with Send
+      NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 6, "The device queue must drop 4 packets");
+      for (uint32_t i = 0; i < 6; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], MilliSeconds (8 * i), "Wrong reception time of packet " << i);
+        }
+    }
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -377,5 +500,7 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcSendBurstTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcSendBurstTestCase (true), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the serialization and deserialization of the
+// Ethernet, IPv4, UDP and TCP headers on the send and receive paths of
+// the internet stack, for various numbers of packets 'n'
+// Sample usage:  ./waf --run 'bench-headers --n=100000'
+//
+// The TCP receive benchmark peeks at the TCP header twice before it
+// removes it, as TcpL4Protocol and TcpSocketBase do, so it also measures
+// the header cache of the packets.  The IPv4 forward benchmark decrements
+// the TTL of a header with a checksum, as Ipv4L3Protocol::IpForward does.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-ts.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \returns an IPv4 header of a datagram of 1000 bytes.
+ *
+ * \param [in] protocol The protocol of the payload.
+ */
+static Ipv4Header
+MakeIpv4Header (uint8_t protocol)
+{
+  Ipv4Header ipv4;
+  ipv4.SetSource (Ipv4Address ("10.1.1.1"));
+  ipv4.SetDestination (Ipv4Address ("10.1.2.1"));
+  ipv4.SetProtocol (protocol);
+  ipv4.SetPayloadSize (1000);
+  ipv4.SetTtl (64);
+  return ipv4;
+}
+
+/**
+ * \returns a TCP header with a timestamp option, as in most segments.
+ */
+static TcpHeader
+MakeTcpHeader (void)
+{
+  TcpHeader tcp;
+  tcp.SetSourcePort (49153);
+  tcp.SetDestinationPort (50000);
+  tcp.SetSequenceNumber (SequenceNumber32 (1));
+  tcp.SetAckNumber (SequenceNumber32 (1));
+  tcp.SetFlags (TcpHeader::ACK);
+  tcp.SetWindowSize (65535);
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (1000);
+  ts->SetEcho (999);
+  tcp.AppendOption (ts);
+  return tcp;
+}
+
+/**
+ * Send TCP segments: add the TCP, IPv4 and Ethernet headers.
+ *
+ * \param [in] n The number of packets.
+ */
+static void
+benchTcpSend (uint32_t n)
+{
+  TcpHeader tcp = MakeTcpHeader ();
+  Ipv4Header ipv4 = MakeIpv4Header (6);
+  EthernetHeader ethernet;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (968);
+      p->AddHeader (tcp);
+      p->AddHeader (ipv4);
+      p->AddHeader (ethernet);
+    }
+}
+
+/**
+ * Receive TCP segments: remove the Ethernet and IPv4 headers, peek at
+ * the TCP header twice and remove it.
+ *
+ * \param [in] n The number of packets.
+ */
+static void
+benchTcpReceive (uint32_t n)
+{
+  Ptr<Packet> p = Create<Packet> (968);
+  p->AddHeader (MakeTcpHeader ());
+  p->AddHeader (MakeIpv4Header (6));
+  p->AddHeader (EthernetHeader ());
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> q = p->Copy ();
+      EthernetHeader ethernet;
+      q->RemoveHeader (ethernet);
+      Ipv4Header ipv4;
+      q->RemoveHeader (ipv4);
+      // TcpL4Protocol looks up the endpoint, then the socket processes
+      // the segment
+      TcpHeader l4;
+      q->PeekHeader (l4);
+      TcpHeader socket;
+      q->PeekHeader (socket);
+      TcpHeader tcp;
+      q->RemoveHeader (tcp);
+    }
+}
+
+/**
+ * Send UDP datagrams: add the UDP, IPv4 and Ethernet headers.
+ *
+ * \param [in] n The number of packets.
+ */
+static void
+benchUdpSend (uint32_t n)
+{
+  UdpHeader udp;
+  udp.SetSourcePort (49153);
+  udp.SetDestinationPort (9);
+  Ipv4Header ipv4 = MakeIpv4Header (17);
+  EthernetHeader ethernet;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (992);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddHeader (ethernet);
+    }
+}
+
+/**
+ * Receive UDP datagrams: remove the Ethernet and IPv4 headers, peek at
+ * the UDP header and remove it.
+ *
+ * \param [in] n The number of packets.
+ */
+static void
+benchUdpReceive (uint32_t n)
+{
+  UdpHeader header;
+  header.SetSourcePort (49153);
+  header.SetDestinationPort (9);
+  Ptr<Packet> p = Create<Packet> (992);
+  p->AddHeader (header);
+  p->AddHeader (MakeIpv4Header (17));
+  p->AddHeader (EthernetHeader ());
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> q = p->Copy ();
+      EthernetHeader ethernet;
+      q->RemoveHeader (ethernet);
+      Ipv4Header ipv4;
+      q->RemoveHeader (ipv4);
+      UdpHeader l4;
+      q->PeekHeader (l4);
+      UdpHeader udp;
+      q->RemoveHeader (udp);
+    }
+}
+
+/**
+ * Forward IPv4 datagrams with checksums: remove the IPv4 header, decrement
+ * its TTL and add it back.
+ *
+ * \param [in] n The number of packets.
+ */
+static void
+benchIpv4Forward (uint32_t n)
+{
+  Ipv4Header header = MakeIpv4Header (17);
+  header.EnableChecksum ();
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddHeader (header);
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> q = p->Copy ();
+      Ipv4Header ipv4;
+      ipv4.EnableChecksum ();
+      q->RemoveHeader (ipv4);
+      if (!ipv4.IsChecksumOk ())
+        {
+          std::cerr << "Error-- bad IPv4 checksum" << std::endl;
+          exit (1);
+        }
+      ipv4.SetTtl (ipv4.GetTtl () - 1);
+      q->AddHeader (ipv4);
+    }
+}
+
+/**
+ * Run a benchmark once.
+ *
+ * \param [in] bench The benchmark.
+ * \param [in] n The number of packets.
+ * \returns The elapsed wall-clock time in milliseconds.
+ */
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+/**
+ * Run a benchmark several times, and print its best rate.
+ *
+ * \param [in] bench The benchmark.
+ * \param [in] n The number of packets.
+ * \param [in] minIterations The number of runs.
+ * \param [in] name The name of the benchmark.
+ */
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration (bench, n);
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ps << " packets/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the serialization of the Ethernet, IPv4, UDP and TCP headers");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-headers with n=" << n << std::endl;
+  runBench (&benchTcpSend, n, minIterations, "Ethernet/IPv4/TCP send");
+  runBench (&benchTcpReceive, n, minIterations, "Ethernet/IPv4/TCP receive");
+  runBench (&benchUdpSend, n, minIterations, "Ethernet/IPv4/UDP send");
+  runBench (&benchUdpReceive, n, minIterations, "Ethernet/IPv4/UDP receive");
+  runBench (&benchIpv4Forward, n, minIterations, "IPv4 forward with checksum");
+
+  return 0;
+}
@@ -21,11 +21,17 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./waf --run 'bench-packets --n=10000'
+//
+// Each benchmark also reports the number of blocks allocated by the
+// packets (Packet objects and tag arrays) per packet, and how many
+// of them still reached the heap through the PacketPool free lists.
+// Run with --PacketPool=false to compare without the free lists.
 
 #include "ns3/command-line.h"
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-pool.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -328,6 +334,80 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchForward (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+  BenchTag<16> tag;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddPacketTag (tag);
+      // Three hops: each channel delivers a copy of the packet, and each
+      // router rewrites the IPv4 header and the packet tag.
+      for (uint32_t hop = 0; hop < 3; hop++)
+        {
+          Ptr<Packet> q = p->Copy ();
+          q->RemoveHeader (ipv4);
+          q->AddHeader (ipv4);
+          q->RemovePacketTag (tag);
+          q->AddPacketTag (tag);
+          p = q;
+        }
+      p->RemoveHeader (ipv4);
+      p->RemoveHeader (udp);
+    }
+}
+
+static void
+benchTaggedForward (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+  // The tags of a typical wireless packet: a priority, a flow id, a
+  // few queue and bearer tags of various sizes.
+  BenchTag<1> priority;
+  BenchTag<4> flowId;
+  BenchTag<8> queue;
+  BenchTag<12> bearer;
+  BenchTag<20> radioBearer;
+  BenchTag<2> byteTag;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddPacketTag (priority);
+      p->AddPacketTag (flowId);
+      p->AddByteTag (byteTag);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddPacketTag (bearer);
+      // Three hops: each device looks up the tags of the packet it
+      // receives, replaces its own, and hands a copy to the next hop
+      // with a queue tag, which the next hop removes.
+      for (uint32_t hop = 0; hop < 3; hop++)
+        {
+          Ptr<Packet> q = p->Copy ();
+          q->PeekPacketTag (priority);
+          q->PeekPacketTag (flowId);
+          q->PeekPacketTag (radioBearer);
+          q->ReplacePacketTag (bearer);
+          q->AddPacketTag (queue);
+          q->RemoveHeader (ipv4);
+          q->AddHeader (ipv4);
+          q->RemovePacketTag (queue);
+          p = q;
+        }
+      p->RemovePacketTag (bearer);
+      p->RemoveHeader (ipv4);
+      p->RemoveHeader (udp);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -343,16 +423,21 @@ static void
 runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  PacketPool::ResetStats ();
   for (uint32_t i = 0; i < minIterations; i++)
     {
       uint64_t delay = runBenchOneIteration(bench, n);
       minDelay = std::min(minDelay, delay);
     }
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  double packets = static_cast<double> (n) * minIterations;
   double ps = n;
   ps *= 1000;
   ps /= minDelay;
   std::cout << ps << " packets/s"
             << " (" << minDelay << " ms elapsed)\t"
+            << stats.allocations / packets << " allocs/packet, "
+            << (stats.allocations - stats.hits) / packets << " from heap\t"
             << name
             << std::endl;
 }
@@ -370,6 +455,11 @@ int main (int argc, char *argv[])
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
   cmd.Parse (argc, argv);
 
+  if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   if (n == 0)
     {
       std::cerr << "Error-- number of packets must be specified " <<
@@ -385,6 +475,8 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchForward, n, minIterations, "Forward a tagged packet over three hops");
+  runBench (&benchTaggedForward, n, minIterations, "Forward a packet with many tags over three hops");
 
   return 0;
 }